@@ -0,0 +1,81 @@
+#ifndef ADAPTIVE_HUFFMAN_H
+#define ADAPTIVE_HUFFMAN_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include "file_io.h"
+
+// Constantes do formato adaptativo (FGK)
+#define ADAPTIVE_MAGIC "HUFV"
+#define ADAPTIVE_MAGIC_SIZE 4
+#define ADAPTIVE_FORMAT_VERSION 1
+#define ADAPTIVE_FLUSH 256                          // Fim de mensagem: o resto do byte é descartado
+#define ADAPTIVE_END 257                            // Fim do fluxo
+#define ADAPTIVE_SYMBOLS 258                        // Bytes mais os dois símbolos de controle
+#define ADAPTIVE_SYMBOL_BITS 9                      // Bits de um símbolo novo após o código NYT
+#define ADAPTIVE_MAX_NODES (2 * ADAPTIVE_SYMBOLS + 1) // Folhas dos símbolos e do NYT, mais os nós internos
+
+// Nó da árvore adaptativa
+typedef struct AdaptiveNode {
+    uint64_t weight;          // Ocorrências dos símbolos da subárvore
+    int parent;               // Índice do pai (-1 na raiz)
+    int left;                 // Filho do bit 0 (-1 numa folha)
+    int right;                // Filho do bit 1 (-1 numa folha)
+    int number;               // Posição na ordem de pesos não decrescentes (propriedade dos irmãos)
+    int symbol;               // Símbolo da folha (-1 no NYT e nos nós internos)
+} AdaptiveNode;
+
+// Árvore compartilhada, atualizada da mesma forma pelo codificador e pelo decodificador
+typedef struct AdaptiveModel {
+    AdaptiveNode nodes[ADAPTIVE_MAX_NODES];
+    int order[ADAPTIVE_MAX_NODES];          // Número -> índice do nó
+    int leaf[ADAPTIVE_SYMBOLS];             // Símbolo -> folha (-1 se ainda não apareceu)
+    int root;                               // Índice da raiz
+    int nyt;                                // Folha "ainda não transmitido"
+    int count;                              // Nós em uso
+} AdaptiveModel;
+
+// Codificador de um fluxo adaptativo
+typedef struct AdaptiveEncoder {
+    AdaptiveModel model;
+    BitWriter writer;
+    unsigned char buffer[BUFFER_SIZE];
+    uint64_t input_bytes;     // Bytes codificados
+    uint64_t messages;        // Mensagens encerradas com adaptiveFlush
+} AdaptiveEncoder;
+
+// Decodificador de um fluxo adaptativo (lê byte a byte, sem esperar o buffer encher)
+typedef struct AdaptiveDecoder {
+    AdaptiveModel model;
+    ByteSource* input;
+    int byte;                 // Byte atual da entrada
+    int bits_left;            // Bits ainda não lidos do byte atual
+    uint64_t output_bytes;    // Bytes decodificados
+} AdaptiveDecoder;
+
+// Funções para identificação do formato
+int isAdaptiveStream(FILE* input);
+int isAdaptiveFile(const char* filename);
+
+// Funções para o modelo adaptativo
+void initAdaptiveModel(AdaptiveModel* model);
+void updateAdaptiveModel(AdaptiveModel* model, int symbol);
+
+// Funções para codificação
+int initAdaptiveEncoder(AdaptiveEncoder* encoder, ByteSink* output);
+int adaptiveEncode(AdaptiveEncoder* encoder, const unsigned char* data, size_t length);
+int adaptiveFlush(AdaptiveEncoder* encoder);
+int finishAdaptiveEncoder(AdaptiveEncoder* encoder);
+
+// Funções para decodificação
+int initAdaptiveDecoder(AdaptiveDecoder* decoder, ByteSource* input);
+int adaptiveDecodeMessage(AdaptiveDecoder* decoder, ByteSink* output);
+
+// Funções para fluxos completos
+int compressStreamAdaptive(FILE* input, FILE* output);
+int decompressStreamAdaptive(FILE* input, FILE* output);
+int compressFileAdaptive(const char* input_filename, const char* output_filename);
+int decompressFileAdaptive(const char* input_filename, const char* output_filename);
+
+#endif // ADAPTIVE_HUFFMAN_H
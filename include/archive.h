@@ -0,0 +1,60 @@
+#ifndef ARCHIVE_H
+#define ARCHIVE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include "file_io.h"
+#include "memory_budget.h"
+#include "progress.h"
+
+// Constantes do formato de arquivo com vários membros
+#define ARCHIVE_MAGIC "HUFA"
+#define ARCHIVE_MAGIC_SIZE 4
+#define ARCHIVE_FORMAT_VERSION 1
+#define ARCHIVE_HEADER_SIZE (ARCHIVE_MAGIC_SIZE + 2)
+#define ARCHIVE_TRAILER_SIZE (8 + 4 + ARCHIVE_MAGIC_SIZE)  // Offset do diretório, membros, assinatura
+#define ARCHIVE_MAX_MEMBERS 65536
+
+// Entrada do diretório central
+typedef struct ArchiveEntry {
+    char name[MAX_FILENAME];      // Caminho relativo do membro
+    uint64_t original_size;       // Bytes originais
+    uint64_t offset;              // Início do contêiner em blocos do membro
+    uint64_t compressed_size;     // Bytes do contêiner do membro
+} ArchiveEntry;
+
+// Diretório central lido do fim do arquivo
+typedef struct ArchiveDirectory {
+    uint32_t count;               // Número de membros
+    ArchiveEntry* entries;        // Membros na ordem em que foram gravados
+} ArchiveDirectory;
+
+// Estatísticas da criação de um arquivo
+typedef struct ArchiveStats {
+    uint64_t members;             // Membros gravados
+    uint64_t duplicate_members;   // Membros idênticos a um anterior (dados compartilhados)
+    uint64_t blocks;              // Blocos comprimidos
+    uint64_t dedup_blocks;        // Blocos gravados como referência
+    uint64_t input_bytes;         // Bytes originais
+    uint64_t output_bytes;        // Bytes do arquivo
+} ArchiveStats;
+
+// Funções para identificação do formato
+int isArchiveFile(const char* filename);
+
+// Funções para criação e leitura do diretório
+int createArchive(const char* archive_path, const char** members, int count,
+                  int threads, const MemoryPlan* plan, int dedup, ArchiveStats* stats,
+                  ProgressTracker* progress);
+int readArchiveDirectory(const char* archive_path, ArchiveDirectory* directory);
+void freeArchiveDirectory(ArchiveDirectory* directory);
+void printArchiveDirectory(const ArchiveDirectory* directory);
+void printArchiveStats(const ArchiveStats* stats);
+
+// Funções para extração
+int extractArchive(const char* archive_path, const char** members, int count,
+                   const char* output_dir, int threads, const MemoryPlan* plan,
+                   ProgressTracker* progress);
+
+#endif // ARCHIVE_H
@@ -0,0 +1,122 @@
+#ifndef ASYNC_CODEC_H
+#define ASYNC_CODEC_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <pthread.h>
+#include "memory_budget.h"
+#include "block_format.h"
+
+// Constantes da API assíncrona
+#define ASYNC_DEFAULT_WORKERS 4              // Threads de trabalho padrão
+#define ASYNC_MAX_WORKERS 64                 // Máximo de threads de trabalho
+#define ASYNC_DEFAULT_QUEUE_DEPTH 64         // Trabalhos aguardando uma thread livre
+#define ASYNC_MAX_QUEUE_DEPTH 65536          // Maior profundidade de fila aceita
+
+// Operação de um trabalho (sempre no formato em blocos)
+typedef enum AsyncOperation {
+    ASYNC_COMPRESS,
+    ASYNC_DECOMPRESS
+} AsyncOperation;
+
+// Situação de um trabalho
+typedef enum AsyncStatus {
+    ASYNC_PENDING,        // Na fila, aguardando uma thread
+    ASYNC_RUNNING,        // Em execução
+    ASYNC_DONE,           // Concluído com sucesso
+    ASYNC_FAILED,         // Concluído com erro (entrada inválida, E/S ou memória)
+    ASYNC_CANCELLED       // Cancelado antes de terminar (a saída é descartada ou parcial)
+} AsyncStatus;
+
+struct AsyncJob;
+
+// Função chamada na thread de trabalho quando um trabalho termina; a partir
+// daí o trabalho pertence a quem o recebe (liberar com freeAsyncJob)
+typedef void (*AsyncCallback)(struct AsyncJob* job, void* context);
+
+// Trabalho de compressão ou descompressão
+// A entrada é um buffer (input) ou um descritor (input_fd >= 0); a saída vai
+// para output_fd quando >= 0 e, senão, para um buffer alocado (output), que
+// com um plano sob limite não passa de plan.limit bytes.
+// Os descritores e o buffer de entrada pertencem a quem submeteu o trabalho
+// e precisam continuar válidos até a conclusão.
+typedef struct AsyncJob {
+    uint64_t id;                  // Número atribuído na submissão
+    AsyncOperation operation;
+    int level;                    // Nível de compressão (0 = COMPRESSION_LEVEL_DEFAULT)
+    const unsigned char* input;   // Dados de entrada (modo buffer)
+    size_t input_size;            // Bytes em input
+    int input_fd;                 // Descritor de entrada (-1 = modo buffer)
+    int output_fd;                // Descritor de saída (-1 = buffer em output)
+    AsyncCallback callback;       // Notificação da conclusão (NULL = fila de conclusões)
+    void* context;                // Repassado ao callback
+    int status;                   // AsyncStatus (atômico)
+    int cancel;                   // 1 quando o cancelamento foi pedido (atômico)
+    unsigned char* output;        // Resultado no modo buffer (liberado com o trabalho)
+    size_t output_size;           // Bytes em output
+    BlockStats stats;             // Estatísticas da operação
+    uint64_t latency_us;          // Tempo de execução na thread de trabalho
+    struct AsyncJob* next;        // Encadeamento nas filas do conjunto
+} AsyncJob;
+
+// Contadores de um conjunto de threads assíncrono
+typedef struct AsyncPoolStats {
+    uint64_t submitted;           // Trabalhos aceitos
+    uint64_t rejected;            // Submissões recusadas por fila cheia
+    uint64_t completed;           // Trabalhos concluídos com sucesso
+    uint64_t failed;              // Trabalhos concluídos com erro
+    uint64_t cancelled;           // Trabalhos cancelados
+    size_t max_queued;            // Maior ocupação da fila de entrada
+} AsyncPoolStats;
+
+struct AsyncPool;
+
+// Estado de cada thread de trabalho (mantido entre trabalhos)
+typedef struct AsyncWorker {
+    pthread_t thread;
+    struct AsyncPool* pool;
+    BlockWorkspace workspace;     // Buffers de bloco e tabelas aquecidos
+    AsyncJob* current;            // Trabalho em execução (ou NULL)
+} AsyncWorker;
+
+// Conjunto de threads que executa os trabalhos submetidos
+// A fila de entrada tem profundidade limitada: com ela cheia a submissão
+// é recusada e o chamador tenta de novo depois de uma conclusão. Trabalhos
+// sem callback vão para a fila de conclusões, sinalizada por notify_fd.
+typedef struct AsyncPool {
+    AsyncWorker slots[ASYNC_MAX_WORKERS];
+    int workers;                  // Threads iniciadas
+    MemoryPlan plan;
+    pthread_mutex_t mutex;
+    pthread_cond_t job_ready;     // Trabalho na fila de entrada ou parada
+    pthread_cond_t job_done;      // Trabalho concluído (fila de conclusões ou callback)
+    AsyncJob* pending_head;       // Fila de entrada (FIFO)
+    AsyncJob* pending_tail;
+    size_t pending_count;
+    size_t queue_depth;           // Limite de pending_count
+    AsyncJob* done_head;          // Fila de conclusões (FIFO)
+    AsyncJob* done_tail;
+    size_t running;               // Trabalhos em execução
+    uint64_t next_id;
+    int stopping;                 // 1 durante destroyAsyncPool
+    int notify_fd;                // Legível enquanto há conclusões (eventfd ou pipe)
+    int notify_write_fd;          // Lado de escrita da notificação (o mesmo fd com eventfd)
+    AsyncPoolStats stats;
+} AsyncPool;
+
+// Funções para o conjunto de threads
+AsyncPool* createAsyncPool(int workers, size_t queue_depth, const MemoryPlan* plan);
+void destroyAsyncPool(AsyncPool* pool);
+int asyncCompletionFd(const AsyncPool* pool);
+void getAsyncPoolStats(AsyncPool* pool, AsyncPoolStats* stats);
+
+// Funções para trabalhos
+AsyncJob* createAsyncBufferJob(AsyncOperation operation, const unsigned char* input, size_t input_size);
+AsyncJob* createAsyncFdJob(AsyncOperation operation, int input_fd, int output_fd);
+void freeAsyncJob(AsyncJob* job);
+int submitAsyncJob(AsyncPool* pool, AsyncJob* job);
+int cancelAsyncJob(AsyncPool* pool, AsyncJob* job);
+AsyncJob* nextAsyncCompletion(AsyncPool* pool, int wait);
+
+#endif // ASYNC_CODEC_H
@@ -0,0 +1,189 @@
+#ifndef BLOCK_FORMAT_H
+#define BLOCK_FORMAT_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include "data_structures.h"
+#include "file_io.h"
+#include "memory_budget.h"
+#include "decode_table.h"
+#include "hash.h"
+#include "table_cache.h"
+#include "progress.h"
+#include "transform.h"
+#include "spsc_ring.h"
+#include "wide_symbol.h"
+
+// Constantes do formato em blocos
+#define BLOCK_MAGIC "HUFB"
+#define BLOCK_MAGIC_SIZE 4
+#define BLOCK_FORMAT_VERSION 3         // Versão mais recente (lida por este decodificador)
+#define BLOCK_FORMAT_VERSION_TRANSFORM 2 // Versão gravada com transformações e sem blocos de 16 bits
+#define BLOCK_FORMAT_VERSION_PLAIN 1   // Versão gravada quando não há blocos transformados
+
+// Flags do cabeçalho
+#define BLOCK_FLAG_DEDUP 0x01     // O contêiner pode ter referências a blocos anteriores
+#define BLOCK_GEAR_SEED 0x48554642ULL   // Semente da tabela do hash rolante ("HUFB")
+
+// Índice de blocos gravado após o marcador de fim: assinatura e um hash por bloco
+#define BLOCK_INDEX_MAGIC "HUFI"
+
+// Níveis de compressão (-1 a -9): velocidade contra tamanho da saída
+#define COMPRESSION_LEVEL_MIN 1
+#define COMPRESSION_LEVEL_MAX 9
+#define COMPRESSION_LEVEL_DEFAULT 6          // Nível usado pelo formato em blocos sem nível explícito
+#define LEVEL_SAMPLE_STRIDE (4 * 1024)       // Trecho contado (ou pulado) pelo histograma amostrado
+#define LEVEL_REUSE_SLACK 32                 // Repete a árvore anterior se custar até 1/32 a mais
+
+// Pipeline em estágios (leitura, análise, codificação e gravação em threads separadas)
+#define PIPELINE_QUEUE_DEPTH 2         // Blocos em cada fila entre dois estágios
+#define PIPELINE_SLOTS 8               // Blocos em trânsito (filas cheias e um por estágio)
+#define PIPELINE_MAX_QUEUES 3          // Filas da compressão (a descompressão usa 2)
+
+// Tipos de bloco
+typedef enum BlockType {
+    BLOCK_END = 0,        // Fim do contêiner (seguido do total de bytes originais)
+    BLOCK_HUFFMAN = 1,    // Árvore serializada + fluxo de bits
+    BLOCK_STORED = 2,     // Bytes originais sem codificação
+    BLOCK_DUP = 3,        // Cópia de um bloco anterior (payload: índice do bloco, 64 bits)
+    BLOCK_TRANSFORMED = 4, // Transformação (1 byte) + bytes transformados (32 bits) + árvore + fluxo de bits
+    BLOCK_WIDE = 5        // Símbolos de 16 bits: comprimentos esparsos + byte final ímpar + fluxo de bits
+} BlockType;
+
+// Estatísticas de uma compressão ou descompressão em blocos
+typedef struct BlockStats {
+    uint64_t blocks;          // Blocos processados
+    uint64_t stored_blocks;   // Blocos gravados sem codificação
+    uint64_t input_bytes;     // Bytes originais
+    uint64_t output_bytes;    // Bytes do contêiner (cabeçalhos incluídos)
+    uint64_t dedup_blocks;    // Blocos gravados como referência a um bloco anterior
+    uint64_t dedup_bytes;     // Bytes originais cobertos por essas referências
+    uint64_t reused_blocks;   // Blocos copiados sem recodificar de um contêiner anterior
+    uint64_t reused_bytes;    // Bytes originais desses blocos
+    uint64_t transformed_blocks; // Blocos codificados após uma transformação
+    uint64_t wide_blocks;     // Blocos codificados com o alfabeto de 16 bits
+    int pipeline_stages;      // Estágios do pipeline (0 = laço em série)
+    SpscRingStats queues[PIPELINE_MAX_QUEUES]; // Ocupação das filas entre estágios, em ordem
+} BlockStats;
+
+// Tamanhos previstos para uma entrada, sem codificar nem gravar
+typedef struct SizeEstimate {
+    uint64_t input_bytes;         // Bytes originais
+    uint64_t single_stream_bytes; // Formato de fluxo único (cabeçalho, árvore e fluxo de bits)
+    uint64_t block_bytes;         // Formato em blocos, nível padrão (cabeçalho, blocos e índice)
+    uint64_t blocks;              // Blocos do contêiner
+    uint64_t stored_blocks;       // Blocos que seriam gravados sem codificação
+} SizeEstimate;
+
+// Estratégia concreta de um nível de compressão
+typedef struct LevelStrategy {
+    int level;                // Nível (1 = mais rápido, 9 = menor saída)
+    int block_shift;          // Multiplica o bloco do plano por 2^block_shift (só sem limite de memória)
+    int sample_shift;         // Conta 1 de cada 2^sample_shift trechos do bloco (0 = histograma exato)
+    int reuse_tables;         // 1 para repetir a árvore do bloco anterior quando o custo é parecido
+    int max_code_length;      // Limite de comprimento dos códigos (0 = sem limite)
+    int evaluate_cost;        // 1 para escolher entre árvore e bloco sem codificação antes de codificar
+    size_t split_unit;        // Granularidade da busca da melhor divisão em blocos (0 = sem busca)
+} LevelStrategy;
+
+// Posição de um bloco já decodificado (para resolver referências)
+typedef struct BlockRecord {
+    uint64_t container_offset;    // Início do bloco de origem, relativo ao cabeçalho do contêiner
+    int64_t output_offset;        // Onde os bytes do bloco foram gravados (-1 = saída sem posição)
+    uint32_t raw_size;            // Bytes originais do bloco
+} BlockRecord;
+
+// Bloco indexado para deduplicação: confirma o que a chave do índice encontrou
+typedef struct BlockDigest {
+    uint64_t check;               // Segunda metade do hash de 128 bits (a primeira é a chave do índice)
+    uint64_t block;               // Índice do bloco no contêiner
+    uint32_t length;              // Bytes originais do bloco
+} BlockDigest;
+
+// Blocos de um contêiner anterior, para recomprimir apenas o que mudou
+typedef struct BlockIndex {
+    FILE* file;                   // Contêiner anterior (aberto para leitura)
+    uint32_t block_size;          // Tamanho máximo de bloco do contêiner
+    int flags;                    // Flags do cabeçalho (cortes por conteúdo se BLOCK_FLAG_DEDUP)
+    uint64_t count;               // Blocos do contêiner
+    HashIndex blocks;             // Hash do bloco -> offset do bloco codificado no arquivo
+} BlockIndex;
+
+// Buffers e tabelas reaproveitados entre chamadas (um por thread)
+typedef struct BlockWorkspace {
+    unsigned char* block;                 // Bloco de entrada (ou decodificado)
+    unsigned char* encoded;               // Fluxo de bits do bloco
+    size_t capacity;                      // Capacidade dos dois buffers
+    CachedTables* cached_tables;          // Tabelas do último bloco (referência ao cache compartilhado)
+    uint64_t table_hits;                  // Blocos que reaproveitaram a tabela
+    uint64_t table_misses;                // Blocos que construíram uma tabela nova
+    uint64_t tree_penalty;                // Excesso da árvore repetida sobre a ótima no próprio bloco (1/1024)
+    int level;                            // Nível de compressão (0 = COMPRESSION_LEVEL_DEFAULT)
+    int transforms;                       // Transformações permitidas antes da codificação (máscara, 0 = nenhuma)
+    unsigned char* transformed;           // Bloco transformado (alocado no primeiro uso, mesma capacidade)
+    int dedup;                            // 1 para gravar blocos repetidos como referência
+    HashIndex dedup_index;                // Hash do bloco -> posição em digests do primeiro bloco igual
+    BlockDigest* digests;                 // Blocos indexados para deduplicação
+    size_t digest_count;                  // Blocos em digests
+    size_t digest_capacity;               // Capacidade de digests
+    uint64_t record_limit;                // Blocos referenciáveis (dedupRecordLimit; 0 = todos)
+    uint64_t gear[MAX_CHAR];              // Tabela do hash rolante para cortes por conteúdo
+    int readable_output;                  // 1 se a saída da descompressão aceita leitura
+    BlockRecord* records;                 // Blocos lidos do contêiner atual (só os record_limit primeiros)
+    size_t record_capacity;               // Capacidade de records
+    uint64_t* hashes;                     // Hash de cada bloco gravado (índice no fim do contêiner)
+    size_t hash_capacity;                 // Capacidade de hashes
+    int hashes_failed;                    // 1 se o índice não coube no limite de memória
+    BlockIndex* base;                     // Contêiner anterior cujos blocos podem ser copiados (ou NULL)
+    ProgressTracker* progress;            // Progresso a atualizar por bloco (ou NULL; pode ser compartilhado)
+    int pipeline;                         // 1 para ler, codificar e gravar em threads separadas
+    int wide;                             // 1 para testar o alfabeto de 16 bits em cada bloco
+    uint32_t* wide_frequencies;           // Histograma de 16 bits (alocado no primeiro uso)
+    unsigned char* wide_lengths;          // Comprimentos dos códigos de 16 bits do bloco (idem)
+    const int* cancel;                    // Pedido de cancelamento lido entre blocos (atômico; NULL = nenhum)
+} BlockWorkspace;
+
+// Funções para identificação do formato
+int isBlockContainer(FILE* input);
+int isBlockContainerFile(const char* filename);
+
+// Funções para compressão e descompressão em blocos
+int compressStreamBlocks(FILE* input, FILE* output, const MemoryPlan* plan, BlockStats* stats);
+int decompressStreamBlocks(FILE* input, FILE* output, const MemoryPlan* plan, BlockStats* stats);
+int compressFileBlocks(const char* input_filename, const char* output_filename,
+                       const MemoryPlan* plan, BlockStats* stats);
+int decompressFileBlocks(const char* input_filename, const char* output_filename,
+                         const MemoryPlan* plan, BlockStats* stats);
+void printBlockStats(const BlockStats* stats);
+
+// Funções para estimativa de tamanho
+int estimateStreamSize(FILE* input, const MemoryPlan* plan, SizeEstimate* estimate);
+int estimateFileSize(const char* filename, const MemoryPlan* plan, SizeEstimate* estimate);
+
+// Funções para níveis de compressão
+int getLevelStrategy(int level, LevelStrategy* strategy);
+
+// Funções para recompressão incremental
+int openBlockIndex(const char* filename, BlockIndex* index);
+void closeBlockIndex(BlockIndex* index);
+
+// Funções para leitura de um bloco por vez
+int readContainerHeader(FILE* input, int* version, uint32_t* block_size, int* flags);
+int decodeNextBlock(FILE* input, FILE* output, off_t container_start, uint32_t block_size, int flags,
+                    BlockWorkspace* workspace, BlockStats* stats, uint32_t* raw_size);
+
+// Funções para reaproveitar buffers e tabelas entre chamadas
+void initBlockWorkspace(BlockWorkspace* workspace);
+int reserveBlockWorkspace(BlockWorkspace* workspace, size_t block_size);
+void freeBlockWorkspace(BlockWorkspace* workspace);
+int compressStreamBlocksWith(FILE* input, FILE* output, const MemoryPlan* plan,
+                             BlockStats* stats, BlockWorkspace* workspace);
+int decompressStreamBlocksWith(FILE* input, FILE* output, const MemoryPlan* plan,
+                               BlockStats* stats, BlockWorkspace* workspace);
+int compressFileBlocksWith(const char* input_filename, const char* output_filename,
+                           const MemoryPlan* plan, BlockStats* stats, BlockWorkspace* workspace);
+int decompressFileBlocksWith(const char* input_filename, const char* output_filename,
+                             const MemoryPlan* plan, BlockStats* stats, BlockWorkspace* workspace);
+
+#endif // BLOCK_FORMAT_H
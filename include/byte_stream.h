@@ -0,0 +1,89 @@
+#ifndef BYTE_STREAM_H
+#define BYTE_STREAM_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+// Constantes dos transportes
+#define STREAM_BUFFER_SIZE (64 * 1024)   // Janela de peek/reserve dos transportes sem memória própria
+#define STREAM_MEMORY_INITIAL_SIZE 4096  // Capacidade inicial de um destino em memória
+
+typedef struct ByteSource ByteSource;
+typedef struct ByteSink ByteSink;
+
+// Operações de um transporte de leitura
+// Transportes em memória (buffer, mmap) expõem todos os dados na janela e não têm read.
+typedef struct ByteSourceOps {
+    size_t (*read)(ByteSource* source, unsigned char* data, size_t length); // Até length bytes (0 = fim ou erro)
+    int (*rewind)(ByteSource* source);          // Volta ao início (-1 se o transporte não permite)
+    int64_t (*remaining)(ByteSource* source);   // Bytes ainda não lidos pelo transporte (-1 se desconhecido)
+    void (*close)(ByteSource* source);          // Libera os recursos do transporte
+} ByteSourceOps;
+
+// Origem de bytes: janela [data + position, data + length) seguida do transporte
+struct ByteSource {
+    const ByteSourceOps* ops;
+    const unsigned char* data;   // Janela: memória do transporte ou buffer de peek
+    size_t length;               // Bytes válidos na janela
+    size_t position;             // Próximo byte da janela
+    unsigned char* buffer;       // Buffer de peek (NULL até o primeiro peek)
+    FILE* file;                  // Transporte FILE* (não é fechado)
+    int fd;                      // Transporte descritor (não é fechado)
+    off_t start;                 // Posição inicial do transporte (para rewind)
+    size_t mapped;               // Bytes mapeados por mmap (0 = nenhum)
+    int error;                   // 1 se houve erro de leitura
+};
+
+// Operações de um transporte de escrita
+// Transportes em memória crescem com grow e mantêm os dados na própria janela.
+typedef struct ByteSinkOps {
+    size_t (*write)(ByteSink* sink, const unsigned char* data, size_t length); // Bytes gravados
+    int (*grow)(ByteSink* sink, size_t length);   // Garante length bytes livres na janela (só memória)
+    int (*flush)(ByteSink* sink);                 // Entrega os dados ao destino
+    void (*close)(ByteSink* sink);                // Libera os recursos do transporte
+} ByteSinkOps;
+
+// Destino de bytes: janela [data, data + capacity) com position bytes ocupados
+struct ByteSink {
+    const ByteSinkOps* ops;
+    unsigned char* data;         // Memória de destino, ou buffer de reserve dos demais transportes
+    size_t position;             // Bytes na janela (memória: total gravado; demais: pendentes)
+    size_t capacity;             // Capacidade da janela
+    FILE* file;                  // Transporte FILE* (não é fechado)
+    int fd;                      // Transporte descritor (não é fechado)
+    uint64_t written;            // Total de bytes aceitos
+    int error;                   // 1 se houve erro de escrita
+};
+
+// Funções para criação das origens
+void initFileSource(ByteSource* source, FILE* file);
+void initFdSource(ByteSource* source, int fd);
+void initMemorySource(ByteSource* source, const void* data, size_t length);
+int openMappedSource(ByteSource* source, const char* filename);
+void closeSource(ByteSource* source);
+
+// Funções para leitura
+size_t sourceRead(ByteSource* source, void* data, size_t length);
+int sourceGetc(ByteSource* source);
+const unsigned char* sourcePeek(ByteSource* source, size_t wanted, size_t* available);
+void sourceSkip(ByteSource* source, size_t length);
+int sourceRewind(ByteSource* source);
+int64_t sourceRemaining(ByteSource* source);
+
+// Funções para criação dos destinos
+void initFileSink(ByteSink* sink, FILE* file);
+void initFdSink(ByteSink* sink, int fd);
+void initMemorySink(ByteSink* sink);
+void closeSink(ByteSink* sink);
+
+// Funções para escrita
+size_t sinkWrite(ByteSink* sink, const void* data, size_t length);
+int sinkPutc(ByteSink* sink, int byte);
+unsigned char* sinkReserve(ByteSink* sink, size_t wanted, size_t* available);
+void sinkCommit(ByteSink* sink, size_t length);
+int sinkFlush(ByteSink* sink);
+int sinkPreallocate(ByteSink* sink, uint64_t length);
+
+#endif // BYTE_STREAM_H
@@ -0,0 +1,40 @@
+#ifndef CODE_TABLE_H
+#define CODE_TABLE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include "data_structures.h"
+#include "file_io.h"
+
+// Constantes para as tabelas de códigos inteiros
+#define MAX_INTEGER_CODE_LENGTH 32     // Maior código suportado pela tabela inteira
+#define PAIR_TABLE_SIZE 65536          // Uma entrada para cada par de bytes
+#define PAIR_CODE_MAX_BITS 27          // Orçamento de bits de um par (cabe em uma palavra de 32 bits)
+#define PAIR_LENGTH_BITS 5             // Bits reservados para o comprimento na entrada do par
+#define PAIR_TABLE_MIN_INPUT (256 * 1024) // Entrada mínima para compensar a construção (ver make bench)
+
+// Tabela de códigos de Huffman em forma inteira (um código por byte)
+typedef struct CodeTable {
+    uint32_t code[MAX_CHAR];          // Bits do código, alinhados à direita
+    unsigned char length[MAX_CHAR];   // Comprimento do código em bits
+    int max_length;                   // Maior comprimento presente na tabela
+} CodeTable;
+
+// Tabela de códigos concatenados para pares de bytes
+// Cada entrada guarda (código << PAIR_LENGTH_BITS) | comprimento;
+// comprimento 0 indica que o par excede o orçamento e usa a tabela simples
+typedef struct PairCodeTable {
+    uint32_t entry[PAIR_TABLE_SIZE];
+} PairCodeTable;
+
+// Funções para construção das tabelas
+int buildCodeTable(char codes[MAX_CHAR][MAX_TREE_HT], CodeTable* table);
+PairCodeTable* buildPairCodeTable(const CodeTable* table);
+void freePairCodeTable(PairCodeTable* pairs);
+
+// Funções para codificação com as tabelas
+void encodeSymbols(BitWriter* writer, const unsigned char* data, size_t length,
+                   const CodeTable* table, const PairCodeTable* pairs);
+
+#endif // CODE_TABLE_H
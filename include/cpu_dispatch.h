@@ -0,0 +1,32 @@
+#ifndef CPU_DISPATCH_H
+#define CPU_DISPATCH_H
+
+// Variantes dos kernels (contagem de frequências, empacotamento e decodificação)
+typedef enum CpuVariant {
+    CPU_GENERIC = 0,      // x86-64 básico (ou qualquer outra arquitetura)
+    CPU_BMI2 = 1,         // shlx/shrx/bzhi para extração de bits
+    CPU_AVX2 = 2,         // AVX2 + BMI2
+    CPU_VARIANT_COUNT
+} CpuVariant;
+
+// Atributos para compilar uma função para uma variante específica
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HAVE_CPU_DISPATCH 1
+#define TARGET_BMI2 __attribute__((target("bmi,bmi2")))
+#define TARGET_AVX2 __attribute__((target("avx2,bmi,bmi2")))
+#else
+#define HAVE_CPU_DISPATCH 0
+#endif
+
+// Corpo de kernel que é expandido dentro de cada variante
+#define KERNEL_INLINE static inline __attribute__((always_inline))
+
+// Funções para detecção e seleção da variante
+CpuVariant detectCpuVariant(void);
+CpuVariant activeCpuVariant(void);
+int isCpuVariantSupported(CpuVariant variant);
+int setCpuVariant(CpuVariant variant);
+int parseCpuVariant(const char* name, CpuVariant* variant);
+const char* cpuVariantName(CpuVariant variant);
+
+#endif // CPU_DISPATCH_H
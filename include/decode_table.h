@@ -0,0 +1,48 @@
+#ifndef DECODE_TABLE_H
+#define DECODE_TABLE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include "data_structures.h"
+#include "file_io.h"
+
+// Constantes para as tabelas de decodificação
+#define DECODE_TABLE_BITS 11                          // Janela K de bits por consulta
+#define DECODE_TABLE_SIZE (1 << DECODE_TABLE_BITS)
+#define MULTI_SYMBOL_MAX 4                            // Máximo de símbolos por entrada
+#define MULTI_SYMBOL_MAX_AVG_BITS (DECODE_TABLE_BITS / 2.0) // Limiar do modo automático
+
+// Modo de preenchimento da tabela
+typedef enum DecodeMode {
+    DECODE_MODE_AUTO,      // Escolhe pelo comprimento médio dos códigos
+    DECODE_MODE_SINGLE,    // Um símbolo por consulta
+    DECODE_MODE_MULTI      // Tantos símbolos completos quanto cabem na janela
+} DecodeMode;
+
+// Entrada da tabela: símbolos completos contidos na janela de K bits
+typedef struct DecodeEntry {
+    unsigned char symbols[MULTI_SYMBOL_MAX]; // Símbolos decodificados, em ordem
+    unsigned char count;                     // Número de símbolos (0 = código maior que K)
+    unsigned char bits;                      // Total de bits consumidos pelos símbolos
+    unsigned char first_bits;                // Bits consumidos apenas pelo primeiro símbolo
+    unsigned char reserved;                  // Alinhamento da entrada em 8 bytes
+} DecodeEntry;
+
+// Tabela de decodificação indexada pelos próximos K bits do fluxo
+typedef struct DecodeTable {
+    DecodeMode mode;                         // Modo efetivamente usado
+    double average_length;                   // Comprimento médio implícito dos códigos
+    HuffmanNode* root;                       // Árvore para códigos maiores que K
+    DecodeEntry entries[DECODE_TABLE_SIZE];
+} DecodeTable;
+
+// Funções para construção das tabelas
+DecodeTable* buildDecodeTable(HuffmanNode* root, DecodeMode mode);
+double averageCodeLength(HuffmanNode* root);
+void freeDecodeTable(DecodeTable* table);
+
+// Funções para decodificação com as tabelas
+uint64_t decodeSymbols(BitReader* reader, const DecodeTable* table, unsigned char* output, uint64_t max_symbols);
+
+#endif // DECODE_TABLE_H
@@ -3,11 +3,23 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include "data_structures.h"
+#include "byte_stream.h"
 
 // Constantes para operações de arquivo
 #define BUFFER_SIZE 4096
 #define MAX_FILENAME 256
+#define HISTOGRAM_BUFFER_SIZE (64 * 1024)
+#define PARALLEL_HISTOGRAM_MIN_RANGE (16LL * 1024 * 1024)  // Menor trecho por thread na contagem paralela
+#define PARALLEL_HISTOGRAM_MAX_THREADS 64
+#define PARALLEL_HISTOGRAM_READ_SIZE (1024 * 1024)         // Leitura de cada thread (pread)
+
+// Cabeçalho do formato de fluxo único
+#define STREAM_MAGIC "HUFS"
+#define STREAM_MAGIC_SIZE 4
+#define STREAM_FORMAT_VERSION 1
+#define STREAM_HEADER_SIZE (STREAM_MAGIC_SIZE + 1 + 8)    // Assinatura, versão e tamanho original
 
 // Estrutura para buffer de bits
 typedef struct BitBuffer {
@@ -15,28 +27,68 @@ typedef struct BitBuffer {
     int bit_count;           // Número de bits no buffer
 } BitBuffer;
 
+// Estrutura para escrita de bits em bloco (acumulador de 64 bits)
+typedef struct BitWriter {
+    uint64_t accumulator;     // Bits pendentes, alinhados à direita
+    int bit_count;            // Número de bits pendentes no acumulador
+    unsigned char* buffer;    // Buffer de bytes de saída
+    size_t position;          // Próxima posição livre no buffer
+    size_t capacity;          // Capacidade do buffer
+    ByteSink* output;         // Destino (NULL = somente memória)
+    int overflow;             // 1 se o buffer de memória não comportou a saída
+} BitWriter;
+
+// Estrutura para leitura de bits em bloco (acumulador de 64 bits)
+typedef struct BitReader {
+    uint64_t accumulator;        // Bits disponíveis, alinhados à esquerda
+    int bit_count;               // Número de bits válidos no acumulador
+    const unsigned char* data;   // Bytes de entrada ainda não consumidos
+    size_t position;             // Próximo byte a ser carregado
+    size_t length;               // Número de bytes válidos em data
+    unsigned char* storage;      // Buffer de leitura do arquivo (NULL = memória)
+    size_t capacity;             // Capacidade do buffer de leitura
+    ByteSource* input;           // Origem (NULL = somente memória)
+} BitReader;
+
 // Funções para cálculo de frequências
 unsigned long* calculateFrequencies(const char* filename);
+void countFrequencies(const unsigned char* data, size_t length, unsigned long* frequencies);
+int countFileFrequencies(int fd, int64_t size, int threads, unsigned long* frequencies);
 int countUniqueCharacters(unsigned long* frequencies);
 
 // Funções para escrita de arquivos comprimidos
-void writeCompressedHeader(FILE* output, HuffmanNode* root);
-void writeCompressedData(FILE* input, FILE* output, char codes[MAX_CHAR][MAX_TREE_HT]);
-void writeBit(BitBuffer* bit_buffer, int bit, FILE* output);
-void flushBitBuffer(BitBuffer* bit_buffer, FILE* output);
+void writeCompressedHeader(ByteSink* output, HuffmanNode* root, uint64_t original_size);
+void writeCompressedData(ByteSource* input, ByteSink* output, char codes[MAX_CHAR][MAX_TREE_HT]);
+void writeBit(BitBuffer* bit_buffer, int bit, ByteSink* output);
+void flushBitBuffer(BitBuffer* bit_buffer, ByteSink* output);
+
+// Funções para escrita de bits em bloco
+void initBitWriter(BitWriter* writer, unsigned char* buffer, size_t capacity, ByteSink* output);
+int drainBitWriter(BitWriter* writer);
+int flushBitWriter(BitWriter* writer);
 
 // Funções para leitura de arquivos comprimidos
-HuffmanNode* readCompressedHeader(FILE* input);
-void readCompressedData(FILE* input, FILE* output, HuffmanNode* root);
-int readBit(BitBuffer* bit_buffer, FILE* input);
+int readCompressedHeader(ByteSource* input, HuffmanNode** root, int64_t* original_size);
+int readCompressedData(ByteSource* input, ByteSink* output, HuffmanNode* root, int64_t original_size);
+int readBit(BitBuffer* bit_buffer, ByteSource* input);
+
+// Funções para leitura de bits em bloco
+void initBitReader(BitReader* reader, unsigned char* storage, size_t capacity, ByteSource* input);
+void initBitReaderFromMemory(BitReader* reader, const unsigned char* data, size_t length);
+void refillBitReader(BitReader* reader);
 
 // Funções auxiliares para manipulação de arquivos
 void initBitBuffer(BitBuffer* bit_buffer);
 int fileExists(const char* filename);
-long getFileSize(const char* filename);
+int64_t getFileSize(const char* filename);
+int writeUint32(FILE* file, uint32_t value);
+int readUint32(FILE* file, uint32_t* value);
+int writeUint64(FILE* file, uint64_t value);
+int readUint64(FILE* file, uint64_t* value);
 
 // Funções para serialização e desserialização da árvore
-void serializeTree(FILE* file, HuffmanNode* root);
-HuffmanNode* deserializeTree(FILE* file);
+void serializeTree(ByteSink* output, HuffmanNode* root);
+HuffmanNode* deserializeTree(ByteSource* input);
+size_t serializedTreeSize(HuffmanNode* root);
 
 #endif // FILE_IO_H
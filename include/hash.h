@@ -0,0 +1,31 @@
+#ifndef HASH_H
+#define HASH_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+// Constantes do índice de hashes
+#define HASH_INDEX_INITIAL_CAPACITY 1024      // Potência de 2
+#define HASH_INDEX_EMPTY UINT64_MAX           // Valor reservado para posições livres
+
+// Índice de endereçamento aberto: hash de 64 bits -> valor de 64 bits
+typedef struct HashIndex {
+    uint64_t* keys;           // Hashes armazenados
+    uint64_t* values;         // Valores (HASH_INDEX_EMPTY = posição livre)
+    size_t capacity;          // Número de posições (potência de 2)
+    size_t count;             // Posições ocupadas
+} HashIndex;
+
+// Funções para cálculo de hashes
+uint64_t hash64(const void* data, size_t length, uint64_t seed);
+void hash128(const void* data, size_t length, uint64_t seed, uint64_t digest[2]);
+
+// Funções para o índice de hashes
+void initHashIndex(HashIndex* index);
+int findHashIndex(const HashIndex* index, uint64_t key, uint64_t* value);
+int insertHashIndex(HashIndex* index, uint64_t key, uint64_t value);
+void clearHashIndex(HashIndex* index);
+void freeHashIndex(HashIndex* index);
+
+#endif // HASH_H
@@ -0,0 +1,57 @@
+#ifndef HUF_READER_H
+#define HUF_READER_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include "data_structures.h"
+#include "file_io.h"
+#include "byte_stream.h"
+#include "decode_table.h"
+#include "table_cache.h"
+#include "block_format.h"
+
+// Constantes do leitor sob demanda
+#define HUF_READER_BUFFER_SIZE (64 * 1024)   // Buffer de bits do formato de fluxo único
+
+// Formato do arquivo aberto pelo leitor
+typedef enum HufReaderFormat {
+    HUF_FORMAT_BLOCKS,        // Contêiner em blocos: um bloco decodificado por vez
+    HUF_FORMAT_STREAM         // Fluxo único: símbolos decodificados direto no buffer do chamador
+} HufReaderFormat;
+
+// Leitor que descomprime sob demanda, a cada hufRead
+// Só o estado do bloco atual (ou o acumulador de bits do fluxo único) fica
+// em memória; nada é gravado em arquivo intermediário.
+typedef struct HufReader {
+    FILE* file;                   // Arquivo comprimido
+    int owns_file;                // 1 se hufClose deve fechar file
+    HufReaderFormat format;
+    int finished;                 // 1 depois do fim dos dados
+    int failed;                   // 1 depois de um erro (as leituras seguintes falham)
+    uint64_t delivered;           // Bytes entregues ao chamador
+    // Contêiner em blocos
+    BlockWorkspace workspace;     // Bloco atual e tabelas
+    BlockStats stats;             // Blocos lidos até agora
+    off_t container_start;        // Posição do cabeçalho do contêiner
+    uint32_t block_size;          // Tamanho máximo de bloco do contêiner
+    int flags;                    // Flags do cabeçalho do contêiner
+    size_t block_length;          // Bytes decodificados do bloco atual
+    size_t block_position;        // Bytes do bloco atual já entregues
+    // Fluxo único
+    ByteSource source;            // Origem do cabeçalho e do fluxo de bits
+    BitReader bits;               // Posição atual no fluxo de bits
+    unsigned char* storage;       // Buffer de leitura de bits
+    HuffmanNode* root;            // Árvore do cabeçalho (NULL = entrada vazia)
+    CachedTables* tables;         // Tabela de decodificação (referência ao cache compartilhado)
+    int64_t original_size;        // Bytes originais (-1 = formato antigo sem tamanho)
+} HufReader;
+
+// Funções para o leitor sob demanda
+HufReader* hufOpen(const char* filename);
+HufReader* hufOpenStream(FILE* file);
+ssize_t hufRead(HufReader* reader, void* buffer, size_t size);
+void hufClose(HufReader* reader);
+
+#endif // HUF_READER_H
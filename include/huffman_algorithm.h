@@ -17,6 +17,12 @@ void generateHuffmanCodes(HuffmanNode* root, char* current_code, int depth, char
 // Funções para compressão e descompressão
 int compressFile(const char* input_filename, const char* output_filename);
 int decompressFile(const char* input_filename, const char* output_filename);
+int compressSource(ByteSource* input, ByteSink* output);
+int decompressSource(ByteSource* input, ByteSink* output);
+
+// Funções para estimativa de tamanho sem compressão
+uint64_t estimateCompressedSize(unsigned long* frequencies);
+uint64_t huffmanCostBits(const unsigned long* frequencies, int* leaves);
 
 // Funções auxiliares para análise de dados
 void printHuffmanCodes(char codes[MAX_CHAR][MAX_TREE_HT]);
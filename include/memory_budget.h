@@ -0,0 +1,58 @@
+#ifndef MEMORY_BUDGET_H
+#define MEMORY_BUDGET_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+// Constantes para o planejamento de memória
+#define MIN_BLOCK_SIZE (4 * 1024)                  // Menor bloco aceito pelo planejador
+#define MAX_BLOCK_SIZE (64 * 1024 * 1024)          // Maior bloco (tamanhos cabem em 32 bits)
+#define DEFAULT_BLOCK_SIZE (1024 * 1024)           // Bloco usado sem limite de memória
+#define FIXED_MEMORY_OVERHEAD (96 * 1024)          // Frequências, buffers de E/S e índices dos blocos
+
+// Buffers opcionais do espaço de trabalho que o plano precisa comportar
+#define PLAN_TRANSFORMS 0x1                        // Bloco transformado (um buffer a mais por bloco)
+#define PLAN_WIDE 0x2                              // Alfabeto de 16 bits (histograma e tabelas de 16 bits)
+#define PLAN_DEDUP 0x4                             // Registros dos blocos para referências entre blocos
+
+// Registros da deduplicação: uma fração fixa do limite, dividida em registros
+// de tamanho previsto (índice de hashes e hash de 128 bits na compressão,
+// posição do bloco na descompressão, com folga para o crescimento dos vetores)
+#define DEDUP_RECORD_SHARE 8                       // 1/8 do limite
+#define DEDUP_RECORD_SIZE 128                      // Bytes previstos por bloco registrado
+
+// Plano de uso de memória derivado do limite informado
+typedef struct MemoryPlan {
+    size_t limit;             // Limite total em bytes (0 = sem limite)
+    size_t block_size;        // Bytes de entrada por bloco
+    size_t io_buffer_size;    // Buffer de leitura/escrita de arquivo
+    int threads;              // Threads de trabalho
+    int in_flight_blocks;     // Blocos em memória ao mesmo tempo (por thread)
+    int use_pair_table;       // 1 se a tabela de pares cabe no orçamento
+    int features;             // Buffers opcionais reservados (PLAN_*)
+    size_t planned_peak;      // Pico de memória previsto pelo plano
+} MemoryPlan;
+
+// Funções para planejamento do orçamento
+int planMemoryBudget(size_t limit, MemoryPlan* plan);
+int planMemoryBudgetFor(size_t limit, int features, MemoryPlan* plan);
+size_t blockMemoryRequirement(size_t block_size, int blocks);
+size_t tableMemoryRequirement(int threads);
+size_t wideMemoryRequirement(size_t block_size);
+size_t workspaceMemoryRequirement(size_t block_size, int features);
+uint64_t dedupRecordLimit(size_t limit);
+void printMemoryPlan(const MemoryPlan* plan);
+
+// Funções para alocação contabilizada
+void setMemoryLimit(size_t limit);
+void* budgetMalloc(size_t size);
+void* budgetCalloc(size_t count, size_t size);
+void budgetFree(void* pointer);
+size_t currentMemoryUsage(void);
+size_t peakMemoryUsage(void);
+void resetPeakMemoryUsage(void);
+int budgetExceeded(void);
+void clearBudgetExceeded(void);
+
+#endif // MEMORY_BUDGET_H
@@ -0,0 +1,34 @@
+#ifndef MEMORY_OUTPUT_H
+#define MEMORY_OUTPUT_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+// Constantes da saída em memória
+#define MEMORY_OUTPUT_CHUNK (64 * 1024)    // Bytes de dados em cada pedaço
+
+// Pedaço da saída em memória
+typedef struct MemoryOutputChunk {
+    struct MemoryOutputChunk* next;
+    size_t used;                  // Bytes válidos em data
+    unsigned char data[];
+} MemoryOutputChunk;
+
+// Saída em memória: pedaços contabilizados no limite de memória, sem cópias
+// ao crescer (open_memstream dobraria o buffer fora do orçamento)
+typedef struct MemoryOutput {
+    MemoryOutputChunk* head;
+    MemoryOutputChunk* tail;
+    size_t size;                  // Bytes gravados
+    size_t reserved;              // Bytes alocados nos pedaços
+    size_t ceiling;               // Maior reserva permitida (0 = sem teto)
+    int exceeded;                 // 1 se a saída passou do teto ou do limite de memória
+} MemoryOutput;
+
+// Funções para a saída em memória
+FILE* openMemoryOutput(MemoryOutput* output, size_t ceiling);
+unsigned char* takeMemoryOutput(MemoryOutput* output);
+void freeMemoryOutput(MemoryOutput* output);
+
+#endif // MEMORY_OUTPUT_H
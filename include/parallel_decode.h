@@ -0,0 +1,41 @@
+#ifndef PARALLEL_DECODE_H
+#define PARALLEL_DECODE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include "decode_table.h"
+#include "byte_stream.h"
+
+// Constantes da decodificação paralela de um único fluxo de bits
+#define PARALLEL_DECODE_SEGMENT (1024 * 1024)   // Bytes comprimidos por trecho
+#define PARALLEL_DECODE_MIN_INPUT (4 * PARALLEL_DECODE_SEGMENT) // Fluxos menores são decodificados em série
+#define PARALLEL_DECODE_MIN_THREADS 4         // Com menos, as duas passagens custam mais que a série
+#define PARALLEL_DECODE_MAX_THREADS 64
+#define PARALLEL_DECODE_SYNC_SYMBOLS 1024       // Inícios de símbolo guardados por trecho para a sincronização
+
+// Resultado da decodificação especulativa de um trecho
+typedef struct DecodeSegment {
+    uint64_t start;               // Primeiro bit do trecho
+    uint64_t limit;               // Primeiro bit do trecho seguinte (ou fim do fluxo)
+    uint64_t exit;                // Primeiro início de símbolo >= limit (ou fim dos símbolos completos)
+    uint64_t symbols;             // Símbolos que começam em [start, exit)
+    uint32_t boundaries[PARALLEL_DECODE_SYNC_SYMBOLS]; // Inícios dos primeiros símbolos, relativos a start
+    int recorded;                 // Entradas válidas em boundaries
+    int failed;                   // 1 se a decodificação especulativa encontrou um código inválido
+} DecodeSegment;
+
+// Estatísticas da última decodificação paralela
+typedef struct ParallelDecodeStats {
+    int threads;                  // Threads usadas
+    uint64_t segments;            // Trechos do fluxo
+    uint64_t synchronized;        // Trechos cuja decodificação especulativa sincronizou
+    uint64_t resync_symbols;      // Símbolos decodificados em série até achar o ponto de sincronização
+} ParallelDecodeStats;
+
+// Funções para decodificação paralela
+int decodeStreamParallel(const unsigned char* data, size_t length, const DecodeTable* table,
+                         int64_t symbols, ByteSink* output, int threads, ParallelDecodeStats* stats);
+int parallelDecodeThreads(size_t length);
+
+#endif // PARALLEL_DECODE_H
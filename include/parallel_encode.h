@@ -0,0 +1,29 @@
+#ifndef PARALLEL_ENCODE_H
+#define PARALLEL_ENCODE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include "code_table.h"
+#include "byte_stream.h"
+
+// Constantes da codificação paralela de um único fluxo de bits
+#define PARALLEL_ENCODE_CHUNK (1024 * 1024)     // Bytes de entrada por trecho
+#define PARALLEL_ENCODE_MIN_INPUT (8 * PARALLEL_ENCODE_CHUNK) // Entradas menores são codificadas em série
+#define PARALLEL_ENCODE_MAX_THREADS 64
+
+// Estatísticas da última codificação paralela
+typedef struct ParallelEncodeStats {
+    int threads;                  // Threads usadas
+    uint64_t chunks;              // Trechos da entrada
+    uint64_t rounds;              // Rodadas (um trecho por thread em cada uma)
+    uint64_t bits;                // Bits do fluxo, sem o preenchimento final
+} ParallelEncodeStats;
+
+// Funções para codificação paralela
+int encodeStreamParallel(const unsigned char* data, size_t length, const CodeTable* table,
+                         const PairCodeTable* pairs, ByteSink* output, int threads,
+                         ParallelEncodeStats* stats);
+int parallelEncodeThreads(size_t length);
+
+#endif // PARALLEL_ENCODE_H
@@ -0,0 +1,51 @@
+#ifndef PROGRESS_H
+#define PROGRESS_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+// Constantes do relatório de progresso
+#define PROGRESS_DEFAULT_INTERVAL_MS 500   // Intervalo mínimo entre dois relatórios
+#define PROGRESS_RATE_SMOOTHING 0.3        // Peso da última janela na vazão atual
+
+// Estado de um trabalho no momento de um relatório
+typedef struct ProgressReport {
+    uint64_t processed;       // Bytes de entrada processados
+    uint64_t total;           // Bytes de entrada esperados (0 = desconhecido)
+    double elapsed;           // Segundos desde o início
+    double rate;              // Vazão atual em bytes/s (média móvel das janelas)
+    double eta;               // Segundos restantes estimados (-1 = desconhecido)
+    int finished;             // 1 no relatório final
+} ProgressReport;
+
+// Função chamada a cada relatório (no máximo uma por intervalo)
+typedef void (*ProgressCallback)(const ProgressReport* report, void* context);
+
+// Acompanhamento de um trabalho, compartilhado pelas threads que o executam
+// processed e next_report usam atômicos relaxados; só a thread que obtém
+// reporting chama o callback e atualiza a janela da vazão.
+typedef struct ProgressTracker {
+    uint64_t processed;           // Bytes processados (atômico)
+    uint64_t total;               // Bytes esperados (0 = desconhecido)
+    int64_t start;                // Início do trabalho (ns, relógio monotônico)
+    int64_t interval;             // Intervalo entre relatórios (ns)
+    int64_t next_report;          // Instante do próximo relatório (atômico)
+    int reporting;                // 1 enquanto uma thread relata (atômico)
+    int64_t window_start;         // Início da janela da vazão atual
+    uint64_t window_processed;    // Bytes processados no início da janela
+    double rate;                  // Vazão atual (bytes/s)
+    ProgressCallback callback;
+    void* context;
+} ProgressTracker;
+
+// Funções para acompanhar um trabalho
+void initProgressTracker(ProgressTracker* tracker, uint64_t total, int interval_ms,
+                         ProgressCallback callback, void* context);
+void progressAdvance(ProgressTracker* tracker, uint64_t bytes);
+void progressFinish(ProgressTracker* tracker);
+
+// Funções para exibição
+void printProgress(const ProgressReport* report, void* context);
+
+#endif // PROGRESS_H
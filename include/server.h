@@ -0,0 +1,57 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include "memory_budget.h"
+
+// Constantes do modo servidor
+#define SERVER_DEFAULT_WORKERS 4                     // Threads de trabalho padrão
+#define SERVER_MAX_WORKERS 64                        // Máximo de threads de trabalho
+#define SERVER_QUEUE_SIZE 64                         // Conexões aguardando uma thread livre
+#define SERVER_LINE_MAX 1024                         // Maior linha de comando aceita
+#define SERVER_MAX_INLINE (256u * 1024 * 1024)       // Maior buffer enviado junto do pedido
+#define SERVER_POLL_SECONDS 1                        // Intervalo para notar o pedido de parada
+#define SERVER_IDLE_POLLS 5                          // Intervalos sem dados antes de fechar a conexão
+
+// Estatísticas acumuladas pelo servidor
+typedef struct ServerStats {
+    uint64_t connections;        // Conexões atendidas
+    uint64_t requests;           // Pedidos processados
+    uint64_t errors;             // Pedidos que falharam
+    uint64_t bytes_in;           // Bytes de entrada dos pedidos
+    uint64_t bytes_out;          // Bytes produzidos pelos pedidos
+    uint64_t total_latency_us;   // Soma das latências de processamento
+    uint64_t max_latency_us;     // Maior latência de processamento
+    uint64_t table_hits;         // Blocos que reaproveitaram a tabela da thread
+    uint64_t table_misses;       // Blocos que trocaram de tabela
+    uint64_t cache_hits;         // Árvores encontradas no cache compartilhado de tabelas
+    uint64_t cache_misses;       // Árvores que tiveram as tabelas construídas
+    uint64_t rejected;           // Pedidos inline recusados pela cota de memória da thread
+} ServerStats;
+
+// Resposta de um pedido (lado do cliente)
+typedef struct ServerReply {
+    int ok;                      // 1 se OK, 0 se ERR
+    uint64_t latency_us;         // Latência de processamento informada pelo servidor
+    uint64_t input_bytes;        // Bytes de entrada processados
+    uint64_t output_bytes;       // Bytes produzidos
+    unsigned char* payload;      // Dados retornados (liberar com free)
+    size_t payload_size;         // Bytes em payload
+    char message[SERVER_LINE_MAX]; // Mensagem de erro
+} ServerReply;
+
+// Funções para execução do servidor
+int planServerBudget(size_t limit, int workers, MemoryPlan* plan);
+int runServer(const char* socket_path, int workers, const MemoryPlan* plan);
+void requestServerShutdown(void);
+void getServerStats(ServerStats* stats);
+void printServerStats(const ServerStats* stats);
+
+// Funções para clientes do servidor
+int connectServer(const char* socket_path);
+int serverRequest(int fd, const char* command, const unsigned char* payload, size_t payload_size,
+                  ServerReply* reply);
+
+#endif // SERVER_H
@@ -0,0 +1,47 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+// Constantes da fila circular de um produtor e um consumidor
+#define SPSC_RING_MAX_CAPACITY 64     // Maior número de itens na fila
+#define SPSC_RING_SPINS 64            // Tentativas com sched_yield antes de dormir
+#define SPSC_RING_SLEEP_NS 50000      // Espera de cada cochilo após as tentativas
+
+// Fila circular sem trava entre duas threads (um produtor, um consumidor)
+// head só é alterado pelo produtor e tail só pelo consumidor; os dois são
+// publicados com acquire/release. Quem espera (fila cheia ou vazia) cede a
+// CPU e, depois de SPSC_RING_SPINS tentativas, dorme um pouco.
+typedef struct SpscRing {
+    void* items[SPSC_RING_MAX_CAPACITY];
+    size_t capacity;              // Itens que cabem na fila
+    size_t head;                  // Próxima posição a escrever (contador crescente)
+    size_t tail;                  // Próxima posição a ler (contador crescente)
+    int closed;                   // 1 quando o produtor terminou
+    int aborted;                  // 1 quando algum estágio falhou (push e pop desistem)
+    uint64_t pushes;              // Itens enfileirados (produtor)
+    uint64_t occupancy_sum;       // Soma da ocupação vista a cada push, incluindo o item (produtor)
+    uint64_t full_waits;          // Vezes em que o produtor encontrou a fila cheia
+    uint64_t empty_waits;         // Vezes em que o consumidor encontrou a fila vazia
+} SpscRing;
+
+// Ocupação de uma fila ao fim de uma execução
+typedef struct SpscRingStats {
+    size_t capacity;              // Itens que cabem na fila
+    uint64_t items;               // Itens que passaram pela fila
+    double average_occupancy;     // Ocupação média vista pelo produtor (1 a capacity)
+    uint64_t full_waits;          // Esperas do produtor (consumidor mais lento)
+    uint64_t empty_waits;         // Esperas do consumidor (produtor mais lento)
+} SpscRingStats;
+
+// Funções para uso da fila
+void initSpscRing(SpscRing* ring, size_t capacity);
+int ringPush(SpscRing* ring, void* item);
+void* ringPop(SpscRing* ring);
+void ringClose(SpscRing* ring);
+void ringAbort(SpscRing* ring);
+void getSpscRingStats(const SpscRing* ring, SpscRingStats* stats);
+
+#endif // SPSC_RING_H
@@ -0,0 +1,57 @@
+#ifndef TABLE_CACHE_H
+#define TABLE_CACHE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include "data_structures.h"
+#include "code_table.h"
+#include "decode_table.h"
+
+// Constantes do cache de tabelas
+#define TABLE_CACHE_DEFAULT_CAPACITY 32   // Entradas mantidas sem uso antes de descartar a mais antiga
+
+// Maior árvore serializada possível: 256 folhas (2 bytes) e 255 nós internos
+#define MAX_SERIALIZED_TREE (2 * MAX_CHAR + MAX_CHAR - 1)
+
+// Tabelas montadas para uma árvore, compartilhadas entre threads
+// As tabelas são construídas na primeira vez em que são pedidas.
+typedef struct CachedTables {
+    uint64_t key;                                 // Hash da árvore serializada
+    unsigned char shape[MAX_SERIALIZED_TREE];     // Árvore serializada (confirma o hash)
+    size_t shape_size;                            // Bytes válidos em shape
+    HuffmanNode* root;                            // Árvore reconstruída (usada pela decodificação)
+    DecodeTable* decode;                          // Tabela de decodificação (ou NULL)
+    CodeTable* code;                              // Tabela de códigos inteiros (ou NULL)
+    PairCodeTable* pairs;                         // Tabela de pares de bytes (ou NULL)
+    int code_failed;                              // 1 se os códigos não cabem na tabela inteira
+    int references;                               // Usuários atuais (protegido pela trava do cache)
+    struct CachedTables* prev;                    // Lista LRU: entrada usada mais recentemente
+    struct CachedTables* next;                    // Lista LRU: entrada usada menos recentemente
+} CachedTables;
+
+// Estatísticas do cache
+typedef struct TableCacheStats {
+    uint64_t hits;            // Árvores encontradas no cache
+    uint64_t misses;          // Árvores inseridas no cache
+    uint64_t evictions;       // Entradas descartadas pelo limite
+    size_t entries;           // Entradas atuais
+    size_t capacity;          // Limite de entradas
+} TableCacheStats;
+
+// Funções para serialização da árvore em memória
+size_t flattenTree(HuffmanNode* root, unsigned char* shape, size_t size);
+
+// Funções para obter e devolver tabelas
+CachedTables* acquireTables(const unsigned char* shape, size_t shape_size);
+void releaseTables(CachedTables* tables);
+const DecodeTable* cachedDecodeTable(CachedTables* tables);
+const CodeTable* cachedCodeTable(CachedTables* tables);
+const PairCodeTable* cachedPairCodeTable(CachedTables* tables);
+
+// Funções para configuração e estatísticas
+void setTableCacheCapacity(size_t capacity);
+void clearTableCache(void);
+void getTableCacheStats(TableCacheStats* stats);
+
+#endif // TABLE_CACHE_H
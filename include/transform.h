@@ -0,0 +1,40 @@
+#ifndef TRANSFORM_H
+#define TRANSFORM_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+// Constantes das transformações aplicadas antes da codificação de Huffman
+#define RLE_MIN_RUN 4                        // Repetições que disparam o contador
+#define RLE_MAX_EXTRA 255                    // Maior contador (repetições além de RLE_MIN_RUN)
+#define TRANSFORM_TRIAL_SLICES 4             // Trechos do bloco usados na escolha
+#define TRANSFORM_TRIAL_SLICE (4 * 1024)     // Bytes de cada trecho
+#define TRANSFORM_MIN_BLOCK (16 * 1024)      // Blocos menores não são testados
+#define TRANSFORM_MIN_GAIN 16                // A transformação precisa economizar 1/16 dos bits
+
+// Transformações reversíveis de um bloco
+typedef enum TransformType {
+    TRANSFORM_NONE = 0,     // Bytes originais
+    TRANSFORM_RLE = 1,      // Sequências de 4+ bytes iguais (zeros inclusive) viram 4 bytes e um contador
+    TRANSFORM_DELTA = 2,    // Diferença entre cada byte e o anterior
+    TRANSFORM_MTF = 3,      // Move-to-front: posição do byte numa lista dos usados recentemente
+    TRANSFORM_COUNT = 4
+} TransformType;
+
+// Máscara de transformações permitidas
+#define TRANSFORM_BIT(type) (1 << (type))
+#define TRANSFORM_ALL (TRANSFORM_BIT(TRANSFORM_RLE) | TRANSFORM_BIT(TRANSFORM_DELTA) | TRANSFORM_BIT(TRANSFORM_MTF))
+
+// Funções para aplicar e desfazer as transformações
+size_t applyTransform(TransformType type, const unsigned char* input, size_t length,
+                      unsigned char* output, size_t capacity);
+int invertTransform(TransformType type, const unsigned char* input, size_t length,
+                    unsigned char* output, size_t expected);
+
+// Funções para escolha e configuração
+TransformType chooseTransform(const unsigned char* data, size_t length, int allowed);
+int parseTransformList(const char* text, int* allowed);
+const char* transformName(TransformType type);
+
+#endif // TRANSFORM_H
@@ -0,0 +1,65 @@
+#ifndef WIDE_SYMBOL_H
+#define WIDE_SYMBOL_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include "file_io.h"
+
+// Constantes do alfabeto de 16 bits (palavras little-endian: UTF-16LE, amostras de sensores)
+#define WIDE_ALPHABET 65536                  // Símbolos possíveis
+#define WIDE_MAX_CODE_LENGTH 20              // Limite de comprimento dos códigos canônicos
+#define WIDE_ROOT_BITS 11                    // Bits do primeiro nível da tabela de decodificação
+#define WIDE_MIN_BLOCK (16 * 1024)           // Blocos menores não são testados
+#define WIDE_MIN_GAIN 32                     // O modo de 16 bits precisa economizar 1/32 do bloco
+#define WIDE_MAX_DECODE_ENTRIES ((1 << WIDE_ROOT_BITS) + WIDE_ALPHABET) // Maior tabela de decodificação gravada
+
+// Tabela de códigos canônicos para palavras de 16 bits
+typedef struct WideCodeTable {
+    uint32_t code[WIDE_ALPHABET];            // Bits do código, alinhados à direita
+    unsigned char length[WIDE_ALPHABET];     // Comprimento do código (0 = símbolo ausente)
+    int symbols;                             // Símbolos presentes
+    int max_length;                          // Maior comprimento presente
+} WideCodeTable;
+
+// Entrada da tabela de decodificação de dois níveis
+// No primeiro nível, sub_bits > 0 indica uma subtabela de 2^sub_bits
+// entradas em offset, indexada pelos bits seguintes aos WIDE_ROOT_BITS
+typedef struct WideDecodeEntry {
+    uint16_t symbol;                         // Palavra decodificada (entrada final)
+    uint8_t bits;                            // Bits consumidos neste nível (0 = código inválido)
+    uint8_t sub_bits;                        // Bits da subtabela (0 = entrada final)
+    uint32_t offset;                         // Início da subtabela em entries
+} WideDecodeEntry;
+
+// Tabela de decodificação: 2^WIDE_ROOT_BITS entradas seguidas das subtabelas
+typedef struct WideDecodeTable {
+    WideDecodeEntry* entries;
+    size_t size;                             // Entradas no total
+    int max_length;                          // Maior comprimento de código
+} WideDecodeTable;
+
+// Funções para escolha dos códigos
+void countWideFrequencies(const unsigned char* data, size_t length, uint32_t* frequencies);
+int buildWideCodeLengths(const uint32_t* frequencies, unsigned char* lengths);
+uint64_t wideCostBits(const uint32_t* frequencies, const unsigned char* lengths);
+void buildWideCodeTable(const unsigned char* lengths, WideCodeTable* table);
+
+// Funções para o cabeçalho esparso de comprimentos
+size_t wideHeaderSize(const unsigned char* lengths);
+size_t writeWideHeader(const unsigned char* lengths, unsigned char* output, size_t capacity);
+size_t readWideHeader(const unsigned char* input, size_t length, unsigned char* lengths);
+
+// Funções para codificação e decodificação
+int encodeWideSymbols(BitWriter* writer, const unsigned char* data, size_t words, const WideCodeTable* table);
+size_t wideDecodeTableEntries(const unsigned char* lengths);
+WideDecodeTable* buildWideDecodeTable(const unsigned char* lengths);
+void freeWideDecodeTable(WideDecodeTable* table);
+size_t decodeWideSymbols(BitReader* reader, const WideDecodeTable* table, unsigned char* output, size_t words);
+
+// Funções para blocos completos (cabeçalho, byte ímpar final e fluxo de bits)
+size_t encodeWideBlock(const unsigned char* data, size_t length, const unsigned char* lengths,
+                       unsigned char* output, size_t capacity);
+int decodeWideBlock(const unsigned char* payload, size_t payload_size, unsigned char* output, size_t raw_size);
+
+#endif // WIDE_SYMBOL_H
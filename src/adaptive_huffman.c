@@ -0,0 +1,518 @@
+#define _POSIX_C_SOURCE 200809L
+#include "adaptive_huffman.h"
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+/**
+ * Verifica se o arquivo aberto começa com a assinatura do formato adaptativo
+ * (a posição de leitura é restaurada)
+ * @param input Arquivo de entrada
+ * @return 1 se é um fluxo adaptativo, 0 caso contrário
+ */
+int isAdaptiveStream(FILE* input) {
+    char magic[ADAPTIVE_MAGIC_SIZE];
+    off_t position = ftello(input);
+    size_t bytes_read = fread(magic, 1, ADAPTIVE_MAGIC_SIZE, input);
+
+    if (position >= 0) {
+        fseeko(input, position, SEEK_SET);
+    }
+
+    return bytes_read == ADAPTIVE_MAGIC_SIZE && memcmp(magic, ADAPTIVE_MAGIC, ADAPTIVE_MAGIC_SIZE) == 0;
+}
+
+/**
+ * Verifica se um arquivo está no formato adaptativo
+ * @param filename Nome do arquivo
+ * @return 1 se é um fluxo adaptativo, 0 caso contrário
+ */
+int isAdaptiveFile(const char* filename) {
+    FILE* file = fopen(filename, "rb");
+    if (file == NULL) {
+        return 0;
+    }
+
+    int result = isAdaptiveStream(file);
+    fclose(file);
+    return result;
+}
+
+/**
+ * Inicializa o modelo com apenas a folha NYT (nenhum símbolo conhecido)
+ * @param model Modelo
+ */
+void initAdaptiveModel(AdaptiveModel* model) {
+    for (int i = 0; i < ADAPTIVE_SYMBOLS; i++) {
+        model->leaf[i] = -1;
+    }
+
+    AdaptiveNode* root = &model->nodes[0];
+    root->weight = 0;
+    root->parent = -1;
+    root->left = -1;
+    root->right = -1;
+    root->number = ADAPTIVE_MAX_NODES - 1;
+    root->symbol = -1;
+
+    model->order[root->number] = 0;
+    model->root = 0;
+    model->nyt = 0;
+    model->count = 1;
+}
+
+/**
+ * Encontra o líder do bloco de um nó: o nó de maior número com o mesmo peso
+ * Os pesos não diminuem com o número, então a busca é binária.
+ * @param model Modelo
+ * @param node Índice do nó
+ * @return Índice do líder
+ */
+static int findBlockLeader(const AdaptiveModel* model, int node) {
+    uint64_t weight = model->nodes[node].weight;
+    int low = model->nodes[node].number;
+    int high = ADAPTIVE_MAX_NODES - 1;
+
+    while (low < high) {
+        int middle = low + (high - low + 1) / 2;
+        if (model->nodes[model->order[middle]].weight == weight) {
+            low = middle;
+        } else {
+            high = middle - 1;
+        }
+    }
+    return model->order[low];
+}
+
+/**
+ * Troca dois nós de posição na árvore (com suas subárvores) e na numeração
+ * @param model Modelo
+ * @param a Primeiro nó
+ * @param b Segundo nó (nenhum dos dois é ancestral do outro)
+ */
+static void swapAdaptiveNodes(AdaptiveModel* model, int a, int b) {
+    AdaptiveNode* node_a = &model->nodes[a];
+    AdaptiveNode* node_b = &model->nodes[b];
+    AdaptiveNode* parent_a = &model->nodes[node_a->parent];
+    AdaptiveNode* parent_b = &model->nodes[node_b->parent];
+
+    if (node_a->parent == node_b->parent) {
+        int left = parent_a->left;
+        parent_a->left = parent_a->right;
+        parent_a->right = left;
+    } else {
+        if (parent_a->left == a) parent_a->left = b; else parent_a->right = b;
+        if (parent_b->left == b) parent_b->left = a; else parent_b->right = a;
+        int parent = node_a->parent;
+        node_a->parent = node_b->parent;
+        node_b->parent = parent;
+    }
+
+    int number = node_a->number;
+    node_a->number = node_b->number;
+    node_b->number = number;
+    model->order[node_a->number] = a;
+    model->order[node_b->number] = b;
+}
+
+/**
+ * Atualiza a árvore após um símbolo (algoritmo FGK)
+ * Um símbolo novo divide a folha NYT em um novo NYT e a folha do símbolo;
+ * depois, do símbolo até a raiz, cada nó troca de lugar com o líder do seu
+ * bloco (exceto o próprio pai) e tem o peso incrementado, o que preserva a
+ * propriedade dos irmãos.
+ * @param model Modelo
+ * @param symbol Símbolo recém-codificado ou decodificado
+ */
+void updateAdaptiveModel(AdaptiveModel* model, int symbol) {
+    int node = model->leaf[symbol];
+
+    if (node < 0) {
+        int parent = model->nyt;
+        int nyt = model->count++;
+        node = model->count++;
+        int number = model->nodes[parent].number;
+
+        model->nodes[nyt] = (AdaptiveNode){0, parent, -1, -1, number - 2, -1};
+        model->nodes[node] = (AdaptiveNode){0, parent, -1, -1, number - 1, symbol};
+        model->nodes[parent].left = nyt;
+        model->nodes[parent].right = node;
+        model->order[number - 2] = nyt;
+        model->order[number - 1] = node;
+        model->nyt = nyt;
+        model->leaf[symbol] = node;
+    }
+
+    while (node >= 0) {
+        int leader = findBlockLeader(model, node);
+        if (leader != node && leader != model->nodes[node].parent) {
+            swapAdaptiveNodes(model, node, leader);
+        }
+        model->nodes[node].weight++;
+        node = model->nodes[node].parent;
+    }
+}
+
+/**
+ * Acrescenta até 32 bits ao escritor, descarregando bytes completos
+ * @param writer Escritor de bits
+ * @param code Bits alinhados à direita
+ * @param length Número de bits (até 32)
+ */
+static void putBits(BitWriter* writer, uint32_t code, int length) {
+    writer->accumulator = (writer->accumulator << length) | code;
+    writer->bit_count += length;
+
+    while (writer->bit_count >= 8) {
+        if (writer->position == writer->capacity) {
+            drainBitWriter(writer);
+        }
+        writer->bit_count -= 8;
+        writer->buffer[writer->position++] = (unsigned char)(writer->accumulator >> writer->bit_count);
+    }
+}
+
+/**
+ * Escreve o código atual de um símbolo (e o atualiza no modelo)
+ * @param encoder Codificador
+ * @param symbol Símbolo (byte ou símbolo de controle)
+ */
+static void encodeAdaptiveSymbol(AdaptiveEncoder* encoder, int symbol) {
+    AdaptiveModel* model = &encoder->model;
+    int known = model->leaf[symbol] >= 0;
+    int node = known ? model->leaf[symbol] : model->nyt;
+
+    // O caminho é montado da folha para a raiz e escrito na ordem inversa
+    unsigned char path[ADAPTIVE_MAX_NODES];
+    int depth = 0;
+    while (model->nodes[node].parent >= 0) {
+        int parent = model->nodes[node].parent;
+        path[depth++] = model->nodes[parent].right == node;
+        node = parent;
+    }
+
+    while (depth > 0) {
+        int length = depth < 32 ? depth : 32;
+        uint32_t code = 0;
+        for (int i = 0; i < length; i++) {
+            code = (code << 1) | path[--depth];
+        }
+        putBits(&encoder->writer, code, length);
+    }
+
+    if (!known) {
+        putBits(&encoder->writer, (uint32_t)symbol, ADAPTIVE_SYMBOL_BITS);
+    }
+
+    updateAdaptiveModel(model, symbol);
+}
+
+/**
+ * Inicializa o codificador e grava a assinatura do formato
+ * @param encoder Codificador
+ * @param output Destino
+ * @return 0 se sucesso, -1 se erro de escrita
+ */
+int initAdaptiveEncoder(AdaptiveEncoder* encoder, ByteSink* output) {
+    initAdaptiveModel(&encoder->model);
+    initBitWriter(&encoder->writer, encoder->buffer, sizeof(encoder->buffer), output);
+    encoder->input_bytes = 0;
+    encoder->messages = 0;
+
+    sinkWrite(output, ADAPTIVE_MAGIC, ADAPTIVE_MAGIC_SIZE);
+    sinkPutc(output, ADAPTIVE_FORMAT_VERSION);
+    return output->error ? -1 : 0;
+}
+
+/**
+ * Codifica bytes, atualizando a árvore após cada um
+ * @param encoder Codificador
+ * @param data Bytes de entrada
+ * @param length Número de bytes
+ * @return 0 se sucesso, -1 se erro de escrita
+ */
+int adaptiveEncode(AdaptiveEncoder* encoder, const unsigned char* data, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        encodeAdaptiveSymbol(encoder, data[i]);
+    }
+    encoder->input_bytes += length;
+    return encoder->writer.output->error ? -1 : 0;
+}
+
+/**
+ * Encerra a mensagem atual: grava o símbolo de fim de mensagem, completa o
+ * byte e entrega tudo ao destino, que já pode decodificar a mensagem inteira
+ * @param encoder Codificador
+ * @return 0 se sucesso, -1 se erro de escrita
+ */
+int adaptiveFlush(AdaptiveEncoder* encoder) {
+    encodeAdaptiveSymbol(encoder, ADAPTIVE_FLUSH);
+    encoder->messages++;
+    if (flushBitWriter(&encoder->writer) != 0 || sinkFlush(encoder->writer.output) != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Encerra o fluxo com o símbolo de fim
+ * @param encoder Codificador
+ * @return 0 se sucesso, -1 se erro de escrita
+ */
+int finishAdaptiveEncoder(AdaptiveEncoder* encoder) {
+    encodeAdaptiveSymbol(encoder, ADAPTIVE_END);
+    if (flushBitWriter(&encoder->writer) != 0 || sinkFlush(encoder->writer.output) != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Lê o próximo bit da entrada (byte a byte, sem esperar um buffer cheio)
+ * @param decoder Decodificador
+ * @return Bit lido (0 ou 1) ou -1 no fim da entrada
+ */
+static int readAdaptiveBit(AdaptiveDecoder* decoder) {
+    if (decoder->bits_left == 0) {
+        decoder->byte = sourceGetc(decoder->input);
+        if (decoder->byte == EOF) {
+            return -1;
+        }
+        decoder->bits_left = 8;
+    }
+    return (decoder->byte >> --decoder->bits_left) & 1;
+}
+
+/**
+ * Inicializa o decodificador, validando a assinatura do formato
+ * @param decoder Decodificador
+ * @param input Origem comprimida
+ * @return 0 se sucesso, -1 se o formato é inválido
+ */
+int initAdaptiveDecoder(AdaptiveDecoder* decoder, ByteSource* input) {
+    initAdaptiveModel(&decoder->model);
+    decoder->input = input;
+    decoder->byte = 0;
+    decoder->bits_left = 0;
+    decoder->output_bytes = 0;
+
+    char magic[ADAPTIVE_MAGIC_SIZE];
+    int version;
+    if (sourceRead(input, magic, ADAPTIVE_MAGIC_SIZE) != ADAPTIVE_MAGIC_SIZE ||
+        memcmp(magic, ADAPTIVE_MAGIC, ADAPTIVE_MAGIC_SIZE) != 0 ||
+        (version = sourceGetc(input)) == EOF || version > ADAPTIVE_FORMAT_VERSION) {
+        fprintf(stderr, "Erro: Formato de arquivo inválido\n");
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Decodifica até o fim da próxima mensagem (ou do fluxo)
+ * @param decoder Decodificador
+ * @param output Destino (descarregado ao fim de cada mensagem)
+ * @return 1 no fim de uma mensagem, 0 no fim do fluxo, -1 se a entrada está truncada ou corrompida
+ */
+int adaptiveDecodeMessage(AdaptiveDecoder* decoder, ByteSink* output) {
+    AdaptiveModel* model = &decoder->model;
+
+    for (;;) {
+        int node = model->root;
+        while (model->nodes[node].left >= 0) {
+            int bit = readAdaptiveBit(decoder);
+            if (bit < 0) {
+                fprintf(stderr, "Erro: Fluxo adaptativo truncado\n");
+                return -1;
+            }
+            node = bit ? model->nodes[node].right : model->nodes[node].left;
+        }
+
+        int symbol = model->nodes[node].symbol;
+        if (node == model->nyt) {
+            symbol = 0;
+            for (int i = 0; i < ADAPTIVE_SYMBOL_BITS; i++) {
+                int bit = readAdaptiveBit(decoder);
+                if (bit < 0) {
+                    fprintf(stderr, "Erro: Fluxo adaptativo truncado\n");
+                    return -1;
+                }
+                symbol = (symbol << 1) | bit;
+            }
+            if (symbol >= ADAPTIVE_SYMBOLS || model->leaf[symbol] >= 0) {
+                fprintf(stderr, "Erro: Símbolo inválido no fluxo adaptativo\n");
+                return -1;
+            }
+        }
+
+        updateAdaptiveModel(model, symbol);
+
+        if (symbol == ADAPTIVE_END) {
+            return sinkFlush(output) == 0 ? 0 : -1;
+        }
+        if (symbol == ADAPTIVE_FLUSH) {
+            // O codificador completou o byte com zeros
+            decoder->bits_left = 0;
+            return sinkFlush(output) == 0 ? 1 : -1;
+        }
+
+        sinkPutc(output, symbol);
+        decoder->output_bytes++;
+    }
+}
+
+/**
+ * Comprime um fluxo em uma única passagem, sem cabeçalho de árvore
+ * Se a entrada não é um arquivo regular (pipe, socket, terminal), cada
+ * leitura vira uma mensagem entregue imediatamente ao destino.
+ * @param input Arquivo de entrada (ainda não lido pelo FILE*)
+ * @param output Arquivo de saída
+ * @return 0 se sucesso, -1 se erro
+ */
+int compressStreamAdaptive(FILE* input, FILE* output) {
+    AdaptiveEncoder* encoder = (AdaptiveEncoder*)malloc(sizeof(AdaptiveEncoder));
+    if (encoder == NULL) {
+        fprintf(stderr, "Erro: Falha na alocação de memória para o codificador\n");
+        exit(EXIT_FAILURE);
+    }
+
+    struct stat info;
+    int streaming = fstat(fileno(input), &info) == 0 && !S_ISREG(info.st_mode);
+    unsigned char buffer[HISTOGRAM_BUFFER_SIZE];
+    ByteSink sink;
+    initFileSink(&sink, output);
+    int result = initAdaptiveEncoder(encoder, &sink);
+
+    while (result == 0) {
+        size_t bytes_read;
+        int failed;
+        if (streaming) {
+            // read() devolve o que já chegou, sem esperar o buffer encher
+            ssize_t count;
+            do {
+                count = read(fileno(input), buffer, sizeof(buffer));
+            } while (count < 0 && errno == EINTR);
+            bytes_read = count > 0 ? (size_t)count : 0;
+            failed = count < 0;
+        } else {
+            bytes_read = fread(buffer, 1, sizeof(buffer), input);
+            failed = bytes_read == 0 && ferror(input);
+        }
+        if (failed) {
+            // Sem o símbolo de fim, o fluxo truncado não passa por completo
+            fprintf(stderr, "Erro: Falha ao ler a entrada: %s\n", strerror(errno));
+            result = -1;
+            break;
+        }
+        if (bytes_read == 0) {
+            break;
+        }
+
+        result = adaptiveEncode(encoder, buffer, bytes_read);
+        if (result == 0 && streaming) {
+            result = adaptiveFlush(encoder);
+        }
+    }
+
+    if (result == 0) {
+        result = finishAdaptiveEncoder(encoder);
+    }
+    closeSink(&sink);
+    free(encoder);
+    return result;
+}
+
+/**
+ * Descomprime um fluxo adaptativo, entregando cada mensagem assim que termina
+ * @param input Arquivo comprimido
+ * @param output Arquivo de saída
+ * @return 0 se sucesso, -1 se erro
+ */
+int decompressStreamAdaptive(FILE* input, FILE* output) {
+    AdaptiveDecoder* decoder = (AdaptiveDecoder*)malloc(sizeof(AdaptiveDecoder));
+    if (decoder == NULL) {
+        fprintf(stderr, "Erro: Falha na alocação de memória para o decodificador\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // Sem sourcePeek, a origem lê byte a byte e não espera um buffer cheio
+    ByteSource source;
+    ByteSink sink;
+    initFileSource(&source, input);
+    initFileSink(&sink, output);
+
+    int result = initAdaptiveDecoder(decoder, &source);
+    while (result == 0) {
+        int status = adaptiveDecodeMessage(decoder, &sink);
+        if (status <= 0) {
+            result = status;
+            break;
+        }
+    }
+
+    if (sinkFlush(&sink) != 0) {
+        result = -1;
+    }
+    closeSink(&sink);
+    closeSource(&source);
+    free(decoder);
+    return result;
+}
+
+/**
+ * Comprime um arquivo no formato adaptativo
+ * @param input_filename Nome do arquivo de entrada
+ * @param output_filename Nome do arquivo de saída
+ * @return 0 se sucesso, -1 se erro
+ */
+int compressFileAdaptive(const char* input_filename, const char* output_filename) {
+    FILE* input = fopen(input_filename, "rb");
+    if (input == NULL) {
+        fprintf(stderr, "Erro: Arquivo de entrada '%s' não encontrado\n", input_filename);
+        return -1;
+    }
+
+    FILE* output = fopen(output_filename, "wb");
+    if (output == NULL) {
+        fprintf(stderr, "Erro: Não foi possível abrir os arquivos\n");
+        fclose(input);
+        return -1;
+    }
+
+    int result = compressStreamAdaptive(input, output);
+
+    fclose(input);
+    if (fclose(output) != 0) {
+        result = -1;
+    }
+    return result;
+}
+
+/**
+ * Descomprime um arquivo no formato adaptativo
+ * @param input_filename Nome do arquivo comprimido
+ * @param output_filename Nome do arquivo de saída
+ * @return 0 se sucesso, -1 se erro
+ */
+int decompressFileAdaptive(const char* input_filename, const char* output_filename) {
+    FILE* input = fopen(input_filename, "rb");
+    if (input == NULL) {
+        fprintf(stderr, "Erro: Arquivo de entrada '%s' não encontrado\n", input_filename);
+        return -1;
+    }
+
+    FILE* output = fopen(output_filename, "wb");
+    if (output == NULL) {
+        fprintf(stderr, "Erro: Não foi possível abrir os arquivos\n");
+        fclose(input);
+        return -1;
+    }
+
+    int result = decompressStreamAdaptive(input, output);
+
+    fclose(input);
+    if (fclose(output) != 0) {
+        result = -1;
+    }
+    return result;
+}
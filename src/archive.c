@@ -0,0 +1,827 @@
+#define _POSIX_C_SOURCE 200809L
+#include "archive.h"
+#include "block_format.h"
+#include "hash.h"
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+// Trabalho de compressão ou extração de um membro
+typedef struct ArchiveJob {
+    const char* source;           // Arquivo de origem (compressão)
+    const ArchiveEntry* entry;    // Entrada do diretório (extração)
+    uint64_t spool_offset;        // Início do contêiner do membro no arquivo de espera (compressão)
+    uint64_t spool_size;          // Bytes do contêiner do membro (compressão)
+    uint64_t hash;                // Hash do contêiner comprimido (compressão)
+    int duplicate_of;             // Trabalho com o mesmo conteúdo (-1 = nenhum)
+    BlockStats stats;
+    int result;
+} ArchiveJob;
+
+// Estado compartilhado pelas threads de um lote de trabalhos
+typedef struct ArchiveBatch {
+    ArchiveJob* jobs;
+    int count;
+    int next;                     // Próximo trabalho livre (atômico)
+    const char* archive_path;     // Arquivo lido na extração
+    const char* output_dir;       // Diretório de destino na extração
+    const MemoryPlan* plan;
+    int dedup;                    // 1 para deduplicar blocos repetidos
+    ProgressTracker* progress;    // Progresso compartilhado pelas threads (ou NULL)
+    FILE* spool;                  // Contêineres prontos, na ordem de conclusão (compressão)
+    pthread_mutex_t spool_mutex;  // Serializa os acréscimos a spool
+} ArchiveBatch;
+
+/**
+ * Retorna o número de threads a usar (0 ou negativo = processadores disponíveis)
+ * @param threads Número pedido
+ * @param jobs Número de trabalhos (não faz sentido usar mais threads)
+ * @return Número efetivo de threads
+ */
+static int resolveThreadCount(int threads, int jobs) {
+    if (threads <= 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = online > 0 ? (int)online : 1;
+    }
+    if (threads > jobs) {
+        threads = jobs;
+    }
+    return threads > 0 ? threads : 1;
+}
+
+/**
+ * Verifica se um nome de membro é um caminho relativo seguro
+ * (sem componentes "..", que escreveriam fora do diretório de destino)
+ * @param name Nome do membro
+ * @return 1 se seguro, 0 caso contrário
+ */
+static int isSafeMemberName(const char* name) {
+    if (name[0] == '\0' || name[0] == '/') {
+        return 0;
+    }
+
+    const char* component = name;
+    while (component != NULL) {
+        const char* slash = strchr(component, '/');
+        size_t length = slash != NULL ? (size_t)(slash - component) : strlen(component);
+        if (length == 2 && component[0] == '.' && component[1] == '.') {
+            return 0;
+        }
+        component = slash != NULL ? slash + 1 : NULL;
+    }
+    return 1;
+}
+
+/**
+ * Converte o caminho de origem no nome gravado (remove "/" e "./" iniciais)
+ * @param path Caminho informado
+ * @return Ponteiro para o início do nome dentro de path
+ */
+static const char* storedMemberName(const char* path) {
+    for (;;) {
+        if (path[0] == '/') {
+            path++;
+        } else if (path[0] == '.' && path[1] == '/') {
+            path += 2;
+        } else {
+            return path;
+        }
+    }
+}
+
+/**
+ * Procura membros com o mesmo nome gravado (seriam extraídos no mesmo caminho)
+ * @param members Caminhos de origem
+ * @param count Número de membros
+ * @return Índice do primeiro membro repetido, -1 se os nomes são distintos
+ */
+static int findRepeatedMemberName(const char** members, int count) {
+    HashIndex seen;
+    initHashIndex(&seen);
+    int indexed = 1;
+    int repeated = -1;
+    for (int i = 0; i < count && repeated < 0; i++) {
+        const char* name = storedMemberName(members[i]);
+        uint64_t key = hash64(name, strlen(name), 0);
+        uint64_t previous;
+
+        // Só um hash repetido (ou o índice sem memória) exige comparar os nomes
+        if (!indexed || findHashIndex(&seen, key, &previous)) {
+            for (int j = 0; j < i && repeated < 0; j++) {
+                if (strcmp(storedMemberName(members[j]), name) == 0) {
+                    repeated = i;
+                }
+            }
+        }
+        if (indexed && insertHashIndex(&seen, key, (uint64_t)i) != 0) {
+            indexed = 0;
+        }
+    }
+    freeHashIndex(&seen);
+    return repeated;
+}
+
+/**
+ * Cria os diretórios intermediários de um caminho de arquivo
+ * @param path Caminho do arquivo
+ * @return 0 se sucesso, -1 se erro
+ */
+static int createParentDirectories(const char* path) {
+    char buffer[2 * MAX_FILENAME];
+    strncpy(buffer, path, sizeof(buffer) - 1);
+    buffer[sizeof(buffer) - 1] = '\0';
+
+    for (char* slash = strchr(buffer + 1, '/'); slash != NULL; slash = strchr(slash + 1, '/')) {
+        *slash = '\0';
+        if (mkdir(buffer, 0755) != 0 && errno != EEXIST) {
+            return -1;
+        }
+        *slash = '/';
+    }
+    return 0;
+}
+
+/**
+ * Comprime um membro no arquivo temporário da thread e acrescenta o
+ * contêiner ao arquivo de espera do lote
+ * Só há um arquivo temporário por thread (reaproveitado entre membros) e um
+ * por lote: o número de arquivos abertos não cresce com o de membros.
+ * @param job Trabalho
+ * @param batch Lote (plano e arquivo de espera)
+ * @param workspace Buffers da thread
+ * @param scratch Arquivo temporário da thread (NULL se não pôde ser criado)
+ */
+static void compressMember(ArchiveJob* job, ArchiveBatch* batch, BlockWorkspace* workspace, FILE* scratch) {
+    job->result = -1;
+    if (scratch == NULL) {
+        fprintf(stderr, "Erro: Não foi possível criar arquivo temporário para '%s'\n", job->source);
+        return;
+    }
+
+    FILE* input = fopen(job->source, "rb");
+    if (input == NULL) {
+        fprintf(stderr, "Erro: Arquivo de entrada '%s' não encontrado\n", job->source);
+        return;
+    }
+
+    rewind(scratch);
+    int result = ftruncate(fileno(scratch), 0) == 0 ? 0 : -1;
+    if (result == 0) {
+        result = compressStreamBlocksWith(input, scratch, batch->plan, &job->stats, workspace);
+    }
+    if (fflush(scratch) != 0) {
+        result = -1;
+    }
+    fclose(input);
+    if (result != 0) {
+        return;
+    }
+
+    // Cópia para o arquivo de espera, com o hash do contêiner para achar
+    // membros idênticos (a compressão é determinística)
+    unsigned char buffer[HISTOGRAM_BUFFER_SIZE];
+    size_t bytes_read;
+    job->hash = 0;
+    job->spool_size = 0;
+    rewind(scratch);
+    pthread_mutex_lock(&batch->spool_mutex);
+    off_t offset = fseeko(batch->spool, 0, SEEK_END) == 0 ? ftello(batch->spool) : -1;
+    result = offset >= 0 ? 0 : -1;
+    while (result == 0 && (bytes_read = fread(buffer, 1, sizeof(buffer), scratch)) > 0) {
+        job->hash = hash64(buffer, bytes_read, job->hash);
+        job->spool_size += bytes_read;
+        if (fwrite(buffer, 1, bytes_read, batch->spool) != bytes_read) {
+            result = -1;
+        }
+    }
+    if (fflush(batch->spool) != 0 || ferror(scratch)) {
+        result = -1;
+    }
+    pthread_mutex_unlock(&batch->spool_mutex);
+
+    if (result != 0) {
+        fprintf(stderr, "Erro: Falha ao gravar o arquivo temporário de '%s'\n", job->source);
+        return;
+    }
+    job->spool_offset = (uint64_t)offset;
+    job->result = 0;
+}
+
+/**
+ * Compara dois trechos de mesmo tamanho do arquivo de espera
+ * @param spool Arquivo de espera
+ * @param first Início do primeiro trecho
+ * @param second Início do segundo trecho
+ * @param size Bytes de cada trecho
+ * @return 1 se idênticos, 0 caso contrário
+ */
+static int sameSpoolContents(FILE* spool, uint64_t first, uint64_t second, uint64_t size) {
+    unsigned char buffer_first[BUFFER_SIZE];
+    unsigned char buffer_second[BUFFER_SIZE];
+
+    for (uint64_t done = 0; done < size;) {
+        size_t wanted = size - done < sizeof(buffer_first) ? (size_t)(size - done) : sizeof(buffer_first);
+        if (fseeko(spool, (off_t)(first + done), SEEK_SET) != 0 ||
+            fread(buffer_first, 1, wanted, spool) != wanted ||
+            fseeko(spool, (off_t)(second + done), SEEK_SET) != 0 ||
+            fread(buffer_second, 1, wanted, spool) != wanted ||
+            memcmp(buffer_first, buffer_second, wanted) != 0) {
+            return 0;
+        }
+        done += wanted;
+    }
+    return 1;
+}
+
+/**
+ * Copia um arquivo já extraído para o destino de um membro idêntico
+ * @param source Arquivo extraído
+ * @param destination Arquivo a criar
+ * @return 0 se sucesso, -1 se erro
+ */
+static int copyExtractedFile(const char* source, const char* destination) {
+    if (createParentDirectories(destination) != 0) {
+        return -1;
+    }
+
+    FILE* input = fopen(source, "rb");
+    FILE* output = fopen(destination, "wb");
+    int result = input != NULL && output != NULL ? 0 : -1;
+
+    unsigned char buffer[HISTOGRAM_BUFFER_SIZE];
+    size_t bytes_read;
+    while (result == 0 && (bytes_read = fread(buffer, 1, sizeof(buffer), input)) > 0) {
+        if (fwrite(buffer, 1, bytes_read, output) != bytes_read) {
+            result = -1;
+        }
+    }
+
+    if (input != NULL) {
+        fclose(input);
+    }
+    if (output != NULL && fclose(output) != 0) {
+        result = -1;
+    }
+    return result;
+}
+
+/**
+ * Monta o caminho de destino de um membro
+ * @param output_dir Diretório de destino (NULL = diretório atual)
+ * @param name Nome do membro
+ * @param path Destino (2 * MAX_FILENAME bytes)
+ */
+static void memberOutputPath(const char* output_dir, const char* name, char* path) {
+    if (output_dir != NULL) {
+        snprintf(path, 2 * MAX_FILENAME, "%s/%s", output_dir, name);
+    } else {
+        snprintf(path, 2 * MAX_FILENAME, "%s", name);
+    }
+}
+
+/**
+ * Extrai um membro lendo o arquivo a partir do seu offset
+ * @param job Trabalho
+ * @param batch Lote (arquivo, destino e plano)
+ * @param workspace Buffers da thread
+ */
+static void extractMember(ArchiveJob* job, const ArchiveBatch* batch, BlockWorkspace* workspace) {
+    const ArchiveEntry* entry = job->entry;
+    job->result = -1;
+
+    char path[2 * MAX_FILENAME];
+    memberOutputPath(batch->output_dir, entry->name, path);
+
+    if (createParentDirectories(path) != 0) {
+        fprintf(stderr, "Erro: Não foi possível criar os diretórios de '%s'\n", path);
+        return;
+    }
+
+    // Cada thread usa seu próprio FILE*: as posições de leitura são independentes
+    // (a saída também é legível para resolver blocos duplicados sem decodificar de novo)
+    FILE* input = fopen(batch->archive_path, "rb");
+    FILE* output = fopen(path, "w+b");
+    if (input == NULL || output == NULL || fseeko(input, (off_t)entry->offset, SEEK_SET) != 0) {
+        fprintf(stderr, "Erro: Não foi possível extrair '%s'\n", entry->name);
+        if (input != NULL) fclose(input);
+        if (output != NULL) fclose(output);
+        return;
+    }
+
+    workspace->readable_output = 1;
+    int result = decompressStreamBlocksWith(input, output, batch->plan, &job->stats, workspace);
+    off_t end = ftello(input);
+
+    if (result == 0 && (job->stats.input_bytes != entry->original_size ||
+                        end < 0 || (uint64_t)end - entry->offset != entry->compressed_size)) {
+        fprintf(stderr, "Erro: Membro '%s' não confere com o diretório\n", entry->name);
+        result = -1;
+    }
+
+    fclose(input);
+    if (fclose(output) != 0) {
+        result = -1;
+    }
+    job->result = result;
+}
+
+/**
+ * Laço de uma thread: processa trabalhos do lote até esgotá-los
+ * @param argument Lote (ArchiveBatch*)
+ */
+static void* archiveWorker(void* argument) {
+    ArchiveBatch* batch = (ArchiveBatch*)argument;
+    BlockWorkspace workspace;
+    initBlockWorkspace(&workspace);
+    workspace.dedup = batch->dedup;
+    workspace.progress = batch->progress;
+    FILE* scratch = batch->archive_path == NULL ? tmpfile() : NULL;
+
+    int index;
+    while ((index = __atomic_fetch_add(&batch->next, 1, __ATOMIC_RELAXED)) < batch->count) {
+        ArchiveJob* job = &batch->jobs[index];
+        if (batch->archive_path == NULL) {
+            compressMember(job, batch, &workspace, scratch);
+        } else {
+            extractMember(job, batch, &workspace);
+        }
+    }
+
+    if (scratch != NULL) {
+        fclose(scratch);
+    }
+    freeBlockWorkspace(&workspace);
+    return NULL;
+}
+
+/**
+ * Executa um lote de trabalhos em paralelo
+ * @param batch Lote
+ * @param threads Número de threads
+ */
+static void runArchiveBatch(ArchiveBatch* batch, int threads) {
+    pthread_t* pool = (pthread_t*)malloc((size_t)threads * sizeof(pthread_t));
+    if (pool == NULL) {
+        fprintf(stderr, "Erro: Falha na alocação de memória para as threads\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // Sem threads extras, a própria thread chamadora processa o lote
+    int started = 0;
+    for (int i = 1; i < threads; i++) {
+        if (pthread_create(&pool[started], NULL, archiveWorker, batch) == 0) {
+            started++;
+        }
+    }
+    archiveWorker(batch);
+
+    for (int i = 0; i < started; i++) {
+        pthread_join(pool[i], NULL);
+    }
+    free(pool);
+}
+
+/**
+ * Copia um trecho do arquivo de espera para o arquivo de saída
+ * @param spool Arquivo de espera
+ * @param offset Início do trecho
+ * @param size Bytes do trecho
+ * @param output Arquivo de saída
+ * @return 0 se sucesso, -1 se erro
+ */
+static int copySpoolRange(FILE* spool, uint64_t offset, uint64_t size, FILE* output) {
+    unsigned char buffer[HISTOGRAM_BUFFER_SIZE];
+
+    if (fseeko(spool, (off_t)offset, SEEK_SET) != 0) {
+        return -1;
+    }
+    for (uint64_t done = 0; done < size;) {
+        size_t wanted = size - done < sizeof(buffer) ? (size_t)(size - done) : sizeof(buffer);
+        if (fread(buffer, 1, wanted, spool) != wanted || fwrite(buffer, 1, wanted, output) != wanted) {
+            return -1;
+        }
+        done += wanted;
+    }
+    return 0;
+}
+
+/**
+ * Verifica se o arquivo começa com a assinatura de arquivo com vários membros
+ * @param filename Nome do arquivo
+ * @return 1 se é um arquivo com vários membros, 0 caso contrário
+ */
+int isArchiveFile(const char* filename) {
+    FILE* file = fopen(filename, "rb");
+    if (file == NULL) {
+        return 0;
+    }
+
+    char magic[ARCHIVE_MAGIC_SIZE];
+    int result = fread(magic, 1, ARCHIVE_MAGIC_SIZE, file) == ARCHIVE_MAGIC_SIZE &&
+                 memcmp(magic, ARCHIVE_MAGIC, ARCHIVE_MAGIC_SIZE) == 0;
+    fclose(file);
+    return result;
+}
+
+/**
+ * Cria um arquivo com vários membros, comprimidos de forma independente e em paralelo
+ * Formato: cabeçalho, contêineres em blocos dos membros, diretório central e rodapé
+ * com o offset do diretório (lido a partir do fim do arquivo).
+ * @param archive_path Arquivo a criar
+ * @param members Caminhos dos membros
+ * @param count Número de membros
+ * @param threads Threads de compressão (0 = processadores disponíveis)
+ * @param plan Plano de memória de cada thread (NULL = plano padrão)
+ * @param dedup 1 para gravar blocos repetidos como referência e compartilhar membros idênticos
+ * @param stats Estatísticas a preencher (pode ser NULL)
+ * @param progress Progresso (NULL = sem relatório; total 0 = soma dos tamanhos dos membros)
+ * @return 0 se sucesso, -1 se erro
+ */
+int createArchive(const char* archive_path, const char** members, int count,
+                  int threads, const MemoryPlan* plan, int dedup, ArchiveStats* stats,
+                  ProgressTracker* progress) {
+    ArchiveStats local_stats;
+    if (stats == NULL) {
+        stats = &local_stats;
+    }
+    memset(stats, 0, sizeof(ArchiveStats));
+
+    if (count <= 0 || count > ARCHIVE_MAX_MEMBERS) {
+        fprintf(stderr, "Erro: Número de membros inválido (1 a %d)\n", ARCHIVE_MAX_MEMBERS);
+        return -1;
+    }
+
+    for (int i = 0; i < count; i++) {
+        const char* name = storedMemberName(members[i]);
+        if (strlen(name) >= MAX_FILENAME || !isSafeMemberName(name)) {
+            fprintf(stderr, "Erro: Nome de membro inválido '%s'\n", members[i]);
+            return -1;
+        }
+    }
+    int repeated = findRepeatedMemberName(members, count);
+    if (repeated >= 0) {
+        fprintf(stderr, "Erro: Membro repetido '%s'\n", members[repeated]);
+        return -1;
+    }
+
+    ArchiveJob* jobs = (ArchiveJob*)calloc((size_t)count, sizeof(ArchiveJob));
+    if (jobs == NULL) {
+        fprintf(stderr, "Erro: Falha na alocação de memória para os membros\n");
+        exit(EXIT_FAILURE);
+    }
+    uint64_t total = 0;
+    for (int i = 0; i < count; i++) {
+        jobs[i].source = members[i];
+        jobs[i].duplicate_of = -1;
+        if (progress != NULL && progress->total == 0) {
+            int64_t size = getFileSize(members[i]);
+            total += size > 0 ? (uint64_t)size : 0;
+        }
+    }
+    if (progress != NULL && progress->total == 0) {
+        progress->total = total;
+    }
+
+    // Os contêineres prontos se acumulam em um único arquivo de espera e são
+    // copiados para o arquivo final na ordem da linha de comando
+    ArchiveBatch batch = { jobs, count, 0, NULL, NULL, plan, dedup, progress, tmpfile(),
+                           PTHREAD_MUTEX_INITIALIZER };
+    if (batch.spool == NULL) {
+        fprintf(stderr, "Erro: Não foi possível criar arquivo temporário\n");
+        free(jobs);
+        return -1;
+    }
+    runArchiveBatch(&batch, resolveThreadCount(threads, count));
+
+    int result = 0;
+    for (int i = 0; i < count; i++) {
+        if (jobs[i].result != 0) {
+            result = -1;
+        }
+    }
+
+    FILE* output = result == 0 ? fopen(archive_path, "wb") : NULL;
+    if (result == 0 && output == NULL) {
+        fprintf(stderr, "Erro: Não foi possível criar '%s'\n", archive_path);
+        result = -1;
+    }
+
+    if (output != NULL) {
+        fwrite(ARCHIVE_MAGIC, 1, ARCHIVE_MAGIC_SIZE, output);
+        fputc(ARCHIVE_FORMAT_VERSION, output);
+        fputc(0, output);
+
+        // Membros na ordem da linha de comando
+        uint64_t offset = ARCHIVE_HEADER_SIZE;
+        uint64_t* offsets = (uint64_t*)malloc((size_t)count * sizeof(uint64_t));
+        uint64_t* sizes = (uint64_t*)malloc((size_t)count * sizeof(uint64_t));
+        if (offsets == NULL || sizes == NULL) {
+            fprintf(stderr, "Erro: Falha na alocação de memória para o diretório\n");
+            exit(EXIT_FAILURE);
+        }
+
+        for (int i = 0; i < count && result == 0; i++) {
+            // Membros idênticos a um anterior apontam para os mesmos dados
+            for (int j = 0; dedup && j < i; j++) {
+                if (jobs[j].duplicate_of < 0 && jobs[j].hash == jobs[i].hash &&
+                    jobs[j].spool_size == jobs[i].spool_size &&
+                    sameSpoolContents(batch.spool, jobs[j].spool_offset, jobs[i].spool_offset,
+                                      jobs[i].spool_size)) {
+                    jobs[i].duplicate_of = j;
+                    break;
+                }
+            }
+            if (jobs[i].duplicate_of >= 0) {
+                offsets[i] = offsets[jobs[i].duplicate_of];
+                sizes[i] = sizes[jobs[i].duplicate_of];
+                stats->duplicate_members++;
+                continue;
+            }
+
+            if (copySpoolRange(batch.spool, jobs[i].spool_offset, jobs[i].spool_size, output) != 0) {
+                result = -1;
+                break;
+            }
+            offsets[i] = offset;
+            sizes[i] = jobs[i].spool_size;
+            offset += jobs[i].spool_size;
+        }
+
+        // Diretório central: nome, tamanho original, offset e tamanho comprimido
+        uint64_t directory_offset = offset;
+        for (int i = 0; i < count && result == 0; i++) {
+            const char* name = storedMemberName(members[i]);
+            uint32_t name_length = (uint32_t)strlen(name);
+            writeUint32(output, name_length);
+            fwrite(name, 1, name_length, output);
+            writeUint64(output, jobs[i].stats.input_bytes);
+            writeUint64(output, offsets[i]);
+            writeUint64(output, sizes[i]);
+        }
+
+        writeUint64(output, directory_offset);
+        writeUint32(output, (uint32_t)count);
+        fwrite(ARCHIVE_MAGIC, 1, ARCHIVE_MAGIC_SIZE, output);
+
+        stats->members = (uint64_t)count;
+        stats->output_bytes = (uint64_t)ftello(output);
+        for (int i = 0; i < count; i++) {
+            stats->input_bytes += jobs[i].stats.input_bytes;
+            if (jobs[i].duplicate_of < 0) {
+                stats->blocks += jobs[i].stats.blocks;
+                stats->dedup_blocks += jobs[i].stats.dedup_blocks;
+            }
+        }
+
+        if (ferror(output)) {
+            result = -1;
+        }
+        if (fclose(output) != 0) {
+            result = -1;
+        }
+        free(offsets);
+        free(sizes);
+    }
+
+    fclose(batch.spool);
+    free(jobs);
+    return result;
+}
+
+/**
+ * Lê o diretório central sem decodificar nenhum membro
+ * @param archive_path Arquivo com vários membros
+ * @param directory Diretório a preencher (liberar com freeArchiveDirectory)
+ * @return 0 se sucesso, -1 se o arquivo é inválido
+ */
+int readArchiveDirectory(const char* archive_path, ArchiveDirectory* directory) {
+    directory->count = 0;
+    directory->entries = NULL;
+
+    FILE* input = fopen(archive_path, "rb");
+    if (input == NULL) {
+        fprintf(stderr, "Erro: Arquivo de entrada '%s' não encontrado\n", archive_path);
+        return -1;
+    }
+
+    char magic[ARCHIVE_MAGIC_SIZE];
+    uint64_t directory_offset;
+    uint32_t count;
+    off_t file_size = -1;
+
+    if (fseeko(input, 0, SEEK_END) == 0) {
+        file_size = ftello(input);
+    }
+
+    int valid = file_size >= ARCHIVE_HEADER_SIZE + ARCHIVE_TRAILER_SIZE &&
+                fseeko(input, -ARCHIVE_TRAILER_SIZE, SEEK_END) == 0 &&
+                readUint64(input, &directory_offset) == 0 &&
+                readUint32(input, &count) == 0 &&
+                fread(magic, 1, ARCHIVE_MAGIC_SIZE, input) == ARCHIVE_MAGIC_SIZE &&
+                memcmp(magic, ARCHIVE_MAGIC, ARCHIVE_MAGIC_SIZE) == 0 &&
+                count <= ARCHIVE_MAX_MEMBERS &&
+                directory_offset <= (uint64_t)(file_size - ARCHIVE_TRAILER_SIZE) &&
+                fseeko(input, (off_t)directory_offset, SEEK_SET) == 0;
+
+    if (!valid) {
+        fprintf(stderr, "Erro: Formato de arquivo inválido\n");
+        fclose(input);
+        return -1;
+    }
+
+    directory->entries = (ArchiveEntry*)calloc(count > 0 ? count : 1, sizeof(ArchiveEntry));
+    if (directory->entries == NULL) {
+        fprintf(stderr, "Erro: Falha na alocação de memória para o diretório\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        ArchiveEntry* entry = &directory->entries[i];
+        uint32_t name_length;
+
+        if (readUint32(input, &name_length) != 0 || name_length == 0 || name_length >= MAX_FILENAME ||
+            fread(entry->name, 1, name_length, input) != name_length ||
+            readUint64(input, &entry->original_size) != 0 ||
+            readUint64(input, &entry->offset) != 0 ||
+            readUint64(input, &entry->compressed_size) != 0 ||
+            entry->offset + entry->compressed_size > directory_offset) {
+            fprintf(stderr, "Erro: Diretório central corrompido (membro %u)\n", i);
+            freeArchiveDirectory(directory);
+            fclose(input);
+            return -1;
+        }
+        entry->name[name_length] = '\0';
+    }
+
+    directory->count = count;
+    fclose(input);
+    return 0;
+}
+
+/**
+ * Libera o diretório central
+ * @param directory Diretório
+ */
+void freeArchiveDirectory(ArchiveDirectory* directory) {
+    free(directory->entries);
+    directory->entries = NULL;
+    directory->count = 0;
+}
+
+/**
+ * Imprime os membros do arquivo com seus tamanhos
+ * @param directory Diretório central
+ */
+void printArchiveDirectory(const ArchiveDirectory* directory) {
+    uint64_t total_original = 0;
+    uint64_t total_compressed = 0;
+
+    printf("%12s %12s %7s  %s\n", "Original", "Comprimido", "Taxa", "Nome");
+    for (uint32_t i = 0; i < directory->count; i++) {
+        const ArchiveEntry* entry = &directory->entries[i];
+        double ratio = entry->original_size > 0
+                       ? (1.0 - (double)entry->compressed_size / entry->original_size) * 100.0 : 0.0;
+        printf("%12llu %12llu %6.1f%%  %s\n", (unsigned long long)entry->original_size,
+               (unsigned long long)entry->compressed_size, ratio, entry->name);
+        total_original += entry->original_size;
+        total_compressed += entry->compressed_size;
+    }
+    printf("%12llu %12llu %7s  %u membros\n", (unsigned long long)total_original,
+           (unsigned long long)total_compressed, "", directory->count);
+}
+
+/**
+ * Imprime as estatísticas da criação de um arquivo
+ * @param stats Estatísticas
+ */
+void printArchiveStats(const ArchiveStats* stats) {
+    printf("\n=== Estatísticas do Arquivo ===\n");
+    printf("Membros: %llu (%llu idênticos a um anterior)\n",
+           (unsigned long long)stats->members, (unsigned long long)stats->duplicate_members);
+    printf("Blocos: %llu (%llu duplicados", (unsigned long long)stats->blocks,
+           (unsigned long long)stats->dedup_blocks);
+    if (stats->blocks > 0) {
+        printf(", %.1f%%", 100.0 * stats->dedup_blocks / stats->blocks);
+    }
+    printf(")\n");
+    printf("Bytes originais: %llu\n", (unsigned long long)stats->input_bytes);
+    printf("Bytes do arquivo: %llu\n", (unsigned long long)stats->output_bytes);
+}
+
+/**
+ * Extrai membros do arquivo em paralelo, cada um a partir do seu offset
+ * @param archive_path Arquivo com vários membros
+ * @param members Nomes a extrair (NULL ou count = 0 extrai todos)
+ * @param count Número de nomes
+ * @param output_dir Diretório de destino (NULL = diretório atual)
+ * @param threads Threads de extração (0 = processadores disponíveis)
+ * @param plan Plano de memória de cada thread (NULL = sem limite)
+ * @param progress Progresso (NULL = sem relatório; total 0 = bytes comprimidos dos membros)
+ * @return 0 se sucesso, -1 se erro
+ */
+int extractArchive(const char* archive_path, const char** members, int count,
+                   const char* output_dir, int threads, const MemoryPlan* plan,
+                   ProgressTracker* progress) {
+    ArchiveDirectory directory;
+    if (readArchiveDirectory(archive_path, &directory) != 0) {
+        return -1;
+    }
+
+    ArchiveJob* jobs = (ArchiveJob*)calloc(directory.count > 0 ? directory.count : 1, sizeof(ArchiveJob));
+    if (jobs == NULL) {
+        fprintf(stderr, "Erro: Falha na alocação de memória para os membros\n");
+        exit(EXIT_FAILURE);
+    }
+
+    int selected = 0;
+    int result = 0;
+    for (uint32_t i = 0; i < directory.count; i++) {
+        int wanted = members == NULL || count == 0;
+        for (int j = 0; j < count && !wanted; j++) {
+            wanted = strcmp(storedMemberName(members[j]), directory.entries[i].name) == 0;
+        }
+        if (!wanted) {
+            continue;
+        }
+        if (!isSafeMemberName(directory.entries[i].name)) {
+            fprintf(stderr, "Erro: Nome de membro inseguro '%s'\n", directory.entries[i].name);
+            result = -1;
+            continue;
+        }
+        jobs[selected].entry = &directory.entries[i];
+        jobs[selected].duplicate_of = -1;
+        selected++;
+    }
+
+    // Membros que compartilham os dados são decodificados uma vez e depois copiados
+    int unique = 0;
+    for (int i = 0; i < selected; i++) {
+        int original = -1;
+        for (int j = 0; j < unique && original < 0; j++) {
+            if (jobs[j].entry->offset == jobs[i].entry->offset) {
+                original = j;
+            }
+        }
+        ArchiveJob job = jobs[i];
+        if (original < 0) {
+            jobs[i] = jobs[unique];
+            jobs[unique++] = job;
+        } else {
+            jobs[i].duplicate_of = original;
+        }
+    }
+
+    // Nomes pedidos que não estão no diretório
+    for (int j = 0; j < count; j++) {
+        int found = 0;
+        for (uint32_t i = 0; i < directory.count && !found; i++) {
+            found = strcmp(storedMemberName(members[j]), directory.entries[i].name) == 0;
+        }
+        if (!found) {
+            fprintf(stderr, "Erro: Membro '%s' não encontrado\n", members[j]);
+            result = -1;
+        }
+    }
+
+    // O progresso conta os bytes comprimidos dos membros decodificados
+    if (progress != NULL && progress->total == 0) {
+        for (int i = 0; i < unique; i++) {
+            progress->total += jobs[i].entry->compressed_size;
+        }
+    }
+
+    if (unique > 0) {
+        ArchiveBatch batch = { jobs, unique, 0, archive_path, output_dir, plan, 0, progress, NULL,
+                               PTHREAD_MUTEX_INITIALIZER };
+        runArchiveBatch(&batch, resolveThreadCount(threads, unique));
+
+        for (int i = 0; i < unique; i++) {
+            if (jobs[i].result != 0) {
+                result = -1;
+            }
+        }
+    }
+
+    for (int i = unique; i < selected; i++) {
+        const ArchiveJob* original = &jobs[jobs[i].duplicate_of];
+        char source[2 * MAX_FILENAME];
+        char destination[2 * MAX_FILENAME];
+        memberOutputPath(output_dir, original->entry->name, source);
+        memberOutputPath(output_dir, jobs[i].entry->name, destination);
+
+        // Um nome repetido já foi extraído: copiar sobre si mesmo truncaria o arquivo
+        if (original->result == 0 && strcmp(source, destination) == 0) {
+            continue;
+        }
+        if (original->result != 0 || copyExtractedFile(source, destination) != 0) {
+            fprintf(stderr, "Erro: Não foi possível extrair '%s'\n", jobs[i].entry->name);
+            result = -1;
+        }
+    }
+
+    free(jobs);
+    freeArchiveDirectory(&directory);
+    return result;
+}
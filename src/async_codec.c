@@ -0,0 +1,541 @@
+#define _POSIX_C_SOURCE 200809L
+#include "async_codec.h"
+#include "memory_output.h"
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/eventfd.h>
+#endif
+
+/**
+ * Retorna o tempo monotônico atual em microssegundos
+ */
+static uint64_t nowMicroseconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+}
+
+/**
+ * Cria o descritor que sinaliza conclusões: eventfd no Linux e, nos demais
+ * sistemas, um pipe não bloqueante
+ * @param pool Conjunto de threads
+ * @return 0 se sucesso, -1 se erro
+ */
+static int openNotification(AsyncPool* pool) {
+#ifdef __linux__
+    pool->notify_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    pool->notify_write_fd = pool->notify_fd;
+    return pool->notify_fd >= 0 ? 0 : -1;
+#else
+    int fds[2];
+    if (pipe(fds) != 0) {
+        return -1;
+    }
+    for (int i = 0; i < 2; i++) {
+        fcntl(fds[i], F_SETFL, fcntl(fds[i], F_GETFL) | O_NONBLOCK);
+        fcntl(fds[i], F_SETFD, FD_CLOEXEC);
+    }
+    pool->notify_fd = fds[0];
+    pool->notify_write_fd = fds[1];
+    return 0;
+#endif
+}
+
+/**
+ * Torna o descritor de conclusões legível (chamada com a trava)
+ * Com o pipe cheio a escrita falha, mas o descritor já está legível.
+ * @param pool Conjunto de threads
+ */
+static void raiseNotification(AsyncPool* pool) {
+    uint64_t one = 1;
+    ssize_t written = write(pool->notify_write_fd, &one, pool->notify_fd == pool->notify_write_fd ? 8 : 1);
+    (void)written;
+}
+
+/**
+ * Consome as notificações pendentes quando a fila de conclusões esvazia
+ * (chamada com a trava; nenhuma conclusão anterior pode ser perdida)
+ * @param pool Conjunto de threads
+ */
+static void clearNotification(AsyncPool* pool) {
+    uint64_t drain[8];
+    while (read(pool->notify_fd, drain, sizeof(drain)) > 0) {
+    }
+}
+
+/**
+ * Acrescenta um trabalho ao fim de uma fila encadeada
+ * @param head Início da fila
+ * @param tail Fim da fila
+ * @param job Trabalho
+ */
+static void appendJob(AsyncJob** head, AsyncJob** tail, AsyncJob* job) {
+    job->next = NULL;
+    if (*tail != NULL) {
+        (*tail)->next = job;
+    } else {
+        *head = job;
+    }
+    *tail = job;
+}
+
+/**
+ * Entrega um trabalho concluído: chama o callback (sem a trava) ou coloca o
+ * trabalho na fila de conclusões e sinaliza o descritor
+ * O trabalho só deixa de contar como em execução depois de entregue, para
+ * que nextAsyncCompletion não desista de esperar antes da entrega.
+ * @param pool Conjunto de threads
+ * @param job Trabalho com a situação final já definida
+ * @param was_running 1 se o trabalho foi executado por uma thread
+ */
+static void deliverJob(AsyncPool* pool, AsyncJob* job, int was_running) {
+    if (job->callback != NULL) {
+        job->callback(job, job->context);
+        pthread_mutex_lock(&pool->mutex);
+    } else {
+        pthread_mutex_lock(&pool->mutex);
+        appendJob(&pool->done_head, &pool->done_tail, job);
+        raiseNotification(pool);
+    }
+    pool->running -= (size_t)was_running;
+    pthread_cond_broadcast(&pool->job_done);
+    pthread_mutex_unlock(&pool->mutex);
+}
+
+/**
+ * Registra a situação final de um trabalho (chamada com a trava)
+ * @param pool Conjunto de threads
+ * @param job Trabalho
+ * @param status ASYNC_DONE, ASYNC_FAILED ou ASYNC_CANCELLED
+ */
+static void finishJob(AsyncPool* pool, AsyncJob* job, AsyncStatus status) {
+    __atomic_store_n(&job->status, (int)status, __ATOMIC_RELEASE);
+    if (status == ASYNC_DONE) {
+        pool->stats.completed++;
+    } else if (status == ASYNC_FAILED) {
+        pool->stats.failed++;
+    } else {
+        pool->stats.cancelled++;
+    }
+}
+
+/**
+ * Executa um trabalho com os buffers de uma thread
+ * Descritores são duplicados, então os do chamador continuam abertos. A saída
+ * em buffer é contabilizada no limite de memória e, com um plano sob limite,
+ * não passa de plan.limit bytes (senão o trabalho falha).
+ * @param pool Conjunto de threads
+ * @param workspace Espaço de trabalho da thread
+ * @param job Trabalho
+ * @return 0 se sucesso, -1 se erro ou cancelamento
+ */
+static int runAsyncJob(AsyncPool* pool, BlockWorkspace* workspace, AsyncJob* job) {
+    // fmemopen não aceita buffers vazios: a entrada vazia usa um byte lido como fim imediato
+    static unsigned char empty_input = 0;
+    FILE* input = NULL;
+    FILE* output = NULL;
+    MemoryOutput collected;
+    memset(&collected, 0, sizeof(collected));
+
+    if (job->input_fd >= 0) {
+        int fd = dup(job->input_fd);
+        input = fd >= 0 ? fdopen(fd, "rb") : NULL;
+        if (input == NULL && fd >= 0) {
+            close(fd);
+        }
+    } else {
+        input = fmemopen(job->input_size > 0 ? (void*)job->input : &empty_input,
+                         job->input_size > 0 ? job->input_size : 1, "rb");
+        if (input != NULL && job->input_size == 0) {
+            fseeko(input, 0, SEEK_END);
+        }
+    }
+
+    if (job->output_fd >= 0) {
+        int fd = dup(job->output_fd);
+        output = fd >= 0 ? fdopen(fd, "wb") : NULL;
+        if (output == NULL && fd >= 0) {
+            close(fd);
+        }
+    } else {
+        output = openMemoryOutput(&collected, pool->plan.limit);
+    }
+
+    int result = -1;
+    if (input != NULL && output != NULL) {
+        workspace->level = job->level;
+        workspace->cancel = &job->cancel;
+        result = job->operation == ASYNC_COMPRESS ?
+                 compressStreamBlocksWith(input, output, &pool->plan, &job->stats, workspace) :
+                 decompressStreamBlocksWith(input, output, &pool->plan, &job->stats, workspace);
+        workspace->cancel = NULL;
+    } else {
+        fprintf(stderr, "Erro: Não foi possível abrir a entrada ou a saída do trabalho %llu: %s\n",
+                (unsigned long long)job->id, strerror(errno));
+    }
+
+    if (input != NULL) {
+        fclose(input);
+    }
+    if (output != NULL && fclose(output) != 0) {
+        result = -1;
+    }
+
+    if (collected.exceeded) {
+        fprintf(stderr, "Erro: A saída do trabalho %llu excede o limite de memória\n",
+                (unsigned long long)job->id);
+    }
+
+    // O buffer de uma operação que falhou não é entregue
+    if (result == 0 && job->output_fd < 0) {
+        job->output_size = collected.size;
+        job->output = takeMemoryOutput(&collected);
+        if (job->output == NULL && job->output_size > 0) {
+            fprintf(stderr, "Erro: Falha na alocação de memória para a saída do trabalho %llu\n",
+                    (unsigned long long)job->id);
+            job->output_size = 0;
+            result = -1;
+        }
+    }
+    freeMemoryOutput(&collected);
+    return result;
+}
+
+/**
+ * Laço de uma thread de trabalho: executa trabalhos da fila de entrada até
+ * a parada do conjunto
+ * @param argument Estado da thread (AsyncWorker*)
+ * @return NULL
+ */
+static void* asyncWorkerMain(void* argument) {
+    AsyncWorker* worker = (AsyncWorker*)argument;
+    AsyncPool* pool = worker->pool;
+
+    pthread_mutex_lock(&pool->mutex);
+    for (;;) {
+        while (pool->pending_head == NULL && !pool->stopping) {
+            pthread_cond_wait(&pool->job_ready, &pool->mutex);
+        }
+        AsyncJob* job = pool->pending_head;
+        if (job == NULL) {
+            break;
+        }
+        pool->pending_head = job->next;
+        if (pool->pending_head == NULL) {
+            pool->pending_tail = NULL;
+        }
+        pool->pending_count--;
+        pool->running++;
+        worker->current = job;
+        __atomic_store_n(&job->status, ASYNC_RUNNING, __ATOMIC_RELEASE);
+        pthread_mutex_unlock(&pool->mutex);
+
+        uint64_t start = nowMicroseconds();
+        int result = runAsyncJob(pool, &worker->workspace, job);
+        job->latency_us = nowMicroseconds() - start;
+
+        // A situação final é definida com a trava: um cancelamento
+        // concorrente vê o trabalho em execução ou já concluído
+        pthread_mutex_lock(&pool->mutex);
+        worker->current = NULL;
+        finishJob(pool, job, result == 0 ? ASYNC_DONE :
+                  __atomic_load_n(&job->cancel, __ATOMIC_ACQUIRE) ? ASYNC_CANCELLED : ASYNC_FAILED);
+        pthread_mutex_unlock(&pool->mutex);
+
+        deliverJob(pool, job, 1);
+        pthread_mutex_lock(&pool->mutex);
+    }
+    pthread_mutex_unlock(&pool->mutex);
+    return NULL;
+}
+
+/**
+ * Cria um conjunto de threads para trabalhos assíncronos
+ * @param workers Número de threads de trabalho (1 a ASYNC_MAX_WORKERS)
+ * @param queue_depth Trabalhos aceitos aguardando uma thread (0 = ASYNC_DEFAULT_QUEUE_DEPTH)
+ * @param plan Plano de memória de cada thread (NULL = plano padrão)
+ * @return Conjunto criado, ou NULL se erro
+ */
+AsyncPool* createAsyncPool(int workers, size_t queue_depth, const MemoryPlan* plan) {
+    if (workers < 1 || workers > ASYNC_MAX_WORKERS) {
+        fprintf(stderr, "Erro: Número de threads inválido (1 a %d)\n", ASYNC_MAX_WORKERS);
+        return NULL;
+    }
+    if (queue_depth > ASYNC_MAX_QUEUE_DEPTH) {
+        fprintf(stderr, "Erro: Profundidade de fila inválida (até %d)\n", ASYNC_MAX_QUEUE_DEPTH);
+        return NULL;
+    }
+
+    AsyncPool* pool = (AsyncPool*)calloc(1, sizeof(AsyncPool));
+    if (pool == NULL) {
+        fprintf(stderr, "Erro: Falha na alocação de memória para as threads\n");
+        exit(EXIT_FAILURE);
+    }
+    if (plan != NULL) {
+        pool->plan = *plan;
+    } else {
+        planMemoryBudget(0, &pool->plan);
+    }
+    pool->queue_depth = queue_depth > 0 ? queue_depth : ASYNC_DEFAULT_QUEUE_DEPTH;
+
+    if (openNotification(pool) != 0) {
+        fprintf(stderr, "Erro: Não foi possível criar o descritor de notificação: %s\n", strerror(errno));
+        free(pool);
+        return NULL;
+    }
+    pthread_mutex_init(&pool->mutex, NULL);
+    pthread_cond_init(&pool->job_ready, NULL);
+    pthread_cond_init(&pool->job_done, NULL);
+
+    for (; pool->workers < workers; pool->workers++) {
+        AsyncWorker* worker = &pool->slots[pool->workers];
+        worker->pool = pool;
+        initBlockWorkspace(&worker->workspace);
+        if (pthread_create(&worker->thread, NULL, asyncWorkerMain, worker) != 0) {
+            fprintf(stderr, "Erro: Não foi possível criar a thread %d\n", pool->workers);
+            destroyAsyncPool(pool);
+            return NULL;
+        }
+    }
+    return pool;
+}
+
+/**
+ * Encerra um conjunto de threads
+ * Trabalhos na fila são cancelados e os em execução recebem o pedido de
+ * cancelamento; todos são entregues antes do retorno. Trabalhos sem callback
+ * ainda não retirados da fila de conclusões são liberados.
+ * @param pool Conjunto de threads (pode ser NULL)
+ */
+void destroyAsyncPool(AsyncPool* pool) {
+    if (pool == NULL) {
+        return;
+    }
+
+    pthread_mutex_lock(&pool->mutex);
+    pool->stopping = 1;
+    AsyncJob* pending = pool->pending_head;
+    pool->pending_head = NULL;
+    pool->pending_tail = NULL;
+    pool->pending_count = 0;
+    for (int i = 0; i < pool->workers; i++) {
+        if (pool->slots[i].current != NULL) {
+            __atomic_store_n(&pool->slots[i].current->cancel, 1, __ATOMIC_RELEASE);
+        }
+    }
+    for (AsyncJob* job = pending; job != NULL; job = job->next) {
+        finishJob(pool, job, ASYNC_CANCELLED);
+    }
+    pthread_cond_broadcast(&pool->job_ready);
+    pthread_mutex_unlock(&pool->mutex);
+
+    while (pending != NULL) {
+        AsyncJob* next = pending->next;
+        deliverJob(pool, pending, 0);
+        pending = next;
+    }
+
+    for (int i = 0; i < pool->workers; i++) {
+        pthread_join(pool->slots[i].thread, NULL);
+        freeBlockWorkspace(&pool->slots[i].workspace);
+    }
+
+    while (pool->done_head != NULL) {
+        AsyncJob* next = pool->done_head->next;
+        freeAsyncJob(pool->done_head);
+        pool->done_head = next;
+    }
+
+    close(pool->notify_fd);
+    if (pool->notify_write_fd != pool->notify_fd) {
+        close(pool->notify_write_fd);
+    }
+    pthread_cond_destroy(&pool->job_done);
+    pthread_cond_destroy(&pool->job_ready);
+    pthread_mutex_destroy(&pool->mutex);
+    free(pool);
+}
+
+/**
+ * Retorna o descritor a observar (poll/epoll) para saber de conclusões
+ * Fica legível enquanto a fila de conclusões tem trabalhos; basta chamar
+ * nextAsyncCompletion até receber NULL, sem ler o descritor.
+ * @param pool Conjunto de threads
+ * @return Descritor de leitura
+ */
+int asyncCompletionFd(const AsyncPool* pool) {
+    return pool->notify_fd;
+}
+
+/**
+ * Copia os contadores de um conjunto de threads
+ * @param pool Conjunto de threads
+ * @param stats Destino
+ */
+void getAsyncPoolStats(AsyncPool* pool, AsyncPoolStats* stats) {
+    pthread_mutex_lock(&pool->mutex);
+    *stats = pool->stats;
+    pthread_mutex_unlock(&pool->mutex);
+}
+
+/**
+ * Cria um trabalho sobre um buffer na memória, com saída em buffer
+ * @param operation ASYNC_COMPRESS ou ASYNC_DECOMPRESS
+ * @param input Dados de entrada (mantidos pelo chamador até a conclusão)
+ * @param input_size Bytes de entrada
+ * @return Trabalho (liberar com freeAsyncJob)
+ */
+AsyncJob* createAsyncBufferJob(AsyncOperation operation, const unsigned char* input, size_t input_size) {
+    AsyncJob* job = (AsyncJob*)calloc(1, sizeof(AsyncJob));
+    if (job == NULL) {
+        fprintf(stderr, "Erro: Falha na alocação de memória para o trabalho\n");
+        exit(EXIT_FAILURE);
+    }
+    job->operation = operation;
+    job->input = input;
+    job->input_size = input_size;
+    job->input_fd = -1;
+    job->output_fd = -1;
+    return job;
+}
+
+/**
+ * Cria um trabalho sobre descritores (arquivos, pipes ou sockets bloqueantes)
+ * @param operation ASYNC_COMPRESS ou ASYNC_DECOMPRESS
+ * @param input_fd Descritor de entrada
+ * @param output_fd Descritor de saída (-1 = resultado em buffer)
+ * @return Trabalho (liberar com freeAsyncJob), ou NULL se o descritor de entrada é inválido
+ */
+AsyncJob* createAsyncFdJob(AsyncOperation operation, int input_fd, int output_fd) {
+    if (input_fd < 0) {
+        fprintf(stderr, "Erro: Descritor de entrada inválido\n");
+        return NULL;
+    }
+    AsyncJob* job = createAsyncBufferJob(operation, NULL, 0);
+    job->input_fd = input_fd;
+    job->output_fd = output_fd;
+    return job;
+}
+
+/**
+ * Libera um trabalho concluído (ou nunca submetido) e o seu resultado
+ * @param job Trabalho (pode ser NULL)
+ */
+void freeAsyncJob(AsyncJob* job) {
+    if (job == NULL) {
+        return;
+    }
+    free(job->output);
+    free(job);
+}
+
+/**
+ * Submete um trabalho sem bloquear
+ * Com a fila de entrada cheia o trabalho não é aceito (contrapressão): o
+ * chamador mantém o trabalho e tenta de novo depois de uma conclusão.
+ * @param pool Conjunto de threads
+ * @param job Trabalho ainda não submetido
+ * @return 0 se aceito, 1 se a fila está cheia, -1 se o conjunto está sendo encerrado
+ */
+int submitAsyncJob(AsyncPool* pool, AsyncJob* job) {
+    pthread_mutex_lock(&pool->mutex);
+    if (pool->stopping) {
+        pthread_mutex_unlock(&pool->mutex);
+        fprintf(stderr, "Erro: Conjunto de threads em encerramento\n");
+        return -1;
+    }
+    if (pool->pending_count >= pool->queue_depth) {
+        pool->stats.rejected++;
+        pthread_mutex_unlock(&pool->mutex);
+        return 1;
+    }
+
+    job->id = ++pool->next_id;
+    job->cancel = 0;
+    job->status = ASYNC_PENDING;
+    appendJob(&pool->pending_head, &pool->pending_tail, job);
+    pool->pending_count++;
+    pool->stats.submitted++;
+    if (pool->pending_count > pool->stats.max_queued) {
+        pool->stats.max_queued = pool->pending_count;
+    }
+    pthread_cond_signal(&pool->job_ready);
+    pthread_mutex_unlock(&pool->mutex);
+    return 0;
+}
+
+/**
+ * Cancela um trabalho submetido
+ * Um trabalho na fila sai dela e é entregue imediatamente como cancelado;
+ * um trabalho em execução para no próximo bloco e é entregue pela sua thread.
+ * @param pool Conjunto de threads
+ * @param job Trabalho submetido e ainda não liberado
+ * @return 0 se o cancelamento foi feito ou pedido, -1 se o trabalho já terminou
+ */
+int cancelAsyncJob(AsyncPool* pool, AsyncJob* job) {
+    pthread_mutex_lock(&pool->mutex);
+    int status = __atomic_load_n(&job->status, __ATOMIC_ACQUIRE);
+    if (status == ASYNC_RUNNING) {
+        __atomic_store_n(&job->cancel, 1, __ATOMIC_RELEASE);
+        pthread_mutex_unlock(&pool->mutex);
+        return 0;
+    }
+    if (status != ASYNC_PENDING) {
+        pthread_mutex_unlock(&pool->mutex);
+        return -1;
+    }
+
+    AsyncJob** link = &pool->pending_head;
+    AsyncJob* previous = NULL;
+    while (*link != NULL && *link != job) {
+        previous = *link;
+        link = &(*link)->next;
+    }
+    if (*link == NULL) {
+        // Trabalho nunca submetido a este conjunto
+        pthread_mutex_unlock(&pool->mutex);
+        return -1;
+    }
+    *link = job->next;
+    if (pool->pending_tail == job) {
+        pool->pending_tail = previous;
+    }
+    pool->pending_count--;
+    __atomic_store_n(&job->cancel, 1, __ATOMIC_RELEASE);
+    finishJob(pool, job, ASYNC_CANCELLED);
+    pthread_mutex_unlock(&pool->mutex);
+
+    deliverJob(pool, job, 0);
+    return 0;
+}
+
+/**
+ * Retira o próximo trabalho da fila de conclusões (só trabalhos sem callback)
+ * @param pool Conjunto de threads
+ * @param wait 1 para esperar enquanto há trabalhos na fila ou em execução
+ * @return Trabalho concluído (liberar com freeAsyncJob), ou NULL se não há
+ */
+AsyncJob* nextAsyncCompletion(AsyncPool* pool, int wait) {
+    pthread_mutex_lock(&pool->mutex);
+    while (pool->done_head == NULL && wait && (pool->pending_count > 0 || pool->running > 0)) {
+        pthread_cond_wait(&pool->job_done, &pool->mutex);
+    }
+
+    AsyncJob* job = pool->done_head;
+    if (job != NULL) {
+        pool->done_head = job->next;
+        if (pool->done_head == NULL) {
+            pool->done_tail = NULL;
+        }
+        job->next = NULL;
+    }
+    if (pool->done_head == NULL) {
+        clearNotification(pool);
+    }
+    pthread_mutex_unlock(&pool->mutex);
+    return job;
+}
@@ -0,0 +1,2629 @@
+#define _POSIX_C_SOURCE 200809L
+#include "block_format.h"
+#include "huffman_algorithm.h"
+#include "code_table.h"
+#include "decode_table.h"
+#include <string.h>
+#include <pthread.h>
+
+/**
+ * Verifica se o arquivo aberto começa com o cabeçalho do formato em blocos
+ * (a posição de leitura é restaurada)
+ * @param input Arquivo de entrada
+ * @return 1 se é um contêiner em blocos, 0 caso contrário
+ */
+int isBlockContainer(FILE* input) {
+    char magic[BLOCK_MAGIC_SIZE];
+    off_t position = ftello(input);
+    size_t bytes_read = fread(magic, 1, BLOCK_MAGIC_SIZE, input);
+
+    if (position >= 0) {
+        fseeko(input, position, SEEK_SET);
+    }
+
+    return bytes_read == BLOCK_MAGIC_SIZE && memcmp(magic, BLOCK_MAGIC, BLOCK_MAGIC_SIZE) == 0;
+}
+
+/**
+ * Verifica se um arquivo está no formato em blocos
+ * @param filename Nome do arquivo
+ * @return 1 se é um contêiner em blocos, 0 caso contrário
+ */
+int isBlockContainerFile(const char* filename) {
+    FILE* file = fopen(filename, "rb");
+    if (file == NULL) {
+        return 0;
+    }
+
+    int result = isBlockContainer(file);
+    fclose(file);
+    return result;
+}
+
+/**
+ * Lê até capacity bytes, repetindo a leitura até encher o bloco ou o arquivo terminar
+ * @param input Arquivo de entrada
+ * @param buffer Destino
+ * @param capacity Bytes desejados
+ * @return Bytes lidos (0 no fim do arquivo)
+ */
+static size_t readBlock(FILE* input, unsigned char* buffer, size_t capacity) {
+    size_t total = 0;
+    while (total < capacity) {
+        size_t bytes_read = fread(buffer + total, 1, capacity - total, input);
+        if (bytes_read == 0) {
+            break;
+        }
+        total += bytes_read;
+    }
+    return total;
+}
+
+// Estratégias dos níveis: os baixos aumentam o bloco, amostram o histograma,
+// repetem a árvore anterior e limitam os códigos à janela da tabela de
+// decodificação; os altos avaliam o custo de cada bloco e procuram a melhor
+// divisão da janela em blocos menores
+static const LevelStrategy level_strategies[COMPRESSION_LEVEL_MAX] = {
+    // nível, bloco, amostra, repete, limite, custo, divisão
+    { 1, 1, 3, 1, DECODE_TABLE_BITS, 0, 0 },
+    { 2, 1, 2, 1, DECODE_TABLE_BITS, 0, 0 },
+    { 3, 1, 1, 1, 12, 0, 0 },
+    { 4, 1, 0, 1, 15, 0, 0 },
+    { 5, 0, 0, 1, 0, 0, 0 },
+    { 6, 0, 0, 0, 0, 0, 0 },
+    { 7, 0, 0, 0, 0, 1, 64 * 1024 },
+    { 8, 0, 0, 0, 0, 1, 32 * 1024 },
+    { 9, 0, 0, 0, 0, 1, 16 * 1024 }
+};
+
+/**
+ * Obtém a estratégia de um nível de compressão
+ * @param level Nível (COMPRESSION_LEVEL_MIN a COMPRESSION_LEVEL_MAX, 0 = padrão)
+ * @param strategy Estratégia a preencher
+ * @return 0 se sucesso, -1 se o nível é inválido
+ */
+int getLevelStrategy(int level, LevelStrategy* strategy) {
+    if (level == 0) {
+        level = COMPRESSION_LEVEL_DEFAULT;
+    }
+    if (level < COMPRESSION_LEVEL_MIN || level > COMPRESSION_LEVEL_MAX) {
+        fprintf(stderr, "Erro: Nível de compressão inválido %d (%d a %d)\n",
+                level, COMPRESSION_LEVEL_MIN, COMPRESSION_LEVEL_MAX);
+        return -1;
+    }
+
+    *strategy = level_strategies[level - 1];
+    return 0;
+}
+
+/**
+ * Conta as frequências de um bloco, exatas ou amostradas; na amostra, cada
+ * byte recebe ao menos 1 para que símbolos não vistos continuem codificáveis
+ * @param data Bytes do bloco
+ * @param length Tamanho do bloco
+ * @param sample_shift Conta 1 de cada 2^sample_shift trechos (0 = todos os bytes)
+ * @param frequencies Tabela de frequências zerada
+ */
+static void countBlockFrequencies(const unsigned char* data, size_t length, int sample_shift,
+                                  unsigned long* frequencies) {
+    if (sample_shift == 0) {
+        countFrequencies(data, length, frequencies);
+        return;
+    }
+
+    size_t step = (size_t)LEVEL_SAMPLE_STRIDE << sample_shift;
+    for (size_t start = 0; start < length; start += step) {
+        size_t chunk = length - start < LEVEL_SAMPLE_STRIDE ? length - start : LEVEL_SAMPLE_STRIDE;
+        countFrequencies(data + start, chunk, frequencies);
+    }
+
+    for (int c = 0; c < MAX_CHAR; c++) {
+        frequencies[c] = (frequencies[c] << sample_shift) + 1;
+    }
+}
+
+/**
+ * Calcula o custo em bytes de um bloco (cabeçalho incluído), escolhendo entre
+ * a árvore ótima e o bloco sem codificação
+ * @param frequencies Frequências exatas do bloco
+ * @param length Tamanho do bloco
+ * @return Bytes que o bloco ocupará no contêiner
+ */
+static uint64_t blockCost(const unsigned long* frequencies, size_t length) {
+    int leaves;
+    uint64_t bits = huffmanCostBits(frequencies, &leaves);
+
+    // Árvore serializada: 2 bytes por folha e 1 por nó interno (mesma conta de writeBlock);
+    // cada bloco também custa o cabeçalho e uma entrada no índice do fim
+    uint64_t payload = (uint64_t)(3 * leaves - 1) + (bits + 7) / 8;
+    return 9 + 8 + (payload < length ? payload : length);
+}
+
+/**
+ * Calcula os bits que a árvore de uma tabela gastaria com outras frequências
+ * @param tables Tabelas de um bloco anterior
+ * @param frequencies Frequências do bloco atual
+ * @return Bits do fluxo codificado (UINT64_MAX se algum símbolo não tem código)
+ */
+static uint64_t tableCostBits(CachedTables* tables, const unsigned long* frequencies) {
+    const CodeTable* table = cachedCodeTable(tables);
+    if (table == NULL) {
+        return UINT64_MAX;
+    }
+
+    uint64_t total = 0;
+    for (int c = 0; c < MAX_CHAR; c++) {
+        if (frequencies[c] > 0) {
+            if (table->length[c] == 0) {
+                return UINT64_MAX;
+            }
+            total += (uint64_t)frequencies[c] * table->length[c];
+        }
+    }
+    return total;
+}
+
+/**
+ * Calcula a profundidade de uma árvore
+ * @param root Raiz da árvore
+ * @return Maior comprimento de código da árvore
+ */
+static int treeDepth(HuffmanNode* root) {
+    if (root == NULL || isLeaf(root)) {
+        return 0;
+    }
+    int left = treeDepth(root->left);
+    int right = treeDepth(root->right);
+    return 1 + (left > right ? left : right);
+}
+
+/**
+ * Constrói a árvore de Huffman com códigos de no máximo max_length bits:
+ * enquanto a árvore for profunda demais, as frequências são achatadas
+ * (f = f/2 + 1) e a árvore é reconstruída
+ * @param frequencies Tabela de frequências (não é alterada)
+ * @param max_length Limite de comprimento (0 = sem limite)
+ * @return Raiz da árvore
+ */
+static HuffmanNode* buildLimitedTree(const unsigned long* frequencies, int max_length) {
+    unsigned long weights[MAX_CHAR];
+    memcpy(weights, frequencies, sizeof(weights));
+
+    for (;;) {
+        HuffmanNode* root = buildHuffmanTree(weights);
+        if (max_length == 0 || treeDepth(root) <= max_length) {
+            return root;
+        }
+        freeHuffmanTree(root);
+
+        for (int c = 0; c < MAX_CHAR; c++) {
+            if (weights[c] > 0) {
+                weights[c] = weights[c] / 2 + 1;
+            }
+        }
+    }
+}
+
+/**
+ * Garante o buffer do bloco transformado, com a capacidade dos demais
+ * @param workspace Espaço de trabalho com buffers já reservados
+ * @return 0 se sucesso, -1 se o limite de memória foi excedido
+ */
+static int reserveTransformBuffer(BlockWorkspace* workspace) {
+    if (workspace->transformed == NULL && workspace->capacity > 0) {
+        workspace->transformed = (unsigned char*)budgetMalloc(workspace->capacity);
+    }
+    return workspace->transformed != NULL ? 0 : -1;
+}
+
+/**
+ * Garante o histograma e os comprimentos do alfabeto de 16 bits
+ * @param workspace Espaço de trabalho
+ * @return 0 se sucesso, -1 se o limite de memória foi excedido
+ */
+static int reserveWideBuffers(BlockWorkspace* workspace) {
+    if (workspace->wide_frequencies == NULL) {
+        workspace->wide_frequencies = (uint32_t*)budgetMalloc(WIDE_ALPHABET * sizeof(uint32_t));
+    }
+    if (workspace->wide_lengths == NULL) {
+        workspace->wide_lengths = (unsigned char*)budgetMalloc(WIDE_ALPHABET);
+    }
+    return workspace->wide_frequencies != NULL && workspace->wide_lengths != NULL ? 0 : -1;
+}
+
+/**
+ * Decide se um bloco usa o alfabeto de 16 bits: conta as palavras do bloco
+ * original, calcula os comprimentos canônicos e compara o tamanho exato
+ * (cabeçalho esparso + fluxo de bits) com o previsto para a codificação
+ * por bytes
+ * @param data Bytes originais do bloco
+ * @param length Tamanho do bloco
+ * @param byte_size Bytes previstos do conteúdo codificado por bytes
+ * @param frequencies Histograma de 16 bits (WIDE_ALPHABET contadores)
+ * @param lengths Recebe os comprimentos dos códigos
+ * @return 1 se o alfabeto de 16 bits economiza ao menos 1/WIDE_MIN_GAIN, 0 caso contrário
+ */
+static int chooseWideBlock(const unsigned char* data, size_t length, uint64_t byte_size,
+                           uint32_t* frequencies, unsigned char* lengths) {
+    memset(frequencies, 0, WIDE_ALPHABET * sizeof(uint32_t));
+    countWideFrequencies(data, length, frequencies);
+    if (buildWideCodeLengths(frequencies, lengths) <= 0) {
+        return 0;
+    }
+
+    // A tabela de decodificação precisa caber na reserva do plano de memória
+    if (wideDecodeTableEntries(lengths) > WIDE_MAX_DECODE_ENTRIES) {
+        return 0;
+    }
+
+    uint64_t wide_size = wideHeaderSize(lengths) + (length & 1) + (wideCostBits(frequencies, lengths) + 7) / 8;
+    return wide_size + wide_size / WIDE_MIN_GAIN < byte_size;
+}
+
+// Decisões de um bloco entre a análise, a codificação e a gravação
+typedef struct BlockPlan {
+    const unsigned char* original;        // Bytes originais do bloco
+    size_t original_length;
+    const unsigned char* data;            // Bytes a codificar (originais ou transformados)
+    size_t length;
+    TransformType transform;              // Transformação aplicada (TRANSFORM_NONE = nenhuma)
+    size_t overhead;                      // Bytes do cabeçalho da transformação no conteúdo
+    unsigned char shape[MAX_SERIALIZED_TREE]; // Árvore serializada
+    size_t tree_size;
+    CachedTables* tables;                 // Referência própria às tabelas (NULL = bloco sem codificação)
+    int use_pairs;                        // 1 para permitir a tabela de pares
+    int duplicate;                        // 1 se o bloco é gravado como referência
+    uint64_t reference;                   // Bloco anterior idêntico (com duplicate)
+    size_t encoded_size;                  // Bytes do fluxo de bits
+    int stored;                           // 1 se o bloco é gravado sem codificação
+    int wide;                             // 1 se o bloco usa o alfabeto de 16 bits
+    const unsigned char* wide_lengths;    // Comprimentos dos códigos de 16 bits (com wide)
+} BlockPlan;
+
+/**
+ * Analisa um bloco: escolhe a transformação, conta as frequências e decide
+ * a árvore (repetida do bloco anterior, nova ou nenhuma). Atualiza o estado
+ * de repetição do espaço de trabalho, então os blocos devem ser analisados
+ * em ordem.
+ * @param data Bytes do bloco
+ * @param length Tamanho do bloco
+ * @param transformed Buffer para o bloco transformado (NULL = sem transformação)
+ * @param wide_lengths Buffer para os comprimentos de 16 bits (NULL = só bytes)
+ * @param workspace Espaço de trabalho (árvore do bloco anterior)
+ * @param strategy Estratégia do nível de compressão
+ * @param use_pairs 1 para permitir a tabela de pares
+ * @param plan Decisões a preencher
+ */
+static void analyzeBlock(const unsigned char* data, size_t length, unsigned char* transformed,
+                         unsigned char* wide_lengths, BlockWorkspace* workspace,
+                         const LevelStrategy* strategy, int use_pairs, BlockPlan* plan) {
+    plan->original = data;
+    plan->original_length = length;
+    plan->transform = TRANSFORM_NONE;
+    plan->overhead = 0;
+    plan->tree_size = 0;
+    plan->tables = NULL;
+    plan->use_pairs = use_pairs;
+    plan->duplicate = 0;
+    plan->encoded_size = 0;
+    plan->stored = 1;
+    plan->wide = 0;
+    plan->wide_lengths = NULL;
+
+    // A transformação só vale se encolher (RLE) ou mantiver o tamanho do bloco
+    if (workspace->transforms != 0 && length >= TRANSFORM_MIN_BLOCK && transformed != NULL) {
+        TransformType transform = chooseTransform(data, length, workspace->transforms);
+        size_t produced = 0;
+        if (transform != TRANSFORM_NONE) {
+            produced = applyTransform(transform, data, length, transformed, length);
+        }
+        if (produced > 0) {
+            data = transformed;
+            length = produced;
+            plan->transform = transform;
+            plan->overhead = 1 + 4;
+        }
+    }
+    plan->data = data;
+    plan->length = length;
+
+    unsigned long frequencies[MAX_CHAR] = {0};
+    countBlockFrequencies(data, length, strategy->sample_shift, frequencies);
+
+    int leaves = 0;
+    uint64_t optimal_bits = 0;
+    if (strategy->reuse_tables || strategy->evaluate_cost || wide_lengths != NULL) {
+        optimal_bits = huffmanCostBits(frequencies, &leaves);
+    }
+
+    // O alfabeto de 16 bits codifica o bloco original (sem transformação) e
+    // dispensa a árvore por bytes; o histograma amostrado é extrapolado
+    if (wide_lengths != NULL && workspace->wide_frequencies != NULL && plan->original_length >= WIDE_MIN_BLOCK) {
+        uint64_t byte_size = leaves > 1 ? plan->overhead + (uint64_t)(3 * leaves - 1) +
+                                          ((optimal_bits << strategy->sample_shift) + 7) / 8 : 0;
+        if (chooseWideBlock(plan->original, plan->original_length, byte_size,
+                            workspace->wide_frequencies, wide_lengths)) {
+            plan->data = plan->original;
+            plan->length = plan->original_length;
+            plan->transform = TRANSFORM_NONE;
+            plan->overhead = 0;
+            plan->wide = 1;
+            plan->wide_lengths = wide_lengths;
+            return;
+        }
+    }
+
+    CachedTables* tables = NULL;
+    int reused = 0;
+
+    // A árvore do bloco anterior é repetida se codificar este bloco quase tão
+    // bem quanto codificou o próprio bloco (o limite de comprimento já a afasta
+    // da árvore ótima)
+    if (strategy->reuse_tables && workspace->cached_tables != NULL) {
+        uint64_t previous_bits = tableCostBits(workspace->cached_tables, frequencies);
+        uint64_t allowed = optimal_bits + optimal_bits * workspace->tree_penalty / 1024 +
+                           optimal_bits / LEVEL_REUSE_SLACK;
+        if (previous_bits <= allowed) {
+            tables = workspace->cached_tables;
+            reused = 1;
+        }
+    }
+
+    // Com o custo exato calculado antes, blocos que não diminuiriam nem são codificados
+    int worthwhile = 1;
+    if (strategy->evaluate_cost && !reused && leaves > 1) {
+        worthwhile = plan->overhead + (uint64_t)(3 * leaves - 1) + (optimal_bits + 7) / 8 < plan->original_length;
+    }
+
+    // Blocos com a mesma árvore reaproveitam as tabelas do cache compartilhado
+    if (!reused && worthwhile) {
+        HuffmanNode* root = buildLimitedTree(frequencies, strategy->max_code_length);
+        size_t shape_size = flattenTree(root, plan->shape, 0);
+        freeHuffmanTree(root);
+        tables = acquireTables(plan->shape, shape_size);
+    }
+    if (tables != NULL) {
+        plan->tree_size = tables->shape_size;
+        memcpy(plan->shape, tables->shape, plan->tree_size);
+    }
+
+    // Nos níveis que repetem árvores, a última construída fica no espaço de
+    // trabalho; o plano guarda a sua própria referência para a codificação
+    if (reused) {
+        plan->tables = acquireTables(tables->shape, tables->shape_size);
+        workspace->table_hits++;
+    } else if (strategy->reuse_tables && tables != NULL) {
+        uint64_t own_bits = tableCostBits(tables, frequencies);
+        workspace->tree_penalty = own_bits == UINT64_MAX || optimal_bits == 0 ? 0 :
+                                  (own_bits - optimal_bits) * 1024 / optimal_bits;
+        releaseTables(workspace->cached_tables);
+        workspace->cached_tables = tables;
+        plan->tables = acquireTables(tables->shape, tables->shape_size);
+        workspace->table_misses++;
+    } else {
+        plan->tables = tables;
+    }
+}
+
+/**
+ * Codifica um bloco analisado e libera a referência às tabelas do plano;
+ * blocos que não diminuem ficam marcados para gravação sem codificação
+ * @param plan Decisões da análise
+ * @param encoded Buffer do fluxo de bits
+ * @param capacity Capacidade do buffer
+ */
+static void encodePlannedBlock(BlockPlan* plan, unsigned char* encoded, size_t capacity) {
+    if (plan->wide) {
+        size_t size = encodeWideBlock(plan->original, plan->original_length, plan->wide_lengths, encoded, capacity);
+        if (size > 0 && size < plan->original_length) {
+            plan->stored = 0;
+            plan->encoded_size = size;
+        }
+        return;
+    }
+
+    // Códigos longos demais para a tabela inteira também caem no bloco sem codificação
+    const CodeTable* table = plan->tables != NULL ? cachedCodeTable(plan->tables) : NULL;
+    if (table != NULL) {
+        const PairCodeTable* pairs = NULL;
+        if (plan->use_pairs && plan->length >= PAIR_TABLE_MIN_INPUT) {
+            pairs = cachedPairCodeTable(plan->tables);
+        }
+
+        BitWriter writer;
+        initBitWriter(&writer, encoded, capacity, NULL);
+        encodeSymbols(&writer, plan->data, plan->length, table, pairs);
+
+        if (flushBitWriter(&writer) == 0 &&
+            plan->overhead + plan->tree_size + writer.position < plan->original_length) {
+            plan->stored = 0;
+            plan->encoded_size = writer.position;
+        }
+    }
+
+    releaseTables(plan->tables);
+    plan->tables = NULL;
+}
+
+/**
+ * Grava um bloco referência a um bloco anterior idêntico
+ * @param output Arquivo de saída
+ * @param length Tamanho do bloco
+ * @param reference Índice do bloco anterior
+ * @param stats Estatísticas a atualizar
+ */
+static void emitDuplicateBlock(FILE* output, size_t length, uint64_t reference, BlockStats* stats) {
+    fputc(BLOCK_DUP, output);
+    writeUint32(output, (uint32_t)length);
+    writeUint32(output, 8);
+    writeUint64(output, reference);
+
+    stats->dedup_blocks++;
+    stats->dedup_bytes += length;
+    stats->output_bytes += 9 + 8;
+    stats->blocks++;
+    stats->input_bytes += length;
+}
+
+/**
+ * Grava um bloco já codificado (ou sem codificação, ou referência)
+ * @param output Arquivo de saída
+ * @param plan Decisões da análise e da codificação
+ * @param encoded Fluxo de bits do bloco
+ * @param stats Estatísticas a atualizar
+ * @return 0 se sucesso, -1 se erro de escrita
+ */
+static int emitBlock(FILE* output, const BlockPlan* plan, const unsigned char* encoded, BlockStats* stats) {
+    if (plan->duplicate) {
+        emitDuplicateBlock(output, plan->original_length, plan->reference, stats);
+        return ferror(output) ? -1 : 0;
+    }
+
+    if (plan->stored) {
+        // Sem ganho, o bloco é gravado com os bytes originais
+        fputc(BLOCK_STORED, output);
+        writeUint32(output, (uint32_t)plan->original_length);
+        writeUint32(output, (uint32_t)plan->original_length);
+        fwrite(plan->original, 1, plan->original_length, output);
+        stats->stored_blocks++;
+        stats->output_bytes += 9 + plan->original_length;
+    } else if (plan->wide) {
+        fputc(BLOCK_WIDE, output);
+        writeUint32(output, (uint32_t)plan->original_length);
+        writeUint32(output, (uint32_t)plan->encoded_size);
+        fwrite(encoded, 1, plan->encoded_size, output);
+        stats->wide_blocks++;
+        stats->output_bytes += 9 + plan->encoded_size;
+    } else {
+        fputc(plan->transform != TRANSFORM_NONE ? BLOCK_TRANSFORMED : BLOCK_HUFFMAN, output);
+        writeUint32(output, (uint32_t)plan->original_length);
+        writeUint32(output, (uint32_t)(plan->overhead + plan->tree_size + plan->encoded_size));
+        if (plan->transform != TRANSFORM_NONE) {
+            fputc(plan->transform, output);
+            writeUint32(output, (uint32_t)plan->length);
+            stats->transformed_blocks++;
+        }
+        fwrite(plan->shape, 1, plan->tree_size, output);
+        fwrite(encoded, 1, plan->encoded_size, output);
+        stats->output_bytes += 9 + plan->overhead + plan->tree_size + plan->encoded_size;
+    }
+
+    stats->blocks++;
+    stats->input_bytes += plan->original_length;
+
+    return ferror(output) ? -1 : 0;
+}
+
+/**
+ * Comprime e grava um bloco; blocos que não diminuem são gravados sem codificação
+ * Com transformações permitidas, o bloco pode ser codificado após a que
+ * vencer o teste de chooseTransform.
+ * @param output Arquivo de saída
+ * @param data Bytes do bloco
+ * @param length Tamanho do bloco
+ * @param workspace Espaço de trabalho (buffer codificado e árvore do bloco anterior)
+ * @param strategy Estratégia do nível de compressão
+ * @param use_pairs 1 para permitir a tabela de pares
+ * @param stats Estatísticas a atualizar
+ * @return 0 se sucesso, -1 se erro de escrita
+ */
+static int writeBlock(FILE* output, const unsigned char* data, size_t length,
+                      BlockWorkspace* workspace, const LevelStrategy* strategy,
+                      int use_pairs, BlockStats* stats) {
+    BlockPlan plan;
+    unsigned char* transformed = NULL;
+    if (workspace->transforms != 0 && length >= TRANSFORM_MIN_BLOCK && reserveTransformBuffer(workspace) == 0) {
+        transformed = workspace->transformed;
+    }
+    unsigned char* wide_lengths = NULL;
+    if (workspace->wide && length >= WIDE_MIN_BLOCK && reserveWideBuffers(workspace) == 0) {
+        wide_lengths = workspace->wide_lengths;
+    }
+
+    analyzeBlock(data, length, transformed, wide_lengths, workspace, strategy, use_pairs, &plan);
+    encodePlannedBlock(&plan, workspace->encoded, workspace->capacity);
+    return emitBlock(output, &plan, workspace->encoded, stats);
+}
+
+/**
+ * Inicializa um espaço de trabalho vazio
+ * @param workspace Espaço de trabalho
+ */
+void initBlockWorkspace(BlockWorkspace* workspace) {
+    memset(workspace, 0, sizeof(BlockWorkspace));
+}
+
+/**
+ * Garante buffers para blocos de até block_size bytes (só crescem)
+ * @param workspace Espaço de trabalho
+ * @param block_size Tamanho de bloco desejado
+ * @return 0 se sucesso, -1 se o limite de memória foi excedido
+ */
+int reserveBlockWorkspace(BlockWorkspace* workspace, size_t block_size) {
+    if (workspace->capacity >= block_size) {
+        return 0;
+    }
+
+    budgetFree(workspace->block);
+    budgetFree(workspace->encoded);
+    budgetFree(workspace->transformed);
+    workspace->transformed = NULL;
+    workspace->block = (unsigned char*)budgetMalloc(block_size);
+    workspace->encoded = (unsigned char*)budgetMalloc(block_size);
+
+    if (workspace->block == NULL || workspace->encoded == NULL) {
+        budgetFree(workspace->block);
+        budgetFree(workspace->encoded);
+        workspace->block = NULL;
+        workspace->encoded = NULL;
+        workspace->capacity = 0;
+        return -1;
+    }
+
+    workspace->capacity = block_size;
+    return 0;
+}
+
+/**
+ * Libera os buffers e a tabela em cache de um espaço de trabalho
+ * @param workspace Espaço de trabalho
+ */
+void freeBlockWorkspace(BlockWorkspace* workspace) {
+    budgetFree(workspace->block);
+    budgetFree(workspace->encoded);
+    budgetFree(workspace->transformed);
+    budgetFree(workspace->wide_frequencies);
+    budgetFree(workspace->wide_lengths);
+    releaseTables(workspace->cached_tables);
+    freeHashIndex(&workspace->dedup_index);
+    budgetFree(workspace->digests);
+    budgetFree(workspace->records);
+    budgetFree(workspace->hashes);
+    initBlockWorkspace(workspace);
+}
+
+/**
+ * Indica se o trabalho do espaço de trabalho foi cancelado por outra thread
+ * @param workspace Espaço de trabalho
+ * @return 1 se cancelado, 0 caso contrário
+ */
+static int blockCancelled(const BlockWorkspace* workspace) {
+    return workspace->cancel != NULL && __atomic_load_n(workspace->cancel, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * Preenche a tabela do hash rolante usado nos cortes por conteúdo
+ * @param gear Tabela de 256 valores pseudoaleatórios fixos
+ */
+static void initGearTable(uint64_t* gear) {
+    for (int i = 0; i < MAX_CHAR; i++) {
+        unsigned char byte = (unsigned char)i;
+        gear[i] = hash64(&byte, 1, BLOCK_GEAR_SEED);
+    }
+}
+
+/**
+ * Escolhe onde cortar o bloco pelo conteúdo (hash rolante "gear"), para que
+ * trechos repetidos gerem os mesmos blocos mesmo deslocados no arquivo
+ * O corte fica entre 1/4 do bloco e o tamanho lido, com média perto de 1/2 bloco.
+ * @param gear Tabela do hash rolante
+ * @param data Bytes disponíveis
+ * @param length Bytes disponíveis
+ * @param block_size Tamanho máximo de bloco
+ * @return Tamanho do bloco a gravar
+ */
+static size_t findChunkBoundary(const uint64_t* gear, const unsigned char* data, size_t length,
+                                size_t block_size) {
+    size_t minimum = block_size / 4;
+    if (length <= minimum) {
+        return length;
+    }
+
+    // Máscara nos bits altos: um corte a cada ~minimum bytes em média
+    int bits = 0;
+    while (((size_t)2 << bits) <= minimum) {
+        bits++;
+    }
+    uint64_t mask = ~(uint64_t)0 << (64 - bits);
+
+    // O hash depende só dos últimos 64 bytes; começa antes do mínimo para aquecê-lo
+    uint64_t hash = 0;
+    for (size_t i = minimum >= 64 ? minimum - 64 : 0; i < minimum; i++) {
+        hash = (hash << 1) + gear[data[i]];
+    }
+    for (size_t i = minimum; i < length; i++) {
+        hash = (hash << 1) + gear[data[i]];
+        if ((hash & mask) == 0) {
+            return i + 1;
+        }
+    }
+    return length;
+}
+
+/**
+ * Calcula o hash que identifica o conteúdo de um bloco (deduplicação e
+ * índice de blocos)
+ * @param data Bytes do bloco
+ * @param length Tamanho do bloco
+ * @return Hash de 64 bits semeado com o tamanho do bloco
+ */
+static uint64_t blockHash(const unsigned char* data, size_t length) {
+    return hash64(data, length, length);
+}
+
+/**
+ * Guarda o hash do bloco de índice n para o índice gravado no fim do contêiner
+ * Sem memória para o índice, o contêiner é gravado sem ele.
+ * @param workspace Espaço de trabalho
+ * @param n Índice do bloco
+ * @param hash Hash do bloco
+ */
+static void recordBlockHash(BlockWorkspace* workspace, uint64_t n, uint64_t hash) {
+    if (workspace->hashes_failed) {
+        return;
+    }
+
+    if (n >= workspace->hash_capacity) {
+        size_t capacity = workspace->hash_capacity > 0 ? workspace->hash_capacity * 2 : 64;
+        uint64_t* hashes = (uint64_t*)budgetMalloc(capacity * sizeof(uint64_t));
+        if (hashes == NULL) {
+            workspace->hashes_failed = 1;
+            return;
+        }
+        if (workspace->hashes != NULL) {
+            memcpy(hashes, workspace->hashes, workspace->hash_capacity * sizeof(uint64_t));
+        }
+        budgetFree(workspace->hashes);
+        workspace->hashes = hashes;
+        workspace->hash_capacity = capacity;
+    }
+
+    workspace->hashes[n] = hash;
+}
+
+/**
+ * Divide uma janela em blocos pela busca exata da divisão de menor custo:
+ * a janela é cortada em unidades de split_unit bytes e, por programação
+ * dinâmica sobre os histogramas acumulados das unidades, escolhe-se a
+ * sequência de blocos contíguos que minimiza árvores + fluxos + cabeçalhos
+ * Sem memória para a busca, a janela é gravada como um único bloco.
+ * @param output Arquivo de saída
+ * @param data Bytes da janela
+ * @param length Tamanho da janela
+ * @param workspace Espaço de trabalho
+ * @param strategy Estratégia do nível de compressão
+ * @param use_pairs 1 para permitir a tabela de pares
+ * @param stats Estatísticas a atualizar
+ * @return 0 se sucesso, -1 se erro de escrita
+ */
+static int writeSplitBlocks(FILE* output, const unsigned char* data, size_t length,
+                            BlockWorkspace* workspace, const LevelStrategy* strategy,
+                            int use_pairs, BlockStats* stats) {
+    size_t unit = strategy->split_unit;
+    size_t units = (length + unit - 1) / unit;
+
+    unsigned long* prefix = NULL;
+    uint64_t* best = NULL;
+    size_t* from = NULL;
+    if (units > 1) {
+        prefix = (unsigned long*)budgetMalloc((units + 1) * MAX_CHAR * sizeof(unsigned long));
+        best = (uint64_t*)budgetMalloc((units + 1) * sizeof(uint64_t));
+        from = (size_t*)budgetMalloc((units + 1) * sizeof(size_t));
+    }
+
+    if (prefix == NULL || best == NULL || from == NULL) {
+        budgetFree(prefix);
+        budgetFree(best);
+        budgetFree(from);
+        recordBlockHash(workspace, stats->blocks, blockHash(data, length));
+        return writeBlock(output, data, length, workspace, strategy, use_pairs, stats);
+    }
+
+    // Histogramas acumulados: a linha k conta as k primeiras unidades
+    memset(prefix, 0, MAX_CHAR * sizeof(unsigned long));
+    for (size_t k = 0; k < units; k++) {
+        unsigned long* row = prefix + (k + 1) * MAX_CHAR;
+        size_t start = k * unit;
+        memcpy(row, row - MAX_CHAR, MAX_CHAR * sizeof(unsigned long));
+        countFrequencies(data + start, length - start < unit ? length - start : unit, row);
+    }
+
+    // best[j]: menor custo das j primeiras unidades; from[j]: início do último bloco
+    best[0] = 0;
+    for (size_t j = 1; j <= units; j++) {
+        size_t end = j * unit < length ? j * unit : length;
+        best[j] = UINT64_MAX;
+        for (size_t i = 0; i < j; i++) {
+            unsigned long frequencies[MAX_CHAR];
+            const unsigned long* high = prefix + j * MAX_CHAR;
+            const unsigned long* low = prefix + i * MAX_CHAR;
+            for (int c = 0; c < MAX_CHAR; c++) {
+                frequencies[c] = high[c] - low[c];
+            }
+
+            uint64_t cost = best[i] + blockCost(frequencies, end - i * unit);
+            if (cost < best[j]) {
+                best[j] = cost;
+                from[j] = i;
+            }
+        }
+    }
+
+    // Refaz o caminho de trás para frente, guardando os fins dos blocos em best
+    size_t count = 0;
+    for (size_t j = units; j > 0; j = from[j]) {
+        best[count++] = j;
+    }
+
+    int result = 0;
+    size_t start = 0;
+    while (count > 0 && result == 0) {
+        size_t j = (size_t)best[--count];
+        size_t end = j * unit < length ? j * unit : length;
+        recordBlockHash(workspace, stats->blocks, blockHash(data + start, end - start));
+        result = writeBlock(output, data + start, end - start, workspace, strategy, use_pairs, stats);
+        start = end;
+    }
+
+    budgetFree(prefix);
+    budgetFree(best);
+    budgetFree(from);
+    return result;
+}
+
+/**
+ * Confere se um conteúdo Huffman (árvore + fluxo de bits) em memória
+ * reproduz os bytes esperados, decodificando em trechos de BUFFER_SIZE
+ * (sem buffer do tamanho do bloco e sem trocar a tabela do bloco anterior)
+ * @param payload Árvore seguida do fluxo de bits
+ * @param payload_size Bytes de payload
+ * @param expected Bytes esperados
+ * @param length Bytes esperados
+ * @return 1 se idênticos, 0 caso contrário
+ */
+static int huffmanPayloadMatches(const unsigned char* payload, size_t payload_size,
+                                 const unsigned char* expected, size_t length) {
+    ByteSource tree_source;
+    initMemorySource(&tree_source, payload, payload_size);
+    HuffmanNode* root = deserializeTree(&tree_source);
+    closeSource(&tree_source);
+    if (root == NULL) {
+        return 0;
+    }
+
+    size_t tree_size = serializedTreeSize(root);
+    int matches = tree_size <= payload_size;
+    if (matches && isLeaf(root)) {
+        // Árvore de um único símbolo: o bloco é a repetição do símbolo
+        for (size_t i = 0; i < length && matches; i++) {
+            matches = expected[i] == root->data;
+        }
+    } else if (matches) {
+        unsigned char shape[MAX_SERIALIZED_TREE];
+        CachedTables* tables = acquireTables(shape, flattenTree(root, shape, 0));
+        const DecodeTable* table = tables != NULL ? cachedDecodeTable(tables) : NULL;
+        matches = table != NULL;
+
+        BitReader reader;
+        initBitReaderFromMemory(&reader, payload + tree_size, payload_size - tree_size);
+        unsigned char chunk[BUFFER_SIZE];
+        for (size_t done = 0; done < length && matches; done += sizeof(chunk)) {
+            size_t count = length - done < sizeof(chunk) ? length - done : sizeof(chunk);
+            matches = decodeSymbols(&reader, table, chunk, count) == count &&
+                      memcmp(chunk, expected + done, count) == 0;
+        }
+        releaseTables(tables);
+    }
+
+    freeHuffmanTree(root);
+    return matches;
+}
+
+/**
+ * Confere se o conteúdo de um bloco do contêiner anterior reproduz o bloco
+ * atual: o hash de 64 bits do índice só aponta o candidato
+ * Blocos transformados são comparados depois de transformar o bloco atual
+ * com a mesma transformação, e os de 16 bits são decodificados no buffer
+ * transformado (que o plano reserva com transformações e com --wide).
+ * @param type Tipo do bloco anterior
+ * @param payload Conteúdo do bloco anterior
+ * @param payload_size Bytes do conteúdo
+ * @param data Bytes do bloco atual
+ * @param length Tamanho do bloco atual
+ * @param workspace Espaço de trabalho
+ * @return 1 se o bloco anterior tem os mesmos bytes, 0 caso contrário
+ */
+static int indexedBlockMatches(int type, const unsigned char* payload, uint32_t payload_size,
+                               const unsigned char* data, size_t length, BlockWorkspace* workspace) {
+    if (type == BLOCK_STORED) {
+        return payload_size == length && memcmp(payload, data, length) == 0;
+    }
+    if (type == BLOCK_HUFFMAN) {
+        return huffmanPayloadMatches(payload, payload_size, data, length);
+    }
+    if (type == BLOCK_TRANSFORMED) {
+        if (payload_size < 1 + 4 || reserveTransformBuffer(workspace) != 0) {
+            return 0;
+        }
+        uint32_t transformed_size = (uint32_t)payload[1] | (uint32_t)payload[2] << 8 |
+                                    (uint32_t)payload[3] << 16 | (uint32_t)payload[4] << 24;
+        size_t size = applyTransform((TransformType)payload[0], data, length, workspace->transformed,
+                                     workspace->capacity);
+        return size > 0 && size == transformed_size &&
+               huffmanPayloadMatches(payload + 1 + 4, payload_size - (1 + 4), workspace->transformed, size);
+    }
+    if (type == BLOCK_WIDE) {
+        return reserveTransformBuffer(workspace) == 0 &&
+               decodeWideBlock(payload, payload_size, workspace->transformed, length) == 0 &&
+               memcmp(workspace->transformed, data, length) == 0;
+    }
+    return 0;
+}
+
+/**
+ * Copia sem recodificar um bloco idêntico do contêiner anterior
+ * @param output Arquivo de saída
+ * @param data Bytes do bloco
+ * @param hash Hash do bloco (blockHash)
+ * @param length Tamanho do bloco
+ * @param workspace Espaço de trabalho com o contêiner anterior
+ * @param stats Estatísticas a atualizar
+ * @return 1 se o bloco foi copiado, 0 se deve ser codificado
+ */
+static int copyIndexedBlock(FILE* output, const unsigned char* data, uint64_t hash, size_t length,
+                            BlockWorkspace* workspace, BlockStats* stats) {
+    BlockIndex* base = workspace->base;
+    uint64_t offset;
+    if (!findHashIndex(&base->blocks, hash, &offset) || fseeko(base->file, (off_t)offset, SEEK_SET) != 0) {
+        return 0;
+    }
+
+    int type = fgetc(base->file);
+    uint32_t raw_size;
+    uint32_t payload_size;
+    // Blocos transformados e de 16 bits só são copiados para contêineres que também os aceitam
+    int copyable = type == BLOCK_HUFFMAN || type == BLOCK_STORED ||
+                   (type == BLOCK_TRANSFORMED && workspace->transforms != 0) ||
+                   (type == BLOCK_WIDE && workspace->wide);
+    if (!copyable || readUint32(base->file, &raw_size) != 0 ||
+        readUint32(base->file, &payload_size) != 0 || raw_size != length) {
+        return 0;
+    }
+
+    // O conteúdo passa pelo buffer de codificação, que comporta qualquer bloco gravado
+    if (payload_size > workspace->capacity ||
+        fread(workspace->encoded, 1, payload_size, base->file) != payload_size ||
+        !indexedBlockMatches(type, workspace->encoded, payload_size, data, length, workspace)) {
+        return 0;
+    }
+
+    fputc(type, output);
+    writeUint32(output, raw_size);
+    writeUint32(output, payload_size);
+    fwrite(workspace->encoded, 1, payload_size, output);
+
+    if (type == BLOCK_STORED) {
+        stats->stored_blocks++;
+    } else if (type == BLOCK_TRANSFORMED) {
+        stats->transformed_blocks++;
+    } else if (type == BLOCK_WIDE) {
+        stats->wide_blocks++;
+    }
+    stats->reused_blocks++;
+    stats->reused_bytes += length;
+    stats->output_bytes += 9 + payload_size;
+    stats->blocks++;
+    stats->input_bytes += length;
+    return 1;
+}
+
+/**
+ * Garante espaço para mais um bloco indexado para deduplicação
+ * @param workspace Espaço de trabalho
+ * @return 0 se sucesso, -1 se o limite de memória foi excedido
+ */
+static int reserveBlockDigests(BlockWorkspace* workspace) {
+    if (workspace->digest_count < workspace->digest_capacity) {
+        return 0;
+    }
+
+    size_t capacity = workspace->digest_capacity > 0 ? workspace->digest_capacity * 2 : 64;
+    if (workspace->record_limit > 0 && capacity > workspace->record_limit) {
+        capacity = (size_t)workspace->record_limit;
+    }
+    BlockDigest* digests = (BlockDigest*)budgetMalloc(capacity * sizeof(BlockDigest));
+    if (digests == NULL) {
+        return -1;
+    }
+    if (workspace->digests != NULL) {
+        memcpy(digests, workspace->digests, workspace->digest_count * sizeof(BlockDigest));
+    }
+    budgetFree(workspace->digests);
+    workspace->digests = digests;
+    workspace->digest_capacity = capacity;
+    return 0;
+}
+
+/**
+ * Procura um bloco idêntico já gravado no contêiner; blocos novos entram no
+ * índice. A chave do índice é metade de um hash de 128 bits; a outra metade
+ * e o tamanho confirmam o bloco encontrado, e uma chave igual com conteúdo
+ * diferente apenas deixa o bloco ser codificado.
+ * Só os workspace->record_limit primeiros blocos entram no índice: são os
+ * únicos que a descompressão registra sob o mesmo limite de memória.
+ * @param workspace Espaço de trabalho com o índice de hashes
+ * @param data Bytes do bloco
+ * @param length Tamanho do bloco
+ * @param n Índice do bloco
+ * @param reference Recebe o índice do bloco idêntico
+ * @return 1 se o bloco pode ser gravado como referência, 0 se deve ser codificado
+ */
+static int findDuplicateBlock(BlockWorkspace* workspace, const unsigned char* data, size_t length,
+                              uint64_t n, uint64_t* reference) {
+    uint64_t digest[2];
+    hash128(data, length, length, digest);
+
+    uint64_t position;
+    if (findHashIndex(&workspace->dedup_index, digest[0], &position)) {
+        const BlockDigest* indexed = &workspace->digests[position];
+        if (indexed->check != digest[1] || indexed->length != length) {
+            return 0;
+        }
+        *reference = indexed->block;
+        return 1;
+    }
+
+    // Sem memória para o índice o bloco apenas deixa de ser deduplicado
+    if ((workspace->record_limit == 0 || n < workspace->record_limit) && reserveBlockDigests(workspace) == 0 &&
+        insertHashIndex(&workspace->dedup_index, digest[0], workspace->digest_count) == 0) {
+        BlockDigest* indexed = &workspace->digests[workspace->digest_count++];
+        indexed->check = digest[1];
+        indexed->block = n;
+        indexed->length = (uint32_t)length;
+    }
+    return 0;
+}
+
+/**
+ * Grava o bloco como referência se um bloco idêntico já está no contêiner
+ * @param output Arquivo de saída
+ * @param data Bytes do bloco
+ * @param length Tamanho do bloco
+ * @param workspace Espaço de trabalho com o índice de hashes
+ * @param stats Estatísticas a atualizar
+ * @return 1 se o bloco foi gravado como referência, 0 se deve ser codificado
+ */
+static int writeDuplicateBlock(FILE* output, const unsigned char* data, size_t length,
+                               BlockWorkspace* workspace, BlockStats* stats) {
+    uint64_t reference;
+
+    if (!findDuplicateBlock(workspace, data, length, stats->blocks, &reference)) {
+        return 0;
+    }
+
+    emitDuplicateBlock(output, length, reference, stats);
+    return 1;
+}
+
+/**
+ * Laço em série da compressão: lê, codifica e grava um bloco de cada vez
+ * @param input Arquivo de entrada
+ * @param output Arquivo de saída (cabeçalho já gravado)
+ * @param block_size Tamanho máximo de bloco
+ * @param strategy Estratégia do nível de compressão
+ * @param split 1 para procurar a melhor divisão de cada janela
+ * @param use_pairs 1 para permitir a tabela de pares
+ * @param workspace Espaço de trabalho
+ * @param stats Estatísticas a atualizar
+ * @return 0 se sucesso, -1 se erro de escrita
+ */
+static int compressBlocksSerial(FILE* input, FILE* output, size_t block_size, const LevelStrategy* strategy,
+                                int split, int use_pairs, BlockWorkspace* workspace, BlockStats* stats) {
+    unsigned char* block = workspace->block;
+    int result = 0;
+
+    // Com deduplicação, o fim de cada bloco depende do conteúdo; os bytes
+    // após o corte são levados para o início do próximo bloco
+    size_t carried = 0;
+    for (;;) {
+        if (blockCancelled(workspace)) {
+            result = -1;
+            break;
+        }
+        size_t length = carried + readBlock(input, block + carried, block_size - carried);
+        if (length == 0) {
+            break;
+        }
+
+        size_t cut = workspace->dedup ? findChunkBoundary(workspace->gear, block, length, block_size) : length;
+        int written = 0;
+        if (split) {
+            // A janela inteira vira um ou mais blocos escolhidos pela busca
+            written = writeSplitBlocks(output, block, cut, workspace, strategy, use_pairs, stats);
+        } else {
+            uint64_t hash = blockHash(block, cut);
+            recordBlockHash(workspace, stats->blocks, hash);
+
+            // Ordem de preferência: referência no próprio contêiner, cópia do
+            // contêiner anterior e, por fim, codificação
+            if ((!workspace->dedup || !writeDuplicateBlock(output, block, cut, workspace, stats)) &&
+                (workspace->base == NULL || !copyIndexedBlock(output, block, hash, cut, workspace, stats))) {
+                written = writeBlock(output, block, cut, workspace, strategy, use_pairs, stats);
+            }
+        }
+
+        if (written != 0) {
+            fprintf(stderr, "Erro: Falha ao gravar o bloco %llu\n", (unsigned long long)stats->blocks);
+            result = -1;
+            break;
+        }
+
+        progressAdvance(workspace->progress, cut);
+        carried = length - cut;
+        memmove(block, block + cut, carried);
+    }
+
+    return result;
+}
+
+// Bloco em trânsito no pipeline, com buffers próprios
+typedef struct PipelineBlock {
+    unsigned char* block;         // Bytes originais do bloco (ou decodificados)
+    unsigned char* encoded;       // Fluxo de bits (ou conteúdo lido do contêiner)
+    unsigned char* transformed;   // Bloco transformado (alocado no primeiro uso)
+    unsigned char* wide_lengths;  // Comprimentos dos códigos de 16 bits (idem)
+    size_t length;                // Bytes originais do bloco
+    BlockPlan plan;               // Decisões da compressão
+    int type;                     // Tipo do bloco lido (descompressão)
+    uint32_t payload_size;        // Bytes do conteúdo lido (descompressão)
+} PipelineBlock;
+
+// Estado compartilhado pelos estágios do pipeline
+// Cada fila tem um único produtor e um único consumidor; os blocos livres
+// voltam da gravação para a leitura pela fila free_slots.
+typedef struct BlockPipeline {
+    PipelineBlock slots[PIPELINE_SLOTS];
+    size_t capacity;              // Capacidade de block e transformed
+    size_t payload_capacity;      // Capacidade de encoded
+    SpscRing free_slots;          // Gravação -> leitura
+    SpscRing queues[PIPELINE_MAX_QUEUES]; // Leitura -> ... -> gravação
+    int queue_count;
+    FILE* input;
+    BlockWorkspace* workspace;    // Estado em série da análise (ou da decodificação)
+    const LevelStrategy* strategy;
+    int use_pairs;
+    size_t block_size;            // Tamanho máximo de bloco
+    int failed;                   // 1 se algum estágio falhou
+    int end_result;               // Resultado do marcador de fim (descompressão)
+    uint64_t end_bytes;           // Bytes do marcador de fim e do índice (descompressão)
+} BlockPipeline;
+
+/**
+ * Reserva os blocos do pipeline e coloca todos na fila de livres
+ * @param pipeline Pipeline
+ * @param capacity Capacidade dos buffers de bloco
+ * @param payload_capacity Capacidade dos buffers de conteúdo codificado
+ * @param queue_count Filas entre os estágios
+ * @return 0 se sucesso, -1 se faltou memória
+ */
+static int initBlockPipeline(BlockPipeline* pipeline, size_t capacity, size_t payload_capacity, int queue_count) {
+    memset(pipeline, 0, sizeof(BlockPipeline));
+    pipeline->capacity = capacity;
+    pipeline->payload_capacity = payload_capacity;
+    pipeline->queue_count = queue_count;
+    pipeline->end_result = -1;
+    initSpscRing(&pipeline->free_slots, PIPELINE_SLOTS);
+    for (int q = 0; q < queue_count; q++) {
+        initSpscRing(&pipeline->queues[q], PIPELINE_QUEUE_DEPTH);
+    }
+
+    for (int i = 0; i < PIPELINE_SLOTS; i++) {
+        PipelineBlock* slot = &pipeline->slots[i];
+        slot->block = (unsigned char*)budgetMalloc(capacity);
+        slot->encoded = (unsigned char*)budgetMalloc(payload_capacity);
+        if (slot->block == NULL || slot->encoded == NULL) {
+            return -1;
+        }
+        ringPush(&pipeline->free_slots, slot);
+    }
+    return 0;
+}
+
+/**
+ * Libera os blocos do pipeline e as tabelas que ficaram em planos interrompidos
+ * @param pipeline Pipeline
+ */
+static void freeBlockPipeline(BlockPipeline* pipeline) {
+    for (int i = 0; i < PIPELINE_SLOTS; i++) {
+        PipelineBlock* slot = &pipeline->slots[i];
+        releaseTables(slot->plan.tables);
+        budgetFree(slot->block);
+        budgetFree(slot->encoded);
+        budgetFree(slot->transformed);
+        budgetFree(slot->wide_lengths);
+    }
+}
+
+/**
+ * Interrompe todos os estágios após uma falha
+ * @param pipeline Pipeline
+ */
+static void abortBlockPipeline(BlockPipeline* pipeline) {
+    __atomic_store_n(&pipeline->failed, 1, __ATOMIC_RELEASE);
+    ringAbort(&pipeline->free_slots);
+    for (int q = 0; q < pipeline->queue_count; q++) {
+        ringAbort(&pipeline->queues[q]);
+    }
+}
+
+/**
+ * Inicia os estágios do pipeline, cada um em sua thread; os consumidores
+ * são criados antes dos produtores, então se alguma thread não puder ser
+ * criada nenhum bloco foi lido ainda
+ * @param pipeline Pipeline
+ * @param threads Threads dos estágios
+ * @param routines Função de cada estágio, da leitura em diante
+ * @param count Número de estágios
+ * @return 0 se sucesso, -1 se alguma thread não pôde ser criada (as criadas já terminaram)
+ */
+static int startPipelineStages(BlockPipeline* pipeline, pthread_t* threads,
+                               void* (*const* routines)(void*), int count) {
+    for (int i = count - 1; i >= 0; i--) {
+        if (pthread_create(&threads[i], NULL, routines[i], pipeline) != 0) {
+            abortBlockPipeline(pipeline);
+            for (int j = i + 1; j < count; j++) {
+                pthread_join(threads[j], NULL);
+            }
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Guarda a ocupação das filas nas estatísticas
+ * @param pipeline Pipeline (estágios já terminados)
+ * @param stats Estatísticas a preencher
+ */
+static void recordPipelineStats(const BlockPipeline* pipeline, BlockStats* stats) {
+    stats->pipeline_stages = pipeline->queue_count + 1;
+    for (int q = 0; q < pipeline->queue_count; q++) {
+        getSpscRingStats(&pipeline->queues[q], &stats->queues[q]);
+    }
+}
+
+/**
+ * Estágio de leitura da compressão: enche blocos livres com a entrada
+ * (com deduplicação, corta pelo conteúdo e leva o resto para o próximo bloco)
+ * @param argument Pipeline
+ * @return NULL
+ */
+static void* compressReadStage(void* argument) {
+    BlockPipeline* pipeline = (BlockPipeline*)argument;
+    BlockWorkspace* workspace = pipeline->workspace;
+    PipelineBlock* current = (PipelineBlock*)ringPop(&pipeline->free_slots);
+    size_t carried = 0;
+
+    while (current != NULL) {
+        if (blockCancelled(workspace)) {
+            abortBlockPipeline(pipeline);
+            break;
+        }
+        size_t length = carried + readBlock(pipeline->input, current->block + carried, pipeline->block_size - carried);
+        if (length == 0) {
+            break;
+        }
+
+        size_t cut = workspace->dedup ?
+                     findChunkBoundary(workspace->gear, current->block, length, pipeline->block_size) : length;
+        PipelineBlock* next = (PipelineBlock*)ringPop(&pipeline->free_slots);
+        if (next == NULL) {
+            break;
+        }
+        carried = length - cut;
+        memcpy(next->block, current->block + cut, carried);
+
+        current->length = cut;
+        if (ringPush(&pipeline->queues[0], current) != 0) {
+            break;
+        }
+        current = next;
+    }
+
+    ringClose(&pipeline->queues[0]);
+    return NULL;
+}
+
+/**
+ * Estágio de análise da compressão: hash do índice, referências e, para os
+ * demais blocos, transformação, histograma e tabelas (em ordem, pois a
+ * repetição da árvore depende do bloco anterior)
+ * @param argument Pipeline
+ * @return NULL
+ */
+static void* compressAnalyzeStage(void* argument) {
+    BlockPipeline* pipeline = (BlockPipeline*)argument;
+    BlockWorkspace* workspace = pipeline->workspace;
+    uint64_t n = 0;
+    PipelineBlock* slot;
+
+    while ((slot = (PipelineBlock*)ringPop(&pipeline->queues[0])) != NULL) {
+        uint64_t hash = blockHash(slot->block, slot->length);
+        recordBlockHash(workspace, n, hash);
+
+        uint64_t reference;
+        if (workspace->dedup && findDuplicateBlock(workspace, slot->block, slot->length, n, &reference)) {
+            memset(&slot->plan, 0, sizeof(BlockPlan));
+            slot->plan.original = slot->block;
+            slot->plan.original_length = slot->length;
+            slot->plan.duplicate = 1;
+            slot->plan.reference = reference;
+        } else {
+            if (workspace->transforms != 0 && slot->length >= TRANSFORM_MIN_BLOCK && slot->transformed == NULL) {
+                slot->transformed = (unsigned char*)budgetMalloc(pipeline->capacity);
+            }
+            int wide = workspace->wide && slot->length >= WIDE_MIN_BLOCK && reserveWideBuffers(workspace) == 0;
+            if (wide && slot->wide_lengths == NULL) {
+                slot->wide_lengths = (unsigned char*)budgetMalloc(WIDE_ALPHABET);
+            }
+            analyzeBlock(slot->block, slot->length, slot->transformed, wide ? slot->wide_lengths : NULL,
+                         workspace, pipeline->strategy, pipeline->use_pairs, &slot->plan);
+        }
+        n++;
+
+        if (ringPush(&pipeline->queues[1], slot) != 0) {
+            break;
+        }
+    }
+
+    ringClose(&pipeline->queues[1]);
+    return NULL;
+}
+
+/**
+ * Estágio de codificação da compressão: fluxo de bits de cada bloco analisado
+ * @param argument Pipeline
+ * @return NULL
+ */
+static void* compressEncodeStage(void* argument) {
+    BlockPipeline* pipeline = (BlockPipeline*)argument;
+    PipelineBlock* slot;
+
+    while ((slot = (PipelineBlock*)ringPop(&pipeline->queues[1])) != NULL) {
+        if (!slot->plan.duplicate) {
+            encodePlannedBlock(&slot->plan, slot->encoded, pipeline->payload_capacity);
+        }
+        if (ringPush(&pipeline->queues[2], slot) != 0) {
+            break;
+        }
+    }
+
+    ringClose(&pipeline->queues[2]);
+    return NULL;
+}
+
+/**
+ * Comprime os blocos com os estágios leitura -> análise -> codificação ->
+ * gravação em threads separadas, ligados por filas limitadas; a gravação
+ * roda na thread atual. A saída é idêntica à do laço em série.
+ * @param input Arquivo de entrada
+ * @param output Arquivo de saída (cabeçalho já gravado)
+ * @param block_size Tamanho máximo de bloco
+ * @param strategy Estratégia do nível de compressão
+ * @param use_pairs 1 para permitir a tabela de pares
+ * @param workspace Espaço de trabalho (estado da análise e índice de hashes)
+ * @param stats Estatísticas a atualizar
+ * @param result Recebe 0 se sucesso, -1 se erro de escrita
+ * @return 0 se o pipeline rodou, -1 se não pôde começar (nada foi lido)
+ */
+static int compressBlocksPipelined(FILE* input, FILE* output, size_t block_size, const LevelStrategy* strategy,
+                                   int use_pairs, BlockWorkspace* workspace, BlockStats* stats, int* result) {
+    BlockPipeline* pipeline = (BlockPipeline*)budgetMalloc(sizeof(BlockPipeline));
+    if (pipeline == NULL) {
+        return -1;
+    }
+    if (initBlockPipeline(pipeline, block_size, block_size, 3) != 0) {
+        freeBlockPipeline(pipeline);
+        budgetFree(pipeline);
+        return -1;
+    }
+    pipeline->input = input;
+    pipeline->workspace = workspace;
+    pipeline->strategy = strategy;
+    pipeline->use_pairs = use_pairs;
+    pipeline->block_size = block_size;
+
+    pthread_t threads[3];
+    void* (*const routines[3])(void*) = { compressReadStage, compressAnalyzeStage, compressEncodeStage };
+    if (startPipelineStages(pipeline, threads, routines, 3) != 0) {
+        freeBlockPipeline(pipeline);
+        budgetFree(pipeline);
+        return -1;
+    }
+
+    // Estágio de gravação: blocos em ordem, devolvidos à leitura depois de gravados
+    *result = 0;
+    PipelineBlock* slot;
+    while ((slot = (PipelineBlock*)ringPop(&pipeline->queues[2])) != NULL) {
+        if (emitBlock(output, &slot->plan, slot->encoded, stats) != 0) {
+            fprintf(stderr, "Erro: Falha ao gravar o bloco %llu\n", (unsigned long long)stats->blocks);
+            abortBlockPipeline(pipeline);
+            break;
+        }
+        progressAdvance(workspace->progress, slot->length);
+        ringPush(&pipeline->free_slots, slot);
+    }
+
+    for (int i = 0; i < 3; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    if (pipeline->failed) {
+        *result = -1;
+    }
+
+    recordPipelineStats(pipeline, stats);
+    freeBlockPipeline(pipeline);
+    budgetFree(pipeline);
+    return 0;
+}
+
+/**
+ * Comprime um fluxo em blocos independentes, em uma única passagem
+ * O uso de memória depende apenas do tamanho do bloco do plano.
+ * @param input Arquivo de entrada
+ * @param output Arquivo de saída
+ * @param plan Plano de memória (NULL = plano padrão sem limite)
+ * @param stats Estatísticas a preencher (pode ser NULL)
+ * @return 0 se sucesso, -1 se erro
+ */
+int compressStreamBlocks(FILE* input, FILE* output, const MemoryPlan* plan, BlockStats* stats) {
+    BlockWorkspace workspace;
+    initBlockWorkspace(&workspace);
+    int result = compressStreamBlocksWith(input, output, plan, stats, &workspace);
+    freeBlockWorkspace(&workspace);
+    return result;
+}
+
+/**
+ * Comprime um fluxo em blocos usando os buffers de um espaço de trabalho
+ * @param input Arquivo de entrada
+ * @param output Arquivo de saída
+ * @param plan Plano de memória (NULL = plano padrão sem limite)
+ * @param stats Estatísticas a preencher (pode ser NULL)
+ * @param workspace Espaço de trabalho reaproveitado entre chamadas
+ * @return 0 se sucesso, -1 se erro
+ */
+int compressStreamBlocksWith(FILE* input, FILE* output, const MemoryPlan* plan,
+                             BlockStats* stats, BlockWorkspace* workspace) {
+    MemoryPlan default_plan;
+    if (plan == NULL) {
+        planMemoryBudget(0, &default_plan);
+        plan = &default_plan;
+    }
+
+    BlockStats local_stats;
+    if (stats == NULL) {
+        stats = &local_stats;
+    }
+    memset(stats, 0, sizeof(BlockStats));
+
+    // Com limite de memória, o cache compartilhado guarda só as tabelas em
+    // uso (o plano reserva um conjunto de tabelas por thread)
+    if (plan->limit > 0) {
+        setTableCacheCapacity(0);
+    }
+
+    LevelStrategy strategy;
+    if (getLevelStrategy(workspace->level, &strategy) != 0) {
+        return -1;
+    }
+
+    // Os níveis rápidos usam blocos maiores, exceto quando há limite de memória
+    size_t block_size = plan->block_size;
+    if (plan->limit == 0) {
+        block_size <<= strategy.block_shift;
+        if (block_size > MAX_BLOCK_SIZE) {
+            block_size = MAX_BLOCK_SIZE;
+        }
+    }
+
+    if (reserveBlockWorkspace(workspace, block_size) != 0) {
+        fprintf(stderr, "Erro: Limite de memória excedido ao alocar os blocos\n");
+        return -1;
+    }
+
+    // Com limite de memória, a deduplicação só existe se o plano reservou os
+    // registros dos blocos; a descompressão sob o mesmo limite os comporta
+    int dedup = workspace->dedup;
+    if (plan->limit > 0 && !(plan->features & PLAN_DEDUP)) {
+        workspace->dedup = 0;
+    }
+    workspace->record_limit = dedupRecordLimit(plan->limit);
+
+    // A busca da melhor divisão muda os cortes, então não se combina com os
+    // cortes por conteúdo da deduplicação nem com a recompressão incremental
+    int split = strategy.split_unit > 0 && !workspace->dedup && workspace->base == NULL;
+
+    // A árvore repetida começa do zero em cada contêiner (saída determinística)
+    if (strategy.reuse_tables) {
+        releaseTables(workspace->cached_tables);
+        workspace->cached_tables = NULL;
+        workspace->tree_penalty = 0;
+    }
+
+    // Referências valem apenas dentro do mesmo contêiner
+    clearHashIndex(&workspace->dedup_index);
+    workspace->digest_count = 0;
+    workspace->hashes_failed = 0;
+
+    // Com limite de memória, o buffer transformado só existe se o plano o
+    // reservou; senão ocuparia a memória das tabelas
+    int transforms = workspace->transforms;
+    if (plan->limit > 0 && !(plan->features & PLAN_TRANSFORMS)) {
+        workspace->transforms = 0;
+    }
+
+    // O mesmo para o histograma e as tabelas do alfabeto de 16 bits
+    int wide = workspace->wide;
+    if (plan->limit > 0 && !(plan->features & PLAN_WIDE)) {
+        workspace->wide = 0;
+    }
+
+    // Cabeçalho: assinatura, versão, flags e tamanho máximo de bloco
+    fwrite(BLOCK_MAGIC, 1, BLOCK_MAGIC_SIZE, output);
+    fputc(workspace->wide ? BLOCK_FORMAT_VERSION :
+          workspace->transforms != 0 ? BLOCK_FORMAT_VERSION_TRANSFORM : BLOCK_FORMAT_VERSION_PLAIN, output);
+    fputc(workspace->dedup ? BLOCK_FLAG_DEDUP : 0, output);
+    writeUint32(output, (uint32_t)block_size);
+    stats->output_bytes = BLOCK_MAGIC_SIZE + 2 + 4;
+
+    if (workspace->dedup) {
+        initGearTable(workspace->gear);
+    }
+
+    // Sem busca de divisão, cópia do contêiner anterior ou limite de memória,
+    // os estágios podem rodar em threads separadas (saída idêntica)
+    int result;
+    int pipelined = workspace->pipeline && !split && workspace->base == NULL && plan->limit == 0;
+    if (!pipelined || compressBlocksPipelined(input, output, block_size, &strategy, plan->use_pair_table,
+                                              workspace, stats, &result) != 0) {
+        result = compressBlocksSerial(input, output, block_size, &strategy, split, plan->use_pair_table,
+                                      workspace, stats);
+    }
+
+    // Marcador de fim com o total de bytes originais
+    fputc(BLOCK_END, output);
+    writeUint64(output, stats->input_bytes);
+    stats->output_bytes += 9;
+
+    // Índice com o hash de cada bloco, usado por uma recompressão incremental
+    if (!workspace->hashes_failed) {
+        fwrite(BLOCK_INDEX_MAGIC, 1, BLOCK_MAGIC_SIZE, output);
+        for (uint64_t i = 0; i < stats->blocks; i++) {
+            writeUint64(output, workspace->hashes[i]);
+        }
+        stats->output_bytes += BLOCK_MAGIC_SIZE + 8 * stats->blocks;
+    }
+
+    if (ferror(input) || ferror(output)) {
+        result = -1;
+    }
+
+    workspace->transforms = transforms;
+    workspace->wide = wide;
+    workspace->dedup = dedup;
+    return result;
+}
+
+/**
+ * Retorna a tabela de decodificação de uma árvore, reaproveitando a do
+ * bloco anterior quando a árvore é a mesma e, senão, a do cache
+ * compartilhado entre threads (a árvore recebida é liberada)
+ * @param workspace Espaço de trabalho
+ * @param root Árvore lida do bloco
+ * @return Tabela de decodificação, ou NULL se falhou
+ */
+static const DecodeTable* workspaceDecodeTable(BlockWorkspace* workspace, HuffmanNode* root) {
+    unsigned char shape[MAX_SERIALIZED_TREE];
+    size_t shape_size = flattenTree(root, shape, 0);
+    freeHuffmanTree(root);
+
+    CachedTables* tables = workspace->cached_tables;
+    if (tables != NULL && shape_size == tables->shape_size && memcmp(shape, tables->shape, shape_size) == 0) {
+        workspace->table_hits++;
+        return cachedDecodeTable(tables);
+    }
+
+    releaseTables(tables);
+    workspace->cached_tables = acquireTables(shape, shape_size);
+    workspace->table_misses++;
+    return workspace->cached_tables != NULL ? cachedDecodeTable(workspace->cached_tables) : NULL;
+}
+
+/**
+ * Decodifica o conteúdo de um bloco Huffman já lido para a memória
+ * @param input Arquivo posicionado no início da árvore do bloco
+ * @param payload_size Bytes de árvore + fluxo de bits
+ * @param raw_size Bytes originais do bloco
+ * @param workspace Buffers do bloco e tabela em cache
+ * @return 0 se sucesso, -1 se o bloco está corrompido
+ */
+static int readHuffmanBlock(FILE* input, uint32_t payload_size, uint32_t raw_size,
+                            BlockWorkspace* workspace) {
+    unsigned char* compressed = workspace->encoded;
+    unsigned char* decoded = workspace->block;
+    size_t capacity = workspace->capacity;
+
+    // A origem lê só os bytes da árvore; o FILE* continua posicionado logo depois
+    ByteSource tree_source;
+    initFileSource(&tree_source, input);
+    HuffmanNode* root = deserializeTree(&tree_source);
+    closeSource(&tree_source);
+    if (root == NULL) {
+        return -1;
+    }
+
+    size_t tree_size = serializedTreeSize(root);
+    if (tree_size > payload_size || payload_size - tree_size > capacity) {
+        freeHuffmanTree(root);
+        return -1;
+    }
+
+    size_t bits_size = payload_size - tree_size;
+    if (fread(compressed, 1, bits_size, input) != bits_size) {
+        freeHuffmanTree(root);
+        return -1;
+    }
+
+    if (isLeaf(root)) {
+        // Árvore de um único símbolo: o bloco é a repetição do símbolo
+        memset(decoded, root->data, raw_size);
+        freeHuffmanTree(root);
+        return 0;
+    }
+
+    const DecodeTable* table = workspaceDecodeTable(workspace, root);
+    if (table == NULL) {
+        return -1;
+    }
+
+    BitReader reader;
+    initBitReaderFromMemory(&reader, compressed, bits_size);
+    return decodeSymbols(&reader, table, decoded, raw_size) == raw_size ? 0 : -1;
+}
+
+/**
+ * Descomprime um contêiner em blocos
+ * O uso de memória depende apenas do tamanho de bloco gravado no cabeçalho.
+ * @param input Arquivo comprimido
+ * @param output Arquivo de saída
+ * @param plan Plano de memória com o limite a respeitar (NULL = sem limite)
+ * @param stats Estatísticas a preencher (pode ser NULL)
+ * @return 0 se sucesso, -1 se erro
+ */
+int decompressStreamBlocks(FILE* input, FILE* output, const MemoryPlan* plan, BlockStats* stats) {
+    BlockWorkspace workspace;
+    initBlockWorkspace(&workspace);
+    int result = decompressStreamBlocksWith(input, output, plan, stats, &workspace);
+    freeBlockWorkspace(&workspace);
+    return result;
+}
+
+/**
+ * Lê o conteúdo de um bloco STORED, HUFFMAN, TRANSFORMED ou WIDE para workspace->block
+ * @param input Arquivo posicionado após o cabeçalho do bloco
+ * @param type Tipo do bloco
+ * @param raw_size Bytes originais
+ * @param payload_size Bytes do conteúdo
+ * @param block_size Tamanho máximo de bloco do contêiner
+ * @param workspace Buffers do bloco e tabela em cache
+ * @return 0 se sucesso, -1 se o bloco está truncado ou corrompido
+ */
+static int readBlockPayload(FILE* input, int type, uint32_t raw_size, uint32_t payload_size,
+                            uint32_t block_size, BlockWorkspace* workspace) {
+    if (type == BLOCK_STORED) {
+        return payload_size == raw_size &&
+               fread(workspace->block, 1, raw_size, input) == raw_size ? 0 : -1;
+    }
+    if (type == BLOCK_HUFFMAN) {
+        if (payload_size > block_size + MAX_SERIALIZED_TREE) {
+            return -1;
+        }
+        return readHuffmanBlock(input, payload_size, raw_size, workspace);
+    }
+    if (type == BLOCK_TRANSFORMED) {
+        int transform = fgetc(input);
+        uint32_t transformed_size;
+        if (transform == EOF || payload_size < 1 + 4 || readUint32(input, &transformed_size) != 0 ||
+            transformed_size > block_size || payload_size - (1 + 4) > block_size + MAX_SERIALIZED_TREE ||
+            reserveTransformBuffer(workspace) != 0 ||
+            readHuffmanBlock(input, payload_size - (1 + 4), transformed_size, workspace) != 0 ||
+            invertTransform((TransformType)transform, workspace->block, transformed_size,
+                            workspace->transformed, raw_size) != 0) {
+            return -1;
+        }
+
+        // O bloco restaurado passa a ser o buffer do bloco (mesma capacidade)
+        unsigned char* restored = workspace->transformed;
+        workspace->transformed = workspace->block;
+        workspace->block = restored;
+        return 0;
+    }
+    if (type == BLOCK_WIDE) {
+        return payload_size <= block_size &&
+               fread(workspace->encoded, 1, payload_size, input) == payload_size &&
+               decodeWideBlock(workspace->encoded, payload_size, workspace->block, raw_size) == 0 ? 0 : -1;
+    }
+    return -1;
+}
+
+/**
+ * Garante espaço para o registro do bloco de índice n
+ * @param workspace Espaço de trabalho
+ * @param n Índice do bloco
+ * @return 0 se sucesso, -1 se o limite de memória foi excedido
+ */
+static int reserveBlockRecords(BlockWorkspace* workspace, uint64_t n) {
+    if (n < workspace->record_capacity) {
+        return 0;
+    }
+
+    size_t capacity = workspace->record_capacity > 0 ? workspace->record_capacity * 2 : 64;
+    if (workspace->record_limit > 0 && capacity > workspace->record_limit) {
+        capacity = (size_t)workspace->record_limit;
+    }
+    BlockRecord* records = (BlockRecord*)budgetMalloc(capacity * sizeof(BlockRecord));
+    if (records == NULL) {
+        return -1;
+    }
+    if (workspace->records != NULL) {
+        memcpy(records, workspace->records, workspace->record_capacity * sizeof(BlockRecord));
+    }
+    budgetFree(workspace->records);
+    workspace->records = records;
+    workspace->record_capacity = capacity;
+    return 0;
+}
+
+/**
+ * Recupera os bytes de um bloco anterior para workspace->block
+ * Se a saída permite leitura (workspace->readable_output), copia os bytes já
+ * gravados sem decodificar de novo; senão, volta ao bloco de origem no
+ * contêiner e o decodifica.
+ * @param input Arquivo comprimido
+ * @param output Arquivo de saída (NULL = sem saída em arquivo)
+ * @param container_start Posição do cabeçalho do contêiner (-1 = entrada sem posição)
+ * @param record Registro do bloco de origem
+ * @param block_size Tamanho máximo de bloco do contêiner
+ * @param workspace Espaço de trabalho
+ * @return 0 se sucesso, -1 se erro
+ */
+static int resolveDuplicateBlock(FILE* input, FILE* output, off_t container_start, const BlockRecord* record,
+                                 uint32_t block_size, BlockWorkspace* workspace) {
+    if (output != NULL && workspace->readable_output && record->output_offset >= 0) {
+        if (fflush(output) != 0 || fseeko(output, (off_t)record->output_offset, SEEK_SET) != 0) {
+            return -1;
+        }
+        size_t copied = fread(workspace->block, 1, record->raw_size, output);
+        if (fseeko(output, 0, SEEK_END) != 0 || copied != record->raw_size) {
+            return -1;
+        }
+        return 0;
+    }
+
+    if (container_start < 0) {
+        return -1;
+    }
+
+    off_t position = ftello(input);
+    int type;
+    uint32_t raw_size;
+    uint32_t payload_size;
+    int result = -1;
+
+    if (position >= 0 && fseeko(input, container_start + (off_t)record->container_offset, SEEK_SET) == 0 &&
+        (type = fgetc(input)) != EOF && readUint32(input, &raw_size) == 0 &&
+        readUint32(input, &payload_size) == 0 && raw_size == record->raw_size) {
+        result = readBlockPayload(input, type, raw_size, payload_size, block_size, workspace);
+    }
+
+    if (position < 0 || fseeko(input, position, SEEK_SET) != 0) {
+        return -1;
+    }
+    return result;
+}
+
+/**
+ * Consome o índice de blocos opcional após o marcador de fim, deixando a
+ * entrada logo depois do contêiner
+ * @param input Arquivo posicionado após o total de bytes originais
+ * @param blocks Número de blocos do contêiner
+ * @return 0 se sucesso, -1 se o índice está truncado
+ */
+static int skipBlockIndex(FILE* input, uint64_t blocks) {
+    char magic[BLOCK_MAGIC_SIZE];
+    size_t bytes_read = fread(magic, 1, BLOCK_MAGIC_SIZE, input);
+
+    if (bytes_read != BLOCK_MAGIC_SIZE || memcmp(magic, BLOCK_INDEX_MAGIC, BLOCK_MAGIC_SIZE) != 0) {
+        // Contêiner sem índice: devolve o que foi lido além do fim
+        if (bytes_read > 0) {
+            fseeko(input, -(off_t)bytes_read, SEEK_CUR);
+        }
+        clearerr(input);
+        return 0;
+    }
+
+    for (uint64_t i = 0; i < blocks; i++) {
+        uint64_t hash;
+        if (readUint64(input, &hash) != 0) {
+            fprintf(stderr, "Erro: Índice de blocos truncado\n");
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Lê e valida o cabeçalho de um contêiner em blocos
+ * @param input Arquivo posicionado no início do contêiner
+ * @param version Recebe a versão do formato
+ * @param block_size Recebe o tamanho máximo de bloco
+ * @param flags Recebe as flags do cabeçalho
+ * @return 0 se sucesso, -1 se o cabeçalho é inválido ou não suportado
+ */
+int readContainerHeader(FILE* input, int* version, uint32_t* block_size, int* flags) {
+    char magic[BLOCK_MAGIC_SIZE];
+
+    if (fread(magic, 1, BLOCK_MAGIC_SIZE, input) != BLOCK_MAGIC_SIZE ||
+        memcmp(magic, BLOCK_MAGIC, BLOCK_MAGIC_SIZE) != 0 ||
+        (*version = fgetc(input)) == EOF || (*flags = fgetc(input)) == EOF ||
+        readUint32(input, block_size) != 0) {
+        fprintf(stderr, "Erro: Formato de arquivo inválido\n");
+        return -1;
+    }
+
+    if (*version > BLOCK_FORMAT_VERSION || *block_size == 0 || *block_size > MAX_BLOCK_SIZE) {
+        fprintf(stderr, "Erro: Versão ou tamanho de bloco não suportado\n");
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Informa a falha na decodificação de um bloco, separando a falta de
+ * memória (alocação recusada nesta thread) de dados corrompidos
+ * @param block Índice do bloco
+ */
+static void reportBlockFailure(uint64_t block) {
+    if (budgetExceeded()) {
+        fprintf(stderr, "Erro: Limite de memória excedido ao decodificar o bloco %llu\n", (unsigned long long)block);
+    } else {
+        fprintf(stderr, "Erro: Bloco %llu corrompido\n", (unsigned long long)block);
+    }
+}
+
+/**
+ * Lê e decodifica o próximo bloco de um contêiner para workspace->block
+ * Referências a blocos anteriores só são aceitas em contêineres com
+ * BLOCK_FLAG_DEDUP, os únicos que guardam a posição de cada bloco.
+ * @param input Arquivo comprimido (no início de um bloco)
+ * @param output Saída onde o bloco será gravado (NULL = sem saída em arquivo)
+ * @param container_start Posição do cabeçalho do contêiner (-1 = entrada sem posição)
+ * @param block_size Tamanho máximo de bloco do contêiner
+ * @param flags Flags do cabeçalho do contêiner
+ * @param workspace Espaço de trabalho
+ * @param stats Estatísticas a atualizar
+ * @param raw_size Recebe os bytes decodificados do bloco
+ * @return 1 se um bloco foi decodificado, 0 no fim do contêiner, -1 se erro
+ */
+int decodeNextBlock(FILE* input, FILE* output, off_t container_start, uint32_t block_size, int flags,
+                    BlockWorkspace* workspace, BlockStats* stats, uint32_t* raw_size) {
+    off_t block_start = container_start >= 0 ? ftello(input) : -1;
+    off_t output_start = output != NULL ? ftello(output) : -1;
+    int type = fgetc(input);
+    uint32_t payload_size;
+
+    if (type == BLOCK_END) {
+        uint64_t total;
+        if (readUint64(input, &total) != 0 || total != stats->input_bytes) {
+            fprintf(stderr, "Erro: Tamanho total não confere com o contêiner\n");
+            return -1;
+        }
+        if (skipBlockIndex(input, stats->blocks) != 0) {
+            return -1;
+        }
+        off_t end = block_start >= 0 ? ftello(input) : -1;
+        progressAdvance(workspace->progress, end >= 0 ? (uint64_t)(end - block_start) : 9);
+        return 0;
+    }
+
+    if (type == EOF || readUint32(input, raw_size) != 0 || readUint32(input, &payload_size) != 0 ||
+        *raw_size > block_size) {
+        fprintf(stderr, "Erro: Contêiner truncado ou corrompido\n");
+        return -1;
+    }
+
+    // Só os blocos que a compressão pode ter referenciado sob o limite têm registro
+    BlockRecord* record = NULL;
+    uint64_t recorded = workspace->record_limit > 0 && stats->blocks > workspace->record_limit ?
+                        workspace->record_limit : stats->blocks;
+    if ((flags & BLOCK_FLAG_DEDUP) && (workspace->record_limit == 0 || stats->blocks < workspace->record_limit)) {
+        if (reserveBlockRecords(workspace, stats->blocks) != 0) {
+            fprintf(stderr, "Erro: Limite de memória excedido ao registrar os blocos\n");
+            return -1;
+        }
+        record = &workspace->records[stats->blocks];
+        record->container_offset = block_start >= 0 ? (uint64_t)(block_start - container_start) : 0;
+        record->output_offset = output_start;
+        record->raw_size = *raw_size;
+    }
+
+    if (type == BLOCK_DUP) {
+        uint64_t reference;
+        int valid = (flags & BLOCK_FLAG_DEDUP) && payload_size == 8 && readUint64(input, &reference) == 0 &&
+                    reference < stats->blocks;
+        if (valid && reference >= recorded) {
+            fprintf(stderr, "Erro: O bloco %llu referencia um bloco além do limite de memória\n",
+                    (unsigned long long)stats->blocks);
+            return -1;
+        }
+        if (!valid ||
+            workspace->records[reference].raw_size != *raw_size ||
+            resolveDuplicateBlock(input, output, container_start, &workspace->records[reference],
+                                  block_size, workspace) != 0) {
+            fprintf(stderr, "Erro: Referência inválida no bloco %llu\n", (unsigned long long)stats->blocks);
+            return -1;
+        }
+        // A origem de uma cópia é sempre o bloco codificado
+        if (record != NULL) {
+            record->container_offset = workspace->records[reference].container_offset;
+        }
+        stats->dedup_blocks++;
+        stats->dedup_bytes += *raw_size;
+    } else if (type == BLOCK_STORED || type == BLOCK_HUFFMAN || type == BLOCK_TRANSFORMED || type == BLOCK_WIDE) {
+        clearBudgetExceeded();
+        if (readBlockPayload(input, type, *raw_size, payload_size, block_size, workspace) != 0) {
+            reportBlockFailure(stats->blocks);
+            return -1;
+        }
+        if (type == BLOCK_STORED) {
+            stats->stored_blocks++;
+        } else if (type == BLOCK_TRANSFORMED) {
+            stats->transformed_blocks++;
+        } else if (type == BLOCK_WIDE) {
+            stats->wide_blocks++;
+        }
+    } else {
+        fprintf(stderr, "Erro: Tipo de bloco desconhecido (%d)\n", type);
+        return -1;
+    }
+
+    stats->blocks++;
+    stats->input_bytes += *raw_size;
+    stats->output_bytes += 9 + payload_size;
+    progressAdvance(workspace->progress, 9 + (uint64_t)payload_size);
+    return 1;
+}
+
+/**
+ * Laço em série da descompressão: lê, decodifica e grava um bloco de cada vez
+ * @param input Arquivo comprimido (após o cabeçalho)
+ * @param output Arquivo de saída
+ * @param container_start Posição do cabeçalho do contêiner (-1 = entrada sem posição)
+ * @param block_size Tamanho máximo de bloco do contêiner
+ * @param flags Flags do cabeçalho do contêiner
+ * @param workspace Espaço de trabalho
+ * @param stats Estatísticas a atualizar
+ * @return 0 se sucesso, -1 se erro
+ */
+static int decompressBlocksSerial(FILE* input, FILE* output, off_t container_start, uint32_t block_size,
+                                  int flags, BlockWorkspace* workspace, BlockStats* stats) {
+    for (;;) {
+        if (blockCancelled(workspace)) {
+            return -1;
+        }
+        uint32_t raw_size;
+        int decoded = decodeNextBlock(input, output, container_start, block_size, flags, workspace, stats, &raw_size);
+        if (decoded <= 0) {
+            return decoded;
+        }
+        fwrite(workspace->block, 1, raw_size, output);
+    }
+}
+
+/**
+ * Decodifica o conteúdo de um bloco Huffman que está todo na memória
+ * @param payload Árvore + fluxo de bits
+ * @param payload_size Bytes do conteúdo
+ * @param raw_size Bytes originais do bloco
+ * @param decoded Destino (ao menos raw_size bytes)
+ * @param workspace Tabela em cache
+ * @return 0 se sucesso, -1 se o bloco está corrompido
+ */
+static int decodeHuffmanPayload(unsigned char* payload, size_t payload_size, uint32_t raw_size,
+                                unsigned char* decoded, BlockWorkspace* workspace) {
+    ByteSource tree_source;
+    initMemorySource(&tree_source, payload, payload_size);
+    HuffmanNode* root = deserializeTree(&tree_source);
+    closeSource(&tree_source);
+    if (root == NULL) {
+        return -1;
+    }
+
+    size_t tree_size = serializedTreeSize(root);
+    if (tree_size > payload_size) {
+        freeHuffmanTree(root);
+        return -1;
+    }
+
+    if (isLeaf(root)) {
+        // Árvore de um único símbolo: o bloco é a repetição do símbolo
+        memset(decoded, root->data, raw_size);
+        freeHuffmanTree(root);
+        return 0;
+    }
+
+    const DecodeTable* table = workspaceDecodeTable(workspace, root);
+    if (table == NULL) {
+        return -1;
+    }
+
+    BitReader reader;
+    initBitReaderFromMemory(&reader, payload + tree_size, payload_size - tree_size);
+    return decodeSymbols(&reader, table, decoded, raw_size) == raw_size ? 0 : -1;
+}
+
+/**
+ * Estágio de leitura da descompressão: lê cabeçalho e conteúdo de cada
+ * bloco para um bloco livre, e por fim o marcador de fim e o índice
+ * @param argument Pipeline
+ * @return NULL
+ */
+static void* decompressReadStage(void* argument) {
+    BlockPipeline* pipeline = (BlockPipeline*)argument;
+    FILE* input = pipeline->input;
+    size_t block_size = pipeline->block_size;
+    uint64_t blocks = 0;
+    uint64_t total_raw = 0;
+
+    for (;;) {
+        if (blockCancelled(pipeline->workspace)) {
+            abortBlockPipeline(pipeline);
+            break;
+        }
+        off_t block_start = ftello(input);
+        int type = fgetc(input);
+        uint32_t raw_size;
+        uint32_t payload_size;
+
+        if (type == BLOCK_END) {
+            uint64_t total;
+            if (readUint64(input, &total) == 0 && total == total_raw) {
+                pipeline->end_result = skipBlockIndex(input, blocks);
+                off_t end = block_start >= 0 ? ftello(input) : -1;
+                pipeline->end_bytes = end >= 0 ? (uint64_t)(end - block_start) : 9;
+            } else {
+                fprintf(stderr, "Erro: Tamanho total não confere com o contêiner\n");
+            }
+            if (pipeline->end_result != 0) {
+                abortBlockPipeline(pipeline);
+            }
+            break;
+        }
+
+        if (type == EOF || readUint32(input, &raw_size) != 0 || readUint32(input, &payload_size) != 0 ||
+            raw_size > block_size) {
+            fprintf(stderr, "Erro: Contêiner truncado ou corrompido\n");
+            abortBlockPipeline(pipeline);
+            break;
+        }
+        if (type != BLOCK_STORED && type != BLOCK_HUFFMAN && type != BLOCK_TRANSFORMED && type != BLOCK_WIDE) {
+            fprintf(stderr, "Erro: Tipo de bloco desconhecido (%d)\n", type);
+            abortBlockPipeline(pipeline);
+            break;
+        }
+
+        // Os mesmos limites de readBlockPayload, antes de ler o conteúdo
+        int valid = type == BLOCK_STORED ? payload_size == raw_size :
+                    type == BLOCK_HUFFMAN ? payload_size <= block_size + MAX_SERIALIZED_TREE :
+                    type == BLOCK_WIDE ? payload_size <= block_size :
+                    payload_size >= 1 + 4 && payload_size - (1 + 4) <= block_size + MAX_SERIALIZED_TREE;
+        PipelineBlock* slot = valid ? (PipelineBlock*)ringPop(&pipeline->free_slots) : NULL;
+        if (slot == NULL) {
+            if (!valid) {
+                fprintf(stderr, "Erro: Bloco %llu corrompido\n", (unsigned long long)blocks);
+                abortBlockPipeline(pipeline);
+            }
+            break;
+        }
+
+        unsigned char* destination = type == BLOCK_STORED ? slot->block : slot->encoded;
+        if (fread(destination, 1, payload_size, input) != payload_size) {
+            fprintf(stderr, "Erro: Bloco %llu corrompido\n", (unsigned long long)blocks);
+            abortBlockPipeline(pipeline);
+            break;
+        }
+
+        slot->type = type;
+        slot->length = raw_size;
+        slot->payload_size = payload_size;
+        if (ringPush(&pipeline->queues[0], slot) != 0) {
+            break;
+        }
+        blocks++;
+        total_raw += raw_size;
+    }
+
+    ringClose(&pipeline->queues[0]);
+    return NULL;
+}
+
+/**
+ * Estágio de decodificação da descompressão: fluxo de bits e transformação
+ * inversa de cada bloco (em ordem, pois a tabela em cache segue os blocos)
+ * @param argument Pipeline
+ * @return NULL
+ */
+static void* decompressDecodeStage(void* argument) {
+    BlockPipeline* pipeline = (BlockPipeline*)argument;
+    BlockWorkspace* workspace = pipeline->workspace;
+    uint64_t n = 0;
+    PipelineBlock* slot;
+
+    while ((slot = (PipelineBlock*)ringPop(&pipeline->queues[0])) != NULL) {
+        int result = 0;
+        clearBudgetExceeded();
+        if (slot->type == BLOCK_HUFFMAN) {
+            result = decodeHuffmanPayload(slot->encoded, slot->payload_size, (uint32_t)slot->length,
+                                          slot->block, workspace);
+        } else if (slot->type == BLOCK_TRANSFORMED) {
+            int transform = slot->encoded[0];
+            uint32_t transformed_size = (uint32_t)slot->encoded[1] | ((uint32_t)slot->encoded[2] << 8) |
+                                        ((uint32_t)slot->encoded[3] << 16) | ((uint32_t)slot->encoded[4] << 24);
+            if (slot->transformed == NULL) {
+                slot->transformed = (unsigned char*)budgetMalloc(pipeline->capacity);
+            }
+            result = transformed_size > pipeline->block_size || slot->transformed == NULL ||
+                     decodeHuffmanPayload(slot->encoded + 1 + 4, slot->payload_size - (1 + 4), transformed_size,
+                                          slot->transformed, workspace) != 0 ||
+                     invertTransform((TransformType)transform, slot->transformed, transformed_size,
+                                     slot->block, slot->length) != 0 ? -1 : 0;
+        } else if (slot->type == BLOCK_WIDE) {
+            result = decodeWideBlock(slot->encoded, slot->payload_size, slot->block, slot->length);
+        }
+
+        if (result != 0) {
+            reportBlockFailure(n);
+            abortBlockPipeline(pipeline);
+            break;
+        }
+        n++;
+
+        if (ringPush(&pipeline->queues[1], slot) != 0) {
+            break;
+        }
+    }
+
+    ringClose(&pipeline->queues[1]);
+    return NULL;
+}
+
+/**
+ * Descomprime os blocos com os estágios leitura -> decodificação ->
+ * gravação em threads separadas, ligados por filas limitadas; a gravação
+ * roda na thread atual. Não trata blocos DUP (contêineres com deduplicação
+ * usam o laço em série).
+ * @param input Arquivo comprimido (após o cabeçalho)
+ * @param output Arquivo de saída
+ * @param block_size Tamanho máximo de bloco do contêiner
+ * @param workspace Espaço de trabalho (tabela em cache e progresso)
+ * @param stats Estatísticas a atualizar
+ * @param result Recebe 0 se sucesso, -1 se erro
+ * @return 0 se o pipeline rodou, -1 se não pôde começar (nada foi lido)
+ */
+static int decompressBlocksPipelined(FILE* input, FILE* output, uint32_t block_size,
+                                     BlockWorkspace* workspace, BlockStats* stats, int* result) {
+    BlockPipeline* pipeline = (BlockPipeline*)budgetMalloc(sizeof(BlockPipeline));
+    if (pipeline == NULL) {
+        return -1;
+    }
+    if (initBlockPipeline(pipeline, block_size, (size_t)block_size + MAX_SERIALIZED_TREE + 1 + 4, 2) != 0) {
+        freeBlockPipeline(pipeline);
+        budgetFree(pipeline);
+        return -1;
+    }
+    pipeline->input = input;
+    pipeline->workspace = workspace;
+    pipeline->block_size = block_size;
+
+    pthread_t threads[2];
+    void* (*const routines[2])(void*) = { decompressReadStage, decompressDecodeStage };
+    if (startPipelineStages(pipeline, threads, routines, 2) != 0) {
+        freeBlockPipeline(pipeline);
+        budgetFree(pipeline);
+        return -1;
+    }
+
+    // Estágio de gravação: blocos em ordem, devolvidos à leitura depois de gravados
+    PipelineBlock* slot;
+    while ((slot = (PipelineBlock*)ringPop(&pipeline->queues[1])) != NULL) {
+        if (fwrite(slot->block, 1, slot->length, output) != slot->length) {
+            fprintf(stderr, "Erro: Falha ao gravar o bloco %llu\n", (unsigned long long)stats->blocks);
+            abortBlockPipeline(pipeline);
+            break;
+        }
+        if (slot->type == BLOCK_STORED) {
+            stats->stored_blocks++;
+        } else if (slot->type == BLOCK_TRANSFORMED) {
+            stats->transformed_blocks++;
+        } else if (slot->type == BLOCK_WIDE) {
+            stats->wide_blocks++;
+        }
+        stats->blocks++;
+        stats->input_bytes += slot->length;
+        stats->output_bytes += 9 + slot->payload_size;
+        progressAdvance(workspace->progress, 9 + (uint64_t)slot->payload_size);
+        ringPush(&pipeline->free_slots, slot);
+    }
+
+    for (int i = 0; i < 2; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    *result = pipeline->failed ? -1 : pipeline->end_result;
+    if (*result == 0) {
+        progressAdvance(workspace->progress, pipeline->end_bytes);
+    }
+
+    recordPipelineStats(pipeline, stats);
+    freeBlockPipeline(pipeline);
+    budgetFree(pipeline);
+    return 0;
+}
+
+/**
+ * Descomprime um contêiner em blocos usando os buffers e a tabela em
+ * cache de um espaço de trabalho
+ * @param input Arquivo comprimido
+ * @param output Arquivo de saída
+ * @param plan Plano de memória com o limite a respeitar (NULL = sem limite)
+ * @param stats Estatísticas a preencher (pode ser NULL)
+ * @param workspace Espaço de trabalho reaproveitado entre chamadas
+ * @return 0 se sucesso, -1 se erro
+ */
+int decompressStreamBlocksWith(FILE* input, FILE* output, const MemoryPlan* plan,
+                               BlockStats* stats, BlockWorkspace* workspace) {
+    BlockStats local_stats;
+    if (stats == NULL) {
+        stats = &local_stats;
+    }
+    memset(stats, 0, sizeof(BlockStats));
+
+    int version;
+    int flags;
+    uint32_t block_size;
+    off_t container_start = ftello(input);
+    if (readContainerHeader(input, &version, &block_size, &flags) != 0) {
+        return -1;
+    }
+
+    // O limite precisa comportar um bloco comprimido, um descomprimido, as
+    // tabelas e, nas versões com transformações ou blocos de 16 bits, o
+    // bloco transformado e as tabelas de 16 bits; com deduplicação, também
+    // a fração dos registros dos blocos
+    int features = version >= BLOCK_FORMAT_VERSION ? PLAN_TRANSFORMS | PLAN_WIDE :
+                   version >= BLOCK_FORMAT_VERSION_TRANSFORM ? PLAN_TRANSFORMS : 0;
+    if (plan != NULL && plan->limit > 0) {
+        size_t required = workspaceMemoryRequirement(block_size, features);
+        size_t records = (flags & BLOCK_FLAG_DEDUP) ? plan->limit / DEDUP_RECORD_SHARE : 0;
+        if (required + records > plan->limit) {
+            size_t minimum = (flags & BLOCK_FLAG_DEDUP) ?
+                             (required * DEDUP_RECORD_SHARE + DEDUP_RECORD_SHARE - 2) / (DEDUP_RECORD_SHARE - 1) :
+                             required;
+            fprintf(stderr, "Erro: O arquivo usa blocos de %u bytes, acima do limite de memória (mínimo %zu bytes)\n",
+                    block_size, minimum);
+            return -1;
+        }
+        setTableCacheCapacity(0);
+    }
+    workspace->record_limit = plan != NULL ? dedupRecordLimit(plan->limit) : 0;
+
+    if (reserveBlockWorkspace(workspace, block_size) != 0) {
+        fprintf(stderr, "Erro: Limite de memória excedido ao alocar os blocos\n");
+        return -1;
+    }
+
+    // O progresso da descompressão conta os bytes lidos do contêiner
+    progressAdvance(workspace->progress, BLOCK_MAGIC_SIZE + 2 + 4);
+
+    // Sem referências a blocos anteriores nem limite de memória, leitura,
+    // decodificação e gravação podem rodar em threads separadas
+    int result;
+    int pipelined = workspace->pipeline && !(flags & BLOCK_FLAG_DEDUP) && (plan == NULL || plan->limit == 0);
+    if (!pipelined || decompressBlocksPipelined(input, output, block_size, workspace, stats, &result) != 0) {
+        result = decompressBlocksSerial(input, output, container_start, block_size, flags, workspace, stats);
+    }
+
+    if (ferror(output)) {
+        result = -1;
+    }
+
+    return result;
+}
+
+/**
+ * Comprime um arquivo no formato em blocos
+ * @param input_filename Nome do arquivo de entrada
+ * @param output_filename Nome do arquivo de saída
+ * @param plan Plano de memória (NULL = plano padrão)
+ * @param stats Estatísticas a preencher (pode ser NULL)
+ * @return 0 se sucesso, -1 se erro
+ */
+int compressFileBlocks(const char* input_filename, const char* output_filename,
+                       const MemoryPlan* plan, BlockStats* stats) {
+    BlockWorkspace workspace;
+    initBlockWorkspace(&workspace);
+    int result = compressFileBlocksWith(input_filename, output_filename, plan, stats, &workspace);
+    freeBlockWorkspace(&workspace);
+    return result;
+}
+
+/**
+ * Comprime um arquivo no formato em blocos com um espaço de trabalho
+ * (por exemplo, com a deduplicação de blocos ativada)
+ * @param input_filename Nome do arquivo de entrada
+ * @param output_filename Nome do arquivo de saída
+ * @param plan Plano de memória (NULL = plano padrão)
+ * @param stats Estatísticas a preencher (pode ser NULL)
+ * @param workspace Espaço de trabalho
+ * @return 0 se sucesso, -1 se erro
+ */
+int compressFileBlocksWith(const char* input_filename, const char* output_filename,
+                           const MemoryPlan* plan, BlockStats* stats, BlockWorkspace* workspace) {
+    FILE* input = fopen(input_filename, "rb");
+    if (input == NULL) {
+        fprintf(stderr, "Erro: Arquivo de entrada '%s' não encontrado\n", input_filename);
+        return -1;
+    }
+
+    FILE* output = fopen(output_filename, "wb");
+    if (output == NULL) {
+        fprintf(stderr, "Erro: Não foi possível abrir os arquivos\n");
+        fclose(input);
+        return -1;
+    }
+
+    int result = compressStreamBlocksWith(input, output, plan, stats, workspace);
+
+    fclose(input);
+    if (fclose(output) != 0) {
+        result = -1;
+    }
+    return result;
+}
+
+/**
+ * Descomprime um arquivo no formato em blocos
+ * @param input_filename Nome do arquivo comprimido
+ * @param output_filename Nome do arquivo de saída
+ * @param plan Plano de memória com o limite a respeitar (NULL = sem limite)
+ * @param stats Estatísticas a preencher (pode ser NULL)
+ * @return 0 se sucesso, -1 se erro
+ */
+int decompressFileBlocks(const char* input_filename, const char* output_filename,
+                         const MemoryPlan* plan, BlockStats* stats) {
+    BlockWorkspace workspace;
+    initBlockWorkspace(&workspace);
+    int result = decompressFileBlocksWith(input_filename, output_filename, plan, stats, &workspace);
+    freeBlockWorkspace(&workspace);
+    return result;
+}
+
+/**
+ * Descomprime um arquivo no formato em blocos com um espaço de trabalho
+ * (por exemplo, com o progresso ligado)
+ * @param input_filename Nome do arquivo comprimido
+ * @param output_filename Nome do arquivo de saída
+ * @param plan Plano de memória com o limite a respeitar (NULL = sem limite)
+ * @param stats Estatísticas a preencher (pode ser NULL)
+ * @param workspace Espaço de trabalho
+ * @return 0 se sucesso, -1 se erro
+ */
+int decompressFileBlocksWith(const char* input_filename, const char* output_filename,
+                             const MemoryPlan* plan, BlockStats* stats, BlockWorkspace* workspace) {
+    FILE* input = fopen(input_filename, "rb");
+    if (input == NULL) {
+        fprintf(stderr, "Erro: Arquivo de entrada '%s' não encontrado\n", input_filename);
+        return -1;
+    }
+
+    // Saída também legível: referências a blocos repetidos copiam os bytes já gravados
+    FILE* output = fopen(output_filename, "w+b");
+    if (output == NULL) {
+        fprintf(stderr, "Erro: Não foi possível abrir os arquivos\n");
+        fclose(input);
+        return -1;
+    }
+
+    workspace->readable_output = 1;
+    int result = decompressStreamBlocksWith(input, output, plan, stats, workspace);
+
+    fclose(input);
+    if (fclose(output) != 0) {
+        result = -1;
+    }
+
+    // Uma saída incompleta não fica no lugar do arquivo descomprimido
+    if (result != 0) {
+        remove(output_filename);
+    }
+    return result;
+}
+
+/**
+ * Calcula o tamanho exato de um bloco no contêiner, com as mesmas regras de
+ * writeBlock no nível padrão, a partir das frequências e dos comprimentos dos
+ * códigos (sem codificar)
+ * @param frequencies Frequências do bloco
+ * @param length Tamanho do bloco
+ * @param stored Recebe 1 se o bloco seria gravado sem codificação
+ * @return Bytes do bloco (cabeçalho incluído)
+ */
+static uint64_t estimateBlockSize(unsigned long* frequencies, size_t length, int* stored) {
+    HuffmanNode* root = buildHuffmanTree(frequencies);
+    char codes[MAX_CHAR][MAX_TREE_HT] = {{0}};
+    char current_code[MAX_TREE_HT] = {0};
+    generateHuffmanCodes(root, current_code, 0, codes);
+    freeHuffmanTree(root);
+
+    uint64_t bits = 0;
+    size_t max_length = 0;
+    int leaves = 0;
+    for (int c = 0; c < MAX_CHAR; c++) {
+        if (frequencies[c] > 0) {
+            size_t code_length = strlen(codes[c]);
+            bits += (uint64_t)frequencies[c] * code_length;
+            max_length = code_length > max_length ? code_length : max_length;
+            leaves++;
+        }
+    }
+
+    // Códigos longos demais para a tabela inteira também caem no bloco sem codificação
+    uint64_t payload = (uint64_t)(3 * leaves - 1) + (bits + 7) / 8;
+    *stored = max_length > MAX_INTEGER_CODE_LENGTH || payload >= length;
+    return 9 + (*stored ? length : payload);
+}
+
+/**
+ * Prevê o tamanho comprimido de um fluxo nos dois formatos, lendo a entrada
+ * uma única vez e contando apenas as frequências (nada é codificado nem gravado)
+ * Os blocos seguem o tamanho do plano e o nível padrão, sem deduplicação.
+ * @param input Arquivo de entrada
+ * @param plan Plano de memória (NULL = plano padrão sem limite)
+ * @param estimate Estimativa a preencher
+ * @return 0 se sucesso, -1 se erro
+ */
+int estimateStreamSize(FILE* input, const MemoryPlan* plan, SizeEstimate* estimate) {
+    MemoryPlan default_plan;
+    if (plan == NULL) {
+        planMemoryBudget(0, &default_plan);
+        plan = &default_plan;
+    }
+    memset(estimate, 0, sizeof(SizeEstimate));
+
+    unsigned char* block = (unsigned char*)budgetMalloc(plan->block_size);
+    if (block == NULL) {
+        fprintf(stderr, "Erro: Limite de memória excedido ao alocar os blocos\n");
+        return -1;
+    }
+
+    unsigned long totals[MAX_CHAR] = {0};
+    size_t length;
+    while ((length = readBlock(input, block, plan->block_size)) > 0) {
+        unsigned long frequencies[MAX_CHAR] = {0};
+        countFrequencies(block, length, frequencies);
+        for (int c = 0; c < MAX_CHAR; c++) {
+            totals[c] += frequencies[c];
+        }
+
+        int stored;
+        estimate->block_bytes += estimateBlockSize(frequencies, length, &stored);
+        estimate->stored_blocks += stored;
+        estimate->blocks++;
+        estimate->input_bytes += length;
+    }
+    budgetFree(block);
+
+    if (ferror(input)) {
+        fprintf(stderr, "Erro: Falha ao ler a entrada\n");
+        return -1;
+    }
+
+    // Cabeçalho, marcador de fim com o total e índice com um hash por bloco
+    estimate->block_bytes += BLOCK_MAGIC_SIZE + 2 + 4 + 9 + BLOCK_MAGIC_SIZE + 8 * estimate->blocks;
+    estimate->single_stream_bytes = estimateCompressedSize(totals);
+    return 0;
+}
+
+/**
+ * Prevê o tamanho comprimido de um arquivo nos dois formatos
+ * @param filename Nome do arquivo
+ * @param plan Plano de memória (NULL = plano padrão sem limite)
+ * @param estimate Estimativa a preencher
+ * @return 0 se sucesso, -1 se erro
+ */
+int estimateFileSize(const char* filename, const MemoryPlan* plan, SizeEstimate* estimate) {
+    FILE* input = fopen(filename, "rb");
+    if (input == NULL) {
+        fprintf(stderr, "Erro: Arquivo de entrada '%s' não encontrado\n", filename);
+        return -1;
+    }
+
+    int result = estimateStreamSize(input, plan, estimate);
+    fclose(input);
+    return result;
+}
+
+/**
+ * Imprime as estatísticas de uma operação em blocos
+ * @param stats Estatísticas
+ */
+void printBlockStats(const BlockStats* stats) {
+    printf("\n=== Estatísticas dos Blocos ===\n");
+    printf("Blocos: %llu (%llu sem codificação)\n",
+           (unsigned long long)stats->blocks, (unsigned long long)stats->stored_blocks);
+    printf("Bytes originais: %llu\n", (unsigned long long)stats->input_bytes);
+    printf("Bytes do contêiner: %llu\n", (unsigned long long)stats->output_bytes);
+    if (stats->dedup_blocks > 0) {
+        printf("Blocos duplicados: %llu (%.1f%% dos blocos, %llu bytes)\n",
+               (unsigned long long)stats->dedup_blocks, 100.0 * stats->dedup_blocks / stats->blocks,
+               (unsigned long long)stats->dedup_bytes);
+    }
+    if (stats->reused_blocks > 0) {
+        printf("Blocos reaproveitados: %llu (%.1f%% dos blocos, %llu bytes)\n",
+               (unsigned long long)stats->reused_blocks, 100.0 * stats->reused_blocks / stats->blocks,
+               (unsigned long long)stats->reused_bytes);
+    }
+    if (stats->transformed_blocks > 0) {
+        printf("Blocos transformados: %llu (%.1f%% dos blocos)\n",
+               (unsigned long long)stats->transformed_blocks, 100.0 * stats->transformed_blocks / stats->blocks);
+    }
+    if (stats->wide_blocks > 0) {
+        printf("Blocos com símbolos de 16 bits: %llu (%.1f%% dos blocos)\n",
+               (unsigned long long)stats->wide_blocks, 100.0 * stats->wide_blocks / stats->blocks);
+    }
+    if (stats->pipeline_stages > 0) {
+        // A compressão tem quatro estágios e a descompressão, três
+        static const char* const compress_queues[] = { "leitura → análise", "análise → codificação",
+                                                       "codificação → gravação" };
+        static const char* const decompress_queues[] = { "leitura → decodificação", "decodificação → gravação" };
+        const char* const* names = stats->pipeline_stages == 4 ? compress_queues : decompress_queues;
+
+        printf("Pipeline: %d estágios\n", stats->pipeline_stages);
+        for (int q = 0; q < stats->pipeline_stages - 1; q++) {
+            const SpscRingStats* queue = &stats->queues[q];
+            printf("  Fila %s: ocupação média %.2f/%zu, %llu esperas com fila cheia, %llu com fila vazia\n",
+                   names[q], queue->average_occupancy, queue->capacity,
+                   (unsigned long long)queue->full_waits, (unsigned long long)queue->empty_waits);
+        }
+    }
+}
+
+/**
+ * Abre um contêiner anterior e monta o índice hash -> bloco a partir do
+ * índice gravado no fim do contêiner (apenas os cabeçalhos dos blocos são lidos)
+ * @param filename Nome do contêiner anterior
+ * @param index Índice a preencher
+ * @return 0 se sucesso, -1 se o arquivo não é um contêiner com índice de blocos
+ */
+int openBlockIndex(const char* filename, BlockIndex* index) {
+    memset(index, 0, sizeof(BlockIndex));
+    initHashIndex(&index->blocks);
+
+    index->file = fopen(filename, "rb");
+    if (index->file == NULL) {
+        fprintf(stderr, "Erro: Arquivo '%s' não encontrado\n", filename);
+        return -1;
+    }
+
+    FILE* file = index->file;
+    char magic[BLOCK_MAGIC_SIZE];
+    int version;
+    if (fread(magic, 1, BLOCK_MAGIC_SIZE, file) != BLOCK_MAGIC_SIZE ||
+        memcmp(magic, BLOCK_MAGIC, BLOCK_MAGIC_SIZE) != 0 ||
+        (version = fgetc(file)) == EOF || (index->flags = fgetc(file)) == EOF ||
+        readUint32(file, &index->block_size) != 0 ||
+        version > BLOCK_FORMAT_VERSION || index->block_size == 0 || index->block_size > MAX_BLOCK_SIZE) {
+        fprintf(stderr, "Erro: '%s' não é um arquivo no formato em blocos\n", filename);
+        closeBlockIndex(index);
+        return -1;
+    }
+
+    // Percorre os cabeçalhos guardando o offset de cada bloco codificado
+    // (referências ficam com UINT64_MAX: a cópia usa sempre o bloco de origem)
+    uint64_t* offsets = NULL;
+    size_t capacity = 0;
+    int result = -1;
+    for (;;) {
+        off_t offset = ftello(file);
+        int type = fgetc(file);
+        uint32_t raw_size;
+        uint32_t payload_size;
+
+        if (type == BLOCK_END) {
+            uint64_t total;
+            result = readUint64(file, &total) == 0 &&
+                     fread(magic, 1, BLOCK_MAGIC_SIZE, file) == BLOCK_MAGIC_SIZE &&
+                     memcmp(magic, BLOCK_INDEX_MAGIC, BLOCK_MAGIC_SIZE) == 0 ? 0 : -1;
+            break;
+        }
+        if (type == EOF || offset < 0 || readUint32(file, &raw_size) != 0 ||
+            readUint32(file, &payload_size) != 0 || fseeko(file, (off_t)payload_size, SEEK_CUR) != 0) {
+            break;
+        }
+
+        if (index->count >= capacity) {
+            capacity = capacity > 0 ? capacity * 2 : 64;
+            uint64_t* grown = (uint64_t*)budgetMalloc(capacity * sizeof(uint64_t));
+            if (grown == NULL) {
+                break;
+            }
+            if (offsets != NULL) {
+                memcpy(grown, offsets, index->count * sizeof(uint64_t));
+            }
+            budgetFree(offsets);
+            offsets = grown;
+        }
+        offsets[index->count++] = type == BLOCK_DUP ? UINT64_MAX : (uint64_t)offset;
+    }
+
+    for (uint64_t i = 0; result == 0 && i < index->count; i++) {
+        uint64_t hash;
+        uint64_t existing;
+        if (readUint64(file, &hash) != 0) {
+            result = -1;
+        } else if (offsets[i] != UINT64_MAX && !findHashIndex(&index->blocks, hash, &existing) &&
+                   insertHashIndex(&index->blocks, hash, offsets[i]) != 0) {
+            result = -1;
+        }
+    }
+    budgetFree(offsets);
+
+    if (result != 0) {
+        fprintf(stderr, "Erro: '%s' não tem um índice de blocos válido\n", filename);
+        closeBlockIndex(index);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Fecha o contêiner anterior e libera o índice
+ * @param index Índice
+ */
+void closeBlockIndex(BlockIndex* index) {
+    if (index->file != NULL) {
+        fclose(index->file);
+    }
+    freeHashIndex(&index->blocks);
+    memset(index, 0, sizeof(BlockIndex));
+}
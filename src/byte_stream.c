@@ -0,0 +1,648 @@
+#define _POSIX_C_SOURCE 200809L
+#include "byte_stream.h"
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/**
+ * Lê de um FILE*
+ * @param source Origem
+ * @param data Destino
+ * @param length Bytes pedidos
+ * @return Bytes lidos (0 = fim ou erro)
+ */
+static size_t fileSourceRead(ByteSource* source, unsigned char* data, size_t length) {
+    size_t bytes_read = fread(data, 1, length, source->file);
+    if (bytes_read == 0 && ferror(source->file)) {
+        source->error = 1;
+    }
+    return bytes_read;
+}
+
+/**
+ * Volta um FILE* à posição em que a origem foi criada
+ * @param source Origem
+ * @return 0 se sucesso, -1 se o arquivo não permite posicionamento
+ */
+static int fileSourceRewind(ByteSource* source) {
+    source->position = 0;
+    source->length = 0;
+    return fseeko(source->file, source->start, SEEK_SET);
+}
+
+/**
+ * Calcula quantos bytes ainda restam em um FILE*
+ * @param source Origem
+ * @return Bytes restantes, ou -1 se o arquivo não permite posicionamento
+ */
+static int64_t fileSourceRemaining(ByteSource* source) {
+    off_t current = ftello(source->file);
+    if (current < 0 || fseeko(source->file, 0, SEEK_END) != 0) {
+        return -1;
+    }
+
+    off_t end = ftello(source->file);
+    fseeko(source->file, current, SEEK_SET);
+    return (int64_t)(end - current);
+}
+
+/**
+ * Lê de um descritor, repetindo leituras interrompidas por sinais
+ * @param source Origem
+ * @param data Destino
+ * @param length Bytes pedidos
+ * @return Bytes lidos (0 = fim ou erro)
+ */
+static size_t fdSourceRead(ByteSource* source, unsigned char* data, size_t length) {
+    for (;;) {
+        ssize_t bytes_read = read(source->fd, data, length);
+        if (bytes_read >= 0) {
+            return (size_t)bytes_read;
+        }
+        if (errno != EINTR) {
+            source->error = 1;
+            return 0;
+        }
+    }
+}
+
+/**
+ * Volta um descritor à posição em que a origem foi criada
+ * @param source Origem
+ * @return 0 se sucesso, -1 se o descritor não permite posicionamento (pipe, socket)
+ */
+static int fdSourceRewind(ByteSource* source) {
+    source->position = 0;
+    source->length = 0;
+    if (source->start < 0) {
+        return -1;
+    }
+    return lseek(source->fd, source->start, SEEK_SET) == source->start ? 0 : -1;
+}
+
+/**
+ * Calcula quantos bytes ainda restam em um descritor de arquivo regular
+ * @param source Origem
+ * @return Bytes restantes, ou -1 se desconhecido
+ */
+static int64_t fdSourceRemaining(ByteSource* source) {
+    struct stat info;
+    off_t current = lseek(source->fd, 0, SEEK_CUR);
+    if (current < 0 || fstat(source->fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+        return -1;
+    }
+    return info.st_size > current ? (int64_t)(info.st_size - current) : 0;
+}
+
+/**
+ * Volta uma origem em memória ao início
+ * @param source Origem
+ * @return 0
+ */
+static int memorySourceRewind(ByteSource* source) {
+    source->position = 0;
+    return 0;
+}
+
+/**
+ * Informa os bytes de uma origem em memória além da janela (nenhum)
+ * @param source Origem
+ * @return 0
+ */
+static int64_t memorySourceRemaining(ByteSource* source) {
+    (void)source;
+    return 0;
+}
+
+/**
+ * Desfaz o mapeamento de uma origem mmap
+ * @param source Origem
+ */
+static void mappedSourceClose(ByteSource* source) {
+    if (source->mapped > 0) {
+        munmap((void*)source->data, source->mapped);
+        source->mapped = 0;
+    }
+}
+
+static const ByteSourceOps file_source_ops = {fileSourceRead, fileSourceRewind, fileSourceRemaining, NULL};
+static const ByteSourceOps fd_source_ops = {fdSourceRead, fdSourceRewind, fdSourceRemaining, NULL};
+static const ByteSourceOps memory_source_ops = {NULL, memorySourceRewind, memorySourceRemaining, NULL};
+static const ByteSourceOps mapped_source_ops = {NULL, memorySourceRewind, memorySourceRemaining, mappedSourceClose};
+
+/**
+ * Prepara os campos comuns de uma origem
+ * @param source Origem
+ * @param ops Operações do transporte
+ */
+static void initSource(ByteSource* source, const ByteSourceOps* ops) {
+    source->ops = ops;
+    source->data = NULL;
+    source->length = 0;
+    source->position = 0;
+    source->buffer = NULL;
+    source->file = NULL;
+    source->fd = -1;
+    source->start = 0;
+    source->mapped = 0;
+    source->error = 0;
+}
+
+/**
+ * Cria uma origem sobre um FILE* já aberto (lido a partir da posição atual)
+ * Sem sourcePeek, a origem nunca lê além do que foi pedido, e o FILE* pode
+ * continuar a ser usado depois.
+ * @param source Origem
+ * @param file Arquivo aberto para leitura
+ */
+void initFileSource(ByteSource* source, FILE* file) {
+    initSource(source, &file_source_ops);
+    source->file = file;
+    source->start = ftello(file);
+}
+
+/**
+ * Cria uma origem sobre um descritor (arquivo, pipe ou socket)
+ * @param source Origem
+ * @param fd Descritor aberto para leitura
+ */
+void initFdSource(ByteSource* source, int fd) {
+    initSource(source, &fd_source_ops);
+    source->fd = fd;
+    source->start = lseek(fd, 0, SEEK_CUR);
+}
+
+/**
+ * Cria uma origem sobre um buffer em memória (sem cópia)
+ * @param source Origem
+ * @param data Bytes de entrada (devem existir enquanto a origem for usada)
+ * @param length Número de bytes
+ */
+void initMemorySource(ByteSource* source, const void* data, size_t length) {
+    initSource(source, &memory_source_ops);
+    source->data = (const unsigned char*)data;
+    source->length = length;
+}
+
+/**
+ * Cria uma origem com o arquivo inteiro mapeado em memória (somente leitura)
+ * @param source Origem
+ * @param filename Nome do arquivo
+ * @return 0 se sucesso, -1 se o arquivo não pode ser mapeado (não regular, por exemplo)
+ */
+int openMappedSource(ByteSource* source, const char* filename) {
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode) || (uint64_t)info.st_size > SIZE_MAX) {
+        close(fd);
+        return -1;
+    }
+
+    initSource(source, &mapped_source_ops);
+    if (info.st_size > 0) {
+        void* data = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            close(fd);
+            return -1;
+        }
+        posix_madvise(data, (size_t)info.st_size, POSIX_MADV_SEQUENTIAL);
+        source->data = (const unsigned char*)data;
+        source->length = (size_t)info.st_size;
+        source->mapped = (size_t)info.st_size;
+    }
+
+    // O mapeamento continua válido após fechar o descritor
+    close(fd);
+    return 0;
+}
+
+/**
+ * Libera os recursos de uma origem (o FILE* ou descritor de origem não é fechado)
+ * @param source Origem
+ */
+void closeSource(ByteSource* source) {
+    if (source->ops->close != NULL) {
+        source->ops->close(source);
+    }
+    free(source->buffer);
+    source->buffer = NULL;
+    source->data = NULL;
+    source->length = 0;
+    source->position = 0;
+}
+
+/**
+ * Lê até length bytes, primeiro da janela e depois direto do transporte
+ * @param source Origem
+ * @param data Destino
+ * @param length Bytes pedidos
+ * @return Bytes lidos (menor que length só no fim da entrada ou em erro)
+ */
+size_t sourceRead(ByteSource* source, void* data, size_t length) {
+    unsigned char* output = (unsigned char*)data;
+    size_t done = source->length - source->position;
+    if (done > length) {
+        done = length;
+    }
+    if (done > 0) {
+        memcpy(output, source->data + source->position, done);
+        source->position += done;
+    }
+
+    while (done < length && source->ops->read != NULL) {
+        size_t bytes_read = source->ops->read(source, output + done, length - done);
+        if (bytes_read == 0) {
+            break;
+        }
+        done += bytes_read;
+    }
+    return done;
+}
+
+/**
+ * Lê um byte
+ * @param source Origem
+ * @return Byte lido, ou EOF no fim da entrada
+ */
+int sourceGetc(ByteSource* source) {
+    if (source->position < source->length) {
+        return source->data[source->position++];
+    }
+
+    unsigned char byte;
+    return sourceRead(source, &byte, 1) == 1 ? byte : EOF;
+}
+
+/**
+ * Expõe os próximos bytes sem consumi-los
+ * Origens em memória expõem todo o restante sem cópia; as demais carregam
+ * até STREAM_BUFFER_SIZE bytes no buffer da origem.
+ * @param source Origem
+ * @param wanted Bytes desejados
+ * @param available Bytes expostos (menos que wanted no fim da entrada ou acima do buffer)
+ * @return Ponteiro para os bytes expostos
+ */
+const unsigned char* sourcePeek(ByteSource* source, size_t wanted, size_t* available) {
+    size_t window = source->length - source->position;
+
+    if (window < wanted && source->ops->read != NULL) {
+        if (source->buffer == NULL) {
+            source->buffer = (unsigned char*)malloc(STREAM_BUFFER_SIZE);
+            if (source->buffer == NULL) {
+                fprintf(stderr, "Erro: Falha na alocação de memória para o buffer de leitura\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+        if (wanted > STREAM_BUFFER_SIZE) {
+            wanted = STREAM_BUFFER_SIZE;
+        }
+
+        if (window > 0) {
+            memmove(source->buffer, source->data + source->position, window);
+        }
+        source->data = source->buffer;
+        source->position = 0;
+        source->length = window;
+
+        while (source->length < wanted) {
+            size_t bytes_read = source->ops->read(source, source->buffer + source->length,
+                                                  STREAM_BUFFER_SIZE - source->length);
+            if (bytes_read == 0) {
+                break;
+            }
+            source->length += bytes_read;
+        }
+    }
+
+    *available = source->length - source->position;
+    return source->data + source->position;
+}
+
+/**
+ * Consome bytes já expostos por sourcePeek
+ * @param source Origem
+ * @param length Bytes a consumir (no máximo os expostos)
+ */
+void sourceSkip(ByteSource* source, size_t length) {
+    size_t window = source->length - source->position;
+    source->position += length < window ? length : window;
+}
+
+/**
+ * Volta a origem ao início
+ * @param source Origem
+ * @return 0 se sucesso, -1 se o transporte não permite (pipe, socket)
+ */
+int sourceRewind(ByteSource* source) {
+    return source->ops->rewind != NULL ? source->ops->rewind(source) : -1;
+}
+
+/**
+ * Calcula quantos bytes ainda restam na origem
+ * @param source Origem
+ * @return Bytes restantes, ou -1 se desconhecido
+ */
+int64_t sourceRemaining(ByteSource* source) {
+    int64_t remaining = source->ops->remaining != NULL ? source->ops->remaining(source) : -1;
+    return remaining < 0 ? -1 : remaining + (int64_t)(source->length - source->position);
+}
+
+/**
+ * Grava em um FILE*
+ * @param sink Destino
+ * @param data Bytes
+ * @param length Número de bytes
+ * @return Bytes gravados
+ */
+static size_t fileSinkWrite(ByteSink* sink, const unsigned char* data, size_t length) {
+    return fwrite(data, 1, length, sink->file);
+}
+
+/**
+ * Entrega ao sistema os dados do FILE*
+ * @param sink Destino
+ * @return 0 se sucesso, -1 se erro
+ */
+static int fileSinkFlush(ByteSink* sink) {
+    return fflush(sink->file) == 0 ? 0 : -1;
+}
+
+/**
+ * Grava em um descritor, repetindo escritas parciais ou interrompidas
+ * @param sink Destino
+ * @param data Bytes
+ * @param length Número de bytes
+ * @return Bytes gravados
+ */
+static size_t fdSinkWrite(ByteSink* sink, const unsigned char* data, size_t length) {
+    size_t done = 0;
+    while (done < length) {
+        ssize_t written = write(sink->fd, data + done, length - done);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        done += (size_t)written;
+    }
+    return done;
+}
+
+/**
+ * Amplia um destino em memória para caber mais length bytes
+ * @param sink Destino
+ * @param length Bytes livres necessários
+ * @return 0 se sucesso, -1 se faltou memória
+ */
+static int memorySinkGrow(ByteSink* sink, size_t length) {
+    size_t capacity = sink->capacity > 0 ? sink->capacity * 2 : STREAM_MEMORY_INITIAL_SIZE;
+    if (capacity < sink->position + length) {
+        capacity = sink->position + length;
+    }
+
+    unsigned char* data = (unsigned char*)realloc(sink->data, capacity);
+    if (data == NULL) {
+        return -1;
+    }
+    sink->data = data;
+    sink->capacity = capacity;
+    return 0;
+}
+
+static const ByteSinkOps file_sink_ops = {fileSinkWrite, NULL, fileSinkFlush, NULL};
+static const ByteSinkOps fd_sink_ops = {fdSinkWrite, NULL, NULL, NULL};
+static const ByteSinkOps memory_sink_ops = {NULL, memorySinkGrow, NULL, NULL};
+
+/**
+ * Prepara os campos comuns de um destino
+ * @param sink Destino
+ * @param ops Operações do transporte
+ */
+static void initSink(ByteSink* sink, const ByteSinkOps* ops) {
+    sink->ops = ops;
+    sink->data = NULL;
+    sink->position = 0;
+    sink->capacity = 0;
+    sink->file = NULL;
+    sink->fd = -1;
+    sink->written = 0;
+    sink->error = 0;
+}
+
+/**
+ * Cria um destino sobre um FILE* já aberto
+ * @param sink Destino
+ * @param file Arquivo aberto para escrita
+ */
+void initFileSink(ByteSink* sink, FILE* file) {
+    initSink(sink, &file_sink_ops);
+    sink->file = file;
+}
+
+/**
+ * Cria um destino sobre um descritor (arquivo, pipe ou socket)
+ * @param sink Destino
+ * @param fd Descritor aberto para escrita
+ */
+void initFdSink(ByteSink* sink, int fd) {
+    initSink(sink, &fd_sink_ops);
+    sink->fd = fd;
+}
+
+/**
+ * Cria um destino em memória que cresce conforme a escrita
+ * Os dados ficam em sink->data (sink->position bytes) até closeSink.
+ * @param sink Destino
+ */
+void initMemorySink(ByteSink* sink) {
+    initSink(sink, &memory_sink_ops);
+}
+
+/**
+ * Grava no transporte os bytes pendentes da janela (destinos que não são memória)
+ * @param sink Destino
+ * @return 0 se sucesso, -1 se erro
+ */
+static int drainSink(ByteSink* sink) {
+    if (sink->ops->grow == NULL && sink->position > 0) {
+        if (sink->ops->write(sink, sink->data, sink->position) != sink->position) {
+            sink->error = 1;
+        }
+        sink->position = 0;
+    }
+    return sink->error ? -1 : 0;
+}
+
+/**
+ * Expõe espaço livre para escrita direta (confirmar com sinkCommit)
+ * Destinos em memória crescem para caber wanted bytes; os demais usam um
+ * buffer de até STREAM_BUFFER_SIZE bytes, gravado quando enche.
+ * @param sink Destino
+ * @param wanted Bytes desejados
+ * @param available Bytes livres expostos (menos que wanted só acima do buffer)
+ * @return Ponteiro para o espaço livre, ou NULL se erro
+ */
+unsigned char* sinkReserve(ByteSink* sink, size_t wanted, size_t* available) {
+    if (sink->capacity - sink->position < wanted || sink->data == NULL) {
+        if (sink->ops->grow != NULL) {
+            if (sink->ops->grow(sink, wanted > 0 ? wanted : 1) != 0) {
+                sink->error = 1;
+            }
+        } else {
+            drainSink(sink);
+            if (sink->data == NULL) {
+                sink->data = (unsigned char*)malloc(STREAM_BUFFER_SIZE);
+                if (sink->data == NULL) {
+                    fprintf(stderr, "Erro: Falha na alocação de memória para o buffer de escrita\n");
+                    exit(EXIT_FAILURE);
+                }
+                sink->capacity = STREAM_BUFFER_SIZE;
+            }
+        }
+    }
+
+    if (sink->error) {
+        *available = 0;
+        return NULL;
+    }
+    *available = sink->capacity - sink->position;
+    return sink->data + sink->position;
+}
+
+/**
+ * Confirma bytes escritos no espaço exposto por sinkReserve
+ * @param sink Destino
+ * @param length Bytes escritos (no máximo os expostos)
+ */
+void sinkCommit(ByteSink* sink, size_t length) {
+    sink->position += length;
+    sink->written += length;
+}
+
+/**
+ * Grava bytes; escritas maiores que o buffer vão direto ao transporte
+ * @param sink Destino
+ * @param data Bytes
+ * @param length Número de bytes
+ * @return Bytes gravados (menor que length só em erro)
+ */
+size_t sinkWrite(ByteSink* sink, const void* data, size_t length) {
+    if (sink->ops->grow == NULL && length > sink->capacity - sink->position) {
+        if (drainSink(sink) != 0) {
+            return 0;
+        }
+        if (length >= STREAM_BUFFER_SIZE) {
+            size_t written = sink->ops->write(sink, (const unsigned char*)data, length);
+            sink->written += written;
+            if (written != length) {
+                sink->error = 1;
+            }
+            return written;
+        }
+    }
+
+    size_t available;
+    unsigned char* window = sinkReserve(sink, length, &available);
+    if (window == NULL || available < length) {
+        return 0;
+    }
+    if (length > 0) {
+        memcpy(window, data, length);
+    }
+    sinkCommit(sink, length);
+    return length;
+}
+
+/**
+ * Grava um byte
+ * @param sink Destino
+ * @param byte Byte a gravar
+ * @return O byte gravado, ou EOF se erro
+ */
+int sinkPutc(ByteSink* sink, int byte) {
+    if (sink->position < sink->capacity) {
+        sink->data[sink->position++] = (unsigned char)byte;
+        sink->written++;
+        return (unsigned char)byte;
+    }
+
+    unsigned char value = (unsigned char)byte;
+    return sinkWrite(sink, &value, 1) == 1 ? value : EOF;
+}
+
+/**
+ * Entrega ao destino tudo o que foi gravado
+ * @param sink Destino
+ * @return 0 se sucesso, -1 se houve algum erro de escrita
+ */
+int sinkFlush(ByteSink* sink) {
+    drainSink(sink);
+    if (sink->ops->flush != NULL && sink->ops->flush(sink) != 0) {
+        sink->error = 1;
+    }
+    return sink->error ? -1 : 0;
+}
+
+/**
+ * Avisa o destino de quantos bytes ainda serão gravados: destinos em memória
+ * crescem uma única vez e arquivos regulares reservam o espaço em disco
+ * (a reserva é só uma otimização; pipes e sockets apenas a ignoram)
+ * @param sink Destino
+ * @param length Bytes que ainda serão gravados
+ * @return 0 se o espaço foi reservado, -1 se o destino não permite
+ */
+int sinkPreallocate(ByteSink* sink, uint64_t length) {
+    if (length == 0) {
+        return 0;
+    }
+
+    if (sink->ops->grow != NULL) {
+        if (length > (uint64_t)(SIZE_MAX - sink->position)) {
+            return -1;
+        }
+        if (sink->data != NULL && sink->capacity - sink->position >= length) {
+            return 0;
+        }
+        return sink->ops->grow(sink, (size_t)length);
+    }
+
+    int fd = sink->file != NULL ? fileno(sink->file) : sink->fd;
+    struct stat info;
+    if (fd < 0 || fstat(fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+        return -1;
+    }
+
+    // A reserva começa depois do que já foi gravado ou está pendente nos buffers
+    off_t offset = sink->file != NULL ? ftello(sink->file) : lseek(fd, 0, SEEK_CUR);
+    if (offset < 0) {
+        return -1;
+    }
+    offset += (off_t)sink->position;
+    return posix_fallocate(fd, offset, (off_t)length) == 0 ? 0 : -1;
+}
+
+/**
+ * Grava o que estiver pendente e libera os recursos do destino (o FILE* ou
+ * descritor de destino não é fechado; a memória de um destino em memória é liberada)
+ * @param sink Destino
+ */
+void closeSink(ByteSink* sink) {
+    if (sink->ops->grow == NULL) {
+        sinkFlush(sink);
+    }
+    if (sink->ops->close != NULL) {
+        sink->ops->close(sink);
+    }
+    free(sink->data);
+    sink->data = NULL;
+    sink->position = 0;
+    sink->capacity = 0;
+}
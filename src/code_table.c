@@ -0,0 +1,280 @@
+#include "code_table.h"
+#include "memory_budget.h"
+#include "cpu_dispatch.h"
+#include <string.h>
+
+#define PAIR_LENGTH_MASK ((1u << PAIR_LENGTH_BITS) - 1)
+#define ENCODE_MIN_SPACE 64   // Espaço mínimo no buffer para o laço sem verificação
+
+/**
+ * Converte os códigos de Huffman em texto para a forma inteira
+ * @param codes Tabela de códigos em texto ('0' e '1')
+ * @param table Tabela inteira a ser preenchida
+ * @return 0 se sucesso, -1 se algum código excede MAX_INTEGER_CODE_LENGTH
+ */
+int buildCodeTable(char codes[MAX_CHAR][MAX_TREE_HT], CodeTable* table) {
+    memset(table, 0, sizeof(CodeTable));
+
+    for (int i = 0; i < MAX_CHAR; i++) {
+        size_t length = strlen(codes[i]);
+        if (length > MAX_INTEGER_CODE_LENGTH) {
+            return -1;
+        }
+
+        uint32_t code = 0;
+        for (size_t j = 0; j < length; j++) {
+            code = (code << 1) | (uint32_t)(codes[i][j] - '0');
+        }
+
+        table->code[i] = code;
+        table->length[i] = (unsigned char)length;
+        if ((int)length > table->max_length) {
+            table->max_length = (int)length;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Pré-calcula os códigos concatenados de todos os pares de bytes
+ * O índice de cada entrada é primeiro | (segundo << 8)
+ * @param table Tabela de códigos simples
+ * @return Tabela de pares alocada (liberar com freePairCodeTable), ou NULL se
+ *         o limite de memória foi excedido
+ */
+PairCodeTable* buildPairCodeTable(const CodeTable* table) {
+    PairCodeTable* pairs = (PairCodeTable*)budgetMalloc(sizeof(PairCodeTable));
+    if (pairs == NULL) {
+        return NULL;
+    }
+
+    for (int second = 0; second < MAX_CHAR; second++) {
+        unsigned second_length = table->length[second];
+        uint32_t second_code = table->code[second];
+        uint32_t* row = &pairs->entry[second << 8];
+
+        for (int first = 0; first < MAX_CHAR; first++) {
+            unsigned length = table->length[first] + second_length;
+
+            // Pares que não cabem no orçamento usam a tabela simples
+            if (length == 0 || length > PAIR_CODE_MAX_BITS) {
+                row[first] = 0;
+                continue;
+            }
+
+            uint32_t code = (table->code[first] << second_length) | second_code;
+            row[first] = (code << PAIR_LENGTH_BITS) | length;
+        }
+    }
+
+    return pairs;
+}
+
+/**
+ * Libera a memória de uma tabela de pares
+ * @param pairs Tabela de pares
+ */
+void freePairCodeTable(PairCodeTable* pairs) {
+    budgetFree(pairs);
+}
+
+/**
+ * Grava os 8 bytes do acumulador em ordem big-endian
+ * (somente os bytes completos são considerados escritos)
+ * @param out Posição de destino no buffer (8 bytes disponíveis)
+ * @param accumulator Acumulador alinhado à esquerda
+ */
+static inline void storeAccumulator(unsigned char* out, uint64_t accumulator) {
+    out[0] = (unsigned char)(accumulator >> 56);
+    out[1] = (unsigned char)(accumulator >> 48);
+    out[2] = (unsigned char)(accumulator >> 40);
+    out[3] = (unsigned char)(accumulator >> 32);
+    out[4] = (unsigned char)(accumulator >> 24);
+    out[5] = (unsigned char)(accumulator >> 16);
+    out[6] = (unsigned char)(accumulator >> 8);
+    out[7] = (unsigned char)accumulator;
+}
+
+/**
+ * Grava 32 bits do acumulador no buffer (espaço já garantido)
+ * @param out Posição de destino no buffer
+ * @param accumulator Acumulador com os bits pendentes
+ * @param bit_count Número de bits pendentes (>= 32)
+ */
+static inline void storeWord(unsigned char* out, uint64_t accumulator, int bit_count) {
+    uint32_t word = (uint32_t)(accumulator >> (bit_count - 32));
+    out[0] = (unsigned char)(word >> 24);
+    out[1] = (unsigned char)(word >> 16);
+    out[2] = (unsigned char)(word >> 8);
+    out[3] = (unsigned char)word;
+}
+
+/**
+ * Codifica um trecho cuja saída máxima cabe no buffer do escritor
+ * O laço mantém o acumulador alinhado à esquerda e grava 8 bytes por
+ * passo sem desvios, avançando apenas os bytes completos.
+ * @param writer Escritor de bits (com ao menos 4 * length + 16 bytes livres)
+ * @param data Bytes a serem codificados
+ * @param length Número de bytes
+ * @param table Tabela de códigos simples (comprimentos >= 1)
+ * @param pairs Tabela de pares (ou NULL)
+ */
+KERNEL_INLINE void encodeChunkBody(BitWriter* writer, const unsigned char* data, size_t length,
+                                   const CodeTable* table, const PairCodeTable* pairs) {
+    unsigned char* out = writer->buffer + writer->position;
+
+    // Esvazia os bytes completos pendentes e alinha o acumulador à esquerda
+    while (writer->bit_count >= 8) {
+        writer->bit_count -= 8;
+        *out++ = (unsigned char)(writer->accumulator >> writer->bit_count);
+    }
+    int bit_count = writer->bit_count;
+    uint64_t accumulator = bit_count > 0 ? writer->accumulator << (64 - bit_count) : 0;
+    size_t i = 0;
+
+    // Invariante: bit_count < 8 no início de cada iteração
+    if (pairs != NULL) {
+        for (; i + 1 < length; i += 2) {
+            uint32_t entry = pairs->entry[data[i] | ((unsigned)data[i + 1] << 8)];
+            unsigned pair_length = entry & PAIR_LENGTH_MASK;
+
+            if (pair_length != 0) {
+                bit_count += pair_length;
+                accumulator |= (uint64_t)(entry >> PAIR_LENGTH_BITS) << (64 - bit_count);
+            } else {
+                unsigned char first = data[i];
+                unsigned char second = data[i + 1];
+
+                bit_count += table->length[first];
+                accumulator |= (uint64_t)table->code[first] << (64 - bit_count);
+                storeAccumulator(out, accumulator);
+                out += bit_count >> 3;
+                accumulator <<= bit_count & ~7;
+                bit_count &= 7;
+
+                bit_count += table->length[second];
+                accumulator |= (uint64_t)table->code[second] << (64 - bit_count);
+            }
+
+            storeAccumulator(out, accumulator);
+            out += bit_count >> 3;
+            accumulator <<= bit_count & ~7;
+            bit_count &= 7;
+        }
+    }
+
+    for (; i < length; i++) {
+        unsigned char symbol = data[i];
+        bit_count += table->length[symbol];
+        accumulator |= (uint64_t)table->code[symbol] << (64 - bit_count);
+        storeAccumulator(out, accumulator);
+        out += bit_count >> 3;
+        accumulator <<= bit_count & ~7;
+        bit_count &= 7;
+    }
+
+    // Volta ao formato alinhado à direita usado entre chamadas
+    writer->accumulator = bit_count > 0 ? accumulator >> (64 - bit_count) : 0;
+    writer->bit_count = bit_count;
+    writer->position = (size_t)(out - writer->buffer);
+}
+
+// Variantes do laço de empacotamento, escolhidas em tempo de execução
+typedef void (*EncodeChunkKernel)(BitWriter*, const unsigned char*, size_t,
+                                  const CodeTable*, const PairCodeTable*);
+
+static void encodeChunkGeneric(BitWriter* writer, const unsigned char* data, size_t length,
+                               const CodeTable* table, const PairCodeTable* pairs) {
+    encodeChunkBody(writer, data, length, table, pairs);
+}
+
+#if HAVE_CPU_DISPATCH
+static TARGET_BMI2 void encodeChunkBmi2(BitWriter* writer, const unsigned char* data, size_t length,
+                                        const CodeTable* table, const PairCodeTable* pairs) {
+    encodeChunkBody(writer, data, length, table, pairs);
+}
+
+static TARGET_AVX2 void encodeChunkAvx2(BitWriter* writer, const unsigned char* data, size_t length,
+                                        const CodeTable* table, const PairCodeTable* pairs) {
+    encodeChunkBody(writer, data, length, table, pairs);
+}
+
+static const EncodeChunkKernel encode_chunk_kernels[CPU_VARIANT_COUNT] = {
+    encodeChunkGeneric, encodeChunkBmi2, encodeChunkAvx2
+};
+#else
+static const EncodeChunkKernel encode_chunk_kernels[CPU_VARIANT_COUNT] = {
+    encodeChunkGeneric, encodeChunkGeneric, encodeChunkGeneric
+};
+#endif
+
+/**
+ * Codifica símbolo a símbolo verificando o espaço no buffer
+ * (usado quando o buffer de memória está quase cheio)
+ * @param writer Escritor de bits
+ * @param data Bytes a serem codificados
+ * @param length Número de bytes
+ * @param table Tabela de códigos simples
+ */
+static void encodeChecked(BitWriter* writer, const unsigned char* data, size_t length,
+                          const CodeTable* table) {
+    for (size_t i = 0; i < length; i++) {
+        unsigned char symbol = data[i];
+        writer->accumulator = (writer->accumulator << table->length[symbol]) | table->code[symbol];
+        writer->bit_count += table->length[symbol];
+
+        if (writer->bit_count >= 32) {
+            if (writer->capacity - writer->position < 4 && drainBitWriter(writer) != 0) {
+                writer->overflow = 1;
+                return;
+            }
+            storeWord(writer->buffer + writer->position, writer->accumulator, writer->bit_count);
+            writer->position += 4;
+            writer->bit_count -= 32;
+        }
+    }
+}
+
+/**
+ * Codifica uma sequência de bytes usando as tabelas inteiras
+ * Com a tabela de pares, cada consulta produz o código de dois bytes;
+ * pares acima do orçamento voltam para duas consultas simples.
+ * @param writer Escritor de bits de destino
+ * @param data Bytes a serem codificados
+ * @param length Número de bytes
+ * @param table Tabela de códigos simples
+ * @param pairs Tabela de pares (NULL para usar apenas a tabela simples)
+ */
+void encodeSymbols(BitWriter* writer, const unsigned char* data, size_t length,
+                   const CodeTable* table, const PairCodeTable* pairs) {
+    EncodeChunkKernel encode_chunk = encode_chunk_kernels[activeCpuVariant()];
+    size_t i = 0;
+
+    // Árvore de um único símbolo: códigos vazios não produzem bits
+    if (table->max_length == 0) {
+        return;
+    }
+
+    while (i < length && !writer->overflow) {
+        if (writer->capacity - writer->position < ENCODE_MIN_SPACE) {
+            drainBitWriter(writer);
+        }
+
+        size_t space = writer->capacity - writer->position;
+        if (space < ENCODE_MIN_SPACE) {
+            // Buffer de memória quase cheio: termina com verificação por símbolo
+            encodeChecked(writer, data + i, length - i, table);
+            return;
+        }
+
+        // Cada byte gera no máximo 4 bytes de saída, mais a folga da gravação de 8 bytes
+        size_t chunk = (space - 16) / 4;
+        if (chunk > length - i) {
+            chunk = length - i;
+        }
+
+        encode_chunk(writer, data + i, chunk, table, pairs);
+        i += chunk;
+    }
+}
@@ -0,0 +1,94 @@
+#include "cpu_dispatch.h"
+#include <string.h>
+
+static const char* variant_names[CPU_VARIANT_COUNT] = { "generic", "bmi2", "avx2" };
+
+// Variante ativa (-1 = ainda não detectada)
+static int active_variant = -1;
+
+/**
+ * Detecta a melhor variante suportada pela CPU via cpuid
+ * @return Variante mais rápida disponível
+ */
+CpuVariant detectCpuVariant(void) {
+#if HAVE_CPU_DISPATCH
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("bmi2")) {
+        return CPU_AVX2;
+    }
+    if (__builtin_cpu_supports("bmi2")) {
+        return CPU_BMI2;
+    }
+#endif
+    return CPU_GENERIC;
+}
+
+/**
+ * Verifica se a CPU atual suporta uma variante
+ * @param variant Variante a verificar
+ * @return 1 se suportada, 0 caso contrário
+ */
+int isCpuVariantSupported(CpuVariant variant) {
+    if ((int)variant < 0 || variant >= CPU_VARIANT_COUNT) {
+        return 0;
+    }
+    return variant <= detectCpuVariant();
+}
+
+/**
+ * Retorna a variante em uso, detectando-a na primeira chamada
+ */
+CpuVariant activeCpuVariant(void) {
+    int variant = __atomic_load_n(&active_variant, __ATOMIC_RELAXED);
+    if (variant < 0) {
+        variant = (int)detectCpuVariant();
+        __atomic_store_n(&active_variant, variant, __ATOMIC_RELAXED);
+    }
+    return (CpuVariant)variant;
+}
+
+/**
+ * Força o uso de uma variante (para benchmarks e testes)
+ * @param variant Variante desejada
+ * @return 0 se sucesso, -1 se a CPU não suporta a variante
+ */
+int setCpuVariant(CpuVariant variant) {
+    if (!isCpuVariantSupported(variant)) {
+        return -1;
+    }
+    __atomic_store_n(&active_variant, (int)variant, __ATOMIC_RELAXED);
+    return 0;
+}
+
+/**
+ * Converte o nome de uma variante ("auto", "generic", "bmi2", "avx2")
+ * @param name Nome da variante
+ * @param variant Variante correspondente ("auto" resolve para a detectada)
+ * @return 0 se sucesso, -1 se o nome é desconhecido
+ */
+int parseCpuVariant(const char* name, CpuVariant* variant) {
+    if (strcmp(name, "auto") == 0) {
+        *variant = detectCpuVariant();
+        return 0;
+    }
+
+    for (int i = 0; i < CPU_VARIANT_COUNT; i++) {
+        if (strcmp(name, variant_names[i]) == 0) {
+            *variant = (CpuVariant)i;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+/**
+ * Retorna o nome de uma variante
+ * @param variant Variante
+ * @return Nome legível
+ */
+const char* cpuVariantName(CpuVariant variant) {
+    if ((int)variant < 0 || variant >= CPU_VARIANT_COUNT) {
+        return "desconhecida";
+    }
+    return variant_names[variant];
+}
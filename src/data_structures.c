@@ -1,16 +1,16 @@
 #include "data_structures.h"
+#include "memory_budget.h"
 
 /**
  * Cria um novo nó da árvore de Huffman
  * @param data Caractere (byte) a ser armazenado
  * @param freq Frequência do caractere
- * @return Ponteiro para o novo nó criado
+ * @return Ponteiro para o novo nó criado, ou NULL se o limite de memória foi excedido
  */
 HuffmanNode* createNode(unsigned char data, unsigned long freq) {
-    HuffmanNode* node = (HuffmanNode*)malloc(sizeof(HuffmanNode));
+    HuffmanNode* node = (HuffmanNode*)budgetMalloc(sizeof(HuffmanNode));
     if (node == NULL) {
-        fprintf(stderr, "Erro: Falha na alocação de memória para o nó\n");
-        exit(EXIT_FAILURE);
+        return NULL;
     }
     
     node->data = data;
@@ -24,23 +24,21 @@ HuffmanNode* createNode(unsigned char data, unsigned long freq) {
 /**
  * Cria uma nova fila de prioridade (min-heap)
  * @param capacity Capacidade máxima da fila
- * @return Ponteiro para a fila de prioridade criada
+ * @return Ponteiro para a fila de prioridade criada, ou NULL se o limite de memória foi excedido
  */
 PriorityQueue* createPriorityQueue(unsigned capacity) {
-    PriorityQueue* pq = (PriorityQueue*)malloc(sizeof(PriorityQueue));
+    PriorityQueue* pq = (PriorityQueue*)budgetMalloc(sizeof(PriorityQueue));
     if (pq == NULL) {
-        fprintf(stderr, "Erro: Falha na alocação de memória para a fila de prioridade\n");
-        exit(EXIT_FAILURE);
+        return NULL;
     }
     
     pq->size = 0;
     pq->capacity = capacity;
-    pq->array = (HuffmanNode**)malloc(capacity * sizeof(HuffmanNode*));
+    pq->array = (HuffmanNode**)budgetMalloc(capacity * sizeof(HuffmanNode*));
     
     if (pq->array == NULL) {
-        fprintf(stderr, "Erro: Falha na alocação de memória para o array da fila\n");
-        free(pq);
-        exit(EXIT_FAILURE);
+        budgetFree(pq);
+        return NULL;
     }
     
     return pq;
@@ -176,7 +174,7 @@ void freeHuffmanTree(HuffmanNode* root) {
     freeHuffmanTree(root->right);
     
     // Libera o nó atual
-    free(root);
+    budgetFree(root);
 }
 
 /**
@@ -190,9 +188,9 @@ void freePriorityQueue(PriorityQueue* pq) {
     
     // Libera o array de ponteiros (não os nós em si)
     if (pq->array != NULL) {
-        free(pq->array);
+        budgetFree(pq->array);
     }
     
     // Libera a estrutura da fila
-    free(pq);
+    budgetFree(pq);
 }
@@ -0,0 +1,299 @@
+#include "decode_table.h"
+#include "memory_budget.h"
+#include "cpu_dispatch.h"
+#include <string.h>
+
+#define DECODE_INDEX_MASK (DECODE_TABLE_SIZE - 1)
+
+/**
+ * Preenche as entradas de um símbolo por consulta percorrendo a árvore
+ * @param node Nó atual
+ * @param code Bits do caminho até o nó
+ * @param length Profundidade do nó
+ * @param entries Entradas da tabela
+ */
+static void fillSingleEntries(HuffmanNode* node, uint32_t code, int length, DecodeEntry* entries) {
+    if (node == NULL) {
+        return;
+    }
+
+    if (isLeaf(node)) {
+        // Todas as janelas que começam com este código decodificam o símbolo
+        uint32_t first = code << (DECODE_TABLE_BITS - length);
+        uint32_t span = 1u << (DECODE_TABLE_BITS - length);
+        for (uint32_t i = 0; i < span; i++) {
+            DecodeEntry* entry = &entries[first + i];
+            entry->symbols[0] = node->data;
+            entry->count = 1;
+            entry->bits = (unsigned char)length;
+            entry->first_bits = (unsigned char)length;
+        }
+        return;
+    }
+
+    // Códigos maiores que a janela ficam com count = 0 (percorrem a árvore)
+    if (length < DECODE_TABLE_BITS) {
+        fillSingleEntries(node->left, code << 1, length + 1, entries);
+        fillSingleEntries(node->right, (code << 1) | 1, length + 1, entries);
+    }
+}
+
+/**
+ * Soma depth * 2^-depth sobre as folhas da subárvore
+ * @param node Nó atual
+ * @param depth Profundidade do nó
+ * @return Contribuição da subárvore para o comprimento médio
+ */
+static double weightedLength(HuffmanNode* node, int depth) {
+    if (node == NULL) {
+        return 0.0;
+    }
+
+    if (isLeaf(node)) {
+        return depth < 64 ? (double)depth / (double)(1ULL << depth) : 0.0;
+    }
+
+    return weightedLength(node->left, depth + 1) + weightedLength(node->right, depth + 1);
+}
+
+/**
+ * Calcula o comprimento médio implícito dos códigos da árvore
+ * (cada folha de profundidade d tem peso 2^-d, como na desigualdade de Kraft)
+ * @param root Raiz da árvore de Huffman
+ * @return Comprimento médio em bits por símbolo
+ */
+double averageCodeLength(HuffmanNode* root) {
+    return weightedLength(root, 0);
+}
+
+/**
+ * Constrói a tabela de decodificação a partir da árvore de Huffman
+ * No modo de vários símbolos, cada entrada guarda todos os símbolos
+ * completos que cabem na janela de K bits e o total de bits consumidos.
+ * @param root Raiz da árvore (não é copiada; deve viver mais que a tabela)
+ * @param mode Modo desejado (DECODE_MODE_AUTO escolhe pelo comprimento médio)
+ * @return Tabela alocada (liberar com freeDecodeTable), ou NULL se o limite
+ *         de memória foi excedido
+ */
+DecodeTable* buildDecodeTable(HuffmanNode* root, DecodeMode mode) {
+    DecodeTable* table = (DecodeTable*)budgetCalloc(1, sizeof(DecodeTable));
+    if (table == NULL) {
+        return NULL;
+    }
+
+    table->root = root;
+    table->average_length = averageCodeLength(root);
+
+    if (mode == DECODE_MODE_AUTO) {
+        // Códigos curtos deixam vários símbolos completos em cada janela
+        mode = table->average_length <= MULTI_SYMBOL_MAX_AVG_BITS ? DECODE_MODE_MULTI : DECODE_MODE_SINGLE;
+    }
+    table->mode = mode;
+
+    // Árvore de um único símbolo não consome bits; não há o que tabelar
+    if (root == NULL || isLeaf(root)) {
+        return table;
+    }
+
+    fillSingleEntries(root, 0, 0, table->entries);
+
+    if (mode == DECODE_MODE_MULTI) {
+        DecodeEntry single[DECODE_TABLE_SIZE];
+        memcpy(single, table->entries, sizeof(single));
+
+        for (uint32_t index = 0; index < DECODE_TABLE_SIZE; index++) {
+            DecodeEntry* entry = &table->entries[index];
+            if (entry->count == 0) {
+                continue;
+            }
+
+            // Acrescenta símbolos enquanto o próximo código couber na janela
+            int consumed = entry->bits;
+            while (entry->count < MULTI_SYMBOL_MAX && consumed < DECODE_TABLE_BITS) {
+                const DecodeEntry* next = &single[(index << consumed) & DECODE_INDEX_MASK];
+                if (next->count == 0 || consumed + next->bits > DECODE_TABLE_BITS) {
+                    break;
+                }
+                entry->symbols[entry->count++] = next->symbols[0];
+                consumed += next->bits;
+            }
+            entry->bits = (unsigned char)consumed;
+        }
+    }
+
+    return table;
+}
+
+/**
+ * Libera a memória de uma tabela de decodificação
+ * @param table Tabela de decodificação
+ */
+void freeDecodeTable(DecodeTable* table) {
+    budgetFree(table);
+}
+
+/**
+ * Completa o acumulador carregando 8 bytes de uma vez quando possível
+ * (bits além de bit_count são os próprios bytes seguintes e serão
+ * recarregados nas mesmas posições)
+ * @param reader Leitor de bits
+ */
+static inline void refillFast(BitReader* reader) {
+    if (reader->length - reader->position >= 8) {
+        const unsigned char* p = reader->data + reader->position;
+        uint64_t value = ((uint64_t)p[0] << 56) | ((uint64_t)p[1] << 48) |
+                         ((uint64_t)p[2] << 40) | ((uint64_t)p[3] << 32) |
+                         ((uint64_t)p[4] << 24) | ((uint64_t)p[5] << 16) |
+                         ((uint64_t)p[6] << 8) | (uint64_t)p[7];
+        reader->accumulator |= value >> reader->bit_count;
+        reader->position += (size_t)((63 - reader->bit_count) >> 3);
+        reader->bit_count |= 56;
+    } else {
+        refillBitReader(reader);
+    }
+}
+
+/**
+ * Decodifica um único símbolo verificando os bits disponíveis
+ * (usado no fim da entrada e para códigos maiores que a janela)
+ * @param reader Leitor de bits
+ * @param table Tabela de decodificação
+ * @return Símbolo decodificado, ou -1 se a entrada terminou
+ */
+static int decodeOneSymbol(BitReader* reader, const DecodeTable* table) {
+    if (reader->bit_count < 32) {
+        refillBitReader(reader);
+    }
+
+    const DecodeEntry* entry = &table->entries[reader->accumulator >> (64 - DECODE_TABLE_BITS)];
+    if (entry->count != 0) {
+        // Código incompleto no fim da entrada é apenas preenchimento
+        if (entry->first_bits > reader->bit_count) {
+            return -1;
+        }
+        reader->accumulator <<= entry->first_bits;
+        reader->bit_count -= entry->first_bits;
+        return entry->symbols[0];
+    }
+
+    // Código longo: percorre a árvore bit a bit
+    HuffmanNode* node = table->root;
+    while (!isLeaf(node)) {
+        if (reader->bit_count == 0) {
+            refillBitReader(reader);
+            if (reader->bit_count == 0) {
+                return -1;
+            }
+        }
+
+        int bit = (int)(reader->accumulator >> 63);
+        reader->accumulator <<= 1;
+        reader->bit_count--;
+        node = bit ? node->right : node->left;
+        if (node == NULL) {
+            return -1;
+        }
+    }
+
+    return node->data;
+}
+
+/**
+ * Laço de decodificação por tabela (expandido em cada variante de CPU)
+ * @param reader Leitor de bits de origem
+ * @param table Tabela de decodificação
+ * @param output Buffer de saída
+ * @param max_symbols Número máximo de símbolos a decodificar
+ * @return Símbolos decodificados
+ */
+KERNEL_INLINE uint64_t decodeSymbolsBody(BitReader* reader, const DecodeTable* table,
+                                         unsigned char* output, uint64_t max_symbols) {
+    const DecodeEntry* entries = table->entries;
+    uint64_t produced = 0;
+
+    while (produced < max_symbols) {
+        // Laço rápido: com >= 4K bits no acumulador, 4 consultas sempre cabem
+        if (produced + 4 * MULTI_SYMBOL_MAX <= max_symbols) {
+            refillFast(reader);
+
+            if (reader->bit_count >= 4 * DECODE_TABLE_BITS) {
+                uint64_t accumulator = reader->accumulator;
+                int bit_count = reader->bit_count;
+                int step;
+
+                for (step = 0; step < 4; step++) {
+                    const DecodeEntry* entry = &entries[accumulator >> (64 - DECODE_TABLE_BITS)];
+                    if (entry->count == 0) {
+                        break;
+                    }
+                    memcpy(output + produced, entry->symbols, MULTI_SYMBOL_MAX);
+                    produced += entry->count;
+                    accumulator <<= entry->bits;
+                    bit_count -= entry->bits;
+                }
+
+                reader->accumulator = accumulator;
+                reader->bit_count = bit_count;
+                if (step == 4) {
+                    continue;
+                }
+            }
+        }
+
+        // Caminho lento: um símbolo com verificação de fim de entrada
+        int symbol = decodeOneSymbol(reader, table);
+        if (symbol < 0) {
+            break;
+        }
+        output[produced++] = (unsigned char)symbol;
+    }
+
+    return produced;
+}
+
+// Variantes do laço de decodificação, escolhidas em tempo de execução
+typedef uint64_t (*DecodeKernel)(BitReader*, const DecodeTable*, unsigned char*, uint64_t);
+
+static uint64_t decodeSymbolsGeneric(BitReader* reader, const DecodeTable* table,
+                                     unsigned char* output, uint64_t max_symbols) {
+    return decodeSymbolsBody(reader, table, output, max_symbols);
+}
+
+#if HAVE_CPU_DISPATCH
+static TARGET_BMI2 uint64_t decodeSymbolsBmi2(BitReader* reader, const DecodeTable* table,
+                                              unsigned char* output, uint64_t max_symbols) {
+    return decodeSymbolsBody(reader, table, output, max_symbols);
+}
+
+static TARGET_AVX2 uint64_t decodeSymbolsAvx2(BitReader* reader, const DecodeTable* table,
+                                              unsigned char* output, uint64_t max_symbols) {
+    return decodeSymbolsBody(reader, table, output, max_symbols);
+}
+
+static const DecodeKernel decode_kernels[CPU_VARIANT_COUNT] = {
+    decodeSymbolsGeneric, decodeSymbolsBmi2, decodeSymbolsAvx2
+};
+#else
+static const DecodeKernel decode_kernels[CPU_VARIANT_COUNT] = {
+    decodeSymbolsGeneric, decodeSymbolsGeneric, decodeSymbolsGeneric
+};
+#endif
+
+/**
+ * Decodifica símbolos até atingir o limite ou a entrada terminar
+ * Só são emitidos símbolos cujo código está completo na entrada,
+ * exatamente como na decodificação bit a bit pela árvore.
+ * @param reader Leitor de bits de origem
+ * @param table Tabela de decodificação
+ * @param output Buffer de saída (capacidade mínima de max_symbols)
+ * @param max_symbols Número máximo de símbolos a decodificar
+ * @return Símbolos decodificados (menor que max_symbols se a entrada terminou)
+ */
+uint64_t decodeSymbols(BitReader* reader, const DecodeTable* table, unsigned char* output, uint64_t max_symbols) {
+    // Árvore vazia ou de um único símbolo: nenhum bit por símbolo
+    if (table->root == NULL || isLeaf(table->root)) {
+        return 0;
+    }
+
+    return decode_kernels[activeCpuVariant()](reader, table, output, max_symbols);
+}
@@ -1,8 +1,21 @@
+#define _POSIX_C_SOURCE 200809L
 #include "file_io.h"
+#include "code_table.h"
+#include "decode_table.h"
+#include "parallel_decode.h"
+#include "parallel_encode.h"
+#include "table_cache.h"
+#include "cpu_dispatch.h"
+#include "memory_budget.h"
 #include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/stat.h>
 
 /**
  * Calcula as frequências de cada caractere em um arquivo
+ * Arquivos com mais de dois trechos de PARALLEL_HISTOGRAM_MIN_RANGE são
+ * contados em paralelo; o resultado é idêntico ao da contagem serial.
  * @param filename Nome do arquivo a ser analisado
  * @return Array com as frequências de cada caractere (0-255)
  */
@@ -20,20 +33,206 @@ unsigned long* calculateFrequencies(const char* filename) {
         exit(EXIT_FAILURE);
     }
     
-    unsigned char buffer[BUFFER_SIZE];
+    struct stat info;
+    if (fstat(fileno(file), &info) == 0 && S_ISREG(info.st_mode) &&
+        info.st_size >= 2 * PARALLEL_HISTOGRAM_MIN_RANGE &&
+        countFileFrequencies(fileno(file), (int64_t)info.st_size, 0, frequencies) == 0) {
+        fclose(file);
+        return frequencies;
+    }
+    memset(frequencies, 0, MAX_CHAR * sizeof(unsigned long));
+    
+    unsigned char buffer[HISTOGRAM_BUFFER_SIZE];
     size_t bytes_read;
     
     // Lê o arquivo em chunks e conta as frequências
-    while ((bytes_read = fread(buffer, 1, BUFFER_SIZE, file)) > 0) {
-        for (size_t i = 0; i < bytes_read; i++) {
-            frequencies[buffer[i]]++;
-        }
+    while ((bytes_read = fread(buffer, 1, HISTOGRAM_BUFFER_SIZE, file)) > 0) {
+        countFrequencies(buffer, bytes_read, frequencies);
     }
     
     fclose(file);
     return frequencies;
 }
 
+// Trecho do arquivo contado por uma thread
+typedef struct HistogramRange {
+    int fd;
+    int64_t start;
+    int64_t end;
+    unsigned long frequencies[MAX_CHAR];   // Tabela própria da thread
+    pthread_t thread;
+    int threaded;                          // 1 se o trecho roda em uma thread própria
+    int failed;
+} HistogramRange;
+
+/**
+ * Conta as frequências de um trecho do arquivo com pread (sem posição compartilhada)
+ * @param argument Trecho (HistogramRange)
+ * @return NULL
+ */
+static void* histogramRangeThread(void* argument) {
+    HistogramRange* range = (HistogramRange*)argument;
+    unsigned char* buffer = (unsigned char*)malloc(PARALLEL_HISTOGRAM_READ_SIZE);
+    if (buffer == NULL) {
+        range->failed = 1;
+        return NULL;
+    }
+    
+    int64_t position = range->start;
+    while (position < range->end) {
+        size_t wanted = range->end - position < PARALLEL_HISTOGRAM_READ_SIZE ?
+                        (size_t)(range->end - position) : PARALLEL_HISTOGRAM_READ_SIZE;
+        ssize_t bytes_read = pread(range->fd, buffer, wanted, (off_t)position);
+        if (bytes_read <= 0) {
+            range->failed = 1;
+            break;
+        }
+        countFrequencies(buffer, (size_t)bytes_read, range->frequencies);
+        position += bytes_read;
+    }
+    
+    free(buffer);
+    return NULL;
+}
+
+/**
+ * Conta as frequências de um arquivo dividido em trechos disjuntos, um por
+ * thread, somando as tabelas no fim
+ * @param fd Descritor do arquivo (a posição de leitura não é alterada)
+ * @param size Bytes a contar, a partir do início
+ * @param threads Número de threads (0 = processadores disponíveis, com trechos
+ *                de pelo menos PARALLEL_HISTOGRAM_MIN_RANGE)
+ * @param frequencies Frequências acumuladas (256 entradas)
+ * @return 0 se sucesso, -1 se erro de leitura (frequencies não é alterado)
+ */
+int countFileFrequencies(int fd, int64_t size, int threads, unsigned long* frequencies) {
+    if (threads <= 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        int64_t ranges = size / PARALLEL_HISTOGRAM_MIN_RANGE;
+        threads = online > 0 ? (int)online : 1;
+        if (threads > ranges) {
+            threads = ranges > 0 ? (int)ranges : 1;
+        }
+    }
+    if (threads > PARALLEL_HISTOGRAM_MAX_THREADS) {
+        threads = PARALLEL_HISTOGRAM_MAX_THREADS;
+    }
+    if (size < threads) {
+        threads = size > 0 ? (int)size : 1;
+    }
+    
+    HistogramRange* ranges = (HistogramRange*)calloc((size_t)threads, sizeof(HistogramRange));
+    if (ranges == NULL) {
+        fprintf(stderr, "Erro: Falha na alocação de memória para a contagem paralela\n");
+        exit(EXIT_FAILURE);
+    }
+    
+    // Trechos de tamanhos iguais; a primeira thread roda na thread atual
+    for (int t = 0; t < threads; t++) {
+        ranges[t].fd = fd;
+        ranges[t].start = size * t / threads;
+        ranges[t].end = size * (t + 1) / threads;
+    }
+    for (int t = 1; t < threads; t++) {
+        ranges[t].threaded = pthread_create(&ranges[t].thread, NULL, histogramRangeThread, &ranges[t]) == 0;
+        if (!ranges[t].threaded) {
+            // Sem a thread, o trecho é contado aqui mesmo
+            histogramRangeThread(&ranges[t]);
+        }
+    }
+    histogramRangeThread(&ranges[0]);
+    
+    int failed = 0;
+    for (int t = 0; t < threads; t++) {
+        if (ranges[t].threaded) {
+            pthread_join(ranges[t].thread, NULL);
+        }
+        failed |= ranges[t].failed;
+    }
+    
+    if (!failed) {
+        for (int t = 0; t < threads; t++) {
+            for (int c = 0; c < MAX_CHAR; c++) {
+                frequencies[c] += ranges[t].frequencies[c];
+            }
+        }
+    }
+    
+    free(ranges);
+    return failed ? -1 : 0;
+}
+
+/**
+ * Laço de contagem com quatro tabelas intercaladas (expandido em cada
+ * variante de CPU); as tabelas separadas evitam que bytes repetidos
+ * em sequência dependam do incremento anterior
+ * @param data Bytes a serem contados
+ * @param length Número de bytes (no máximo UINT32_MAX)
+ * @param frequencies Frequências acumuladas
+ */
+KERNEL_INLINE void countFrequenciesBody(const unsigned char* data, size_t length, unsigned long* frequencies) {
+    uint32_t counts[4][MAX_CHAR];
+    memset(counts, 0, sizeof(counts));
+    
+    size_t i = 0;
+    for (; i + 4 <= length; i += 4) {
+        counts[0][data[i]]++;
+        counts[1][data[i + 1]]++;
+        counts[2][data[i + 2]]++;
+        counts[3][data[i + 3]]++;
+    }
+    for (; i < length; i++) {
+        counts[0][data[i]]++;
+    }
+    
+    for (int c = 0; c < MAX_CHAR; c++) {
+        frequencies[c] += (unsigned long)counts[0][c] + counts[1][c] + counts[2][c] + counts[3][c];
+    }
+}
+
+// Variantes da contagem de frequências, escolhidas em tempo de execução
+typedef void (*HistogramKernel)(const unsigned char*, size_t, unsigned long*);
+
+static void countFrequenciesGeneric(const unsigned char* data, size_t length, unsigned long* frequencies) {
+    countFrequenciesBody(data, length, frequencies);
+}
+
+#if HAVE_CPU_DISPATCH
+static TARGET_BMI2 void countFrequenciesBmi2(const unsigned char* data, size_t length, unsigned long* frequencies) {
+    countFrequenciesBody(data, length, frequencies);
+}
+
+static TARGET_AVX2 void countFrequenciesAvx2(const unsigned char* data, size_t length, unsigned long* frequencies) {
+    countFrequenciesBody(data, length, frequencies);
+}
+
+static const HistogramKernel histogram_kernels[CPU_VARIANT_COUNT] = {
+    countFrequenciesGeneric, countFrequenciesBmi2, countFrequenciesAvx2
+};
+#else
+static const HistogramKernel histogram_kernels[CPU_VARIANT_COUNT] = {
+    countFrequenciesGeneric, countFrequenciesGeneric, countFrequenciesGeneric
+};
+#endif
+
+/**
+ * Acumula as frequências de um buffer usando o kernel da CPU ativa
+ * @param data Bytes a serem contados
+ * @param length Número de bytes
+ * @param frequencies Frequências acumuladas (256 entradas)
+ */
+void countFrequencies(const unsigned char* data, size_t length, unsigned long* frequencies) {
+    HistogramKernel kernel = histogram_kernels[activeCpuVariant()];
+    
+    // Trechos limitados mantêm os contadores de 32 bits sem estouro
+    while (length > 0) {
+        size_t chunk = length > 0x40000000u ? 0x40000000u : length;
+        kernel(data, chunk, frequencies);
+        data += chunk;
+        length -= chunk;
+    }
+}
+
 /**
  * Conta quantos caracteres únicos existem no arquivo
  * @param frequencies Array de frequências
@@ -62,16 +261,16 @@ void initBitBuffer(BitBuffer* bit_buffer) {
  * Escreve um bit no arquivo usando buffer
  * @param bit_buffer Buffer de bits
  * @param bit Bit a ser escrito (0 ou 1)
- * @param output Arquivo de saída
+ * @param output Destino
  */
-void writeBit(BitBuffer* bit_buffer, int bit, FILE* output) {
+void writeBit(BitBuffer* bit_buffer, int bit, ByteSink* output) {
     // Adiciona o bit ao buffer
     bit_buffer->buffer = (bit_buffer->buffer << 1) | (bit & 1);
     bit_buffer->bit_count++;
     
     // Se o buffer está cheio, escreve no arquivo
     if (bit_buffer->bit_count == 8) {
-        fputc(bit_buffer->buffer, output);
+        sinkPutc(output, bit_buffer->buffer);
         bit_buffer->buffer = 0;
         bit_buffer->bit_count = 0;
     }
@@ -80,74 +279,174 @@ void writeBit(BitBuffer* bit_buffer, int bit, FILE* output) {
 /**
  * Força a escrita dos bits restantes no buffer
  * @param bit_buffer Buffer de bits
- * @param output Arquivo de saída
+ * @param output Destino
  */
-void flushBitBuffer(BitBuffer* bit_buffer, FILE* output) {
+void flushBitBuffer(BitBuffer* bit_buffer, ByteSink* output) {
     if (bit_buffer->bit_count > 0) {
         // Preenche os bits restantes com zeros
         bit_buffer->buffer <<= (8 - bit_buffer->bit_count);
-        fputc(bit_buffer->buffer, output);
+        sinkPutc(output, bit_buffer->buffer);
         bit_buffer->buffer = 0;
         bit_buffer->bit_count = 0;
     }
 }
 
 /**
- * Serializa a árvore de Huffman no arquivo
- * @param file Arquivo de saída
+ * Serializa a árvore de Huffman no destino
+ * @param output Destino
  * @param root Raiz da árvore
  */
-void serializeTree(FILE* file, HuffmanNode* root) {
+void serializeTree(ByteSink* output, HuffmanNode* root) {
     if (root == NULL) {
         return;
     }
     
     if (isLeaf(root)) {
         // Marca como nó folha e escreve o caractere
-        fputc(1, file);
-        fputc(root->data, file);
+        sinkPutc(output, 1);
+        sinkPutc(output, root->data);
     } else {
         // Marca como nó interno
-        fputc(0, file);
-        serializeTree(file, root->left);
-        serializeTree(file, root->right);
+        sinkPutc(output, 0);
+        serializeTree(output, root->left);
+        serializeTree(output, root->right);
     }
 }
 
 /**
- * Escreve o cabeçalho do arquivo comprimido
- * @param output Arquivo de saída
- * @param root Raiz da árvore de Huffman
+ * Calcula quantos bytes a árvore ocupa quando serializada
+ * @param root Raiz da árvore
+ * @return Tamanho em bytes (2 por folha, 1 por nó interno)
  */
-void writeCompressedHeader(FILE* output, HuffmanNode* root) {
+size_t serializedTreeSize(HuffmanNode* root) {
+    if (root == NULL) {
+        return 0;
+    }
+    
+    if (isLeaf(root)) {
+        return 2;
+    }
+    
+    return 1 + serializedTreeSize(root->left) + serializedTreeSize(root->right);
+}
+
+/**
+ * Escreve o cabeçalho do arquivo comprimido: assinatura, versão, tamanho
+ * original (64 bits, little-endian) e árvore serializada
+ * @param output Destino
+ * @param root Raiz da árvore de Huffman (NULL = entrada vazia, sem árvore)
+ * @param original_size Bytes originais
+ */
+void writeCompressedHeader(ByteSink* output, HuffmanNode* root, uint64_t original_size) {
+    unsigned char header[STREAM_HEADER_SIZE];
+    memcpy(header, STREAM_MAGIC, STREAM_MAGIC_SIZE);
+    header[STREAM_MAGIC_SIZE] = STREAM_FORMAT_VERSION;
+    for (int i = 0; i < 8; i++) {
+        header[STREAM_MAGIC_SIZE + 1 + i] = (unsigned char)(original_size >> (8 * i));
+    }
+    sinkWrite(output, header, STREAM_HEADER_SIZE);
+    
     // Serializa a árvore no cabeçalho
     serializeTree(output, root);
     
     // Marca o fim do cabeçalho com um byte especial
-    fputc(0xFF, output);
+    sinkPutc(output, 0xFF);
+}
+
+/**
+ * Inicializa um escritor de bits em bloco
+ * @param writer Escritor a ser inicializado
+ * @param buffer Buffer de bytes de saída
+ * @param capacity Capacidade do buffer (mínimo de 8 bytes)
+ * @param output Destino, ou NULL para escrever apenas em memória
+ */
+void initBitWriter(BitWriter* writer, unsigned char* buffer, size_t capacity, ByteSink* output) {
+    writer->accumulator = 0;
+    writer->bit_count = 0;
+    writer->buffer = buffer;
+    writer->position = 0;
+    writer->capacity = capacity;
+    writer->output = output;
+    writer->overflow = 0;
+}
+
+/**
+ * Descarrega os bytes completos do buffer do escritor no destino
+ * @param writer Escritor de bits
+ * @return 0 se sucesso, -1 se o escritor é somente memória ou houve erro
+ */
+int drainBitWriter(BitWriter* writer) {
+    if (writer->output == NULL) {
+        return -1;
+    }
+
+    if (writer->position > 0) {
+        size_t written = sinkWrite(writer->output, writer->buffer, writer->position);
+        if (written != writer->position) {
+            return -1;
+        }
+        writer->position = 0;
+    }
+
+    return 0;
 }
 
 /**
- * Escreve os dados comprimidos no arquivo
- * @param input Arquivo de entrada
- * @param output Arquivo de saída
+ * Escreve os bits pendentes (completando o último byte com zeros)
+ * e descarrega o buffer no destino, se houver
+ * @param writer Escritor de bits
+ * @return 0 se sucesso, -1 se houve estouro do buffer ou erro de escrita
+ */
+int flushBitWriter(BitWriter* writer) {
+    while (writer->bit_count > 0) {
+        if (writer->position == writer->capacity && drainBitWriter(writer) != 0) {
+            writer->overflow = 1;
+            break;
+        }
+
+        unsigned char byte;
+        if (writer->bit_count >= 8) {
+            byte = (unsigned char)(writer->accumulator >> (writer->bit_count - 8));
+            writer->bit_count -= 8;
+        } else {
+            byte = (unsigned char)(writer->accumulator << (8 - writer->bit_count));
+            writer->bit_count = 0;
+        }
+        writer->buffer[writer->position++] = byte;
+    }
+
+    writer->accumulator = 0;
+    writer->bit_count = 0;
+
+    if (writer->output != NULL && drainBitWriter(writer) != 0) {
+        return -1;
+    }
+
+    return writer->overflow ? -1 : 0;
+}
+
+/**
+ * Escreve os dados comprimidos bit a bit (caminho para códigos longos)
+ * @param input Origem
+ * @param output Destino
  * @param codes Tabela de códigos de Huffman
  */
-void writeCompressedData(FILE* input, FILE* output, char codes[MAX_CHAR][MAX_TREE_HT]) {
+static void writeCompressedDataBitwise(ByteSource* input, ByteSink* output, char codes[MAX_CHAR][MAX_TREE_HT]) {
     BitBuffer bit_buffer;
     initBitBuffer(&bit_buffer);
     
-    unsigned char buffer[BUFFER_SIZE];
-    size_t bytes_read;
+    const unsigned char* data;
+    size_t available;
     
-    // Lê o arquivo original e escreve os códigos correspondentes
-    while ((bytes_read = fread(buffer, 1, BUFFER_SIZE, input)) > 0) {
-        for (size_t i = 0; i < bytes_read; i++) {
-            char* code = codes[buffer[i]];
+    // Lê a entrada original e escreve os códigos correspondentes
+    while ((data = sourcePeek(input, STREAM_BUFFER_SIZE, &available), available > 0)) {
+        for (size_t i = 0; i < available; i++) {
+            char* code = codes[data[i]];
             for (int j = 0; code[j] != '\0'; j++) {
                 writeBit(&bit_buffer, code[j] - '0', output);
             }
         }
+        sourceSkip(input, available);
     }
     
     // Escreve os bits restantes
@@ -155,22 +454,82 @@ void writeCompressedData(FILE* input, FILE* output, char codes[MAX_CHAR][MAX_TRE
 }
 
 /**
- * Desserializa a árvore de Huffman do arquivo
- * @param file Arquivo de entrada
- * @return Raiz da árvore reconstruída
+ * Escreve os dados comprimidos no destino
+ * Usa a tabela de códigos inteiros e, para entradas grandes o suficiente
+ * para compensar sua construção, a tabela de pares de bytes. Origens em
+ * memória (buffer, mmap) são codificadas sem cópia e, a partir de
+ * PARALLEL_ENCODE_MIN_INPUT, por várias threads com a mesma tabela.
+ * @param input Origem
+ * @param output Destino
+ * @param codes Tabela de códigos de Huffman
  */
-HuffmanNode* deserializeTree(FILE* file) {
-    int marker = fgetc(file);
+void writeCompressedData(ByteSource* input, ByteSink* output, char codes[MAX_CHAR][MAX_TREE_HT]) {
+    CodeTable table;
+    if (buildCodeTable(codes, &table) != 0) {
+        // Códigos mais longos que uma palavra usam o caminho bit a bit
+        writeCompressedDataBitwise(input, output, codes);
+        return;
+    }
+
+    PairCodeTable* pairs = NULL;
+    int64_t remaining = sourceRemaining(input);
+    if (remaining >= PAIR_TABLE_MIN_INPUT) {
+        pairs = buildPairCodeTable(&table);
+    }
+
+    // Origens em memória (buffer, mmap) grandes são codificadas por várias threads
+    size_t window_length = input->length - input->position;
+    if (input->ops->read == NULL && parallelEncodeThreads(window_length) > 1) {
+        encodeStreamParallel(input->data + input->position, window_length, &table, pairs, output, 0, NULL);
+        sourceSkip(input, window_length);
+        freePairCodeTable(pairs);
+        return;
+    }
+
+    unsigned char out_buffer[BUFFER_SIZE];
+    const unsigned char* data;
+    size_t available;
+
+    BitWriter writer;
+    initBitWriter(&writer, out_buffer, BUFFER_SIZE, output);
+
+    // Lê a entrada original e escreve os códigos correspondentes
+    while ((data = sourcePeek(input, STREAM_BUFFER_SIZE, &available), available > 0)) {
+        encodeSymbols(&writer, data, available, &table, pairs);
+        sourceSkip(input, available);
+    }
+
+    // Escreve os bits restantes
+    flushBitWriter(&writer);
+
+    freePairCodeTable(pairs);
+}
+
+/**
+ * Desserializa a árvore de Huffman da origem
+ * @param input Origem
+ * @return Raiz da árvore reconstruída, ou NULL se a árvore está incompleta ou
+ *         o limite de memória foi excedido
+ */
+HuffmanNode* deserializeTree(ByteSource* input) {
+    int marker = sourceGetc(input);
     
     if (marker == 1) {
         // Nó folha
-        unsigned char data = fgetc(file);
+        unsigned char data = (unsigned char)sourceGetc(input);
         return createNode(data, 0); // Frequência não é necessária para decodificação
     } else if (marker == 0) {
         // Nó interno
         HuffmanNode* node = createNode(0, 0);
-        node->left = deserializeTree(file);
-        node->right = deserializeTree(file);
+        if (node == NULL) {
+            return NULL;
+        }
+        node->left = deserializeTree(input);
+        node->right = node->left != NULL ? deserializeTree(input) : NULL;
+        if (node->right == NULL) {
+            freeHuffmanTree(node);
+            return NULL;
+        }
         return node;
     }
     
@@ -179,32 +538,79 @@ HuffmanNode* deserializeTree(FILE* file) {
 
 /**
  * Lê o cabeçalho do arquivo comprimido
- * @param input Arquivo de entrada
- * @return Raiz da árvore de Huffman
+ * Arquivos anteriores à versão 1 começam direto pela árvore e não guardam o
+ * tamanho original.
+ * @param input Origem
+ * @param root Recebe a raiz da árvore de Huffman (NULL se a entrada original é vazia)
+ * @param original_size Recebe os bytes originais (-1 = desconhecido, formato antigo)
+ * @return 0 se sucesso, -1 se o cabeçalho é inválido
  */
-HuffmanNode* readCompressedHeader(FILE* input) {
-    HuffmanNode* root = deserializeTree(input);
+int readCompressedHeader(ByteSource* input, HuffmanNode** root, int64_t* original_size) {
+    size_t available;
+    const unsigned char* header = sourcePeek(input, STREAM_HEADER_SIZE, &available);
+    
+    *root = NULL;
+    *original_size = -1;
+    if (available >= STREAM_MAGIC_SIZE && memcmp(header, STREAM_MAGIC, STREAM_MAGIC_SIZE) == 0) {
+        if (available < STREAM_HEADER_SIZE || header[STREAM_MAGIC_SIZE] > STREAM_FORMAT_VERSION) {
+            fprintf(stderr, "Erro: Versão do formato não suportada\n");
+            return -1;
+        }
+        uint64_t size = 0;
+        for (int i = 7; i >= 0; i--) {
+            size = (size << 8) | header[STREAM_MAGIC_SIZE + 1 + i];
+        }
+        if (size > INT64_MAX) {
+            fprintf(stderr, "Erro: Formato de arquivo inválido\n");
+            return -1;
+        }
+        *original_size = (int64_t)size;
+        sourceSkip(input, STREAM_HEADER_SIZE);
+    }
+    
+    // Entradas vazias não têm árvore
+    if (*original_size != 0) {
+        clearBudgetExceeded();
+        *root = deserializeTree(input);
+        if (*root == NULL) {
+            fprintf(stderr, budgetExceeded() ? "Erro: Limite de memória excedido ao ler a árvore\n" :
+                                               "Erro: Formato de arquivo inválido\n");
+            return -1;
+        }
+    }
     
     // Lê o marcador de fim do cabeçalho
-    int marker = fgetc(input);
+    int marker = sourceGetc(input);
     if (marker != 0xFF) {
         fprintf(stderr, "Erro: Formato de arquivo inválido\n");
-        freeHuffmanTree(root);
-        return NULL;
+        freeHuffmanTree(*root);
+        *root = NULL;
+        return -1;
     }
     
-    return root;
+    // Cada símbolo ocupa ao menos um bit: um tamanho acima dos bits restantes é
+    // corrupção (a árvore de um único símbolo não tem fluxo de bits)
+    int64_t compressed = sourceRemaining(input);
+    if (*original_size > 0 && !isLeaf(*root) && compressed >= 0 &&
+        ((uint64_t)*original_size + 7) / 8 > (uint64_t)compressed) {
+        fprintf(stderr, "Erro: Tamanho original incompatível com os dados comprimidos\n");
+        freeHuffmanTree(*root);
+        *root = NULL;
+        return -1;
+    }
+    
+    return 0;
 }
 
 /**
- * Lê um bit do arquivo usando buffer
+ * Lê um bit da origem usando buffer
  * @param bit_buffer Buffer de bits
- * @param input Arquivo de entrada
+ * @param input Origem
  * @return Bit lido (0 ou 1) ou -1 se EOF
  */
-int readBit(BitBuffer* bit_buffer, FILE* input) {
+int readBit(BitBuffer* bit_buffer, ByteSource* input) {
     if (bit_buffer->bit_count == 0) {
-        int byte = fgetc(input);
+        int byte = sourceGetc(input);
         if (byte == EOF) {
             return -1;
         }
@@ -218,32 +624,172 @@ int readBit(BitBuffer* bit_buffer, FILE* input) {
 }
 
 /**
- * Lê e descomprime os dados do arquivo
- * @param input Arquivo de entrada comprimido
- * @param output Arquivo de saída descomprimido
- * @param root Raiz da árvore de Huffman
+ * Inicializa um leitor de bits em bloco sobre uma origem
+ * @param reader Leitor a ser inicializado
+ * @param storage Buffer de leitura (mínimo de 16 bytes)
+ * @param capacity Capacidade do buffer
+ * @param input Origem
  */
-void readCompressedData(FILE* input, FILE* output, HuffmanNode* root) {
-    BitBuffer bit_buffer;
-    initBitBuffer(&bit_buffer);
-    
-    HuffmanNode* current = root;
-    int bit;
-    
-    // Lê os bits e navega na árvore para decodificar
-    while ((bit = readBit(&bit_buffer, input)) != -1) {
-        if (bit == 0) {
-            current = current->left;
-        } else {
-            current = current->right;
+void initBitReader(BitReader* reader, unsigned char* storage, size_t capacity, ByteSource* input) {
+    reader->accumulator = 0;
+    reader->bit_count = 0;
+    reader->data = storage;
+    reader->position = 0;
+    reader->length = 0;
+    reader->storage = storage;
+    reader->capacity = capacity;
+    reader->input = input;
+}
+
+/**
+ * Inicializa um leitor de bits em bloco sobre um buffer em memória
+ * @param reader Leitor a ser inicializado
+ * @param data Bytes de entrada
+ * @param length Número de bytes
+ */
+void initBitReaderFromMemory(BitReader* reader, const unsigned char* data, size_t length) {
+    reader->accumulator = 0;
+    reader->bit_count = 0;
+    reader->data = data;
+    reader->position = 0;
+    reader->length = length;
+    reader->storage = NULL;
+    reader->capacity = 0;
+    reader->input = NULL;
+}
+
+/**
+ * Completa o acumulador com até 64 bits, recarregando o buffer da
+ * origem quando necessário. Após a chamada, bit_count < 57 indica
+ * que a entrada terminou.
+ * @param reader Leitor de bits
+ */
+void refillBitReader(BitReader* reader) {
+    // Recarrega o buffer quando restam menos de 8 bytes
+    if (reader->input != NULL && reader->length - reader->position < 8) {
+        size_t remaining = reader->length - reader->position;
+        memmove(reader->storage, reader->storage + reader->position, remaining);
+        size_t bytes_read = sourceRead(reader->input, reader->storage + remaining, reader->capacity - remaining);
+        reader->data = reader->storage;
+        reader->position = 0;
+        reader->length = remaining + bytes_read;
+    }
+
+    while (reader->bit_count <= 56 && reader->position < reader->length) {
+        reader->accumulator |= (uint64_t)reader->data[reader->position++] << (56 - reader->bit_count);
+        reader->bit_count += 8;
+    }
+}
+
+/**
+ * Lê e descomprime os dados da origem
+ * Usa uma tabela de decodificação de K bits montada a partir da árvore
+ * (ou já montada para a mesma árvore, via cache); o modo (um ou vários símbolos por consulta) é escolhido pelo
+ * comprimento médio dos códigos. Os símbolos são decodificados direto no
+ * espaço reservado no destino. Com o tamanho original conhecido (e já
+ * confrontado com o tamanho da entrada), o destino é reservado de uma vez e a
+ * decodificação para no último símbolo (os bits de preenchimento do último
+ * byte são ignorados).
+ * @param input Origem comprimida
+ * @param output Destino descomprimido
+ * @param root Raiz da árvore de Huffman (NULL só com original_size 0)
+ * @param original_size Bytes originais (-1 = até a entrada terminar, formato antigo)
+ * @return 0 se sucesso, -1 se os dados estão truncados ou houve erro
+ */
+int readCompressedData(ByteSource* input, ByteSink* output, HuffmanNode* root, int64_t original_size) {
+    if (original_size == 0) {
+        return 0;
+    }
+
+    // Árvore de um único símbolo: a saída é a repetição do símbolo
+    if (original_size > 0 && isLeaf(root)) {
+        uint64_t remaining = (uint64_t)original_size;
+        while (remaining > 0) {
+            size_t available;
+            size_t wanted = remaining < STREAM_BUFFER_SIZE ? (size_t)remaining : STREAM_BUFFER_SIZE;
+            unsigned char* window = sinkReserve(output, wanted, &available);
+            if (window == NULL) {
+                return -1;
+            }
+            size_t count = available < remaining ? available : (size_t)remaining;
+            memset(window, root->data, count);
+            sinkCommit(output, count);
+            remaining -= count;
         }
-        
-        // Se chegou a uma folha, escreve o caractere
-        if (isLeaf(current)) {
-            fputc(current->data, output);
-            current = root; // Volta para a raiz
+        return 0;
+    }
+
+    // Arquivos com a mesma árvore reaproveitam a tabela do cache compartilhado
+    unsigned char shape[MAX_SERIALIZED_TREE];
+    CachedTables* tables = acquireTables(shape, flattenTree(root, shape, 0));
+    const DecodeTable* table = tables != NULL ? cachedDecodeTable(tables) : NULL;
+    if (table == NULL) {
+        fprintf(stderr, "Erro: Limite de memória excedido ao montar a tabela de decodificação\n");
+        releaseTables(tables);
+        return -1;
+    }
+
+    // O tamanho só é reservado de uma vez quando readCompressedHeader pôde
+    // confrontá-lo com a entrada; sem isso (pipes), o destino cresce com a saída
+    int bounded = sourceRemaining(input) >= 0;
+    if (original_size > 0 && bounded) {
+        sinkPreallocate(output, (uint64_t)original_size);
+    }
+
+    // Origens em memória (buffer, mmap) com fluxos grandes são decodificadas por várias threads
+    size_t stream_length = input->length - input->position;
+    if (input->ops->read == NULL && parallelDecodeThreads(stream_length) > 1) {
+        int parallel = decodeStreamParallel(input->data + input->position, stream_length, table,
+                                            original_size, output, 0, NULL);
+        sourceSkip(input, stream_length);
+        releaseTables(tables);
+        return parallel;
+    }
+
+    unsigned char in_buffer[BUFFER_SIZE];
+    BitReader reader;
+    initBitReader(&reader, in_buffer, BUFFER_SIZE, input);
+
+    int result = 0;
+    if (original_size > 0) {
+        // Cada janela é decodificada inteira; só a entrada truncada para antes
+        uint64_t remaining = (uint64_t)original_size;
+        while (remaining > 0) {
+            size_t available;
+            uint64_t limit = bounded ? SIZE_MAX : STREAM_BUFFER_SIZE;
+            size_t wanted = remaining < limit ? (size_t)remaining : (size_t)limit;
+            unsigned char* window = sinkReserve(output, wanted, &available);
+            if (window == NULL) {
+                result = -1;
+                break;
+            }
+            uint64_t count = available < remaining ? available : remaining;
+            uint64_t decoded = decodeSymbols(&reader, table, window, count);
+            sinkCommit(output, (size_t)decoded);
+            remaining -= decoded;
+            if (decoded != count) {
+                fprintf(stderr, "Erro: Dados comprimidos truncados\n");
+                result = -1;
+                break;
+            }
         }
+    } else {
+        // Formato antigo: decodifica até a entrada terminar (decodeSymbols devolve menos que o pedido)
+        uint64_t decoded;
+        size_t available;
+        do {
+            unsigned char* window = sinkReserve(output, STREAM_BUFFER_SIZE, &available);
+            if (window == NULL) {
+                result = -1;
+                break;
+            }
+            decoded = decodeSymbols(&reader, table, window, available);
+            sinkCommit(output, (size_t)decoded);
+        } while (decoded == available);
     }
+
+    releaseTables(tables);
+    return result;
 }
 
 /**
@@ -263,17 +809,82 @@ int fileExists(const char* filename) {
 /**
  * Obtém o tamanho de um arquivo em bytes
  * @param filename Nome do arquivo
- * @return Tamanho do arquivo em bytes, ou -1 se erro
+ * @return Tamanho do arquivo em bytes (64 bits em qualquer plataforma), ou -1 se erro
  */
-long getFileSize(const char* filename) {
+int64_t getFileSize(const char* filename) {
     FILE* file = fopen(filename, "rb");
     if (file == NULL) {
         return -1;
     }
     
-    fseek(file, 0, SEEK_END);
-    long size = ftell(file);
+    off_t size = fseeko(file, 0, SEEK_END) == 0 ? ftello(file) : -1;
     fclose(file);
     
-    return size;
+    return (int64_t)size;
+}
+
+/**
+ * Escreve um inteiro de 32 bits em little-endian
+ * @param file Arquivo de saída
+ * @param value Valor a ser escrito
+ * @return 0 se sucesso, -1 se erro
+ */
+int writeUint32(FILE* file, uint32_t value) {
+    unsigned char bytes[4];
+    for (int i = 0; i < 4; i++) {
+        bytes[i] = (unsigned char)(value >> (8 * i));
+    }
+    return fwrite(bytes, 1, 4, file) == 4 ? 0 : -1;
+}
+
+/**
+ * Lê um inteiro de 32 bits em little-endian
+ * @param file Arquivo de entrada
+ * @param value Valor lido
+ * @return 0 se sucesso, -1 se o arquivo terminou
+ */
+int readUint32(FILE* file, uint32_t* value) {
+    unsigned char bytes[4];
+    if (fread(bytes, 1, 4, file) != 4) {
+        return -1;
+    }
+
+    *value = 0;
+    for (int i = 3; i >= 0; i--) {
+        *value = (*value << 8) | bytes[i];
+    }
+    return 0;
+}
+
+/**
+ * Escreve um inteiro de 64 bits em little-endian
+ * @param file Arquivo de saída
+ * @param value Valor a ser escrito
+ * @return 0 se sucesso, -1 se erro
+ */
+int writeUint64(FILE* file, uint64_t value) {
+    unsigned char bytes[8];
+    for (int i = 0; i < 8; i++) {
+        bytes[i] = (unsigned char)(value >> (8 * i));
+    }
+    return fwrite(bytes, 1, 8, file) == 8 ? 0 : -1;
+}
+
+/**
+ * Lê um inteiro de 64 bits em little-endian
+ * @param file Arquivo de entrada
+ * @param value Valor lido
+ * @return 0 se sucesso, -1 se o arquivo terminou
+ */
+int readUint64(FILE* file, uint64_t* value) {
+    unsigned char bytes[8];
+    if (fread(bytes, 1, 8, file) != 8) {
+        return -1;
+    }
+
+    *value = 0;
+    for (int i = 7; i >= 0; i--) {
+        *value = (*value << 8) | bytes[i];
+    }
+    return 0;
 }
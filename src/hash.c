@@ -0,0 +1,245 @@
+#include "hash.h"
+#include "memory_budget.h"
+#include <string.h>
+
+// Constantes do MurmurHash64A
+#define HASH_MULTIPLIER 0xc6a4a7935bd1e995ULL
+#define HASH_SHIFT 47
+
+/**
+ * Calcula um hash de 64 bits (MurmurHash64A), lendo 8 bytes por passo
+ * @param data Bytes de entrada
+ * @param length Número de bytes
+ * @param seed Semente (entradas com sementes diferentes têm hashes independentes)
+ * @return Hash de 64 bits
+ */
+uint64_t hash64(const void* data, size_t length, uint64_t seed) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    uint64_t hash = seed ^ ((uint64_t)length * HASH_MULTIPLIER);
+    size_t words = length / 8;
+
+    for (size_t i = 0; i < words; i++) {
+        uint64_t word;
+        memcpy(&word, bytes + i * 8, sizeof(word));
+
+        word *= HASH_MULTIPLIER;
+        word ^= word >> HASH_SHIFT;
+        word *= HASH_MULTIPLIER;
+
+        hash ^= word;
+        hash *= HASH_MULTIPLIER;
+    }
+
+    // Bytes finais (menos de 8)
+    const unsigned char* tail = bytes + words * 8;
+    switch (length & 7) {
+        case 7: hash ^= (uint64_t)tail[6] << 48; /* fall through */
+        case 6: hash ^= (uint64_t)tail[5] << 40; /* fall through */
+        case 5: hash ^= (uint64_t)tail[4] << 32; /* fall through */
+        case 4: hash ^= (uint64_t)tail[3] << 24; /* fall through */
+        case 3: hash ^= (uint64_t)tail[2] << 16; /* fall through */
+        case 2: hash ^= (uint64_t)tail[1] << 8;  /* fall through */
+        case 1: hash ^= (uint64_t)tail[0];
+                hash *= HASH_MULTIPLIER;
+                break;
+        default: break;
+    }
+
+    hash ^= hash >> HASH_SHIFT;
+    hash *= HASH_MULTIPLIER;
+    hash ^= hash >> HASH_SHIFT;
+    return hash;
+}
+
+/**
+ * Mistura final de uma metade do hash de 128 bits
+ * @param value Valor parcial
+ * @return Valor misturado
+ */
+static uint64_t finalMix64(uint64_t value) {
+    value ^= value >> 33;
+    value *= 0xff51afd7ed558ccdULL;
+    value ^= value >> 33;
+    value *= 0xc4ceb9fe1a85ec53ULL;
+    value ^= value >> 33;
+    return value;
+}
+
+/**
+ * Calcula um hash de 128 bits (MurmurHash3 x64_128), lendo 16 bytes por passo
+ * Função independente de hash64: um par de blocos que colide em uma
+ * não colide por isso na outra.
+ * @param data Bytes de entrada
+ * @param length Número de bytes
+ * @param seed Semente
+ * @param digest Recebe as duas metades do hash
+ */
+void hash128(const void* data, size_t length, uint64_t seed, uint64_t digest[2]) {
+    const uint64_t c1 = 0x87c37b91114253d5ULL;
+    const uint64_t c2 = 0x4cf5ad432745937fULL;
+    const unsigned char* bytes = (const unsigned char*)data;
+    uint64_t h1 = seed;
+    uint64_t h2 = seed;
+    size_t blocks = length / 16;
+
+    for (size_t i = 0; i < blocks; i++) {
+        uint64_t k1;
+        uint64_t k2;
+        memcpy(&k1, bytes + i * 16, sizeof(k1));
+        memcpy(&k2, bytes + i * 16 + 8, sizeof(k2));
+
+        k1 *= c1; k1 = (k1 << 31) | (k1 >> 33); k1 *= c2; h1 ^= k1;
+        h1 = (h1 << 27) | (h1 >> 37); h1 += h2; h1 = h1 * 5 + 0x52dce729;
+        k2 *= c2; k2 = (k2 << 33) | (k2 >> 31); k2 *= c1; h2 ^= k2;
+        h2 = (h2 << 31) | (h2 >> 33); h2 += h1; h2 = h2 * 5 + 0x38495ab5;
+    }
+
+    // Bytes finais (menos de 16)
+    const unsigned char* tail = bytes + blocks * 16;
+    uint64_t k1 = 0;
+    uint64_t k2 = 0;
+    size_t rest = length & 15;
+    for (size_t i = rest; i > 8; i--) {
+        k2 ^= (uint64_t)tail[i - 1] << (8 * (i - 9));
+    }
+    for (size_t i = rest < 8 ? rest : 8; i > 0; i--) {
+        k1 ^= (uint64_t)tail[i - 1] << (8 * (i - 1));
+    }
+    if (rest > 8) {
+        k2 *= c2; k2 = (k2 << 33) | (k2 >> 31); k2 *= c1; h2 ^= k2;
+    }
+    if (rest > 0) {
+        k1 *= c1; k1 = (k1 << 31) | (k1 >> 33); k1 *= c2; h1 ^= k1;
+    }
+
+    h1 ^= (uint64_t)length;
+    h2 ^= (uint64_t)length;
+    h1 += h2;
+    h2 += h1;
+    h1 = finalMix64(h1);
+    h2 = finalMix64(h2);
+    h1 += h2;
+    h2 += h1;
+    digest[0] = h1;
+    digest[1] = h2;
+}
+
+/**
+ * Inicializa um índice vazio (a memória é alocada na primeira inserção)
+ * @param index Índice
+ */
+void initHashIndex(HashIndex* index) {
+    memset(index, 0, sizeof(HashIndex));
+}
+
+/**
+ * Procura a posição de uma chave (ou a posição livre onde ela entraria)
+ * @param keys Chaves
+ * @param values Valores
+ * @param capacity Número de posições
+ * @param key Chave procurada
+ * @return Posição encontrada
+ */
+static size_t probeHashIndex(const uint64_t* keys, const uint64_t* values, size_t capacity, uint64_t key) {
+    size_t mask = capacity - 1;
+    size_t slot = (size_t)key & mask;
+    while (values[slot] != HASH_INDEX_EMPTY && keys[slot] != key) {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+/**
+ * Procura o valor associado a um hash
+ * @param index Índice
+ * @param key Hash procurado
+ * @param value Valor encontrado
+ * @return 1 se encontrado, 0 caso contrário
+ */
+int findHashIndex(const HashIndex* index, uint64_t key, uint64_t* value) {
+    if (index->capacity == 0) {
+        return 0;
+    }
+
+    size_t slot = probeHashIndex(index->keys, index->values, index->capacity, key);
+    if (index->values[slot] == HASH_INDEX_EMPTY) {
+        return 0;
+    }
+    *value = index->values[slot];
+    return 1;
+}
+
+/**
+ * Dobra a capacidade do índice, reinserindo as chaves
+ * @param index Índice
+ * @return 0 se sucesso, -1 se o limite de memória foi excedido
+ */
+static int growHashIndex(HashIndex* index) {
+    size_t capacity = index->capacity > 0 ? index->capacity * 2 : HASH_INDEX_INITIAL_CAPACITY;
+    uint64_t* keys = (uint64_t*)budgetMalloc(capacity * sizeof(uint64_t));
+    uint64_t* values = (uint64_t*)budgetMalloc(capacity * sizeof(uint64_t));
+    if (keys == NULL || values == NULL) {
+        budgetFree(keys);
+        budgetFree(values);
+        return -1;
+    }
+    memset(values, 0xFF, capacity * sizeof(uint64_t));
+
+    for (size_t i = 0; i < index->capacity; i++) {
+        if (index->values[i] != HASH_INDEX_EMPTY) {
+            size_t slot = probeHashIndex(keys, values, capacity, index->keys[i]);
+            keys[slot] = index->keys[i];
+            values[slot] = index->values[i];
+        }
+    }
+
+    budgetFree(index->keys);
+    budgetFree(index->values);
+    index->keys = keys;
+    index->values = values;
+    index->capacity = capacity;
+    return 0;
+}
+
+/**
+ * Associa um valor a um hash (substitui o valor se o hash já existe)
+ * @param index Índice
+ * @param key Hash
+ * @param value Valor (diferente de HASH_INDEX_EMPTY)
+ * @return 0 se sucesso, -1 se o limite de memória foi excedido
+ */
+int insertHashIndex(HashIndex* index, uint64_t key, uint64_t value) {
+    // Mantém a ocupação abaixo de 50% para sondagens curtas
+    if ((index->count + 1) * 2 > index->capacity && growHashIndex(index) != 0) {
+        return -1;
+    }
+
+    size_t slot = probeHashIndex(index->keys, index->values, index->capacity, key);
+    if (index->values[slot] == HASH_INDEX_EMPTY) {
+        index->count++;
+    }
+    index->keys[slot] = key;
+    index->values[slot] = value;
+    return 0;
+}
+
+/**
+ * Remove todas as chaves, mantendo a memória alocada
+ * @param index Índice
+ */
+void clearHashIndex(HashIndex* index) {
+    if (index->capacity > 0) {
+        memset(index->values, 0xFF, index->capacity * sizeof(uint64_t));
+    }
+    index->count = 0;
+}
+
+/**
+ * Libera a memória do índice
+ * @param index Índice
+ */
+void freeHashIndex(HashIndex* index) {
+    budgetFree(index->keys);
+    budgetFree(index->values);
+    initHashIndex(index);
+}
@@ -0,0 +1,239 @@
+#define _POSIX_C_SOURCE 200809L
+#include "huf_reader.h"
+#include <string.h>
+#include <limits.h>
+
+/**
+ * Prepara a leitura de um contêiner em blocos
+ * @param reader Leitor (arquivo no início do contêiner)
+ * @return 0 se sucesso, -1 se o cabeçalho é inválido ou faltou memória
+ */
+static int openBlockReader(HufReader* reader) {
+    reader->format = HUF_FORMAT_BLOCKS;
+    reader->container_start = ftello(reader->file);
+    initBlockWorkspace(&reader->workspace);
+    int version;
+    if (readContainerHeader(reader->file, &version, &reader->block_size, &reader->flags) != 0) {
+        return -1;
+    }
+    if (reserveBlockWorkspace(&reader->workspace, reader->block_size) != 0) {
+        fprintf(stderr, "Erro: Limite de memória excedido ao alocar os blocos\n");
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Prepara a leitura do formato de fluxo único: cabeçalho, árvore e tabela
+ * @param reader Leitor (arquivo no início do fluxo)
+ * @return 0 se sucesso, -1 se o cabeçalho é inválido ou faltou memória
+ */
+static int openStreamReader(HufReader* reader) {
+    reader->format = HUF_FORMAT_STREAM;
+    initFileSource(&reader->source, reader->file);
+    if (readCompressedHeader(&reader->source, &reader->root, &reader->original_size) != 0) {
+        fprintf(stderr, "Erro: Falha ao ler o cabeçalho do arquivo\n");
+        return -1;
+    }
+    if (reader->root == NULL) {
+        reader->finished = 1;
+        return 0;
+    }
+
+    // Arquivos com a mesma árvore reaproveitam a tabela do cache compartilhado
+    unsigned char shape[MAX_SERIALIZED_TREE];
+    reader->tables = acquireTables(shape, flattenTree(reader->root, shape, 0));
+    if (reader->tables == NULL || cachedDecodeTable(reader->tables) == NULL) {
+        fprintf(stderr, "Erro: Limite de memória excedido ao montar a tabela de decodificação\n");
+        return -1;
+    }
+
+    reader->storage = (unsigned char*)budgetMalloc(HUF_READER_BUFFER_SIZE);
+    if (reader->storage == NULL) {
+        fprintf(stderr, "Erro: Limite de memória excedido ao alocar o leitor\n");
+        return -1;
+    }
+    initBitReader(&reader->bits, reader->storage, HUF_READER_BUFFER_SIZE, &reader->source);
+    return 0;
+}
+
+/**
+ * Abre um leitor sobre um arquivo já aberto (que não é fechado por hufClose)
+ * O arquivo precisa permitir voltar à posição inicial: o formato é
+ * identificado pela assinatura, e referências entre blocos voltam a blocos
+ * anteriores do contêiner.
+ * @param file Arquivo comprimido, na posição inicial dos dados
+ * @return Leitor, ou NULL se o arquivo não pôde ser lido
+ */
+HufReader* hufOpenStream(FILE* file) {
+    if (ftello(file) < 0) {
+        fprintf(stderr, "Erro: O leitor precisa de um arquivo com posição (não um pipe)\n");
+        return NULL;
+    }
+
+    HufReader* reader = (HufReader*)calloc(1, sizeof(HufReader));
+    if (reader == NULL) {
+        fprintf(stderr, "Erro: Falha na alocação de memória para o leitor\n");
+        exit(EXIT_FAILURE);
+    }
+    reader->file = file;
+
+    int result = isBlockContainer(file) ? openBlockReader(reader) : openStreamReader(reader);
+    if (result != 0) {
+        hufClose(reader);
+        return NULL;
+    }
+    return reader;
+}
+
+/**
+ * Abre um arquivo comprimido (formato em blocos ou de fluxo único) para
+ * leitura sob demanda
+ * @param filename Nome do arquivo comprimido
+ * @return Leitor (liberar com hufClose), ou NULL se erro
+ */
+HufReader* hufOpen(const char* filename) {
+    FILE* file = fopen(filename, "rb");
+    if (file == NULL) {
+        fprintf(stderr, "Erro: Arquivo de entrada '%s' não encontrado\n", filename);
+        return NULL;
+    }
+
+    HufReader* reader = hufOpenStream(file);
+    if (reader == NULL) {
+        fclose(file);
+        return NULL;
+    }
+    reader->owns_file = 1;
+    return reader;
+}
+
+/**
+ * Entrega bytes de um contêiner em blocos, decodificando o próximo bloco
+ * quando o atual se esgota
+ * @param reader Leitor
+ * @param output Destino
+ * @param size Bytes desejados
+ * @return Bytes entregues, ou -1 se erro antes de entregar algum byte
+ */
+static ssize_t readBlocks(HufReader* reader, unsigned char* output, size_t size) {
+    size_t done = 0;
+    while (done < size) {
+        if (reader->block_position == reader->block_length) {
+            if (reader->finished) {
+                break;
+            }
+            uint32_t raw_size;
+            int decoded = decodeNextBlock(reader->file, NULL, reader->container_start, reader->block_size,
+                                          reader->flags, &reader->workspace, &reader->stats, &raw_size);
+            if (decoded < 0) {
+                reader->failed = 1;
+                break;
+            }
+            if (decoded == 0) {
+                reader->finished = 1;
+                break;
+            }
+            reader->block_length = raw_size;
+            reader->block_position = 0;
+            continue;
+        }
+
+        size_t count = reader->block_length - reader->block_position;
+        if (count > size - done) {
+            count = size - done;
+        }
+        memcpy(output + done, reader->workspace.block + reader->block_position, count);
+        reader->block_position += count;
+        done += count;
+    }
+    return done > 0 || !reader->failed ? (ssize_t)done : -1;
+}
+
+/**
+ * Decodifica bytes do formato de fluxo único direto no destino
+ * @param reader Leitor
+ * @param output Destino
+ * @param size Bytes desejados
+ * @return Bytes entregues, ou -1 se erro antes de entregar algum byte
+ */
+static ssize_t readStream(HufReader* reader, unsigned char* output, size_t size) {
+    uint64_t count = size;
+    if (reader->original_size >= 0 && (uint64_t)reader->original_size - reader->delivered < count) {
+        count = (uint64_t)reader->original_size - reader->delivered;
+    }
+
+    // Árvore de um único símbolo: a saída é a repetição do símbolo
+    uint64_t decoded;
+    if (reader->original_size > 0 && isLeaf(reader->root)) {
+        memset(output, reader->root->data, (size_t)count);
+        decoded = count;
+    } else {
+        decoded = decodeSymbols(&reader->bits, cachedDecodeTable(reader->tables), output, count);
+    }
+
+    if (decoded < count) {
+        // Sem tamanho no cabeçalho (formato antigo), o fluxo termina quando a entrada acaba
+        if (reader->original_size >= 0) {
+            fprintf(stderr, "Erro: Dados comprimidos truncados\n");
+            reader->failed = 1;
+        }
+        reader->finished = 1;
+    } else if (reader->original_size >= 0 && reader->delivered + decoded == (uint64_t)reader->original_size) {
+        reader->finished = 1;
+    }
+    if (reader->source.error) {
+        reader->failed = 1;
+    }
+    return decoded > 0 || !reader->failed ? (ssize_t)decoded : -1;
+}
+
+/**
+ * Lê até size bytes descomprimidos, decodificando sob demanda
+ * Depois de um erro, os bytes decodificados antes dele ainda são entregues
+ * e a chamada seguinte devolve -1.
+ * @param reader Leitor
+ * @param buffer Destino
+ * @param size Bytes desejados
+ * @return Bytes entregues (0 no fim dos dados), ou -1 se erro
+ */
+ssize_t hufRead(HufReader* reader, void* buffer, size_t size) {
+    if (reader->failed) {
+        return -1;
+    }
+    if (size > (size_t)SSIZE_MAX) {
+        size = (size_t)SSIZE_MAX;
+    }
+    if (size == 0 || (reader->finished && reader->block_position == reader->block_length)) {
+        return 0;
+    }
+
+    ssize_t result = reader->format == HUF_FORMAT_BLOCKS ? readBlocks(reader, (unsigned char*)buffer, size) :
+                     readStream(reader, (unsigned char*)buffer, size);
+    if (result > 0) {
+        reader->delivered += (uint64_t)result;
+    }
+    return result;
+}
+
+/**
+ * Libera um leitor (e fecha o arquivo se ele foi aberto por hufOpen)
+ * @param reader Leitor (pode ser NULL)
+ */
+void hufClose(HufReader* reader) {
+    if (reader == NULL) {
+        return;
+    }
+    if (reader->format == HUF_FORMAT_BLOCKS) {
+        freeBlockWorkspace(&reader->workspace);
+    } else {
+        releaseTables(reader->tables);
+        freeHuffmanTree(reader->root);
+        budgetFree(reader->storage);
+        closeSource(&reader->source);
+    }
+    if (reader->owns_file) {
+        fclose(reader->file);
+    }
+    free(reader);
+}
@@ -1,9 +1,22 @@
 #include "huffman_algorithm.h"
+#include "block_format.h"
+
+/**
+ * Libera as árvores ainda na fila e a própria fila
+ * @param pq Fila de prioridade
+ */
+static void freeQueuedTrees(PriorityQueue* pq) {
+    for (unsigned i = 0; i < pq->size; i++) {
+        freeHuffmanTree(pq->array[i]);
+    }
+    freePriorityQueue(pq);
+}
 
 /**
  * Constrói a árvore de Huffman a partir das frequências dos caracteres
  * @param frequencies Array com as frequências de cada caractere
- * @return Raiz da árvore de Huffman construída
+ * @return Raiz da árvore de Huffman construída, ou NULL se a entrada é vazia
+ *         ou o limite de memória foi excedido
  */
 HuffmanNode* buildHuffmanTree(unsigned long* frequencies) {
     // Conta quantos caracteres únicos existem
@@ -15,11 +28,18 @@ HuffmanNode* buildHuffmanTree(unsigned long* frequencies) {
     
     // Cria a fila de prioridade
     PriorityQueue* pq = createPriorityQueue(unique_chars);
+    if (pq == NULL) {
+        return NULL;
+    }
     
     // Insere todos os caracteres com frequência > 0 na fila
     for (int i = 0; i < MAX_CHAR; i++) {
         if (frequencies[i] > 0) {
             HuffmanNode* node = createNode((unsigned char)i, frequencies[i]);
+            if (node == NULL) {
+                freeQueuedTrees(pq);
+                return NULL;
+            }
             insert(pq, node);
         }
     }
@@ -32,6 +52,12 @@ HuffmanNode* buildHuffmanTree(unsigned long* frequencies) {
         
         // Cria um novo nó interno com a soma das frequências
         HuffmanNode* internal = createNode(0, left->frequency + right->frequency);
+        if (internal == NULL) {
+            freeHuffmanTree(left);
+            freeHuffmanTree(right);
+            freeQueuedTrees(pq);
+            return NULL;
+        }
         internal->left = left;
         internal->right = right;
         
@@ -80,6 +106,202 @@ void generateHuffmanCodes(HuffmanNode* root, char* current_code, int depth, char
     }
 }
 
+/**
+ * Compara dois pesos para qsort (ordem crescente)
+ * @param a Primeiro peso
+ * @param b Segundo peso
+ * @return Negativo, zero ou positivo
+ */
+static int compareWeights(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * Calcula o tamanho em bits de um fluxo codificado com a árvore de Huffman
+ * ótima, sem montar a árvore: o total é a soma dos pesos dos nós internos
+ * (método das duas filas sobre os pesos ordenados)
+ * @param frequencies Tabela de frequências
+ * @param leaves Recebe o número de símbolos presentes
+ * @return Bits do fluxo codificado
+ */
+uint64_t huffmanCostBits(const unsigned long* frequencies, int* leaves) {
+    uint64_t weights[MAX_CHAR];
+    uint64_t merged[MAX_CHAR];
+    int count = 0;
+
+    for (int c = 0; c < MAX_CHAR; c++) {
+        if (frequencies[c] > 0) {
+            weights[count++] = frequencies[c];
+        }
+    }
+    *leaves = count;
+
+    // Um único símbolo ainda gasta um bit por ocorrência
+    if (count < 2) {
+        return count == 1 ? weights[0] : 0;
+    }
+
+    qsort(weights, (size_t)count, sizeof(uint64_t), compareWeights);
+
+    uint64_t total = 0;
+    int next = 0;
+    int head = 0;
+    int tail = 0;
+    for (int n = 0; n < count - 1; n++) {
+        uint64_t pair[2];
+        for (int k = 0; k < 2; k++) {
+            if (next < count && (head == tail || weights[next] <= merged[head])) {
+                pair[k] = weights[next++];
+            } else {
+                pair[k] = merged[head++];
+            }
+        }
+        merged[tail++] = pair[0] + pair[1];
+        total += pair[0] + pair[1];
+    }
+    return total;
+}
+
+/**
+ * Calcula o tamanho exato que a compressão de fluxo único gravaria para uma
+ * tabela de frequências, sem codificar nem gravar nada: cabeçalho com o
+ * tamanho original, árvore serializada, marcador de fim do cabeçalho e
+ * fluxo de bits completado até o byte
+ * @param frequencies Frequências da entrada inteira
+ * @return Bytes comprimidos
+ */
+uint64_t estimateCompressedSize(unsigned long* frequencies) {
+    HuffmanNode* root = buildHuffmanTree(frequencies);
+    if (root == NULL) {
+        // Entrada vazia: só o cabeçalho e o marcador
+        return STREAM_HEADER_SIZE + 1;
+    }
+    
+    char codes[MAX_CHAR][MAX_TREE_HT] = {{0}};
+    char current_code[MAX_TREE_HT] = {0};
+    generateHuffmanCodes(root, current_code, 0, codes);
+    freeHuffmanTree(root);
+    
+    uint64_t bits = 0;
+    int leaves = 0;
+    for (int i = 0; i < MAX_CHAR; i++) {
+        if (frequencies[i] > 0) {
+            bits += (uint64_t)frequencies[i] * strlen(codes[i]);
+            leaves++;
+        }
+    }
+    
+    // Árvore: 2 bytes por folha e 1 por nó interno, seguida do marcador 0xFF
+    return STREAM_HEADER_SIZE + (uint64_t)(3 * leaves - 1) + 1 + (bits + 7) / 8;
+}
+
+/**
+ * Constrói a árvore e grava o cabeçalho e os dados comprimidos
+ * @param frequencies Frequências da entrada inteira
+ * @param input Origem posicionada no início dos dados
+ * @param output Destino
+ * @return 0 se sucesso, -1 se erro
+ */
+static int writeCompressedStream(unsigned long* frequencies, ByteSource* input, ByteSink* output) {
+    uint64_t original_size = 0;
+    for (int i = 0; i < MAX_CHAR; i++) {
+        original_size += frequencies[i];
+    }
+    
+    // Constrói a árvore de Huffman (entradas vazias ficam só com o cabeçalho)
+    HuffmanNode* root = buildHuffmanTree(frequencies);
+    if (root == NULL && original_size > 0) {
+        fprintf(stderr, "Erro: Limite de memória excedido ao construir a árvore de Huffman\n");
+        return -1;
+    }
+    
+    // Escreve o cabeçalho com o tamanho original e a árvore
+    writeCompressedHeader(output, root, original_size);
+    
+    // Com um único símbolo, o tamanho original basta: não há fluxo de bits
+    if (root != NULL && !isLeaf(root)) {
+        char codes[MAX_CHAR][MAX_TREE_HT] = {{0}};
+        char current_code[MAX_TREE_HT] = {0};
+        generateHuffmanCodes(root, current_code, 0, codes);
+        writeCompressedData(input, output, codes);
+    }
+    
+    freeHuffmanTree(root);
+    return sinkFlush(output) == 0 && !input->error ? 0 : -1;
+}
+
+/**
+ * Comprime uma origem qualquer (arquivo, descritor, memória ou mmap)
+ * A origem é lida duas vezes (frequências e codificação), então precisa
+ * permitir sourceRewind.
+ * @param input Origem
+ * @param output Destino
+ * @return 0 se sucesso, -1 se erro
+ */
+int compressSource(ByteSource* input, ByteSink* output) {
+    unsigned long frequencies[MAX_CHAR] = {0};
+    const unsigned char* data;
+    size_t available;
+    
+    while ((data = sourcePeek(input, STREAM_BUFFER_SIZE, &available), available > 0)) {
+        countFrequencies(data, available, frequencies);
+        sourceSkip(input, available);
+    }
+    
+    if (sourceRewind(input) != 0) {
+        fprintf(stderr, "Erro: A compressão exige uma entrada que possa ser relida\n");
+        return -1;
+    }
+    
+    return writeCompressedStream(frequencies, input, output);
+}
+
+/**
+ * Descomprime uma origem qualquer no formato de fluxo único
+ * @param input Origem comprimida
+ * @param output Destino
+ * @return 0 se sucesso, -1 se erro
+ */
+int decompressSource(ByteSource* input, ByteSink* output) {
+    // Lê o cabeçalho e reconstrói a árvore
+    HuffmanNode* root;
+    int64_t original_size;
+    if (readCompressedHeader(input, &root, &original_size) != 0) {
+        fprintf(stderr, "Erro: Falha ao ler o cabeçalho do arquivo\n");
+        return -1;
+    }
+    
+    // Lê e descomprime os dados
+    int result = readCompressedData(input, output, root, original_size);
+    
+    freeHuffmanTree(root);
+    return result == 0 && sinkFlush(output) == 0 && !input->error ? 0 : -1;
+}
+
+/**
+ * Abre um arquivo de entrada como origem: mapeado em memória quando
+ * possível, ou por FILE* (pipes e arquivos especiais)
+ * @param source Origem
+ * @param filename Nome do arquivo
+ * @param file Recebe o FILE* aberto (NULL se a origem é mmap)
+ * @return 0 se sucesso, -1 se o arquivo não pôde ser aberto
+ */
+static int openInputSource(ByteSource* source, const char* filename, FILE** file) {
+    *file = NULL;
+    if (openMappedSource(source, filename) == 0) {
+        return 0;
+    }
+    
+    *file = fopen(filename, "rb");
+    if (*file == NULL) {
+        return -1;
+    }
+    initFileSource(source, *file);
+    return 0;
+}
+
 /**
  * Comprime um arquivo usando o algoritmo de Huffman
  * @param input_filename Nome do arquivo de entrada
@@ -93,48 +315,43 @@ int compressFile(const char* input_filename, const char* output_filename) {
         return -1;
     }
     
-    // Calcula as frequências dos caracteres
+    // Calcula as frequências dos caracteres (em paralelo para arquivos grandes)
     unsigned long* frequencies = calculateFrequencies(input_filename);
     
-    // Constrói a árvore de Huffman
-    HuffmanNode* root = buildHuffmanTree(frequencies);
-    if (root == NULL) {
-        fprintf(stderr, "Erro: Falha ao construir a árvore de Huffman\n");
+    // Abre os arquivos
+    ByteSource source;
+    FILE* input = NULL;
+    if (openInputSource(&source, input_filename, &input) != 0) {
+        fprintf(stderr, "Erro: Não foi possível abrir os arquivos\n");
         free(frequencies);
         return -1;
     }
     
-    // Gera os códigos de Huffman
-    char codes[MAX_CHAR][MAX_TREE_HT] = {{0}};
-    char current_code[MAX_TREE_HT] = {0};
-    generateHuffmanCodes(root, current_code, 0, codes);
-    
-    // Abre os arquivos
-    FILE* input = fopen(input_filename, "rb");
     FILE* output = fopen(output_filename, "wb");
-    
-    if (input == NULL || output == NULL) {
+    if (output == NULL) {
         fprintf(stderr, "Erro: Não foi possível abrir os arquivos\n");
-        freeHuffmanTree(root);
+        closeSource(&source);
+        if (input != NULL) fclose(input);
         free(frequencies);
         return -1;
     }
     
-    // Escreve o cabeçalho com a árvore
-    writeCompressedHeader(output, root);
-    
-    // Escreve os dados comprimidos
-    writeCompressedData(input, output, codes);
+    ByteSink sink;
+    initFileSink(&sink, output);
+    int result = writeCompressedStream(frequencies, &source, &sink);
     
     // Fecha os arquivos
-    fclose(input);
-    fclose(output);
+    closeSink(&sink);
+    closeSource(&source);
+    if (input != NULL) fclose(input);
+    if (fclose(output) != 0) {
+        result = -1;
+    }
     
     // Libera a memória
-    freeHuffmanTree(root);
     free(frequencies);
     
-    return 0;
+    return result;
 }
 
 /**
@@ -150,35 +367,45 @@ int decompressFile(const char* input_filename, const char* output_filename) {
         return -1;
     }
     
-    // Abre os arquivos
-    FILE* input = fopen(input_filename, "rb");
-    FILE* output = fopen(output_filename, "wb");
+    // Contêineres em blocos têm assinatura própria
+    if (isBlockContainerFile(input_filename)) {
+        return decompressFileBlocks(input_filename, output_filename, NULL, NULL);
+    }
     
-    if (input == NULL || output == NULL) {
+    // Abre os arquivos
+    ByteSource source;
+    FILE* input = NULL;
+    if (openInputSource(&source, input_filename, &input) != 0) {
         fprintf(stderr, "Erro: Não foi possível abrir os arquivos\n");
         return -1;
     }
     
-    // Lê o cabeçalho e reconstrói a árvore
-    HuffmanNode* root = readCompressedHeader(input);
-    if (root == NULL) {
-        fprintf(stderr, "Erro: Falha ao ler o cabeçalho do arquivo\n");
-        fclose(input);
-        fclose(output);
+    FILE* output = fopen(output_filename, "wb");
+    if (output == NULL) {
+        fprintf(stderr, "Erro: Não foi possível abrir os arquivos\n");
+        closeSource(&source);
+        if (input != NULL) fclose(input);
         return -1;
     }
     
-    // Lê e descomprime os dados
-    readCompressedData(input, output, root);
+    ByteSink sink;
+    initFileSink(&sink, output);
+    int result = decompressSource(&source, &sink);
     
     // Fecha os arquivos
-    fclose(input);
-    fclose(output);
+    closeSink(&sink);
+    closeSource(&source);
+    if (input != NULL) fclose(input);
+    if (fclose(output) != 0) {
+        result = -1;
+    }
     
-    // Libera a memória
-    freeHuffmanTree(root);
+    // Uma saída incompleta não fica no lugar do arquivo descomprimido
+    if (result != 0) {
+        remove(output_filename);
+    }
     
-    return 0;
+    return result;
 }
 
 /**
@@ -236,8 +463,8 @@ void printHuffmanTree(HuffmanNode* root, int depth) {
  * @return Taxa de compressão (0.0 a 1.0)
  */
 double calculateCompressionRatio(const char* original_file, const char* compressed_file) {
-    long original_size = getFileSize(original_file);
-    long compressed_size = getFileSize(compressed_file);
+    int64_t original_size = getFileSize(original_file);
+    int64_t compressed_size = getFileSize(compressed_file);
     
     if (original_size <= 0 || compressed_size <= 0) {
         return -1.0;
@@ -263,19 +490,19 @@ int validateCompression(const char* original_file, const char* decompressed_file
     }
     
     int identical = 1;
-    int ch1, ch2;
-    
-    while ((ch1 = fgetc(original)) != EOF && (ch2 = fgetc(decompressed)) != EOF) {
-        if (ch1 != ch2) {
+    unsigned char buffer1[HISTOGRAM_BUFFER_SIZE];
+    unsigned char buffer2[HISTOGRAM_BUFFER_SIZE];
+    size_t read1, read2;
+    
+    // Compara em blocos; os dois arquivos precisam chegar juntos ao fim
+    do {
+        read1 = fread(buffer1, 1, sizeof(buffer1), original);
+        read2 = fread(buffer2, 1, sizeof(buffer2), decompressed);
+        if (read1 != read2 || memcmp(buffer1, buffer2, read1) != 0) {
             identical = 0;
             break;
         }
-    }
-    
-    // Verifica se ambos os arquivos terminaram ao mesmo tempo
-    if (ch1 != EOF || ch2 != EOF) {
-        identical = 0;
-    }
+    } while (read1 > 0);
     
     fclose(original);
     fclose(decompressed);
@@ -289,8 +516,8 @@ int validateCompression(const char* original_file, const char* decompressed_file
  * @param compressed_file Arquivo comprimido
  */
 void printCompressionStats(const char* original_file, const char* compressed_file) {
-    long original_size = getFileSize(original_file);
-    long compressed_size = getFileSize(compressed_file);
+    int64_t original_size = getFileSize(original_file);
+    int64_t compressed_size = getFileSize(compressed_file);
     
     if (original_size <= 0 || compressed_size <= 0) {
         printf("Erro ao obter tamanhos dos arquivos\n");
@@ -300,8 +527,8 @@ void printCompressionStats(const char* original_file, const char* compressed_fil
     double ratio = calculateCompressionRatio(original_file, compressed_file);
     
     printf("\n=== Estatísticas de Compressão ===\n");
-    printf("Tamanho original: %ld bytes\n", original_size);
-    printf("Tamanho comprimido: %ld bytes\n", compressed_size);
+    printf("Tamanho original: %lld bytes\n", (long long)original_size);
+    printf("Tamanho comprimido: %lld bytes\n", (long long)compressed_size);
     printf("Taxa de compressão: %.2f%%\n", ratio * 100);
-    printf("Economia de espaço: %ld bytes\n", original_size - compressed_size);
+    printf("Economia de espaço: %lld bytes\n", (long long)(original_size - compressed_size));
 }
@@ -1,40 +1,274 @@
+#define _POSIX_C_SOURCE 200809L
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
 #include "huffman_algorithm.h"
+#include "block_format.h"
+#include "memory_budget.h"
+#include "cpu_dispatch.h"
+#include "server.h"
+#include "archive.h"
+#include "adaptive_huffman.h"
+#include <unistd.h>
 
 #define MAX_FILENAME 256
 
 void printUsage(const char* program_name) {
     printf("Compressor e Descompressor Huffman\n");
-    printf("Uso: %s [opção] arquivo_entrada [arquivo_saída]\n\n", program_name);
+    printf("Uso: %s [opção] arquivo_entrada [arquivo_saída]\n", program_name);
+    printf("     %s -a arquivo.hua membro... | -l arquivo.hua | -x arquivo.hua [membro...]\n", program_name);
+    printf("     %s --estimate arquivo...\n\n", program_name);
     printf("Opções:\n");
     printf("  -c, --compress    Comprime o arquivo de entrada\n");
     printf("  -d, --decompress  Descomprime o arquivo de entrada\n");
+    printf("  -a, --archive     Cria um arquivo com vários membros comprimidos em paralelo\n");
+    printf("  -l, --list        Lista os membros de um arquivo sem descomprimi-los\n");
+    printf("  -x, --extract     Extrai todos os membros, ou apenas os informados, em paralelo\n");
+    printf("  --estimate        Prevê o tamanho comprimido dos arquivos sem gravar nada\n");
+    printf("  -C DIRETÓRIO      Diretório de destino da extração\n");
+    printf("  --dedup           Grava blocos e membros repetidos como referências (formato em blocos)\n");
+    printf("  --update ANTIGO   Recomprime reaproveitando os blocos inalterados de um .huf anterior\n");
+    printf("  -1 ... -9         Nível de compressão em blocos: -1 mais rápido, -9 menor saída (padrão: %d)\n",
+           COMPRESSION_LEVEL_DEFAULT);
+    printf("  --adaptive        Huffman adaptativo de uma passagem, sem cabeçalho (fluxos e pipes)\n");
+    printf("  --progress        Mostra bytes processados, MB/s e tempo restante (comprime em blocos)\n");
+    printf("  --transform LISTA Transforma blocos antes da codificação: auto, rle, delta, mtf ou none\n");
+    printf("  --pipeline        Lê, codifica e grava os blocos em threads separadas (formato em blocos)\n");
+    printf("  --wide            Testa símbolos de 16 bits em cada bloco (UTF-16, amostras de 16 bits)\n");
+    printf("  --threads N       Threads de compressão/extração de membros (padrão: processadores)\n");
     printf("  -h, --help        Mostra esta mensagem de ajuda\n");
-    printf("  -v, --verbose     Modo verboso (mostra estatísticas detalhadas)\n\n");
+    printf("  -v, --verbose     Modo verboso (mostra estatísticas detalhadas)\n");
+    printf("  --mem-limit N     Limita a memória usada (ex.: 512K, 64M, 1G); comprime em blocos\n");
+    printf("  --cpu VARIANTE    Força os kernels: auto, generic, bmi2 ou avx2 (padrão: auto)\n");
+    printf("  --serve SOCKET    Atende pedidos em um socket Unix até receber SHUTDOWN\n");
+    printf("  --workers N       Threads de trabalho do servidor (padrão: %d)\n\n", SERVER_DEFAULT_WORKERS);
     printf("Exemplos:\n");
     printf("  %s -c arquivo.txt arquivo.huf\n", program_name);
     printf("  %s -d arquivo.huf arquivo_descomprimido.txt\n", program_name);
     printf("  %s -c -v imagem.jpg imagem.huf\n", program_name);
+    printf("  %s -c --mem-limit 16M dados.bin dados.huf\n", program_name);
+    printf("  %s -c --update ontem.huf log.txt hoje.huf\n", program_name);
+    printf("  %s -c -9 dados.bin dados.huf\n", program_name);
+    printf("  %s -c --transform delta,rle sensores.bin sensores.huf\n", program_name);
+    printf("  %s -c --progress -1 backup.tar backup.huf\n", program_name);
+    printf("  %s -c --adaptive /dev/stdin eventos.huf\n", program_name);
+    printf("  %s --serve /tmp/huffman.sock --workers 8\n", program_name);
+    printf("  %s --estimate dados/*.bin\n", program_name);
+    printf("  %s -a fontes.hua src/*.c include/*.h\n", program_name);
+    printf("  %s -x fontes.hua -C copia src/main.c\n", program_name);
+}
+
+/**
+ * Converte um tamanho com sufixo opcional (K, M, G) em bytes
+ * @param text Texto a ser convertido
+ * @param size Resultado em bytes
+ * @return 0 se sucesso, -1 se o texto é inválido
+ */
+static int parseMemorySize(const char* text, size_t* size) {
+    char* end;
+    unsigned long long value = strtoull(text, &end, 10);
+    if (end == text) {
+        return -1;
+    }
+
+    switch (*end) {
+        case 'k': case 'K': value <<= 10; end++; break;
+        case 'm': case 'M': value <<= 20; end++; break;
+        case 'g': case 'G': value <<= 30; end++; break;
+        default: break;
+    }
+
+    if (*end == 'B' || *end == 'b') {
+        end++;
+    }
+    if (*end != '\0' || value == 0) {
+        return -1;
+    }
+
+    *size = (size_t)value;
+    return 0;
+}
+
+/**
+ * Imprime o pico de memória contabilizado e o RSS máximo do processo
+ * @param plan Plano de memória da compressão (NULL se não houve plano)
+ * @param limit Limite de memória aplicado (0 = sem limite)
+ */
+static void printMemoryReport(const MemoryPlan* plan, size_t limit) {
+    if (plan != NULL) {
+        printMemoryPlan(plan);
+    } else if (limit > 0) {
+        printf("\nLimite de memória: %zu bytes\n", limit);
+    }
+
+    struct rusage usage;
+    printf("Pico de memória (heap contabilizado): %zu bytes\n", peakMemoryUsage());
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+        printf("RSS máximo do processo: %ld KiB\n", usage.ru_maxrss);
+    }
 }
 
 void printVerboseInfo(const char* input_file, const char* output_file, int is_compression) {
-    long file_size = getFileSize(input_file);
+    int64_t file_size = getFileSize(input_file);
     if (file_size > 0) {
-        printf("Arquivo de entrada: %s (%ld bytes)\n", input_file, file_size);
+        printf("Arquivo de entrada: %s (%lld bytes)\n", input_file, (long long)file_size);
         printf("Arquivo de saída: %s\n", output_file);
         printf("Operação: %s\n", is_compression ? "Compressão" : "Descompressão");
+        printf("Kernels: %s\n", cpuVariantName(activeCpuVariant()));
         printf("Iniciando...\n");
     }
 }
 
+/**
+ * Recomprime um arquivo reaproveitando os blocos inalterados de um contêiner
+ * anterior; os cortes seguem o tamanho de bloco e o modo do contêiner anterior
+ * para que as partes iguais produzam os mesmos blocos
+ * @param input_file Arquivo de entrada
+ * @param output_file Arquivo de saída (pode ser o próprio contêiner anterior)
+ * @param update_path Contêiner anterior
+ * @param plan Plano de memória (NULL = plano padrão)
+ * @param dedup 1 para também deduplicar blocos repetidos
+ * @param level Nível de compressão dos blocos recodificados (0 = padrão)
+ * @param transforms Transformações permitidas nos blocos recodificados (máscara)
+ * @param wide 1 para testar símbolos de 16 bits nos blocos recodificados
+ * @param progress Progresso a atualizar (ou NULL)
+ * @param stats Estatísticas a preencher
+ * @return 0 se sucesso, -1 se erro
+ */
+static int updateFile(const char* input_file, const char* output_file, const char* update_path,
+                      const MemoryPlan* plan, int dedup, int level, int transforms, int wide,
+                      ProgressTracker* progress, BlockStats* stats) {
+    BlockIndex index;
+    if (openBlockIndex(update_path, &index) != 0) {
+        return -1;
+    }
+
+    MemoryPlan update_plan;
+    if (plan != NULL) {
+        update_plan = *plan;
+    } else {
+        planMemoryBudget(0, &update_plan);
+    }
+    update_plan.block_size = index.block_size;
+
+    // Substituir o próprio contêiner anterior exige gravar num temporário
+    char temporary[MAX_FILENAME + 8];
+    struct stat old_info;
+    struct stat new_info;
+    const char* destination = output_file;
+    if (stat(update_path, &old_info) == 0 && stat(output_file, &new_info) == 0 &&
+        old_info.st_dev == new_info.st_dev && old_info.st_ino == new_info.st_ino) {
+        snprintf(temporary, sizeof(temporary), "%s.tmp", output_file);
+        destination = temporary;
+    }
+
+    BlockWorkspace workspace;
+    initBlockWorkspace(&workspace);
+    workspace.dedup = dedup || (index.flags & BLOCK_FLAG_DEDUP);
+    workspace.base = &index;
+    workspace.level = level;
+    workspace.transforms = transforms;
+    workspace.wide = wide;
+    workspace.progress = progress;
+    int result = compressFileBlocksWith(input_file, destination, &update_plan, stats, &workspace);
+    freeBlockWorkspace(&workspace);
+    closeBlockIndex(&index);
+
+    if (destination != output_file) {
+        if (result == 0 && rename(destination, output_file) != 0) {
+            fprintf(stderr, "Erro: Não foi possível substituir '%s'\n", output_file);
+            result = -1;
+        }
+        if (result != 0) {
+            remove(destination);
+        }
+    }
+    return result;
+}
+
+/**
+ * Imprime uma linha da tabela de estimativas
+ * @param name Nome do arquivo (ou "Total")
+ * @param original Bytes originais
+ * @param single_stream Bytes no formato de fluxo único
+ * @param blocks Bytes no formato em blocos
+ */
+static void printEstimateLine(const char* name, uint64_t original, uint64_t single_stream, uint64_t blocks) {
+    double base = original > 0 ? (double)original : 1.0;
+    printf("%-32s %14llu ", name, (unsigned long long)original);
+    printf("%14llu (%5.1f%%) ", (unsigned long long)single_stream, 100.0 * single_stream / base);
+    printf("%14llu (%5.1f%%)\n", (unsigned long long)blocks, 100.0 * blocks / base);
+}
+
+/**
+ * Estima o tamanho comprimido de vários arquivos sem comprimir nem gravar nada
+ * @param files Arquivos
+ * @param count Número de arquivos
+ * @param plan Plano de memória (tamanho de bloco; NULL = padrão)
+ * @return 0 se todos foram estimados, -1 se algum falhou
+ */
+static int estimateFiles(const char** files, int count, const MemoryPlan* plan) {
+    uint64_t total_original = 0;
+    uint64_t total_single = 0;
+    uint64_t total_blocks = 0;
+    int estimated = 0;
+    int result = 0;
+
+    printf("%-32s %14s %24s %23s\n", "Arquivo", "Original", "Fluxo único", "Blocos");
+    for (int i = 0; i < count; i++) {
+        SizeEstimate estimate;
+        if (estimateFileSize(files[i], plan, &estimate) != 0) {
+            result = -1;
+            continue;
+        }
+        printEstimateLine(files[i], estimate.input_bytes, estimate.single_stream_bytes, estimate.block_bytes);
+
+        total_original += estimate.input_bytes;
+        total_single += estimate.single_stream_bytes;
+        total_blocks += estimate.block_bytes;
+        estimated++;
+    }
+
+    if (estimated > 1) {
+        printEstimateLine("Total", total_original, total_single, total_blocks);
+    }
+    return result;
+}
+
 int main(int argc, char* argv[]) {
     clock_t start_time, end_time;
     double cpu_time_used;
     int verbose_mode = 0;
-    int operation = 0; // 0 = nenhuma, 1 = compressão, 2 = descompressão
+    int operation = 0; // 0 = nenhuma, 1 = compressão, 2 = descompressão, 3-5 = criar/listar/extrair arquivo, 6 = estimar
+    size_t memory_limit = 0; // 0 = sem limite
+    MemoryPlan memory_plan;
+    BlockStats block_stats;
+    int used_blocks = 0;
+    const char* serve_path = NULL;
+    int workers = SERVER_DEFAULT_WORKERS;
+    int threads = 0; // 0 = processadores disponíveis
+    const char* extract_dir = NULL;
+    int dedup = 0;
+    const char* update_path = NULL;
+    int adaptive = 0;
+    int level = 0; // 0 = formato padrão (sem nível)
+    int show_progress = 0;
+    int transforms = 0; // Máscara de transformações (0 = nenhuma)
+    int pipeline = 0;
+    int wide = 0;
+    ProgressTracker progress;
+    ProgressTracker* tracker = NULL;
+    
+    // Argumentos posicionais: entrada e saída, ou arquivo e membros
+    const char** positionals = (const char**)malloc((size_t)argc * sizeof(const char*));
+    int positional_count = 0;
+    if (positionals == NULL) {
+        fprintf(stderr, "Erro: Falha na alocação de memória para os argumentos\n");
+        return 1;
+    }
     
     char input_file[MAX_FILENAME] = {0};
     char output_file[MAX_FILENAME] = {0};
@@ -50,22 +284,221 @@ int main(int argc, char* argv[]) {
             operation = 1;
         } else if (strcmp(argv[i], "-d") == 0 || strcmp(argv[i], "--decompress") == 0) {
             operation = 2;
-        } else if (input_file[0] == '\0') {
-            strncpy(input_file, argv[i], MAX_FILENAME - 1);
-            input_file[MAX_FILENAME - 1] = '\0';
-        } else if (output_file[0] == '\0') {
-            strncpy(output_file, argv[i], MAX_FILENAME - 1);
-            output_file[MAX_FILENAME - 1] = '\0';
+        } else if (strcmp(argv[i], "-a") == 0 || strcmp(argv[i], "--archive") == 0) {
+            operation = 3;
+        } else if (strcmp(argv[i], "-l") == 0 || strcmp(argv[i], "--list") == 0) {
+            operation = 4;
+        } else if (strcmp(argv[i], "-x") == 0 || strcmp(argv[i], "--extract") == 0) {
+            operation = 5;
+        } else if (strcmp(argv[i], "--estimate") == 0) {
+            operation = 6;
+        } else if (strcmp(argv[i], "--dedup") == 0) {
+            dedup = 1;
+        } else if (strcmp(argv[i], "--update") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Erro: --update exige o arquivo comprimido anterior\n");
+                return 1;
+            }
+            update_path = argv[++i];
+        } else if (argv[i][0] == '-' && argv[i][1] >= '1' && argv[i][1] <= '9' && argv[i][2] == '\0') {
+            level = argv[i][1] - '0';
+        } else if (strcmp(argv[i], "--progress") == 0) {
+            show_progress = 1;
+        } else if (strcmp(argv[i], "--pipeline") == 0) {
+            pipeline = 1;
+        } else if (strcmp(argv[i], "--wide") == 0) {
+            wide = 1;
+        } else if (strcmp(argv[i], "--transform") == 0 || strncmp(argv[i], "--transform=", 12) == 0) {
+            const char* value = argv[i][11] == '=' ? argv[i] + 12 : (i + 1 < argc ? argv[++i] : "");
+            if (parseTransformList(value, &transforms) != 0) {
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--adaptive") == 0) {
+            adaptive = 1;
+        } else if (strcmp(argv[i], "-C") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Erro: -C exige um diretório\n");
+                return 1;
+            }
+            extract_dir = argv[++i];
+        } else if (strcmp(argv[i], "--threads") == 0 || strncmp(argv[i], "--threads=", 10) == 0) {
+            const char* value = argv[i][9] == '=' ? argv[i] + 10 : (i + 1 < argc ? argv[++i] : "");
+            char* end;
+            long count = strtol(value, &end, 10);
+            if (end == value || *end != '\0' || count < 1 || count > SERVER_MAX_WORKERS) {
+                fprintf(stderr, "Erro: Número de threads inválido '%s' (1 a %d)\n", value, SERVER_MAX_WORKERS);
+                return 1;
+            }
+            threads = (int)count;
+        } else if (strcmp(argv[i], "--mem-limit") == 0 || strncmp(argv[i], "--mem-limit=", 12) == 0) {
+            const char* value = argv[i][11] == '=' ? argv[i] + 12 : (i + 1 < argc ? argv[++i] : "");
+            if (parseMemorySize(value, &memory_limit) != 0) {
+                fprintf(stderr, "Erro: Limite de memória inválido '%s'\n", value);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--cpu") == 0 || strncmp(argv[i], "--cpu=", 6) == 0) {
+            const char* value = argv[i][5] == '=' ? argv[i] + 6 : (i + 1 < argc ? argv[++i] : "");
+            CpuVariant variant;
+            if (parseCpuVariant(value, &variant) != 0) {
+                fprintf(stderr, "Erro: Variante de CPU inválida '%s'\n", value);
+                return 1;
+            }
+            if (setCpuVariant(variant) != 0) {
+                fprintf(stderr, "Erro: A CPU não suporta a variante '%s'\n", value);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--serve") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Erro: --serve exige o caminho do socket\n");
+                return 1;
+            }
+            serve_path = argv[++i];
+        } else if (strcmp(argv[i], "--workers") == 0 || strncmp(argv[i], "--workers=", 10) == 0) {
+            const char* value = argv[i][9] == '=' ? argv[i] + 10 : (i + 1 < argc ? argv[++i] : "");
+            char* end;
+            long count = strtol(value, &end, 10);
+            if (end == value || *end != '\0' || count < 1 || count > SERVER_MAX_WORKERS) {
+                fprintf(stderr, "Erro: Número de threads inválido '%s' (1 a %d)\n", value, SERVER_MAX_WORKERS);
+                return 1;
+            }
+            workers = (int)count;
         } else {
-            fprintf(stderr, "Erro: Argumento inválido '%s'\n", argv[i]);
+            positionals[positional_count++] = argv[i];
+        }
+    }
+    
+    // Modo servidor: cada thread usa uma fração do limite (blocos e dados inline)
+    if (serve_path != NULL) {
+        MemoryPlan* plan = NULL;
+        if (memory_limit > 0) {
+            if (planServerBudget(memory_limit, workers, &memory_plan) != 0) {
+                fprintf(stderr, "Erro: Limite de memória muito baixo para %d threads\n", workers);
+                return 1;
+            }
+            setMemoryLimit(memory_limit);
+            plan = &memory_plan;
+        }
+        
+        int server_result = runServer(serve_path, workers, plan);
+        if (verbose_mode && server_result == 0) {
+            ServerStats server_stats;
+            getServerStats(&server_stats);
+            printServerStats(&server_stats);
+        }
+        return server_result == 0 ? 0 : 1;
+    }
+    
+    // Estimativa: só as frequências são contadas, nada é codificado nem gravado
+    if (operation == 6) {
+        if (positional_count == 0) {
+            fprintf(stderr, "Erro: Deve especificar os arquivos a estimar\n");
             printUsage(argv[0]);
             return 1;
         }
+        
+        MemoryPlan* plan = NULL;
+        if (memory_limit > 0) {
+            if (planMemoryBudget(memory_limit, &memory_plan) != 0) {
+                fprintf(stderr, "Erro: Limite de memória muito baixo\n");
+                return 1;
+            }
+            setMemoryLimit(memory_limit);
+            plan = &memory_plan;
+        }
+        
+        int estimate_result = estimateFiles(positionals, positional_count, plan);
+        free(positionals);
+        return estimate_result == 0 ? 0 : 1;
     }
     
+    // Arquivos com vários membros: o primeiro argumento é o arquivo, os demais os membros
+    if (operation >= 3 && operation <= 5) {
+        if (positional_count == 0 || (operation == 3 && positional_count < 2)) {
+            fprintf(stderr, "Erro: Deve especificar o arquivo%s\n", operation == 3 ? " e os membros" : "");
+            printUsage(argv[0]);
+            return 1;
+        }
+        
+        if (threads == 0) {
+            long online = sysconf(_SC_NPROCESSORS_ONLN);
+            threads = online > 0 ? (int)online : 1;
+        }
+        
+        MemoryPlan* plan = NULL;
+        if (memory_limit > 0) {
+            if (planMemoryBudgetFor(memory_limit / (size_t)threads, dedup && operation == 3 ? PLAN_DEDUP : 0,
+                                    &memory_plan) != 0) {
+                fprintf(stderr, "Erro: Limite de memória muito baixo para %d threads\n", threads);
+                return 1;
+            }
+            setMemoryLimit(memory_limit);
+            plan = &memory_plan;
+        }
+        
+        const char* archive_path = positionals[0];
+        int archive_result;
+        start_time = clock();
+        
+        // O total é preenchido pelo próprio arquivo (membros ou bytes comprimidos)
+        if (show_progress && operation != 4) {
+            initProgressTracker(&progress, 0, 0, printProgress, NULL);
+            tracker = &progress;
+        }
+        
+        if (operation == 3) {
+            printf("Criando '%s' com %d membros...\n", archive_path, positional_count - 1);
+            ArchiveStats archive_stats;
+            archive_result = createArchive(archive_path, positionals + 1, positional_count - 1,
+                                           threads, plan, dedup, &archive_stats, tracker);
+            if (archive_result == 0 && verbose_mode) {
+                printArchiveStats(&archive_stats);
+            }
+        } else if (operation == 4) {
+            ArchiveDirectory directory;
+            archive_result = readArchiveDirectory(archive_path, &directory);
+            if (archive_result == 0) {
+                printArchiveDirectory(&directory);
+                freeArchiveDirectory(&directory);
+            }
+        } else {
+            printf("Extraindo '%s'...\n", archive_path);
+            archive_result = extractArchive(archive_path, positionals + 1, positional_count - 1,
+                                            extract_dir, threads, plan, tracker);
+        }
+        
+        if (archive_result == 0) {
+            progressFinish(tracker);
+        }
+        
+        if (archive_result != 0) {
+            fprintf(stderr, "Erro durante a operação com o arquivo\n");
+        } else if (verbose_mode) {
+            cpu_time_used = ((double)(clock() - start_time)) / CLOCKS_PER_SEC;
+            printf("Threads: %d\n", threads);
+            printf("Tempo de CPU: %.3f segundos\n", cpu_time_used);
+        }
+        free(positionals);
+        return archive_result == 0 ? 0 : 1;
+    }
+    
+    if (positional_count > 2) {
+        fprintf(stderr, "Erro: Argumento inválido '%s'\n", positionals[2]);
+        printUsage(argv[0]);
+        return 1;
+    }
+    if (positional_count > 0) {
+        strncpy(input_file, positionals[0], MAX_FILENAME - 1);
+        input_file[MAX_FILENAME - 1] = '\0';
+    }
+    if (positional_count > 1) {
+        strncpy(output_file, positionals[1], MAX_FILENAME - 1);
+        output_file[MAX_FILENAME - 1] = '\0';
+    }
+    free(positionals);
+    
     // Verifica se os argumentos necessários foram fornecidos
     if (operation == 0) {
-        fprintf(stderr, "Erro: Deve especificar uma operação (-c ou -d)\n");
+        fprintf(stderr, "Erro: Deve especificar uma operação (-c, -d, -a, -l ou -x)\n");
         printUsage(argv[0]);
         return 1;
     }
@@ -100,10 +533,38 @@ int main(int argc, char* argv[]) {
         return 1;
     }
     
+    if (memory_limit > 0) {
+        // Transformações pedem um terceiro buffer por bloco, --wide as tabelas
+        // de 16 bits e --dedup os registros dos blocos, reservados no plano
+        // (--update herda os cortes por conteúdo de um contêiner com --dedup)
+        int features = (transforms != 0 ? PLAN_TRANSFORMS : 0) | (wide && operation == 1 ? PLAN_WIDE : 0) |
+                       ((dedup || update_path != NULL) && operation == 1 ? PLAN_DEDUP : 0);
+        if (planMemoryBudgetFor(memory_limit, features, &memory_plan) != 0) {
+            planMemoryBudget(0, &memory_plan);
+            size_t minimum = workspaceMemoryRequirement(MIN_BLOCK_SIZE, features & ~PLAN_WIDE);
+            if (features & PLAN_DEDUP) {
+                minimum = (minimum * DEDUP_RECORD_SHARE + DEDUP_RECORD_SHARE - 2) / (DEDUP_RECORD_SHARE - 1);
+            }
+            fprintf(stderr, "Erro: Limite de memória muito baixo (mínimo %zu bytes)\n", minimum);
+            return 1;
+        }
+        if ((features & PLAN_WIDE) && !(memory_plan.features & PLAN_WIDE)) {
+            fprintf(stderr, "Aviso: O limite de memória não comporta --wide; os blocos usam só bytes\n");
+        }
+        setMemoryLimit(memory_limit);
+    }
+    
     if (verbose_mode) {
         printVerboseInfo(input_file, output_file, operation == 1);
     }
     
+    // O progresso conta os bytes do arquivo de entrada nos dois sentidos
+    if (show_progress) {
+        int64_t input_size = getFileSize(input_file);
+        initProgressTracker(&progress, input_size > 0 ? (uint64_t)input_size : 0, 0, printProgress, NULL);
+        tracker = &progress;
+    }
+    
     // Inicia o cronômetro
     start_time = clock();
     
@@ -113,7 +574,32 @@ int main(int argc, char* argv[]) {
     if (operation == 1) {
         // Compressão
         printf("Comprimindo '%s' para '%s'...\n", input_file, output_file);
-        result = compressFile(input_file, output_file);
+        if (adaptive) {
+            // Uma passagem, sem cabeçalho: cada leitura de um pipe é entregue logo
+            result = compressFileAdaptive(input_file, output_file);
+        } else if (update_path != NULL) {
+            result = updateFile(input_file, output_file, update_path,
+                                memory_limit > 0 ? &memory_plan : NULL, dedup, level, transforms, wide,
+                                tracker, &block_stats);
+            used_blocks = 1;
+        } else if (memory_limit > 0 || dedup || level > 0 || show_progress || transforms != 0 || pipeline || wide) {
+            // Com limite de memória, deduplicação, nível, progresso, transformações, pipeline ou
+            // símbolos de 16 bits, comprime em blocos numa única passagem
+            BlockWorkspace workspace;
+            initBlockWorkspace(&workspace);
+            workspace.dedup = dedup;
+            workspace.level = level;
+            workspace.transforms = transforms;
+            workspace.progress = tracker;
+            workspace.pipeline = pipeline;
+            workspace.wide = wide;
+            result = compressFileBlocksWith(input_file, output_file,
+                                            memory_limit > 0 ? &memory_plan : NULL, &block_stats, &workspace);
+            freeBlockWorkspace(&workspace);
+            used_blocks = 1;
+        } else {
+            result = compressFile(input_file, output_file);
+        }
         
         if (result == 0) {
             printf("Compressão concluída com sucesso!\n");
@@ -128,7 +614,20 @@ int main(int argc, char* argv[]) {
     } else if (operation == 2) {
         // Descompressão
         printf("Descomprimindo '%s' para '%s'...\n", input_file, output_file);
-        result = decompressFile(input_file, output_file);
+        if (isAdaptiveFile(input_file)) {
+            result = decompressFileAdaptive(input_file, output_file);
+        } else if (isBlockContainerFile(input_file)) {
+            BlockWorkspace workspace;
+            initBlockWorkspace(&workspace);
+            workspace.progress = tracker;
+            workspace.pipeline = pipeline;
+            result = decompressFileBlocksWith(input_file, output_file,
+                                              memory_limit > 0 ? &memory_plan : NULL, &block_stats, &workspace);
+            freeBlockWorkspace(&workspace);
+            used_blocks = 1;
+        } else {
+            result = decompressFile(input_file, output_file);
+        }
         
         if (result == 0) {
             printf("Descompressão concluída com sucesso!\n");
@@ -146,10 +645,26 @@ int main(int argc, char* argv[]) {
         }
     }
     
+    // Os formatos sem laço de blocos só mostram o relatório final
+    if (result == 0 && tracker != NULL) {
+        if (!used_blocks) {
+            progressAdvance(tracker, tracker->total);
+        }
+        progressFinish(tracker);
+    }
+    
     // Para o cronômetro e calcula o tempo
     end_time = clock();
     cpu_time_used = ((double)(end_time - start_time)) / CLOCKS_PER_SEC;
     
+    if (verbose_mode && result == 0 && used_blocks) {
+        printBlockStats(&block_stats);
+    }
+    
+    if ((verbose_mode || memory_limit > 0) && result == 0) {
+        printMemoryReport(memory_limit > 0 && operation == 1 ? &memory_plan : NULL, memory_limit);
+    }
+    
     if (verbose_mode && result == 0) {
         printf("Tempo de execução: %.3f segundos\n", cpu_time_used);
     }
@@ -0,0 +1,334 @@
+#include "memory_budget.h"
+#include "code_table.h"
+#include "decode_table.h"
+#include "table_cache.h"
+#include "wide_symbol.h"
+#include <string.h>
+
+// Cabeçalho guardado antes de cada bloco contabilizado (mantém alinhamento de 16 bytes)
+#define ALLOCATION_HEADER 16
+
+static size_t memory_limit = 0;     // 0 = sem limite
+static size_t memory_current = 0;
+static size_t memory_peak = 0;
+static __thread int memory_exceeded = 0;   // 1 depois de uma alocação recusada nesta thread
+
+/**
+ * Define o limite de memória aplicado pelas alocações contabilizadas
+ * @param limit Limite em bytes (0 = sem limite)
+ */
+void setMemoryLimit(size_t limit) {
+    memory_limit = limit;
+}
+
+/**
+ * Aloca memória contabilizando o uso atual e o pico
+ * @param size Número de bytes
+ * @return Ponteiro para a memória, ou NULL se falhou ou excederia o limite
+ */
+void* budgetMalloc(size_t size) {
+    size_t total = size + ALLOCATION_HEADER;
+    size_t current = __atomic_add_fetch(&memory_current, total, __ATOMIC_RELAXED);
+
+    if (memory_limit != 0 && current > memory_limit) {
+        __atomic_sub_fetch(&memory_current, total, __ATOMIC_RELAXED);
+        memory_exceeded = 1;
+        return NULL;
+    }
+
+    unsigned char* block = (unsigned char*)malloc(total);
+    if (block == NULL) {
+        __atomic_sub_fetch(&memory_current, total, __ATOMIC_RELAXED);
+        memory_exceeded = 1;
+        return NULL;
+    }
+
+    // Atualiza o pico sem travas
+    size_t peak = __atomic_load_n(&memory_peak, __ATOMIC_RELAXED);
+    while (current > peak &&
+           !__atomic_compare_exchange_n(&memory_peak, &peak, current, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+
+    memcpy(block, &total, sizeof(size_t));
+    return block + ALLOCATION_HEADER;
+}
+
+/**
+ * Aloca memória zerada contabilizando o uso
+ * @param count Número de elementos
+ * @param size Tamanho de cada elemento
+ * @return Ponteiro para a memória, ou NULL se falhou ou excederia o limite
+ */
+void* budgetCalloc(size_t count, size_t size) {
+    if (size != 0 && count > (size_t)-1 / size) {
+        return NULL;
+    }
+
+    void* pointer = budgetMalloc(count * size);
+    if (pointer != NULL) {
+        memset(pointer, 0, count * size);
+    }
+    return pointer;
+}
+
+/**
+ * Libera memória obtida com budgetMalloc ou budgetCalloc
+ * @param pointer Ponteiro a ser liberado (NULL é ignorado)
+ */
+void budgetFree(void* pointer) {
+    if (pointer == NULL) {
+        return;
+    }
+
+    unsigned char* block = (unsigned char*)pointer - ALLOCATION_HEADER;
+    size_t total;
+    memcpy(&total, block, sizeof(size_t));
+    __atomic_sub_fetch(&memory_current, total, __ATOMIC_RELAXED);
+    free(block);
+}
+
+/**
+ * Informa se alguma alocação contabilizada desta thread foi recusada desde
+ * a última chamada a clearBudgetExceeded (distingue falta de memória de
+ * dados corrompidos quando uma operação falha)
+ * @return 1 se alguma alocação foi recusada, 0 caso contrário
+ */
+int budgetExceeded(void) {
+    return memory_exceeded;
+}
+
+/**
+ * Esquece as alocações recusadas anteriormente nesta thread
+ */
+void clearBudgetExceeded(void) {
+    memory_exceeded = 0;
+}
+
+/**
+ * Retorna a memória contabilizada atualmente em uso
+ */
+size_t currentMemoryUsage(void) {
+    return __atomic_load_n(&memory_current, __ATOMIC_RELAXED);
+}
+
+/**
+ * Retorna o maior uso de memória contabilizado desde o último reinício
+ */
+size_t peakMemoryUsage(void) {
+    return __atomic_load_n(&memory_peak, __ATOMIC_RELAXED);
+}
+
+/**
+ * Reinicia o pico de memória para o uso atual
+ */
+void resetPeakMemoryUsage(void) {
+    __atomic_store_n(&memory_peak, currentMemoryUsage(), __ATOMIC_RELAXED);
+}
+
+/**
+ * Calcula a memória exigida pelos buffers de blocos em voo
+ * (cada bloco precisa da entrada e da saída codificada do mesmo tamanho)
+ * @param block_size Tamanho do bloco
+ * @param blocks Número de blocos simultâneos
+ * @return Bytes necessários
+ */
+size_t blockMemoryRequirement(size_t block_size, int blocks) {
+    return (size_t)blocks * 2 * (block_size + ALLOCATION_HEADER);
+}
+
+/**
+ * Calcula a memória de uma árvore e das tabelas de um bloco: a árvore
+ * construída com sua fila de prioridade, a árvore reconstruída da entrada do
+ * cache e as tabelas de decodificação e de códigos (todas no pior caso de
+ * 256 símbolos)
+ * @param threads Threads que constroem tabelas ao mesmo tempo
+ * @return Bytes necessários
+ */
+size_t tableMemoryRequirement(int threads) {
+    size_t nodes = 2 * MAX_CHAR - 1;
+    size_t tree = nodes * (sizeof(HuffmanNode) + ALLOCATION_HEADER);
+    size_t queue = sizeof(PriorityQueue) + MAX_CHAR * sizeof(HuffmanNode*) + 2 * ALLOCATION_HEADER;
+    size_t tables = sizeof(CachedTables) + sizeof(DecodeTable) + sizeof(CodeTable) + 3 * ALLOCATION_HEADER;
+    return (size_t)threads * (2 * tree + queue + tables);
+}
+
+/**
+ * Calcula o número de buffers do tamanho do bloco de cada bloco em voo
+ * (contêineres com blocos de 16 bits têm a versão que também admite blocos
+ * transformados, então o decodificador reserva o buffer transformado)
+ * @param features Buffers opcionais (PLAN_*)
+ * @return Buffers por bloco
+ */
+static int blockBuffers(int features) {
+    return 2 + ((features & (PLAN_TRANSFORMS | PLAN_WIDE)) ? 1 : 0);
+}
+
+/**
+ * Calcula a memória do alfabeto de 16 bits com blocos de um tamanho: o
+ * histograma e os comprimentos do espaço de trabalho, mais o maior dos
+ * usos temporários (ordenação dos símbolos, tabela de códigos ou
+ * comprimentos lidos com a tabela de decodificação de WIDE_MAX_DECODE_ENTRIES)
+ * @param block_size Tamanho do bloco
+ * @return Bytes necessários
+ */
+size_t wideMemoryRequirement(size_t block_size) {
+    size_t symbols = block_size / 2 < WIDE_ALPHABET ? block_size / 2 : WIDE_ALPHABET;
+    size_t persistent = WIDE_ALPHABET * sizeof(uint32_t) + WIDE_ALPHABET + 2 * ALLOCATION_HEADER;
+    size_t sort = 2 * (symbols * sizeof(uint64_t) + ALLOCATION_HEADER);
+    size_t encode = sizeof(WideCodeTable) + ALLOCATION_HEADER;
+    size_t decode = WIDE_ALPHABET + sizeof(WideDecodeTable) +
+                    WIDE_MAX_DECODE_ENTRIES * sizeof(WideDecodeEntry) + 3 * ALLOCATION_HEADER;
+
+    size_t temporary = sort > encode ? sort : encode;
+    return persistent + (decode > temporary ? decode : temporary);
+}
+
+/**
+ * Calcula a memória que cresce com o bloco: os buffers do bloco e, com o
+ * alfabeto de 16 bits, a sua ordenação e tabelas
+ * @param block_size Tamanho do bloco
+ * @param features Buffers opcionais (PLAN_*)
+ * @return Bytes necessários
+ */
+static size_t blockFootprint(size_t block_size, int features) {
+    size_t bytes = (size_t)blockBuffers(features) * (block_size + ALLOCATION_HEADER);
+    if (features & PLAN_WIDE) {
+        bytes += wideMemoryRequirement(block_size);
+    }
+    return bytes;
+}
+
+/**
+ * Calcula a memória de uma única thread com blocos de um tamanho: parte
+ * fixa, árvore e tabelas, buffers do bloco e buffers opcionais
+ * (é também o mínimo para descomprimir um contêiner com esses blocos)
+ * @param block_size Tamanho do bloco
+ * @param features Buffers opcionais (PLAN_*)
+ * @return Bytes necessários
+ */
+size_t workspaceMemoryRequirement(size_t block_size, int features) {
+    return FIXED_MEMORY_OVERHEAD + tableMemoryRequirement(1) + blockFootprint(block_size, features);
+}
+
+/**
+ * Calcula quantos blocos de um contêiner com deduplicação têm registro sob
+ * um limite de memória: a compressão só referencia blocos abaixo desse
+ * número e a descompressão só registra a posição desses blocos, então os
+ * dois lados cabem na fração do limite reservada por PLAN_DEDUP
+ * Sem limite, todos os blocos são registrados (o vetor cresce com o contêiner).
+ * @param limit Limite em bytes (0 = sem limite)
+ * @return Blocos registrados (0 = todos)
+ */
+uint64_t dedupRecordLimit(size_t limit) {
+    if (limit == 0) {
+        return 0;
+    }
+    uint64_t records = (uint64_t)(limit / DEDUP_RECORD_SHARE) / DEDUP_RECORD_SIZE;
+    return records > 0 ? records : 1;
+}
+
+/**
+ * Escolhe tamanho de bloco, threads, blocos em voo e tabelas para
+ * caber no limite de memória. O resultado não depende do tamanho da entrada.
+ * @param limit Limite em bytes (0 = sem limite)
+ * @param plan Plano a ser preenchido
+ * @return 0 se sucesso, -1 se o limite é menor que o mínimo viável
+ */
+int planMemoryBudget(size_t limit, MemoryPlan* plan) {
+    return planMemoryBudgetFor(limit, 0, plan);
+}
+
+/**
+ * Escolhe o plano como planMemoryBudget, reservando também os buffers
+ * opcionais: com transformações, cada bloco em voo tem um terceiro buffer;
+ * com o alfabeto de 16 bits, também o histograma e as tabelas de 16 bits.
+ * Se o alfabeto de 16 bits só coubesse com blocos menores que
+ * WIDE_MIN_BLOCK, ele fica fora do plano (plan->features diz o que foi reservado).
+ * Com deduplicação, 1/DEDUP_RECORD_SHARE do limite fica com os registros
+ * dos blocos (ver dedupRecordLimit).
+ * @param limit Limite em bytes (0 = sem limite)
+ * @param features Buffers opcionais (PLAN_*)
+ * @param plan Plano a ser preenchido
+ * @return 0 se sucesso, -1 se o limite é menor que o mínimo viável
+ */
+int planMemoryBudgetFor(size_t limit, int features, MemoryPlan* plan) {
+    memset(plan, 0, sizeof(MemoryPlan));
+    plan->limit = limit;
+    plan->io_buffer_size = BUFFER_SIZE;
+    plan->threads = 1;
+    plan->in_flight_blocks = 1;
+    plan->features = features;
+
+    if (limit == 0) {
+        plan->block_size = DEFAULT_BLOCK_SIZE;
+        plan->use_pair_table = 1;
+        plan->planned_peak = workspaceMemoryRequirement(plan->block_size, features) + sizeof(PairCodeTable);
+        return 0;
+    }
+
+    // Árvore e tabelas são reservadas antes dos blocos: sem elas, cada bloco
+    // seria gravado sem codificação (ou a descompressão falharia)
+    size_t reserved = FIXED_MEMORY_OVERHEAD + tableMemoryRequirement(plan->threads);
+    if (features & PLAN_DEDUP) {
+        reserved += limit / DEDUP_RECORD_SHARE;
+    }
+    size_t minimum = reserved + blockFootprint(MIN_BLOCK_SIZE, features);
+    if (limit < minimum) {
+        return (features & PLAN_WIDE) ? planMemoryBudgetFor(limit, features & ~PLAN_WIDE, plan) : -1;
+    }
+
+    size_t available = limit - reserved;
+    size_t buffers = (size_t)blockBuffers(features);
+
+    // A tabela de pares só entra se ainda sobrar espaço para blocos grandes
+    // o bastante para compensar sua construção a cada bloco
+    if (available >= sizeof(PairCodeTable) + blockFootprint(PAIR_TABLE_MIN_INPUT, features)) {
+        plan->use_pair_table = 1;
+        available -= sizeof(PairCodeTable);
+    }
+
+    size_t blocks = (size_t)(plan->threads * plan->in_flight_blocks);
+    size_t per_block = available / blocks;
+    size_t block_size = per_block / buffers - ALLOCATION_HEADER;
+    if (block_size > MAX_BLOCK_SIZE) {
+        block_size = MAX_BLOCK_SIZE;
+    }
+    block_size -= block_size % MIN_BLOCK_SIZE;
+
+    // O alfabeto de 16 bits cresce com o bloco até o tamanho do alfabeto
+    while (block_size > MIN_BLOCK_SIZE && blockFootprint(block_size, features) > per_block) {
+        block_size -= MIN_BLOCK_SIZE;
+    }
+    if ((features & PLAN_WIDE) && block_size < WIDE_MIN_BLOCK) {
+        return planMemoryBudgetFor(limit, features & ~PLAN_WIDE, plan);
+    }
+
+    plan->block_size = block_size;
+    plan->planned_peak = reserved +
+                         (plan->use_pair_table ? sizeof(PairCodeTable) : 0) +
+                         blockFootprint(block_size, features) * blocks;
+    return 0;
+}
+
+/**
+ * Imprime o plano de memória escolhido
+ * @param plan Plano de memória
+ */
+void printMemoryPlan(const MemoryPlan* plan) {
+    printf("\n=== Plano de Memória ===\n");
+    if (plan->limit > 0) {
+        printf("Limite: %zu bytes\n", plan->limit);
+    } else {
+        printf("Limite: nenhum\n");
+    }
+    printf("Tamanho do bloco: %zu bytes\n", plan->block_size);
+    printf("Threads: %d\n", plan->threads);
+    printf("Blocos em voo por thread: %d\n", plan->in_flight_blocks);
+    printf("Tabela de pares: %s\n", plan->use_pair_table ? "sim" : "não");
+    printf("Buffer de transformação: %s\n", (plan->features & PLAN_TRANSFORMS) ? "sim" : "não");
+    printf("Alfabeto de 16 bits: %s\n", (plan->features & PLAN_WIDE) ? "sim" : "não");
+    if ((plan->features & PLAN_DEDUP) && plan->limit > 0) {
+        printf("Blocos referenciáveis (deduplicação): %llu\n", (unsigned long long)dedupRecordLimit(plan->limit));
+    }
+    printf("Pico previsto: %zu bytes\n", plan->planned_peak);
+}
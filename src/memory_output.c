@@ -0,0 +1,105 @@
+#define _GNU_SOURCE
+#include "memory_output.h"
+#include "memory_budget.h"
+#include <string.h>
+
+/**
+ * Grava na saída em memória (função de escrita do fopencookie)
+ * @param cookie Saída (MemoryOutput*)
+ * @param data Bytes a gravar
+ * @param size Número de bytes
+ * @return Bytes gravados (menos que size se o teto ou o limite acabou)
+ */
+static ssize_t writeMemoryOutput(void* cookie, const char* data, size_t size) {
+    MemoryOutput* output = (MemoryOutput*)cookie;
+    size_t done = 0;
+    while (done < size) {
+        MemoryOutputChunk* chunk = output->tail;
+        if (chunk == NULL || chunk->used == MEMORY_OUTPUT_CHUNK) {
+            size_t bytes = sizeof(MemoryOutputChunk) + MEMORY_OUTPUT_CHUNK;
+            if (output->ceiling > 0 && output->reserved + bytes > output->ceiling) {
+                output->exceeded = 1;
+                break;
+            }
+            chunk = (MemoryOutputChunk*)budgetMalloc(bytes);
+            if (chunk == NULL) {
+                output->exceeded = 1;
+                break;
+            }
+            chunk->next = NULL;
+            chunk->used = 0;
+            if (output->tail != NULL) {
+                output->tail->next = chunk;
+            } else {
+                output->head = chunk;
+            }
+            output->tail = chunk;
+            output->reserved += bytes;
+        }
+
+        size_t count = MEMORY_OUTPUT_CHUNK - chunk->used;
+        if (count > size - done) {
+            count = size - done;
+        }
+        memcpy(chunk->data + chunk->used, data + done, count);
+        chunk->used += count;
+        done += count;
+    }
+    output->size += done;
+    return (ssize_t)done;
+}
+
+/**
+ * Abre um fluxo de escrita sobre uma saída em memória vazia
+ * O fluxo não tem posição (ftello devolve -1); quem lê blocos anteriores da
+ * saída precisa voltar à entrada.
+ * @param output Saída (liberar com freeMemoryOutput depois de fechar o fluxo)
+ * @param ceiling Maior reserva em bytes (0 = só o limite de memória global)
+ * @return Fluxo de escrita, ou NULL se erro
+ */
+FILE* openMemoryOutput(MemoryOutput* output, size_t ceiling) {
+    memset(output, 0, sizeof(MemoryOutput));
+    output->ceiling = ceiling;
+    cookie_io_functions_t functions = { NULL, writeMemoryOutput, NULL, NULL };
+    return fopencookie(output, "wb", functions);
+}
+
+/**
+ * Junta os pedaços em um buffer contíguo, liberando cada pedaço copiado
+ * O pico é o buffer mais um pedaço; o buffer devolvido sai do orçamento e
+ * pertence ao chamador (liberar com free).
+ * @param output Saída (fica vazia)
+ * @return Buffer com output->size bytes (NULL se vazio), ou NULL se faltou memória
+ */
+unsigned char* takeMemoryOutput(MemoryOutput* output) {
+    unsigned char* buffer = output->size > 0 ? (unsigned char*)malloc(output->size) : NULL;
+    if (output->size > 0 && buffer == NULL) {
+        return NULL;
+    }
+
+    size_t offset = 0;
+    while (output->head != NULL) {
+        MemoryOutputChunk* next = output->head->next;
+        memcpy(buffer + offset, output->head->data, output->head->used);
+        offset += output->head->used;
+        budgetFree(output->head);
+        output->head = next;
+    }
+    output->tail = NULL;
+    output->reserved = 0;
+    return buffer;
+}
+
+/**
+ * Libera os pedaços de uma saída em memória
+ * @param output Saída
+ */
+void freeMemoryOutput(MemoryOutput* output) {
+    while (output->head != NULL) {
+        MemoryOutputChunk* next = output->head->next;
+        budgetFree(output->head);
+        output->head = next;
+    }
+    output->tail = NULL;
+    output->reserved = 0;
+}
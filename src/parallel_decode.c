@@ -0,0 +1,468 @@
+#include "parallel_decode.h"
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+
+// Fluxo de bits em memória, lido por todas as threads
+typedef struct BitStream {
+    const unsigned char* data;
+    size_t length;
+    uint64_t total_bits;
+    const DecodeTable* table;
+} BitStream;
+
+// Trabalho compartilhado pelas threads de uma passagem
+typedef struct DecodeJob {
+    const BitStream* stream;
+    DecodeSegment* segments;      // Trechos do fluxo
+    size_t count;                 // Número de trechos
+    const uint64_t* starts;       // Início verdadeiro de cada trecho (segunda passagem)
+    const uint64_t* symbols;      // Símbolos verdadeiros de cada trecho (segunda passagem)
+    const uint64_t* offsets;      // Posição de cada trecho na saída da rodada
+    unsigned char* output;        // Saída da rodada
+    size_t first;                 // Primeiro trecho da rodada
+    size_t round_size;            // Trechos da rodada
+} DecodeJob;
+
+// Thread de uma passagem
+typedef struct DecodeWorker {
+    DecodeJob* job;
+    int index;                    // Posição da thread
+    int threads;                  // Total de threads
+    pthread_t thread;
+    int threaded;                 // 1 se roda em uma thread própria
+    int failed;
+} DecodeWorker;
+
+/**
+ * Lê 64 bits do fluxo a partir de um bit qualquer (zeros após o fim)
+ * @param stream Fluxo de bits
+ * @param position Posição em bits
+ * @return Bits alinhados à esquerda (ao menos 57 válidos)
+ */
+static inline uint64_t peekBits(const BitStream* stream, uint64_t position) {
+    size_t byte = (size_t)(position >> 3);
+    uint64_t value = 0;
+
+    if (byte + 8 <= stream->length) {
+        const unsigned char* p = stream->data + byte;
+        value = ((uint64_t)p[0] << 56) | ((uint64_t)p[1] << 48) |
+                ((uint64_t)p[2] << 40) | ((uint64_t)p[3] << 32) |
+                ((uint64_t)p[4] << 24) | ((uint64_t)p[5] << 16) |
+                ((uint64_t)p[6] << 8) | (uint64_t)p[7];
+    } else {
+        for (int i = 0; i < 8 && byte + i < stream->length; i++) {
+            value |= (uint64_t)stream->data[byte + i] << (56 - 8 * i);
+        }
+    }
+
+    return value << (position & 7);
+}
+
+/**
+ * Calcula o comprimento do código que começa em um bit do fluxo
+ * @param stream Fluxo de bits
+ * @param position Início do código
+ * @return Bits do código, ou -1 se o código não está completo no fluxo ou é inválido
+ */
+static int symbolLength(const BitStream* stream, uint64_t position) {
+    uint64_t window = peekBits(stream, position);
+    const DecodeEntry* entry = &stream->table->entries[window >> (64 - DECODE_TABLE_BITS)];
+    int length = entry->first_bits;
+
+    if (entry->count == 0) {
+        // Código longo: percorre a árvore bit a bit
+        HuffmanNode* node = stream->table->root;
+        length = 0;
+        while (!isLeaf(node)) {
+            if (length > 0 && (length & 31) == 0) {
+                window = peekBits(stream, position + (uint64_t)length);
+            }
+            int bit = (int)(window >> 63);
+            window <<= 1;
+            length++;
+            node = bit ? node->right : node->left;
+            if (node == NULL) {
+                return -1;
+            }
+        }
+    }
+
+    return position + (uint64_t)length <= stream->total_bits ? length : -1;
+}
+
+/**
+ * Conta os símbolos a partir de um início de símbolo até o primeiro início
+ * em ou após limit (ou até o fim dos códigos completos). Entradas de vários
+ * símbolos que terminam antes do limite são consumidas de uma vez.
+ * @param stream Fluxo de bits
+ * @param position Início de símbolo de partida
+ * @param limit Bit de parada
+ * @param count Contador de símbolos a incrementar
+ * @return Primeiro início de símbolo >= limit, ou onde os códigos completos acabaram
+ */
+static uint64_t scanSymbols(const BitStream* stream, uint64_t position, uint64_t limit, uint64_t* count) {
+    const DecodeEntry* entries = stream->table->entries;
+    uint64_t symbols = 0;
+
+    while (position < limit) {
+        const DecodeEntry* entry = &entries[peekBits(stream, position) >> (64 - DECODE_TABLE_BITS)];
+        uint64_t end = position + entry->bits;
+        if (entry->count != 0 && end <= limit && end <= stream->total_bits) {
+            symbols += entry->count;
+            position = end;
+            continue;
+        }
+
+        int length = symbolLength(stream, position);
+        if (length < 0) {
+            break;
+        }
+        symbols++;
+        position += (uint64_t)length;
+    }
+
+    *count += symbols;
+    return position;
+}
+
+/**
+ * Decodifica um trecho a partir do seu primeiro bit, como se ali começasse
+ * um símbolo, guardando os primeiros inícios de símbolo para a sincronização
+ * @param stream Fluxo de bits
+ * @param segment Trecho (start e limit preenchidos)
+ */
+static void speculateSegment(const BitStream* stream, DecodeSegment* segment) {
+    uint64_t position = segment->start;
+    uint64_t symbols = 0;
+    int recorded = 0;
+
+    while (position < segment->limit && recorded < PARALLEL_DECODE_SYNC_SYMBOLS) {
+        int length = symbolLength(stream, position);
+        if (length < 0) {
+            // No meio do fluxo, um código inválido impede a sincronização
+            segment->failed = segment->limit < stream->total_bits;
+            break;
+        }
+        segment->boundaries[recorded++] = (uint32_t)(position - segment->start);
+        symbols++;
+        position += (uint64_t)length;
+    }
+
+    if (!segment->failed && recorded == PARALLEL_DECODE_SYNC_SYMBOLS) {
+        position = scanSymbols(stream, position, segment->limit, &symbols);
+    }
+
+    segment->recorded = recorded;
+    segment->symbols = symbols;
+    segment->exit = position;
+}
+
+/**
+ * Primeira passagem: decodificação especulativa dos trechos da thread
+ * @param argument Thread (DecodeWorker)
+ * @return NULL
+ */
+static void* speculateThread(void* argument) {
+    DecodeWorker* worker = (DecodeWorker*)argument;
+    DecodeJob* job = worker->job;
+
+    for (size_t k = (size_t)worker->index; k < job->count; k += (size_t)worker->threads) {
+        speculateSegment(job->stream, &job->segments[k]);
+    }
+    return NULL;
+}
+
+/**
+ * Segunda passagem: decodifica o trecho da thread na rodada atual, a partir
+ * do início verdadeiro, direto na sua posição da saída
+ * @param argument Thread (DecodeWorker)
+ * @return NULL
+ */
+static void* decodeThread(void* argument) {
+    DecodeWorker* worker = (DecodeWorker*)argument;
+    DecodeJob* job = worker->job;
+    if ((size_t)worker->index >= job->round_size) {
+        return NULL;
+    }
+
+    size_t k = job->first + (size_t)worker->index;
+    uint64_t symbols = job->symbols[k];
+    if (symbols == 0) {
+        return NULL;
+    }
+
+    const BitStream* stream = job->stream;
+    size_t byte = (size_t)(job->starts[k] >> 3);
+    int skip = (int)(job->starts[k] & 7);
+    BitReader reader;
+    initBitReaderFromMemory(&reader, stream->data + byte, stream->length - byte);
+
+    // Só o primeiro byte é carregado: o laço rápido supõe menos de 64 bits no acumulador
+    reader.accumulator = ((uint64_t)stream->data[byte] << 56) << skip;
+    reader.bit_count = 8 - skip;
+    reader.position = 1;
+
+    unsigned char* output = job->output + job->offsets[worker->index];
+    worker->failed = decodeSymbols(&reader, stream->table, output, symbols) != symbols;
+    return NULL;
+}
+
+/**
+ * Executa uma passagem nas threads; a primeira roda na thread atual
+ * @param workers Threads (job, index e threads preenchidos)
+ * @param threads Número de threads
+ * @param routine Função de cada thread
+ * @return 1 se alguma thread falhou, 0 caso contrário
+ */
+static int runWorkers(DecodeWorker* workers, int threads, void* (*routine)(void*)) {
+    for (int t = 0; t < threads; t++) {
+        workers[t].failed = 0;
+    }
+    for (int t = 1; t < threads; t++) {
+        workers[t].threaded = pthread_create(&workers[t].thread, NULL, routine, &workers[t]) == 0;
+        if (!workers[t].threaded) {
+            // Sem a thread, o trabalho é feito aqui mesmo
+            routine(&workers[t]);
+        }
+    }
+    routine(&workers[0]);
+
+    int failed = 0;
+    for (int t = 0; t < threads; t++) {
+        if (workers[t].threaded) {
+            pthread_join(workers[t].thread, NULL);
+        }
+        failed |= workers[t].failed;
+    }
+    return failed;
+}
+
+/**
+ * Calcula quantas threads compensam para um fluxo: processadores
+ * disponíveis, com ao menos um trecho de PARALLEL_DECODE_SEGMENT por thread.
+ * A passagem especulativa custa quase o dobro da decodificação, então com
+ * menos de PARALLEL_DECODE_MIN_THREADS a série é mais rápida.
+ * @param length Bytes do fluxo de bits
+ * @return Número de threads (1 = decodificação em série)
+ */
+int parallelDecodeThreads(size_t length) {
+    if (length < PARALLEL_DECODE_MIN_INPUT) {
+        return 1;
+    }
+
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t segments = length / PARALLEL_DECODE_SEGMENT;
+    int threads = online > 0 ? (int)online : 1;
+    if ((size_t)threads > segments) {
+        threads = (int)segments;
+    }
+    if (threads < PARALLEL_DECODE_MIN_THREADS) {
+        return 1;
+    }
+    return threads < PARALLEL_DECODE_MAX_THREADS ? threads : PARALLEL_DECODE_MAX_THREADS;
+}
+
+/**
+ * Decodifica um único fluxo de bits com várias threads, sem índice
+ * O fluxo é dividido em trechos e cada um é decodificado a partir do seu
+ * primeiro bit, como se ali começasse um símbolo. Códigos de Huffman
+ * costumam se ressincronizar após poucos símbolos: em série, a decodificação
+ * verdadeira de cada fronteira avança até coincidir com um dos inícios
+ * guardados pelo trecho seguinte, e daí em diante a contagem especulativa é
+ * a verdadeira (sem coincidência, o trecho é contado em série). Com o
+ * início e o número de símbolos de cada trecho, uma segunda passagem
+ * decodifica os trechos em paralelo direto nas suas posições da saída. O
+ * resultado é idêntico ao de readCompressedData.
+ * @param data Fluxo de bits (após o cabeçalho)
+ * @param length Bytes do fluxo
+ * @param table Tabela de decodificação da árvore do arquivo
+ * @param symbols Símbolos a decodificar (-1 = até o fim dos códigos completos, formato antigo)
+ * @param output Destino
+ * @param threads Número de threads (0 = parallelDecodeThreads)
+ * @param stats Estatísticas a preencher (pode ser NULL)
+ * @return 0 se sucesso, -1 se os dados estão truncados ou houve erro de escrita
+ */
+int decodeStreamParallel(const unsigned char* data, size_t length, const DecodeTable* table,
+                         int64_t symbols, ByteSink* output, int threads, ParallelDecodeStats* stats) {
+    ParallelDecodeStats local_stats;
+    if (stats == NULL) {
+        stats = &local_stats;
+    }
+    memset(stats, 0, sizeof(ParallelDecodeStats));
+
+    if (threads <= 0) {
+        threads = parallelDecodeThreads(length);
+    }
+    if (threads > PARALLEL_DECODE_MAX_THREADS) {
+        threads = PARALLEL_DECODE_MAX_THREADS;
+    }
+    if (length < (size_t)threads) {
+        threads = 1;
+    }
+
+    // Ao menos um trecho por thread, nenhum maior que PARALLEL_DECODE_SEGMENT
+    size_t count = (length + PARALLEL_DECODE_SEGMENT - 1) / PARALLEL_DECODE_SEGMENT;
+    if (count < (size_t)threads) {
+        count = (size_t)threads;
+    }
+    if (count == 0) {
+        count = 1;
+    }
+
+    BitStream stream = {data, length, (uint64_t)length * 8, table};
+    DecodeSegment* segments = (DecodeSegment*)calloc(count, sizeof(DecodeSegment));
+    uint64_t* starts = (uint64_t*)malloc(count * sizeof(uint64_t));
+    uint64_t* counts = (uint64_t*)malloc(count * sizeof(uint64_t));
+    uint64_t* offsets = (uint64_t*)malloc((size_t)threads * sizeof(uint64_t));
+    DecodeWorker* workers = (DecodeWorker*)calloc((size_t)threads, sizeof(DecodeWorker));
+    if (segments == NULL || starts == NULL || counts == NULL || offsets == NULL || workers == NULL) {
+        fprintf(stderr, "Erro: Falha na alocação de memória para a decodificação paralela\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (size_t k = 0; k < count; k++) {
+        segments[k].start = (uint64_t)(length * k / count) * 8;
+        segments[k].limit = (uint64_t)(length * (k + 1) / count) * 8;
+    }
+
+    DecodeJob job;
+    memset(&job, 0, sizeof(DecodeJob));
+    job.stream = &stream;
+    job.segments = segments;
+    job.count = count;
+    job.starts = starts;
+    job.symbols = counts;
+    job.offsets = offsets;
+    for (int t = 0; t < threads; t++) {
+        workers[t].job = &job;
+        workers[t].index = t;
+        workers[t].threads = threads;
+    }
+    stats->threads = threads;
+    stats->segments = count;
+
+    // Primeira passagem: cada trecho é decodificado (só contado) a partir do próprio início
+    runWorkers(workers, threads, speculateThread);
+
+    // Em série: o início verdadeiro de cada trecho é a saída verdadeira do anterior
+    uint64_t position = 0;
+    uint64_t total = 0;
+    int ended = 0;
+    for (size_t k = 0; k < count; k++) {
+        DecodeSegment* segment = &segments[k];
+        starts[k] = position;
+        counts[k] = 0;
+        if (ended) {
+            continue;
+        }
+
+        int synced = k == 0 && !segment->failed;
+        int j = 0;
+        uint64_t extra = 0;
+        uint64_t walk = position;
+        while (!synced && !segment->failed) {
+            while (j < segment->recorded && segment->start + segment->boundaries[j] < walk) {
+                j++;
+            }
+            if (j == segment->recorded) {
+                break;
+            }
+            if (segment->start + segment->boundaries[j] == walk) {
+                synced = 1;
+                break;
+            }
+            int symbol_length = symbolLength(&stream, walk);
+            if (symbol_length < 0) {
+                break;
+            }
+            walk += (uint64_t)symbol_length;
+            extra++;
+        }
+
+        if (synced) {
+            counts[k] = extra + segment->symbols - (uint64_t)j;
+            position = segment->exit;
+            stats->synchronized += k > 0;
+            stats->resync_symbols += extra;
+        } else {
+            position = scanSymbols(&stream, position, segment->limit, &counts[k]);
+        }
+
+        // Códigos completos acabaram antes do fim do trecho: fim da decodificação
+        ended = position < segment->limit;
+        total += counts[k];
+    }
+
+    // Com o tamanho original conhecido, os bits de preenchimento são descartados
+    int result = 0;
+    if (symbols >= 0) {
+        if (total < (uint64_t)symbols) {
+            fprintf(stderr, "Erro: Dados comprimidos truncados\n");
+            result = -1;
+        }
+        uint64_t remaining = (uint64_t)symbols;
+        for (size_t k = 0; k < count; k++) {
+            counts[k] = counts[k] < remaining ? counts[k] : remaining;
+            remaining -= counts[k];
+        }
+    }
+
+    // Segunda passagem, em rodadas de um trecho por thread
+    unsigned char* scratch = NULL;
+    size_t scratch_size = 0;
+    for (size_t first = 0; first < count && result == 0; first += (size_t)threads) {
+        size_t round_size = count - first < (size_t)threads ? count - first : (size_t)threads;
+        uint64_t round_bytes = 0;
+        for (size_t i = 0; i < round_size; i++) {
+            offsets[i] = round_bytes;
+            round_bytes += counts[first + i];
+        }
+        if (round_bytes == 0) {
+            continue;
+        }
+
+        // Destinos em memória recebem a rodada direto; os demais, por um buffer
+        size_t available;
+        unsigned char* window = sinkReserve(output, (size_t)round_bytes, &available);
+        if (window == NULL) {
+            result = -1;
+            break;
+        }
+        if (available < round_bytes) {
+            if (scratch_size < round_bytes) {
+                free(scratch);
+                scratch = (unsigned char*)malloc((size_t)round_bytes);
+                if (scratch == NULL) {
+                    fprintf(stderr, "Erro: Falha na alocação de memória para a decodificação paralela\n");
+                    exit(EXIT_FAILURE);
+                }
+                scratch_size = (size_t)round_bytes;
+            }
+            window = scratch;
+        }
+
+        job.first = first;
+        job.round_size = round_size;
+        job.output = window;
+        if (runWorkers(workers, threads, decodeThread) != 0) {
+            fprintf(stderr, "Erro: Dados comprimidos inválidos\n");
+            result = -1;
+            break;
+        }
+
+        if (window == scratch) {
+            result = sinkWrite(output, scratch, (size_t)round_bytes) == round_bytes ? 0 : -1;
+        } else {
+            sinkCommit(output, (size_t)round_bytes);
+        }
+    }
+
+    free(scratch);
+    free(workers);
+    free(offsets);
+    free(counts);
+    free(starts);
+    free(segments);
+    return result;
+}
@@ -0,0 +1,292 @@
+#include "parallel_encode.h"
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+
+// Trecho da entrada e sua posição no fluxo de bits da rodada
+typedef struct EncodeChunk {
+    const unsigned char* data;
+    size_t length;
+    uint64_t bits;                // Bits dos códigos do trecho
+    uint64_t offset;              // Primeiro bit do trecho na rodada
+    uint64_t tail;                // Bits finais que não completam um byte, alinhados à direita
+    int tail_bits;                // Número de bits em tail
+} EncodeChunk;
+
+// Trabalho compartilhado pelas threads de uma rodada
+typedef struct EncodeJob {
+    const CodeTable* table;
+    const PairCodeTable* pairs;
+    EncodeChunk* chunks;          // Trechos da rodada
+    size_t count;                 // Número de trechos da rodada
+    unsigned char* output;        // Bytes completos da rodada
+} EncodeJob;
+
+// Thread de uma passagem (um trecho por thread em cada rodada)
+typedef struct EncodeWorker {
+    EncodeJob* job;
+    int index;                    // Posição da thread (e do trecho na rodada)
+    pthread_t thread;
+    int threaded;                 // 1 se roda em uma thread própria
+    int failed;
+} EncodeWorker;
+
+/**
+ * Primeira passagem: calcula os bits do trecho da thread pelo histograma
+ * @param argument Thread (EncodeWorker)
+ * @return NULL
+ */
+static void* measureThread(void* argument) {
+    EncodeWorker* worker = (EncodeWorker*)argument;
+    EncodeJob* job = worker->job;
+    if ((size_t)worker->index >= job->count) {
+        return NULL;
+    }
+
+    EncodeChunk* chunk = &job->chunks[worker->index];
+    unsigned long frequencies[MAX_CHAR] = {0};
+    countFrequencies(chunk->data, chunk->length, frequencies);
+
+    uint64_t bits = 0;
+    for (int i = 0; i < MAX_CHAR; i++) {
+        bits += (uint64_t)frequencies[i] * job->table->length[i];
+    }
+    chunk->bits = bits;
+    return NULL;
+}
+
+/**
+ * Segunda passagem: codifica o trecho da thread direto na sua posição da
+ * saída. O escritor começa com os bits do byte compartilhado com o trecho
+ * anterior zerados e grava só os bytes completos do trecho; os bits finais
+ * ficam em tail para a costura.
+ * @param argument Thread (EncodeWorker)
+ * @return NULL
+ */
+static void* encodeThread(void* argument) {
+    EncodeWorker* worker = (EncodeWorker*)argument;
+    EncodeJob* job = worker->job;
+    if ((size_t)worker->index >= job->count) {
+        return NULL;
+    }
+
+    EncodeChunk* chunk = &job->chunks[worker->index];
+    uint64_t end = chunk->offset + chunk->bits;
+    size_t first_byte = (size_t)(chunk->offset >> 3);
+    size_t capacity = (size_t)(end >> 3) - first_byte;
+
+    BitWriter writer;
+    initBitWriter(&writer, job->output + first_byte, capacity, NULL);
+    writer.bit_count = (int)(chunk->offset & 7);
+    encodeSymbols(&writer, chunk->data, chunk->length, job->table, job->pairs);
+
+    while (writer.bit_count >= 8 && writer.position < writer.capacity) {
+        writer.bit_count -= 8;
+        writer.buffer[writer.position++] = (unsigned char)(writer.accumulator >> writer.bit_count);
+    }
+
+    chunk->tail_bits = writer.bit_count;
+    chunk->tail = writer.bit_count > 0 ? writer.accumulator & ((1ull << writer.bit_count) - 1) : 0;
+    worker->failed = writer.overflow || writer.position != capacity || writer.bit_count >= 8;
+    return NULL;
+}
+
+/**
+ * Executa uma passagem nas threads; a primeira roda na thread atual
+ * @param workers Threads (job e index preenchidos)
+ * @param threads Número de threads
+ * @param routine Função de cada thread
+ * @return 1 se alguma thread falhou, 0 caso contrário
+ */
+static int runWorkers(EncodeWorker* workers, int threads, void* (*routine)(void*)) {
+    for (int t = 0; t < threads; t++) {
+        workers[t].failed = 0;
+    }
+    for (int t = 1; t < threads; t++) {
+        workers[t].threaded = pthread_create(&workers[t].thread, NULL, routine, &workers[t]) == 0;
+        if (!workers[t].threaded) {
+            // Sem a thread, o trabalho é feito aqui mesmo
+            routine(&workers[t]);
+        }
+    }
+    routine(&workers[0]);
+
+    int failed = 0;
+    for (int t = 0; t < threads; t++) {
+        if (workers[t].threaded) {
+            pthread_join(workers[t].thread, NULL);
+        }
+        failed |= workers[t].failed;
+    }
+    return failed;
+}
+
+/**
+ * Calcula quantas threads compensam para uma entrada: processadores
+ * disponíveis, com ao menos um trecho de PARALLEL_ENCODE_CHUNK por thread
+ * @param length Bytes de entrada
+ * @return Número de threads (1 = codificação em série)
+ */
+int parallelEncodeThreads(size_t length) {
+    if (length < PARALLEL_ENCODE_MIN_INPUT) {
+        return 1;
+    }
+
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t chunks = length / PARALLEL_ENCODE_CHUNK;
+    int threads = online > 0 ? (int)online : 1;
+    if ((size_t)threads > chunks) {
+        threads = (int)chunks;
+    }
+    return threads < PARALLEL_ENCODE_MAX_THREADS ? threads : PARALLEL_ENCODE_MAX_THREADS;
+}
+
+/**
+ * Codifica uma entrada em memória com várias threads e uma única tabela
+ * A entrada é processada em rodadas de um trecho por thread. Na primeira
+ * passagem cada thread conta os bits do seu trecho pelo histograma; a soma
+ * de prefixos dá a posição exata em bits de cada trecho. Na segunda, cada
+ * thread codifica o seu trecho direto na sua faixa de bytes da saída, e em
+ * série os bits que sobram no fim de cada trecho são combinados com o
+ * primeiro byte do seguinte. O resultado é idêntico ao de encodeSymbols
+ * seguido de flushBitWriter.
+ * @param data Bytes de entrada
+ * @param length Número de bytes
+ * @param table Tabela de códigos simples
+ * @param pairs Tabela de pares (ou NULL)
+ * @param output Destino
+ * @param threads Número de threads (0 = parallelEncodeThreads)
+ * @param stats Estatísticas a preencher (pode ser NULL)
+ * @return 0 se sucesso, -1 se houve erro de escrita
+ */
+int encodeStreamParallel(const unsigned char* data, size_t length, const CodeTable* table,
+                         const PairCodeTable* pairs, ByteSink* output, int threads,
+                         ParallelEncodeStats* stats) {
+    ParallelEncodeStats local_stats;
+    if (stats == NULL) {
+        stats = &local_stats;
+    }
+    memset(stats, 0, sizeof(ParallelEncodeStats));
+
+    if (threads <= 0) {
+        threads = parallelEncodeThreads(length);
+    }
+    if (threads > PARALLEL_ENCODE_MAX_THREADS) {
+        threads = PARALLEL_ENCODE_MAX_THREADS;
+    }
+    stats->threads = threads;
+
+    // Árvore de um único símbolo: códigos vazios não produzem bits
+    if (table->max_length == 0) {
+        return 0;
+    }
+
+    EncodeChunk* chunks = (EncodeChunk*)calloc((size_t)threads, sizeof(EncodeChunk));
+    EncodeWorker* workers = (EncodeWorker*)calloc((size_t)threads, sizeof(EncodeWorker));
+    if (chunks == NULL || workers == NULL) {
+        fprintf(stderr, "Erro: Falha na alocação de memória para a codificação paralela\n");
+        exit(EXIT_FAILURE);
+    }
+
+    EncodeJob job;
+    memset(&job, 0, sizeof(EncodeJob));
+    job.table = table;
+    job.pairs = pairs;
+    job.chunks = chunks;
+    for (int t = 0; t < threads; t++) {
+        workers[t].job = &job;
+        workers[t].index = t;
+    }
+
+    // Byte incompleto que passa de uma rodada para a seguinte (alinhado à esquerda)
+    unsigned char carry = 0;
+    int carry_bits = 0;
+    unsigned char* scratch = NULL;
+    size_t scratch_size = 0;
+    int result = 0;
+
+    for (size_t start = 0; start < length && result == 0; ) {
+        job.count = 0;
+        while (job.count < (size_t)threads && start < length) {
+            size_t chunk_length = length - start < PARALLEL_ENCODE_CHUNK ? length - start : PARALLEL_ENCODE_CHUNK;
+            chunks[job.count].data = data + start;
+            chunks[job.count].length = chunk_length;
+            start += chunk_length;
+            job.count++;
+        }
+        stats->chunks += job.count;
+        stats->rounds++;
+
+        // Primeira passagem: bits de cada trecho; a soma de prefixos dá as posições
+        runWorkers(workers, threads, measureThread);
+        uint64_t position = (uint64_t)carry_bits;
+        for (size_t i = 0; i < job.count; i++) {
+            chunks[i].offset = position;
+            position += chunks[i].bits;
+        }
+        stats->bits += position - (uint64_t)carry_bits;
+        size_t round_bytes = (size_t)(position >> 3);
+
+        // Destinos em memória recebem a rodada direto; os demais, por um buffer
+        unsigned char* window = NULL;
+        if (round_bytes > 0) {
+            size_t available;
+            window = sinkReserve(output, round_bytes, &available);
+            if (window == NULL) {
+                result = -1;
+                break;
+            }
+            if (available < round_bytes) {
+                if (scratch_size < round_bytes) {
+                    free(scratch);
+                    scratch = (unsigned char*)malloc(round_bytes);
+                    if (scratch == NULL) {
+                        fprintf(stderr, "Erro: Falha na alocação de memória para a codificação paralela\n");
+                        exit(EXIT_FAILURE);
+                    }
+                    scratch_size = round_bytes;
+                }
+                window = scratch;
+            }
+        }
+
+        // Segunda passagem: cada trecho nos seus bytes completos
+        job.output = window;
+        if (runWorkers(workers, threads, encodeThread) != 0) {
+            fprintf(stderr, "Erro: Falha na codificação paralela\n");
+            result = -1;
+            break;
+        }
+
+        // Costura em série: os bits finais de cada trecho completam o primeiro byte do seguinte
+        for (size_t i = 0; i < job.count; i++) {
+            EncodeChunk* chunk = &chunks[i];
+            uint64_t end = chunk->offset + chunk->bits;
+            if ((end >> 3) > (chunk->offset >> 3)) {
+                // O trecho completou o byte pendente: ele é gravado e o novo pendente é o final do trecho
+                window[chunk->offset >> 3] |= carry;
+                carry = 0;
+            }
+            if (chunk->tail_bits > 0) {
+                carry |= (unsigned char)(chunk->tail << (8 - chunk->tail_bits));
+            }
+            carry_bits = (int)(end & 7);
+        }
+
+        if (window == scratch && round_bytes > 0) {
+            result = sinkWrite(output, scratch, round_bytes) == round_bytes ? 0 : -1;
+        } else if (round_bytes > 0) {
+            sinkCommit(output, round_bytes);
+        }
+    }
+
+    // Último byte, completado com zeros como em flushBitWriter
+    if (result == 0 && carry_bits > 0) {
+        result = sinkWrite(output, &carry, 1) == 1 ? 0 : -1;
+    }
+
+    free(scratch);
+    free(workers);
+    free(chunks);
+    return result;
+}
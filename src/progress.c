@@ -0,0 +1,158 @@
+#define _POSIX_C_SOURCE 200809L
+#include "progress.h"
+#include <string.h>
+#include <time.h>
+
+/**
+ * Lê o relógio monotônico
+ * @return Instante atual em nanossegundos
+ */
+static int64_t progressClock(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (int64_t)now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+/**
+ * Inicia o acompanhamento de um trabalho
+ * @param tracker Acompanhamento
+ * @param total Bytes de entrada esperados (0 = desconhecido, sem ETA)
+ * @param interval_ms Intervalo mínimo entre relatórios (0 = PROGRESS_DEFAULT_INTERVAL_MS)
+ * @param callback Função chamada a cada relatório
+ * @param context Argumento repassado ao callback
+ */
+void initProgressTracker(ProgressTracker* tracker, uint64_t total, int interval_ms,
+                         ProgressCallback callback, void* context) {
+    memset(tracker, 0, sizeof(ProgressTracker));
+    tracker->total = total;
+    tracker->interval = (int64_t)(interval_ms > 0 ? interval_ms : PROGRESS_DEFAULT_INTERVAL_MS) * 1000000LL;
+    tracker->start = progressClock();
+    tracker->window_start = tracker->start;
+    tracker->next_report = tracker->start + tracker->interval;
+    tracker->callback = callback;
+    tracker->context = context;
+}
+
+/**
+ * Monta um relatório a partir do estado do acompanhamento
+ * @param tracker Acompanhamento
+ * @param now Instante atual
+ * @param finished 1 para o relatório final (vazão média de todo o trabalho)
+ * @param report Relatório a preencher
+ */
+static void buildReport(ProgressTracker* tracker, int64_t now, int finished, ProgressReport* report) {
+    report->processed = __atomic_load_n(&tracker->processed, __ATOMIC_RELAXED);
+    report->total = tracker->total;
+    report->elapsed = (now - tracker->start) / 1e9;
+    report->finished = finished;
+
+    // Vazão atual: média móvel das janelas entre relatórios
+    double window = (now - tracker->window_start) / 1e9;
+    if (window > 0) {
+        double current = (report->processed - tracker->window_processed) / window;
+        tracker->rate = tracker->rate > 0 ? tracker->rate + PROGRESS_RATE_SMOOTHING * (current - tracker->rate)
+                                          : current;
+        tracker->window_start = now;
+        tracker->window_processed = report->processed;
+    }
+    report->rate = finished && report->elapsed > 0 ? report->processed / report->elapsed : tracker->rate;
+
+    if (report->total == 0 || report->rate <= 0) {
+        report->eta = finished ? 0 : -1;
+    } else if (report->processed >= report->total) {
+        report->eta = 0;
+    } else {
+        report->eta = (report->total - report->processed) / report->rate;
+    }
+}
+
+/**
+ * Soma bytes processados e, se o intervalo passou, relata o progresso
+ * Chamada pelo laço de blocos de qualquer thread: fora do instante de
+ * relatório, custa uma soma atômica relaxada e uma leitura do relógio.
+ * @param tracker Acompanhamento (NULL = nada a fazer)
+ * @param bytes Bytes de entrada processados desde a última chamada
+ */
+void progressAdvance(ProgressTracker* tracker, uint64_t bytes) {
+    if (tracker == NULL) {
+        return;
+    }
+    __atomic_add_fetch(&tracker->processed, bytes, __ATOMIC_RELAXED);
+
+    int64_t now = progressClock();
+    if (now < __atomic_load_n(&tracker->next_report, __ATOMIC_RELAXED) || tracker->callback == NULL) {
+        return;
+    }
+
+    // Apenas uma thread relata; as demais seguem sem esperar
+    if (__atomic_exchange_n(&tracker->reporting, 1, __ATOMIC_ACQUIRE) != 0) {
+        return;
+    }
+
+    ProgressReport report;
+    buildReport(tracker, now, 0, &report);
+    tracker->callback(&report, tracker->context);
+
+    __atomic_store_n(&tracker->next_report, now + tracker->interval, __ATOMIC_RELAXED);
+    __atomic_store_n(&tracker->reporting, 0, __ATOMIC_RELEASE);
+}
+
+/**
+ * Emite o relatório final (depois que todas as threads terminaram)
+ * @param tracker Acompanhamento (NULL = nada a fazer)
+ */
+void progressFinish(ProgressTracker* tracker) {
+    if (tracker == NULL || tracker->callback == NULL) {
+        return;
+    }
+
+    ProgressReport report;
+    buildReport(tracker, progressClock(), 1, &report);
+    tracker->callback(&report, tracker->context);
+}
+
+/**
+ * Formata uma quantidade de bytes com a maior unidade adequada
+ * @param bytes Quantidade
+ * @param text Destino (16 bytes)
+ */
+static void formatBytes(double bytes, char* text) {
+    static const char* units[] = {"B", "KB", "MB", "GB", "TB"};
+    int unit = 0;
+    while (bytes >= 1024.0 && unit < 4) {
+        bytes /= 1024.0;
+        unit++;
+    }
+    snprintf(text, 16, unit == 0 ? "%.0f %s" : "%.2f %s", bytes, units[unit]);
+}
+
+/**
+ * Callback que escreve o progresso numa única linha do terminal
+ * (reescrita com '\r'; o relatório final termina a linha)
+ * @param report Relatório
+ * @param context Arquivo de saída (NULL = stderr)
+ */
+void printProgress(const ProgressReport* report, void* context) {
+    FILE* output = context != NULL ? (FILE*)context : stderr;
+    char processed[16];
+    char total[16];
+    formatBytes((double)report->processed, processed);
+
+    if (report->total > 0) {
+        formatBytes((double)report->total, total);
+        fprintf(output, "\r%5.1f%%  %s de %s  %.1f MB/s", 100.0 * report->processed / report->total,
+                processed, total, report->rate / (1024.0 * 1024.0));
+    } else {
+        fprintf(output, "\r%s  %.1f MB/s", processed, report->rate / (1024.0 * 1024.0));
+    }
+
+    if (report->finished) {
+        fprintf(output, "  em %.2f s      \n", report->elapsed);
+    } else if (report->eta >= 0) {
+        long seconds = (long)(report->eta + 0.5);
+        fprintf(output, "  ETA %ld:%02ld:%02ld      ", seconds / 3600, seconds / 60 % 60, seconds % 60);
+    } else {
+        fprintf(output, "      ");
+    }
+    fflush(output);
+}
@@ -0,0 +1,874 @@
+#define _POSIX_C_SOURCE 200809L
+#include "server.h"
+#include "huffman_algorithm.h"
+#include "block_format.h"
+#include "memory_output.h"
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+
+// Leitura com buffer de uma conexão
+typedef struct Connection {
+    int fd;
+    unsigned char buffer[SERVER_LINE_MAX];
+    size_t start;                 // Primeiro byte ainda não consumido
+    size_t end;                   // Fim dos bytes válidos
+    int idle_polls;               // Intervalos seguidos sem receber dados
+} Connection;
+
+// Estado de cada thread de trabalho (mantido entre pedidos)
+typedef struct Worker {
+    pthread_t thread;
+    const MemoryPlan* plan;
+    BlockWorkspace workspace;     // Buffers de bloco e tabela de decodificação aquecidos
+    unsigned char* input;         // Buffer para os dados enviados junto do pedido
+    size_t input_capacity;
+    size_t inline_limit;          // Cota de entrada e saída dos pedidos inline (0 = sem limite)
+} Worker;
+
+// Fila de conexões aceitas aguardando uma thread livre
+static int connection_queue[SERVER_QUEUE_SIZE];
+static int queue_head = 0;
+static int queue_count = 0;
+static pthread_mutex_t queue_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t queue_not_empty = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t queue_not_full = PTHREAD_COND_INITIALIZER;
+
+static int listen_fd = -1;
+static int stop_requested = 0;
+static ServerStats server_stats;
+
+/**
+ * Tratador de SIGINT/SIGTERM: apenas marca o pedido de parada
+ * @param signal_number Sinal recebido
+ */
+static void handleStopSignal(int signal_number) {
+    (void)signal_number;
+    __atomic_store_n(&stop_requested, 1, __ATOMIC_RELAXED);
+}
+
+/**
+ * Pede que o servidor pare de aceitar conexões e encerre as threads
+ */
+void requestServerShutdown(void) {
+    __atomic_store_n(&stop_requested, 1, __ATOMIC_RELAXED);
+    int fd = __atomic_load_n(&listen_fd, __ATOMIC_RELAXED);
+    if (fd >= 0) {
+        // Desbloqueia o accept da thread principal
+        shutdown(fd, SHUT_RDWR);
+    }
+}
+
+/**
+ * Verifica se a parada do servidor foi pedida
+ */
+static int stopRequested(void) {
+    return __atomic_load_n(&stop_requested, __ATOMIC_RELAXED);
+}
+
+/**
+ * Retorna o tempo monotônico atual em microssegundos
+ */
+static uint64_t nowMicroseconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+}
+
+/**
+ * Copia as estatísticas acumuladas do servidor
+ * @param stats Destino
+ */
+void getServerStats(ServerStats* stats) {
+    stats->connections = __atomic_load_n(&server_stats.connections, __ATOMIC_RELAXED);
+    stats->requests = __atomic_load_n(&server_stats.requests, __ATOMIC_RELAXED);
+    stats->errors = __atomic_load_n(&server_stats.errors, __ATOMIC_RELAXED);
+    stats->bytes_in = __atomic_load_n(&server_stats.bytes_in, __ATOMIC_RELAXED);
+    stats->bytes_out = __atomic_load_n(&server_stats.bytes_out, __ATOMIC_RELAXED);
+    stats->total_latency_us = __atomic_load_n(&server_stats.total_latency_us, __ATOMIC_RELAXED);
+    stats->max_latency_us = __atomic_load_n(&server_stats.max_latency_us, __ATOMIC_RELAXED);
+    stats->table_hits = __atomic_load_n(&server_stats.table_hits, __ATOMIC_RELAXED);
+    stats->table_misses = __atomic_load_n(&server_stats.table_misses, __ATOMIC_RELAXED);
+    stats->rejected = __atomic_load_n(&server_stats.rejected, __ATOMIC_RELAXED);
+
+    TableCacheStats cache;
+    getTableCacheStats(&cache);
+    stats->cache_hits = cache.hits;
+    stats->cache_misses = cache.misses;
+}
+
+/**
+ * Registra um pedido concluído nas estatísticas globais
+ * @param latency_us Latência de processamento
+ * @param bytes_in Bytes de entrada
+ * @param bytes_out Bytes produzidos
+ * @param failed 1 se o pedido falhou
+ */
+static void recordRequest(uint64_t latency_us, uint64_t bytes_in, uint64_t bytes_out, int failed) {
+    __atomic_add_fetch(&server_stats.requests, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&server_stats.errors, (uint64_t)failed, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&server_stats.bytes_in, bytes_in, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&server_stats.bytes_out, bytes_out, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&server_stats.total_latency_us, latency_us, __ATOMIC_RELAXED);
+
+    uint64_t max = __atomic_load_n(&server_stats.max_latency_us, __ATOMIC_RELAXED);
+    while (latency_us > max &&
+           !__atomic_compare_exchange_n(&server_stats.max_latency_us, &max, latency_us, 1,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+
+/**
+ * Formata as estatísticas do servidor como texto "chave=valor"
+ * @param stats Estatísticas
+ * @param text Destino
+ * @param capacity Capacidade do destino
+ * @return Número de caracteres escritos
+ */
+static size_t formatServerStats(const ServerStats* stats, char* text, size_t capacity) {
+    uint64_t average = stats->requests > 0 ? stats->total_latency_us / stats->requests : 0;
+    int written = snprintf(text, capacity,
+                           "connections=%llu\nrequests=%llu\nerrors=%llu\nbytes_in=%llu\nbytes_out=%llu\n"
+                           "avg_latency_us=%llu\nmax_latency_us=%llu\ntable_hits=%llu\ntable_misses=%llu\n"
+                           "cache_hits=%llu\ncache_misses=%llu\nrejected=%llu\n",
+                           (unsigned long long)stats->connections, (unsigned long long)stats->requests,
+                           (unsigned long long)stats->errors, (unsigned long long)stats->bytes_in,
+                           (unsigned long long)stats->bytes_out, (unsigned long long)average,
+                           (unsigned long long)stats->max_latency_us, (unsigned long long)stats->table_hits,
+                           (unsigned long long)stats->table_misses, (unsigned long long)stats->cache_hits,
+                           (unsigned long long)stats->cache_misses, (unsigned long long)stats->rejected);
+    return written < 0 ? 0 : ((size_t)written < capacity ? (size_t)written : capacity - 1);
+}
+
+/**
+ * Imprime as estatísticas do servidor
+ * @param stats Estatísticas
+ */
+void printServerStats(const ServerStats* stats) {
+    char text[SERVER_LINE_MAX];
+    formatServerStats(stats, text, sizeof(text));
+    printf("\n=== Estatísticas do Servidor ===\n%s", text);
+}
+
+/**
+ * Escreve todos os bytes em um descritor, repetindo escritas parciais
+ * @param fd Descritor de destino
+ * @param data Bytes a escrever
+ * @param size Número de bytes
+ * @return 0 se sucesso, -1 se erro
+ */
+static int writeAll(int fd, const void* data, size_t size) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    while (size > 0) {
+        ssize_t written = write(fd, bytes, size);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        bytes += written;
+        size -= (size_t)written;
+    }
+    return 0;
+}
+
+/**
+ * Lê mais bytes da conexão para o buffer
+ * Sem dados, acorda a cada SERVER_POLL_SECONDS para notar o pedido de parada;
+ * depois de SERVER_IDLE_POLLS intervalos sem dados, a conexão é abandonada
+ * para que clientes ociosos não prendam as threads.
+ * @param connection Conexão
+ * @return Bytes lidos, 0 no fim da conexão, -1 se erro, parada ou ociosidade
+ */
+static ssize_t fillConnection(Connection* connection) {
+    if (connection->start == connection->end) {
+        connection->start = 0;
+        connection->end = 0;
+    }
+
+    for (;;) {
+        ssize_t bytes_read = read(connection->fd, connection->buffer + connection->end,
+                                  sizeof(connection->buffer) - connection->end);
+        if (bytes_read >= 0) {
+            connection->end += (size_t)bytes_read;
+            connection->idle_polls = 0;
+            return bytes_read;
+        }
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            if (stopRequested() || ++connection->idle_polls >= SERVER_IDLE_POLLS) {
+                return -1;
+            }
+            continue;
+        }
+        if (errno != EINTR) {
+            return -1;
+        }
+    }
+}
+
+/**
+ * Lê uma linha terminada por '\n' (sem o terminador)
+ * @param connection Conexão
+ * @param line Destino (SERVER_LINE_MAX bytes)
+ * @return 0 se sucesso, -1 no fim da conexão, se erro ou se a linha é longa demais
+ */
+static int readLine(Connection* connection, char* line) {
+    for (;;) {
+        unsigned char* start = connection->buffer + connection->start;
+        size_t available = connection->end - connection->start;
+        unsigned char* newline = (unsigned char*)memchr(start, '\n', available);
+
+        if (newline != NULL) {
+            size_t length = (size_t)(newline - start);
+            memcpy(line, start, length);
+            line[length] = '\0';
+            if (length > 0 && line[length - 1] == '\r') {
+                line[length - 1] = '\0';
+            }
+            connection->start += length + 1;
+            return 0;
+        }
+
+        // Move o início da linha para o começo do buffer antes de ler mais
+        if (connection->start > 0) {
+            memmove(connection->buffer, start, available);
+            connection->start = 0;
+            connection->end = available;
+        }
+        if (connection->end == sizeof(connection->buffer) || fillConnection(connection) <= 0) {
+            return -1;
+        }
+    }
+}
+
+/**
+ * Lê exatamente size bytes da conexão
+ * @param connection Conexão
+ * @param destination Destino
+ * @param size Número de bytes
+ * @return 0 se sucesso, -1 se a conexão terminou antes
+ */
+static int readExact(Connection* connection, unsigned char* destination, size_t size) {
+    while (size > 0) {
+        if (connection->start == connection->end && fillConnection(connection) <= 0) {
+            return -1;
+        }
+
+        size_t available = connection->end - connection->start;
+        size_t chunk = available < size ? available : size;
+        memcpy(destination, connection->buffer + connection->start, chunk);
+        connection->start += chunk;
+        destination += chunk;
+        size -= chunk;
+    }
+    return 0;
+}
+
+/**
+ * Descarta exatamente size bytes da conexão (dados de um pedido recusado)
+ * @param connection Conexão
+ * @param size Número de bytes
+ * @return 0 se sucesso, -1 se a conexão terminou antes
+ */
+static int skipExact(Connection* connection, size_t size) {
+    while (size > 0) {
+        if (connection->start == connection->end && fillConnection(connection) <= 0) {
+            return -1;
+        }
+
+        size_t available = connection->end - connection->start;
+        size_t chunk = available < size ? available : size;
+        connection->start += chunk;
+        size -= chunk;
+    }
+    return 0;
+}
+
+/**
+ * Envia uma resposta de sucesso seguida dos dados
+ * Formato: "OK <bytes de dados> <latência us> <bytes de entrada> <bytes de saída>\n"
+ * Com payload NULL, só o cabeçalho é enviado e os dados ficam com o chamador.
+ * @return 0 se sucesso, -1 se erro de escrita
+ */
+static int sendOk(int fd, uint64_t latency_us, uint64_t input_bytes, uint64_t output_bytes,
+                  const void* payload, size_t payload_size) {
+    char header[128];
+    int length = snprintf(header, sizeof(header), "OK %zu %llu %llu %llu\n", payload_size,
+                          (unsigned long long)latency_us, (unsigned long long)input_bytes,
+                          (unsigned long long)output_bytes);
+    if (writeAll(fd, header, (size_t)length) != 0) {
+        return -1;
+    }
+    return payload != NULL && payload_size > 0 ? writeAll(fd, payload, payload_size) : 0;
+}
+
+/**
+ * Envia uma resposta de erro
+ * @return 0 se sucesso, -1 se erro de escrita
+ */
+static int sendError(int fd, const char* message) {
+    char line[SERVER_LINE_MAX];
+    int length = snprintf(line, sizeof(line), "ERR %s\n", message);
+    return writeAll(fd, line, (size_t)length);
+}
+
+/**
+ * Garante capacidade para os dados de um pedido (sem limite, o buffer só cresce)
+ * @param worker Thread de trabalho
+ * @param size Bytes necessários
+ * @return 0 se sucesso, -1 se o limite de memória foi excedido
+ */
+static int reserveInput(Worker* worker, size_t size) {
+    // Sob limite, um buffer bem maior que o pedido tiraria espaço da saída
+    int oversized = worker->inline_limit > 0 && worker->input_capacity / 2 > size;
+    if (worker->input_capacity >= size && !oversized) {
+        return 0;
+    }
+
+    // Pelo menos 1 byte: fmemopen não aceita buffers vazios
+    size_t capacity = size > 0 ? size : 1;
+    budgetFree(worker->input);
+    worker->input = (unsigned char*)budgetMalloc(capacity);
+    worker->input_capacity = worker->input != NULL ? capacity : 0;
+    return worker->input != NULL ? 0 : -1;
+}
+
+/**
+ * Executa uma operação em blocos entre dois fluxos com os buffers da thread
+ * @param worker Thread de trabalho
+ * @param compress 1 para comprimir, 0 para descomprimir
+ * @param input Fluxo de entrada
+ * @param output Fluxo de saída
+ * @param stats Estatísticas da operação
+ * @return 0 se sucesso, -1 se erro
+ */
+static int runBlockOperation(Worker* worker, int compress, FILE* input, FILE* output, BlockStats* stats) {
+    uint64_t hits = worker->workspace.table_hits;
+    uint64_t misses = worker->workspace.table_misses;
+
+    int result = compress ? compressStreamBlocksWith(input, output, worker->plan, stats, &worker->workspace)
+                          : decompressStreamBlocksWith(input, output, worker->plan, stats, &worker->workspace);
+
+    __atomic_add_fetch(&server_stats.table_hits, worker->workspace.table_hits - hits, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&server_stats.table_misses, worker->workspace.table_misses - misses, __ATOMIC_RELAXED);
+    return result;
+}
+
+/**
+ * Processa COMPRESS/DECOMPRESS de arquivos
+ * Arquivos comprimidos usam o formato em blocos; a descompressão também aceita o formato simples.
+ * @return 0 se sucesso, -1 se erro de escrita na conexão
+ */
+static int handleFileRequest(Worker* worker, int fd, int compress, const char* input_path,
+                             const char* output_path) {
+    uint64_t start = nowMicroseconds();
+    BlockStats stats;
+    memset(&stats, 0, sizeof(stats));
+    int result;
+
+    if (!compress && !isBlockContainerFile(input_path)) {
+        result = decompressFile(input_path, output_path);
+    } else {
+        FILE* input = fopen(input_path, "rb");
+        FILE* output = input != NULL ? fopen(output_path, "wb") : NULL;
+        result = -1;
+        if (input != NULL && output != NULL) {
+            result = runBlockOperation(worker, compress, input, output, &stats);
+        }
+        if (output != NULL && fclose(output) != 0) {
+            result = -1;
+        }
+        if (input != NULL) {
+            fclose(input);
+        }
+    }
+
+    uint64_t input_bytes = getFileSize(input_path) > 0 ? (uint64_t)getFileSize(input_path) : 0;
+    uint64_t output_bytes = getFileSize(output_path) > 0 ? (uint64_t)getFileSize(output_path) : 0;
+    uint64_t latency = nowMicroseconds() - start;
+    recordRequest(latency, input_bytes, result == 0 ? output_bytes : 0, result != 0);
+
+    if (result != 0) {
+        return sendError(fd, compress ? "falha na compressão" : "falha na descompressão");
+    }
+    return sendOk(fd, latency, input_bytes, output_bytes, NULL, 0);
+}
+
+/**
+ * Processa COMPRESS-DATA/DECOMPRESS-DATA: os dados chegam e voltam pela conexão
+ * Sob limite de memória, a entrada e a saída dividem a cota inline da thread:
+ * um pedido maior que a cota é recusado (a conexão continua utilizável) e uma
+ * saída que não cabe no que sobrou falha o pedido, sem tocar a memória das
+ * outras threads.
+ * @return 0 se sucesso, -1 se a conexão deve ser encerrada
+ */
+static int handleInlineRequest(Worker* worker, Connection* connection, int compress, const char* size_text) {
+    char* end;
+    unsigned long long size = strtoull(size_text, &end, 10);
+    if (end == size_text || *end != '\0' || size > SERVER_MAX_INLINE) {
+        // Sem um tamanho confiável não há como achar o próximo pedido
+        sendError(connection->fd, "tamanho inválido");
+        return -1;
+    }
+
+    if ((worker->inline_limit > 0 && size > worker->inline_limit) || reserveInput(worker, (size_t)size) != 0) {
+        __atomic_add_fetch(&server_stats.rejected, 1, __ATOMIC_RELAXED);
+        if (skipExact(connection, (size_t)size) != 0) {
+            return -1;
+        }
+        return sendError(connection->fd, "limite de memória excedido");
+    }
+    if (readExact(connection, worker->input, (size_t)size) != 0) {
+        return -1;
+    }
+
+    uint64_t start = nowMicroseconds();
+    // O buffer de entrada retido também conta na cota
+    size_t ceiling = 0;
+    if (worker->inline_limit > 0) {
+        ceiling = worker->inline_limit > worker->input_capacity ? worker->inline_limit - worker->input_capacity : 1;
+    }
+    MemoryOutput collected;
+    FILE* input = fmemopen(worker->input, size > 0 ? (size_t)size : 1, "rb");
+    FILE* output = openMemoryOutput(&collected, ceiling);
+    int result = -1;
+    BlockStats stats;
+
+    if (input != NULL && output != NULL) {
+        if (size == 0) {
+            // fmemopen precisa de pelo menos 1 byte; a entrada vazia é lida como fim imediato
+            fseeko(input, 0, SEEK_END);
+        }
+        result = runBlockOperation(worker, compress, input, output, &stats);
+    }
+    if (input != NULL) {
+        fclose(input);
+    }
+    if (output != NULL && fclose(output) != 0) {
+        result = -1;
+    }
+
+    uint64_t latency = nowMicroseconds() - start;
+    recordRequest(latency, size, result == 0 ? collected.size : 0, result != 0);
+
+    int sent;
+    if (result != 0 && collected.exceeded) {
+        __atomic_add_fetch(&server_stats.rejected, 1, __ATOMIC_RELAXED);
+        sent = sendError(connection->fd, "limite de memória excedido");
+    } else if (result != 0) {
+        sent = sendError(connection->fd, compress ? "falha na compressão" : "dados comprimidos inválidos");
+    } else {
+        sent = sendOk(connection->fd, latency, size, collected.size, NULL, collected.size);
+        for (MemoryOutputChunk* chunk = collected.head; chunk != NULL && sent == 0; chunk = chunk->next) {
+            sent = writeAll(connection->fd, chunk->data, chunk->used);
+        }
+    }
+    freeMemoryOutput(&collected);
+    return sent;
+}
+
+/**
+ * Processa um pedido de uma conexão
+ * @param worker Thread de trabalho
+ * @param connection Conexão
+ * @param line Linha de comando recebida
+ * @return 0 para continuar na conexão, 1 para encerrá-la, -1 se erro
+ */
+static int handleRequest(Worker* worker, Connection* connection, char* line) {
+    char* save = NULL;
+    char* command = strtok_r(line, " ", &save);
+    char* first = strtok_r(NULL, " ", &save);
+    char* second = strtok_r(NULL, " ", &save);
+    int fd = connection->fd;
+
+    if (command == NULL) {
+        return sendError(fd, "pedido vazio");
+    }
+
+    if (strcmp(command, "COMPRESS") == 0 || strcmp(command, "DECOMPRESS") == 0) {
+        if (first == NULL || second == NULL) {
+            return sendError(fd, "uso: COMPRESS|DECOMPRESS <entrada> <saída>");
+        }
+        return handleFileRequest(worker, fd, command[0] == 'C', first, second);
+    }
+
+    if (strcmp(command, "COMPRESS-DATA") == 0 || strcmp(command, "DECOMPRESS-DATA") == 0) {
+        if (first == NULL) {
+            sendError(fd, "uso: COMPRESS-DATA|DECOMPRESS-DATA <bytes>");
+            return -1;
+        }
+        return handleInlineRequest(worker, connection, command[0] == 'C', first);
+    }
+
+    if (strcmp(command, "STATS") == 0) {
+        ServerStats stats;
+        char text[SERVER_LINE_MAX];
+        getServerStats(&stats);
+        size_t length = formatServerStats(&stats, text, sizeof(text));
+        return sendOk(fd, 0, 0, 0, text, length);
+    }
+
+    if (strcmp(command, "PING") == 0) {
+        return sendOk(fd, 0, 0, 0, NULL, 0);
+    }
+
+    if (strcmp(command, "QUIT") == 0) {
+        sendOk(fd, 0, 0, 0, NULL, 0);
+        return 1;
+    }
+
+    if (strcmp(command, "SHUTDOWN") == 0) {
+        sendOk(fd, 0, 0, 0, NULL, 0);
+        requestServerShutdown();
+        return 1;
+    }
+
+    return sendError(fd, "comando desconhecido");
+}
+
+/**
+ * Atende os pedidos de uma conexão até que ela termine
+ * @param worker Thread de trabalho
+ * @param fd Descritor da conexão
+ */
+static void serveConnection(Worker* worker, int fd) {
+    Connection* connection = (Connection*)malloc(sizeof(Connection));
+    if (connection == NULL) {
+        close(fd);
+        return;
+    }
+    connection->fd = fd;
+    connection->start = 0;
+    connection->end = 0;
+    connection->idle_polls = 0;
+
+    // Leituras com tempo limite permitem notar o pedido de parada
+    struct timeval timeout = { SERVER_POLL_SECONDS, 0 };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    __atomic_add_fetch(&server_stats.connections, 1, __ATOMIC_RELAXED);
+
+    char line[SERVER_LINE_MAX];
+    while (!stopRequested() && readLine(connection, line) == 0) {
+        if (handleRequest(worker, connection, line) != 0) {
+            break;
+        }
+    }
+
+    close(fd);
+    free(connection);
+}
+
+/**
+ * Coloca uma conexão na fila, esperando se ela estiver cheia
+ * @param fd Descritor da conexão (-1 encerra uma thread)
+ */
+static void enqueueConnection(int fd) {
+    pthread_mutex_lock(&queue_mutex);
+    while (queue_count == SERVER_QUEUE_SIZE) {
+        pthread_cond_wait(&queue_not_full, &queue_mutex);
+    }
+    connection_queue[(queue_head + queue_count) % SERVER_QUEUE_SIZE] = fd;
+    queue_count++;
+    pthread_cond_signal(&queue_not_empty);
+    pthread_mutex_unlock(&queue_mutex);
+}
+
+/**
+ * Retira a próxima conexão da fila, esperando se ela estiver vazia
+ * @return Descritor da conexão (-1 = encerrar a thread)
+ */
+static int dequeueConnection(void) {
+    pthread_mutex_lock(&queue_mutex);
+    while (queue_count == 0) {
+        pthread_cond_wait(&queue_not_empty, &queue_mutex);
+    }
+    int fd = connection_queue[queue_head];
+    queue_head = (queue_head + 1) % SERVER_QUEUE_SIZE;
+    queue_count--;
+    pthread_cond_signal(&queue_not_full);
+    pthread_mutex_unlock(&queue_mutex);
+    return fd;
+}
+
+/**
+ * Laço de uma thread de trabalho: atende conexões da fila
+ * @param argument Estado da thread (Worker*)
+ */
+static void* workerMain(void* argument) {
+    Worker* worker = (Worker*)argument;
+    int fd;
+    while ((fd = dequeueConnection()) >= 0) {
+        serveConnection(worker, fd);
+    }
+    return NULL;
+}
+
+/**
+ * Divide o limite de memória entre as threads do servidor
+ * Cada thread fica com limit/workers: metade para o plano dos blocos e metade
+ * para a entrada e a saída dos pedidos inline, admitidos contra essa cota.
+ * @param limit Limite total em bytes
+ * @param workers Número de threads de trabalho
+ * @param plan Recebe o plano de cada thread
+ * @return 0 se sucesso, -1 se a cota de uma thread não comporta o plano
+ */
+int planServerBudget(size_t limit, int workers, MemoryPlan* plan) {
+    if (workers < 1) {
+        return -1;
+    }
+    return planMemoryBudget(limit / (size_t)workers / 2, plan);
+}
+
+/**
+ * Executa o servidor de compressão até receber SHUTDOWN, SIGINT ou SIGTERM
+ * Protocolo por linhas em um socket Unix; cada pedido recebe "OK ..." ou "ERR ...".
+ * Com plano sob limite (planServerBudget), cada thread também admite até
+ * plan->limit bytes de entrada e saída inline.
+ * @param socket_path Caminho do socket (um socket existente é substituído)
+ * @param workers Número de threads de trabalho
+ * @param plan Plano de memória de cada thread (NULL = plano padrão)
+ * @return 0 se sucesso, -1 se erro
+ */
+int runServer(const char* socket_path, int workers, const MemoryPlan* plan) {
+    struct sockaddr_un address;
+    if (strlen(socket_path) >= sizeof(address.sun_path)) {
+        fprintf(stderr, "Erro: Caminho do socket muito longo '%s'\n", socket_path);
+        return -1;
+    }
+    if (workers < 1 || workers > SERVER_MAX_WORKERS) {
+        fprintf(stderr, "Erro: Número de threads inválido (1 a %d)\n", SERVER_MAX_WORKERS);
+        return -1;
+    }
+
+    MemoryPlan default_plan;
+    if (plan == NULL) {
+        planMemoryBudget(0, &default_plan);
+        plan = &default_plan;
+    }
+
+    // Só um socket antigo é substituído; qualquer outro arquivo fica intacto
+    struct stat existing;
+    if (lstat(socket_path, &existing) == 0 && !S_ISSOCK(existing.st_mode)) {
+        fprintf(stderr, "Erro: '%s' já existe e não é um socket\n", socket_path);
+        return -1;
+    }
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        fprintf(stderr, "Erro: Não foi possível criar o socket: %s\n", strerror(errno));
+        return -1;
+    }
+
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, socket_path);
+    unlink(socket_path);
+
+    if (bind(fd, (struct sockaddr*)&address, sizeof(address)) != 0 || listen(fd, SERVER_QUEUE_SIZE) != 0) {
+        fprintf(stderr, "Erro: Não foi possível escutar em '%s': %s\n", socket_path, strerror(errno));
+        close(fd);
+        return -1;
+    }
+
+    // Sinais interrompem o accept (sem SA_RESTART); escrita em conexão fechada não derruba o processo
+    struct sigaction stop_action;
+    struct sigaction previous_int, previous_term, previous_pipe;
+    memset(&stop_action, 0, sizeof(stop_action));
+    stop_action.sa_handler = handleStopSignal;
+    sigemptyset(&stop_action.sa_mask);
+    sigaction(SIGINT, &stop_action, &previous_int);
+    sigaction(SIGTERM, &stop_action, &previous_term);
+    stop_action.sa_handler = SIG_IGN;
+    sigaction(SIGPIPE, &stop_action, &previous_pipe);
+
+    __atomic_store_n(&stop_requested, 0, __ATOMIC_RELAXED);
+    memset(&server_stats, 0, sizeof(server_stats));
+    __atomic_store_n(&listen_fd, fd, __ATOMIC_RELAXED);
+
+    Worker* pool = (Worker*)calloc((size_t)workers, sizeof(Worker));
+    if (pool == NULL) {
+        fprintf(stderr, "Erro: Falha na alocação de memória para as threads\n");
+        exit(EXIT_FAILURE);
+    }
+
+    int started = 0;
+    for (; started < workers; started++) {
+        pool[started].plan = plan;
+        pool[started].inline_limit = plan->limit;
+        initBlockWorkspace(&pool[started].workspace);
+        if (pthread_create(&pool[started].thread, NULL, workerMain, &pool[started]) != 0) {
+            fprintf(stderr, "Erro: Não foi possível criar a thread %d\n", started);
+            break;
+        }
+    }
+
+    int result = started == workers ? 0 : -1;
+    if (result == 0) {
+        printf("Servidor escutando em '%s' com %d threads\n", socket_path, workers);
+        fflush(stdout);
+    }
+
+    while (result == 0 && !stopRequested()) {
+        int client = accept(fd, NULL, NULL);
+        if (client < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            if (!stopRequested()) {
+                fprintf(stderr, "Erro: Falha ao aceitar conexão: %s\n", strerror(errno));
+                result = -1;
+            }
+            break;
+        }
+        enqueueConnection(client);
+    }
+
+    // Encerra as threads: conexões já na fila ainda são atendidas
+    requestServerShutdown();
+    for (int i = 0; i < started; i++) {
+        enqueueConnection(-1);
+    }
+    for (int i = 0; i < started; i++) {
+        pthread_join(pool[i].thread, NULL);
+        freeBlockWorkspace(&pool[i].workspace);
+        budgetFree(pool[i].input);
+    }
+    free(pool);
+
+    __atomic_store_n(&listen_fd, -1, __ATOMIC_RELAXED);
+    close(fd);
+    unlink(socket_path);
+
+    sigaction(SIGINT, &previous_int, NULL);
+    sigaction(SIGTERM, &previous_term, NULL);
+    sigaction(SIGPIPE, &previous_pipe, NULL);
+    return result;
+}
+
+/**
+ * Conecta ao servidor, tentando novamente por até um segundo
+ * (o servidor pode ainda estar iniciando)
+ * @param socket_path Caminho do socket
+ * @return Descritor da conexão, ou -1 se falhou
+ */
+int connectServer(const char* socket_path) {
+    struct sockaddr_un address;
+    if (strlen(socket_path) >= sizeof(address.sun_path)) {
+        return -1;
+    }
+
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, socket_path);
+
+    for (int attempt = 0; attempt < 100; attempt++) {
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0) {
+            return -1;
+        }
+        if (connect(fd, (struct sockaddr*)&address, sizeof(address)) == 0) {
+            return fd;
+        }
+        close(fd);
+
+        struct timespec delay = { 0, 10 * 1000 * 1000 };
+        nanosleep(&delay, NULL);
+    }
+    return -1;
+}
+
+/**
+ * Lê uma linha de resposta byte a byte (sem ler além do cabeçalho)
+ * @return 0 se sucesso, -1 se a conexão terminou
+ */
+static int readReplyLine(int fd, char* line, size_t capacity) {
+    size_t length = 0;
+    for (;;) {
+        char c;
+        ssize_t bytes_read = read(fd, &c, 1);
+        if (bytes_read < 0 && errno == EINTR) {
+            continue;
+        }
+        if (bytes_read <= 0) {
+            return -1;
+        }
+        if (c == '\n') {
+            break;
+        }
+        if (length + 1 < capacity) {
+            line[length++] = c;
+        }
+    }
+    line[length] = '\0';
+    return 0;
+}
+
+/**
+ * Envia um pedido e espera a resposta
+ * @param fd Conexão obtida com connectServer
+ * @param command Linha de comando (sem '\n'), ex.: "COMPRESS-DATA 42"
+ * @param payload Dados enviados após a linha (pode ser NULL)
+ * @param payload_size Bytes em payload
+ * @param reply Resposta preenchida (liberar reply->payload com free)
+ * @return 0 se a resposta foi recebida (OK ou ERR), -1 se erro de conexão
+ */
+int serverRequest(int fd, const char* command, const unsigned char* payload, size_t payload_size,
+                  ServerReply* reply) {
+    memset(reply, 0, sizeof(ServerReply));
+
+    if (writeAll(fd, command, strlen(command)) != 0 || writeAll(fd, "\n", 1) != 0 ||
+        (payload_size > 0 && writeAll(fd, payload, payload_size) != 0)) {
+        return -1;
+    }
+
+    char line[SERVER_LINE_MAX];
+    if (readReplyLine(fd, line, sizeof(line)) != 0) {
+        return -1;
+    }
+
+    if (strncmp(line, "ERR ", 4) == 0) {
+        strncpy(reply->message, line + 4, SERVER_LINE_MAX - 1);
+        return 0;
+    }
+
+    unsigned long long size, latency, input_bytes, output_bytes;
+    if (sscanf(line, "OK %llu %llu %llu %llu", &size, &latency, &input_bytes, &output_bytes) != 4) {
+        return -1;
+    }
+
+    reply->ok = 1;
+    reply->latency_us = latency;
+    reply->input_bytes = input_bytes;
+    reply->output_bytes = output_bytes;
+    reply->payload_size = (size_t)size;
+
+    if (size > 0) {
+        reply->payload = (unsigned char*)malloc((size_t)size);
+        if (reply->payload == NULL) {
+            fprintf(stderr, "Erro: Falha na alocação de memória para a resposta\n");
+            exit(EXIT_FAILURE);
+        }
+        size_t received = 0;
+        while (received < size) {
+            ssize_t bytes_read = read(fd, reply->payload + received, (size_t)size - received);
+            if (bytes_read < 0 && errno == EINTR) {
+                continue;
+            }
+            if (bytes_read <= 0) {
+                free(reply->payload);
+                reply->payload = NULL;
+                return -1;
+            }
+            received += (size_t)bytes_read;
+        }
+    }
+    return 0;
+}
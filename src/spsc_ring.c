@@ -0,0 +1,125 @@
+#define _POSIX_C_SOURCE 200809L
+#include "spsc_ring.h"
+#include <string.h>
+#include <sched.h>
+#include <time.h>
+
+/**
+ * Espera um pouco por outra thread: cede a CPU nas primeiras tentativas e
+ * depois dorme, para não ocupar um processador em esperas longas (E/S)
+ * @param attempt Número de tentativas já feitas
+ */
+static void ringBackoff(int attempt) {
+    if (attempt < SPSC_RING_SPINS) {
+        sched_yield();
+    } else {
+        struct timespec pause = {0, SPSC_RING_SLEEP_NS};
+        nanosleep(&pause, NULL);
+    }
+}
+
+/**
+ * Inicializa uma fila vazia
+ * @param ring Fila
+ * @param capacity Itens que cabem na fila (1 a SPSC_RING_MAX_CAPACITY)
+ */
+void initSpscRing(SpscRing* ring, size_t capacity) {
+    memset(ring, 0, sizeof(SpscRing));
+    if (capacity < 1) {
+        capacity = 1;
+    }
+    ring->capacity = capacity < SPSC_RING_MAX_CAPACITY ? capacity : SPSC_RING_MAX_CAPACITY;
+}
+
+/**
+ * Enfileira um item, esperando enquanto a fila está cheia (só o produtor)
+ * @param ring Fila
+ * @param item Item
+ * @return 0 se sucesso, -1 se a fila foi abortada
+ */
+int ringPush(SpscRing* ring, void* item) {
+    size_t head = ring->head;
+    int waited = 0;
+
+    for (int attempt = 0; head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) >= ring->capacity; attempt++) {
+        if (__atomic_load_n(&ring->aborted, __ATOMIC_ACQUIRE)) {
+            return -1;
+        }
+        waited = 1;
+        ringBackoff(attempt);
+    }
+    if (__atomic_load_n(&ring->aborted, __ATOMIC_ACQUIRE)) {
+        return -1;
+    }
+
+    ring->items[head % ring->capacity] = item;
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+
+    ring->pushes++;
+    ring->occupancy_sum += head + 1 - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+    ring->full_waits += (uint64_t)waited;
+    return 0;
+}
+
+/**
+ * Retira o próximo item, esperando enquanto a fila está vazia (só o consumidor)
+ * @param ring Fila
+ * @return Item, ou NULL se a fila foi fechada e esvaziada ou abortada
+ */
+void* ringPop(SpscRing* ring) {
+    size_t tail = ring->tail;
+    int waited = 0;
+
+    for (int attempt = 0; __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) == tail; attempt++) {
+        if (__atomic_load_n(&ring->aborted, __ATOMIC_ACQUIRE)) {
+            return NULL;
+        }
+        // O fechamento é publicado depois do último item: confere a fila de novo
+        if (__atomic_load_n(&ring->closed, __ATOMIC_ACQUIRE)) {
+            if (__atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) == tail) {
+                ring->empty_waits += (uint64_t)waited;
+                return NULL;
+            }
+            break;
+        }
+        waited = 1;
+        ringBackoff(attempt);
+    }
+    if (__atomic_load_n(&ring->aborted, __ATOMIC_ACQUIRE)) {
+        return NULL;
+    }
+
+    void* item = ring->items[tail % ring->capacity];
+    __atomic_store_n(&ring->tail, tail + 1, __ATOMIC_RELEASE);
+    ring->empty_waits += (uint64_t)waited;
+    return item;
+}
+
+/**
+ * Marca o fim dos itens (só o produtor); o consumidor ainda recebe os pendentes
+ * @param ring Fila
+ */
+void ringClose(SpscRing* ring) {
+    __atomic_store_n(&ring->closed, 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * Interrompe a fila (qualquer thread): push e pop desistem imediatamente
+ * @param ring Fila
+ */
+void ringAbort(SpscRing* ring) {
+    __atomic_store_n(&ring->aborted, 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * Resume a ocupação de uma fila (após as threads terminarem)
+ * @param ring Fila
+ * @param stats Estatísticas a preencher
+ */
+void getSpscRingStats(const SpscRing* ring, SpscRingStats* stats) {
+    stats->capacity = ring->capacity;
+    stats->items = ring->pushes;
+    stats->average_occupancy = ring->pushes > 0 ? (double)ring->occupancy_sum / (double)ring->pushes : 0.0;
+    stats->full_waits = ring->full_waits;
+    stats->empty_waits = ring->empty_waits;
+}
@@ -0,0 +1,334 @@
+#include "table_cache.h"
+#include "huffman_algorithm.h"
+#include "memory_budget.h"
+#include "hash.h"
+#include <string.h>
+#include <pthread.h>
+
+// Estado do cache, compartilhado por todas as threads do processo
+static pthread_mutex_t cache_lock = PTHREAD_MUTEX_INITIALIZER;
+static CachedTables* cache_head = NULL;      // Entrada usada mais recentemente
+static CachedTables* cache_tail = NULL;      // Entrada usada menos recentemente
+static TableCacheStats cache_stats = {0, 0, 0, 0, TABLE_CACHE_DEFAULT_CAPACITY};
+
+/**
+ * Grava a árvore em pré-ordem na memória, no mesmo formato de serializeTree
+ * @param root Raiz da árvore
+ * @param shape Destino (MAX_SERIALIZED_TREE bytes)
+ * @param size Bytes já gravados
+ * @return Novo número de bytes gravados
+ */
+size_t flattenTree(HuffmanNode* root, unsigned char* shape, size_t size) {
+    if (root == NULL) {
+        return size;
+    }
+
+    if (isLeaf(root)) {
+        shape[size++] = 1;
+        shape[size++] = root->data;
+        return size;
+    }
+
+    shape[size++] = 0;
+    size = flattenTree(root->left, shape, size);
+    return flattenTree(root->right, shape, size);
+}
+
+/**
+ * Reconstrói a árvore a partir da forma serializada em memória
+ * @param shape Árvore serializada
+ * @param shape_size Bytes de shape
+ * @param position Posição de leitura (avança)
+ * @return Raiz da árvore, ou NULL se a forma está incompleta ou faltou memória
+ */
+static HuffmanNode* unflattenTree(const unsigned char* shape, size_t shape_size, size_t* position) {
+    if (*position >= shape_size) {
+        return NULL;
+    }
+
+    if (shape[(*position)++] == 1) {
+        if (*position >= shape_size) {
+            return NULL;
+        }
+        return createNode(shape[(*position)++], 0);
+    }
+
+    HuffmanNode* node = createNode(0, 0);
+    if (node == NULL) {
+        return NULL;
+    }
+    node->left = unflattenTree(shape, shape_size, position);
+    node->right = unflattenTree(shape, shape_size, position);
+    if (node->left == NULL || node->right == NULL) {
+        freeHuffmanTree(node);
+        return NULL;
+    }
+    return node;
+}
+
+/**
+ * Libera uma entrada e todas as suas tabelas
+ * @param tables Entrada
+ */
+static void freeCachedTables(CachedTables* tables) {
+    freeDecodeTable(tables->decode);
+    freePairCodeTable(tables->pairs);
+    budgetFree(tables->code);
+    freeHuffmanTree(tables->root);
+    budgetFree(tables);
+}
+
+/**
+ * Retira uma entrada da lista LRU (com a trava do cache)
+ * @param tables Entrada
+ */
+static void unlinkTables(CachedTables* tables) {
+    if (tables->prev != NULL) {
+        tables->prev->next = tables->next;
+    } else {
+        cache_head = tables->next;
+    }
+    if (tables->next != NULL) {
+        tables->next->prev = tables->prev;
+    } else {
+        cache_tail = tables->prev;
+    }
+    tables->prev = NULL;
+    tables->next = NULL;
+}
+
+/**
+ * Coloca uma entrada no início da lista LRU (com a trava do cache)
+ * @param tables Entrada
+ */
+static void pushTables(CachedTables* tables) {
+    tables->prev = NULL;
+    tables->next = cache_head;
+    if (cache_head != NULL) {
+        cache_head->prev = tables;
+    } else {
+        cache_tail = tables;
+    }
+    cache_head = tables;
+}
+
+/**
+ * Descarta as entradas sem uso mais antigas até respeitar o limite
+ * (com a trava do cache; entradas em uso nunca são descartadas)
+ */
+static void evictTables(void) {
+    CachedTables* tables = cache_tail;
+    while (tables != NULL && cache_stats.entries > cache_stats.capacity) {
+        CachedTables* prev = tables->prev;
+        if (tables->references == 0) {
+            unlinkTables(tables);
+            freeCachedTables(tables);
+            cache_stats.entries--;
+            cache_stats.evictions++;
+        }
+        tables = prev;
+    }
+}
+
+/**
+ * Procura uma árvore no cache e a marca como usada (com a trava do cache)
+ * @param key Hash da árvore serializada
+ * @param shape Árvore serializada
+ * @param shape_size Bytes de shape
+ * @return Entrada com uma referência a mais, ou NULL se a árvore não está no cache
+ */
+static CachedTables* findTables(uint64_t key, const unsigned char* shape, size_t shape_size) {
+    for (CachedTables* tables = cache_head; tables != NULL; tables = tables->next) {
+        if (tables->key == key && tables->shape_size == shape_size &&
+            memcmp(tables->shape, shape, shape_size) == 0) {
+            unlinkTables(tables);
+            pushTables(tables);
+            tables->references++;
+            cache_stats.hits++;
+            return tables;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Obtém as tabelas de uma árvore, reaproveitando as de qualquer thread que
+ * já tenha usado a mesma árvore (devolver com releaseTables)
+ * @param shape Árvore serializada (flattenTree)
+ * @param shape_size Bytes de shape
+ * @return Entrada do cache, ou NULL se a árvore é inválida ou faltou memória
+ */
+CachedTables* acquireTables(const unsigned char* shape, size_t shape_size) {
+    if (shape_size == 0 || shape_size > MAX_SERIALIZED_TREE) {
+        return NULL;
+    }
+    uint64_t key = hash64(shape, shape_size, 0);
+
+    pthread_mutex_lock(&cache_lock);
+    CachedTables* found = findTables(key, shape, shape_size);
+    pthread_mutex_unlock(&cache_lock);
+    if (found != NULL) {
+        return found;
+    }
+
+    // Entrada nova montada fora da trava; as tabelas são construídas sob demanda
+    CachedTables* tables = (CachedTables*)budgetCalloc(1, sizeof(CachedTables));
+    if (tables == NULL) {
+        return NULL;
+    }
+    size_t position = 0;
+    tables->root = unflattenTree(shape, shape_size, &position);
+    if (tables->root == NULL || position != shape_size) {
+        freeCachedTables(tables);
+        return NULL;
+    }
+    tables->key = key;
+    memcpy(tables->shape, shape, shape_size);
+    tables->shape_size = shape_size;
+    tables->references = 1;
+
+    // Outra thread pode ter inserido a mesma árvore enquanto isso
+    pthread_mutex_lock(&cache_lock);
+    found = findTables(key, shape, shape_size);
+    if (found != NULL) {
+        pthread_mutex_unlock(&cache_lock);
+        freeCachedTables(tables);
+        return found;
+    }
+    pushTables(tables);
+    cache_stats.entries++;
+    cache_stats.misses++;
+    evictTables();
+    pthread_mutex_unlock(&cache_lock);
+    return tables;
+}
+
+/**
+ * Devolve uma entrada obtida com acquireTables
+ * @param tables Entrada (pode ser NULL)
+ */
+void releaseTables(CachedTables* tables) {
+    if (tables == NULL) {
+        return;
+    }
+
+    pthread_mutex_lock(&cache_lock);
+    tables->references--;
+    evictTables();
+    pthread_mutex_unlock(&cache_lock);
+}
+
+/**
+ * Retorna a tabela de decodificação da entrada, construindo-a no primeiro uso
+ * Se duas threads a constroem ao mesmo tempo, a segunda descarta a sua.
+ * @param tables Entrada
+ * @return Tabela de decodificação, ou NULL se faltou memória
+ */
+const DecodeTable* cachedDecodeTable(CachedTables* tables) {
+    DecodeTable* table = __atomic_load_n(&tables->decode, __ATOMIC_ACQUIRE);
+    if (table != NULL) {
+        return table;
+    }
+
+    table = buildDecodeTable(tables->root, DECODE_MODE_AUTO);
+    if (table == NULL) {
+        return NULL;
+    }
+
+    DecodeTable* expected = NULL;
+    if (!__atomic_compare_exchange_n(&tables->decode, &expected, table, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        freeDecodeTable(table);
+        return expected;
+    }
+    return table;
+}
+
+/**
+ * Retorna a tabela de códigos inteiros da entrada, construindo-a no primeiro uso
+ * @param tables Entrada
+ * @return Tabela de códigos, ou NULL se algum código excede a tabela inteira
+ */
+const CodeTable* cachedCodeTable(CachedTables* tables) {
+    CodeTable* table = __atomic_load_n(&tables->code, __ATOMIC_ACQUIRE);
+    if (table != NULL || __atomic_load_n(&tables->code_failed, __ATOMIC_ACQUIRE)) {
+        return table;
+    }
+
+    char codes[MAX_CHAR][MAX_TREE_HT] = {{0}};
+    char current_code[MAX_TREE_HT] = {0};
+    generateHuffmanCodes(tables->root, current_code, 0, codes);
+
+    table = (CodeTable*)budgetMalloc(sizeof(CodeTable));
+    if (table == NULL) {
+        return NULL;
+    }
+    if (buildCodeTable(codes, table) != 0) {
+        budgetFree(table);
+        __atomic_store_n(&tables->code_failed, 1, __ATOMIC_RELEASE);
+        return NULL;
+    }
+
+    CodeTable* expected = NULL;
+    if (!__atomic_compare_exchange_n(&tables->code, &expected, table, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        budgetFree(table);
+        return expected;
+    }
+    return table;
+}
+
+/**
+ * Retorna a tabela de pares da entrada, construindo-a no primeiro uso
+ * @param tables Entrada
+ * @return Tabela de pares, ou NULL se a tabela de códigos não existe ou faltou memória
+ */
+const PairCodeTable* cachedPairCodeTable(CachedTables* tables) {
+    PairCodeTable* pairs = __atomic_load_n(&tables->pairs, __ATOMIC_ACQUIRE);
+    if (pairs != NULL) {
+        return pairs;
+    }
+
+    const CodeTable* table = cachedCodeTable(tables);
+    if (table == NULL || (pairs = buildPairCodeTable(table)) == NULL) {
+        return NULL;
+    }
+
+    PairCodeTable* expected = NULL;
+    if (!__atomic_compare_exchange_n(&tables->pairs, &expected, pairs, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        freePairCodeTable(pairs);
+        return expected;
+    }
+    return pairs;
+}
+
+/**
+ * Define quantas entradas o cache mantém (entradas em uso não contam como descartáveis)
+ * @param capacity Limite de entradas (0 = não guardar nada além das entradas em uso)
+ */
+void setTableCacheCapacity(size_t capacity) {
+    pthread_mutex_lock(&cache_lock);
+    cache_stats.capacity = capacity;
+    evictTables();
+    pthread_mutex_unlock(&cache_lock);
+}
+
+/**
+ * Descarta todas as entradas sem uso
+ */
+void clearTableCache(void) {
+    pthread_mutex_lock(&cache_lock);
+    size_t capacity = cache_stats.capacity;
+    cache_stats.capacity = 0;
+    evictTables();
+    cache_stats.capacity = capacity;
+    pthread_mutex_unlock(&cache_lock);
+}
+
+/**
+ * Copia as estatísticas do cache
+ * @param stats Destino
+ */
+void getTableCacheStats(TableCacheStats* stats) {
+    pthread_mutex_lock(&cache_lock);
+    *stats = cache_stats;
+    pthread_mutex_unlock(&cache_lock);
+}
@@ -0,0 +1,264 @@
+#include "transform.h"
+#include "file_io.h"
+#include "huffman_algorithm.h"
+#include <string.h>
+
+static const char* transform_names[TRANSFORM_COUNT] = {"none", "rle", "delta", "mtf"};
+
+/**
+ * Codifica sequências de bytes iguais: a partir de RLE_MIN_RUN repetições,
+ * os 4 bytes são seguidos de um contador com as repetições restantes
+ * @param input Bytes originais
+ * @param length Tamanho da entrada
+ * @param output Destino
+ * @param capacity Capacidade do destino
+ * @return Bytes gravados, ou 0 se não couberam
+ */
+static size_t encodeRuns(const unsigned char* input, size_t length, unsigned char* output, size_t capacity) {
+    size_t written = 0;
+    size_t i = 0;
+
+    while (i < length) {
+        unsigned char byte = input[i];
+        size_t run = 1;
+        while (i + run < length && input[i + run] == byte && run < RLE_MIN_RUN + RLE_MAX_EXTRA) {
+            run++;
+        }
+
+        size_t literal = run < RLE_MIN_RUN ? run : RLE_MIN_RUN;
+        if (written + literal + (run >= RLE_MIN_RUN) > capacity) {
+            return 0;
+        }
+        memset(output + written, byte, literal);
+        written += literal;
+        if (run >= RLE_MIN_RUN) {
+            output[written++] = (unsigned char)(run - RLE_MIN_RUN);
+        }
+        i += run;
+    }
+    return written;
+}
+
+/**
+ * Desfaz encodeRuns
+ * @param input Bytes transformados
+ * @param length Tamanho da entrada
+ * @param output Destino
+ * @param expected Bytes originais esperados
+ * @return 0 se sucesso, -1 se os dados estão corrompidos
+ */
+static int decodeRuns(const unsigned char* input, size_t length, unsigned char* output, size_t expected) {
+    size_t written = 0;
+    int previous = -1;
+    int run = 0;
+
+    for (size_t i = 0; i < length; i++) {
+        if (run == RLE_MIN_RUN) {
+            // Contador: repete o byte anterior e recomeça a contagem
+            if (written + input[i] > expected) {
+                return -1;
+            }
+            memset(output + written, previous, input[i]);
+            written += input[i];
+            previous = -1;
+            run = 0;
+            continue;
+        }
+
+        if (written >= expected) {
+            return -1;
+        }
+        output[written++] = input[i];
+        run = input[i] == previous ? run + 1 : 1;
+        previous = input[i];
+    }
+
+    return written == expected && run < RLE_MIN_RUN ? 0 : -1;
+}
+
+/**
+ * Aplica uma transformação a um bloco
+ * @param type Transformação
+ * @param input Bytes originais
+ * @param length Tamanho da entrada
+ * @param output Destino (não pode coincidir com a entrada)
+ * @param capacity Capacidade do destino
+ * @return Bytes transformados, ou 0 se não couberam no destino
+ */
+size_t applyTransform(TransformType type, const unsigned char* input, size_t length,
+                      unsigned char* output, size_t capacity) {
+    if (type == TRANSFORM_RLE) {
+        return encodeRuns(input, length, output, capacity);
+    }
+    if (length > capacity) {
+        return 0;
+    }
+
+    if (type == TRANSFORM_DELTA) {
+        unsigned char previous = 0;
+        for (size_t i = 0; i < length; i++) {
+            output[i] = (unsigned char)(input[i] - previous);
+            previous = input[i];
+        }
+    } else if (type == TRANSFORM_MTF) {
+        unsigned char order[MAX_CHAR];
+        for (int c = 0; c < MAX_CHAR; c++) {
+            order[c] = (unsigned char)c;
+        }
+        for (size_t i = 0; i < length; i++) {
+            unsigned char byte = input[i];
+            int position = 0;
+            while (order[position] != byte) {
+                position++;
+            }
+            memmove(order + 1, order, (size_t)position);
+            order[0] = byte;
+            output[i] = (unsigned char)position;
+        }
+    } else {
+        memcpy(output, input, length);
+    }
+    return length;
+}
+
+/**
+ * Desfaz uma transformação
+ * @param type Transformação aplicada
+ * @param input Bytes transformados
+ * @param length Tamanho da entrada
+ * @param output Destino (não pode coincidir com a entrada)
+ * @param expected Bytes originais esperados (capacidade do destino)
+ * @return 0 se sucesso, -1 se os dados estão corrompidos
+ */
+int invertTransform(TransformType type, const unsigned char* input, size_t length,
+                    unsigned char* output, size_t expected) {
+    if (type == TRANSFORM_RLE) {
+        return decodeRuns(input, length, output, expected);
+    }
+    if (length != expected) {
+        return -1;
+    }
+
+    if (type == TRANSFORM_DELTA) {
+        unsigned char previous = 0;
+        for (size_t i = 0; i < length; i++) {
+            previous = (unsigned char)(previous + input[i]);
+            output[i] = previous;
+        }
+    } else if (type == TRANSFORM_MTF) {
+        unsigned char order[MAX_CHAR];
+        for (int c = 0; c < MAX_CHAR; c++) {
+            order[c] = (unsigned char)c;
+        }
+        for (size_t i = 0; i < length; i++) {
+            int position = input[i];
+            unsigned char byte = order[position];
+            memmove(order + 1, order, (size_t)position);
+            order[0] = byte;
+            output[i] = byte;
+        }
+    } else if (type == TRANSFORM_NONE) {
+        memcpy(output, input, length);
+    } else {
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Escolhe a transformação de um bloco por um teste barato: cada candidata é
+ * aplicada a alguns trechos espalhados pelo bloco e o custo é o tamanho do
+ * fluxo de Huffman ótimo desses trechos (calculado sem montar a árvore)
+ * @param data Bytes do bloco
+ * @param length Tamanho do bloco
+ * @param allowed Máscara de transformações permitidas
+ * @return Transformação escolhida (TRANSFORM_NONE se nenhuma compensa)
+ */
+TransformType chooseTransform(const unsigned char* data, size_t length, int allowed) {
+    if (allowed == 0 || length < TRANSFORM_MIN_BLOCK) {
+        return TRANSFORM_NONE;
+    }
+
+    // Espaço para a expansão do RLE (no pior caso, 5 bytes a cada 4)
+    unsigned char trial[2 * TRANSFORM_TRIAL_SLICE];
+    size_t slice = length < TRANSFORM_TRIAL_SLICE ? length : TRANSFORM_TRIAL_SLICE;
+    uint64_t costs[TRANSFORM_COUNT];
+
+    for (int type = 0; type < TRANSFORM_COUNT; type++) {
+        costs[type] = UINT64_MAX;
+        if (type != TRANSFORM_NONE && !(allowed & TRANSFORM_BIT(type))) {
+            continue;
+        }
+
+        uint64_t total = 0;
+        for (int k = 0; k < TRANSFORM_TRIAL_SLICES; k++) {
+            size_t start = (length - slice) * (size_t)k / (TRANSFORM_TRIAL_SLICES - 1);
+            size_t produced = applyTransform((TransformType)type, data + start, slice, trial, sizeof(trial));
+
+            unsigned long frequencies[MAX_CHAR] = {0};
+            countFrequencies(trial, produced, frequencies);
+            int leaves;
+            total += huffmanCostBits(frequencies, &leaves);
+        }
+        costs[type] = total;
+    }
+
+    // Sem ganho claro, o bloco fica como está (a inversa também custa tempo)
+    TransformType best = TRANSFORM_NONE;
+    uint64_t best_cost = costs[TRANSFORM_NONE] - costs[TRANSFORM_NONE] / TRANSFORM_MIN_GAIN;
+    for (int type = 1; type < TRANSFORM_COUNT; type++) {
+        if (costs[type] < best_cost) {
+            best = (TransformType)type;
+            best_cost = costs[type];
+        }
+    }
+    return best;
+}
+
+/**
+ * Converte uma lista separada por vírgulas ("rle,delta", "auto" ou "none")
+ * na máscara de transformações permitidas
+ * @param text Lista
+ * @param allowed Máscara a preencher
+ * @return 0 se sucesso, -1 se algum nome é inválido
+ */
+int parseTransformList(const char* text, int* allowed) {
+    if (strcmp(text, "auto") == 0) {
+        *allowed = TRANSFORM_ALL;
+        return 0;
+    }
+
+    int mask = 0;
+    const char* item = text;
+    while (*item != '\0') {
+        size_t length = strcspn(item, ",");
+        int found = 0;
+        for (int type = 0; type < TRANSFORM_COUNT; type++) {
+            if (strlen(transform_names[type]) == length && strncmp(item, transform_names[type], length) == 0) {
+                mask |= type != TRANSFORM_NONE ? TRANSFORM_BIT(type) : 0;
+                found = 1;
+            }
+        }
+        if (!found) {
+            fprintf(stderr, "Erro: Transformação inválida '%.*s' (auto, none, rle, delta ou mtf)\n",
+                    (int)length, item);
+            return -1;
+        }
+        item += length;
+        if (*item == ',') {
+            item++;
+        }
+    }
+
+    *allowed = mask;
+    return 0;
+}
+
+/**
+ * Retorna o nome de uma transformação
+ * @param type Transformação
+ * @return Nome curto
+ */
+const char* transformName(TransformType type) {
+    return type >= 0 && type < TRANSFORM_COUNT ? transform_names[type] : "?";
+}
@@ -0,0 +1,666 @@
+#include "wide_symbol.h"
+#include "memory_budget.h"
+#include <string.h>
+
+/**
+ * Conta as palavras de 16 bits (little-endian) de um bloco; um byte final
+ * ímpar não é contado. A tabela deve chegar zerada.
+ * @param data Bytes do bloco
+ * @param length Número de bytes
+ * @param frequencies Tabela de WIDE_ALPHABET contadores a atualizar
+ */
+void countWideFrequencies(const unsigned char* data, size_t length, uint32_t* frequencies) {
+    for (size_t i = 0; i + 1 < length; i += 2) {
+        frequencies[data[i] | (data[i + 1] << 8)]++;
+    }
+}
+
+/**
+ * Compara dois pesos empacotados (frequência << 16 | símbolo) para qsort
+ * @param a Primeiro peso
+ * @param b Segundo peso
+ * @return Negativo, zero ou positivo, em ordem crescente
+ */
+static int compareWideWeights(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * Calcula no próprio vetor os comprimentos ótimos de Huffman (algoritmo de
+ * Moffat e Katajainen): recebe os pesos em ordem crescente e devolve o
+ * comprimento de cada um, sem montar a árvore
+ * @param weights Pesos em ordem crescente; recebe os comprimentos (não crescentes)
+ * @param count Número de pesos (ao menos 2)
+ */
+static void minimumRedundancyLengths(uint64_t* weights, int count) {
+    // Primeira fase: pesos dos nós internos, com ponteiros para os pais
+    int root = 0;
+    int leaf = 2;
+    weights[0] += weights[1];
+    for (int next = 1; next < count - 1; next++) {
+        if (leaf >= count || weights[root] < weights[leaf]) {
+            weights[next] = weights[root];
+            weights[root++] = (uint64_t)next;
+        } else {
+            weights[next] = weights[leaf++];
+        }
+
+        if (leaf >= count || (root < next && weights[root] < weights[leaf])) {
+            weights[next] += weights[root];
+            weights[root++] = (uint64_t)next;
+        } else {
+            weights[next] += weights[leaf++];
+        }
+    }
+
+    // Segunda fase: profundidade de cada nó interno
+    weights[count - 2] = 0;
+    for (int next = count - 3; next >= 0; next--) {
+        weights[next] = weights[weights[next]] + 1;
+    }
+
+    // Terceira fase: profundidade das folhas, da raiz para baixo
+    int available = 1;
+    int used = 0;
+    uint64_t depth = 0;
+    int next = count - 1;
+    root = count - 2;
+    while (available > 0) {
+        while (root >= 0 && weights[root] == depth) {
+            used++;
+            root--;
+        }
+        while (available > used) {
+            weights[next--] = depth;
+            available--;
+        }
+        available = 2 * used;
+        depth++;
+        used = 0;
+    }
+}
+
+/**
+ * Limita os comprimentos a WIDE_MAX_CODE_LENGTH: os códigos longos demais
+ * são cortados, os menos frequentes abaixo do limite são alongados até a
+ * desigualdade de Kraft valer de novo, e a folga que sobrar encurta os
+ * mais frequentes
+ * @param lengths Comprimentos, do símbolo menos frequente ao mais frequente
+ * @param count Número de símbolos
+ */
+static void limitWideLengths(uint64_t* lengths, int count) {
+    if (lengths[0] <= WIDE_MAX_CODE_LENGTH) {
+        return;
+    }
+
+    const uint64_t capacity = 1ull << WIDE_MAX_CODE_LENGTH;
+    uint64_t kraft = 0;
+    for (int i = 0; i < count; i++) {
+        if (lengths[i] > WIDE_MAX_CODE_LENGTH) {
+            lengths[i] = WIDE_MAX_CODE_LENGTH;
+        }
+        kraft += 1ull << (WIDE_MAX_CODE_LENGTH - lengths[i]);
+    }
+
+    for (int i = 0; i < count && kraft > capacity; i++) {
+        while (lengths[i] < WIDE_MAX_CODE_LENGTH && kraft > capacity) {
+            kraft -= 1ull << (WIDE_MAX_CODE_LENGTH - lengths[i] - 1);
+            lengths[i]++;
+        }
+    }
+
+    for (int i = count - 1; i >= 0; i--) {
+        while (lengths[i] > 1 && kraft + (1ull << (WIDE_MAX_CODE_LENGTH - lengths[i])) <= capacity) {
+            kraft += 1ull << (WIDE_MAX_CODE_LENGTH - lengths[i]);
+            lengths[i]--;
+        }
+    }
+}
+
+/**
+ * Calcula os comprimentos dos códigos canônicos de um histograma de 16 bits
+ * Um único símbolo recebe um código de 1 bit.
+ * @param frequencies Tabela de WIDE_ALPHABET contadores
+ * @param lengths Recebe WIDE_ALPHABET comprimentos (0 = símbolo ausente)
+ * @return Número de símbolos presentes, ou -1 se faltou memória
+ */
+int buildWideCodeLengths(const uint32_t* frequencies, unsigned char* lengths) {
+    memset(lengths, 0, WIDE_ALPHABET);
+
+    int count = 0;
+    for (int s = 0; s < WIDE_ALPHABET; s++) {
+        count += frequencies[s] > 0;
+    }
+    if (count == 0) {
+        return 0;
+    }
+
+    uint64_t* sorted = (uint64_t*)budgetMalloc((size_t)count * sizeof(uint64_t));
+    uint64_t* weights = (uint64_t*)budgetMalloc((size_t)count * sizeof(uint64_t));
+    if (sorted == NULL || weights == NULL) {
+        budgetFree(sorted);
+        budgetFree(weights);
+        return -1;
+    }
+
+    int n = 0;
+    for (int s = 0; s < WIDE_ALPHABET; s++) {
+        if (frequencies[s] > 0) {
+            sorted[n++] = ((uint64_t)frequencies[s] << 16) | (uint64_t)s;
+        }
+    }
+    qsort(sorted, (size_t)count, sizeof(uint64_t), compareWideWeights);
+
+    if (count == 1) {
+        weights[0] = 1;
+    } else {
+        for (int i = 0; i < count; i++) {
+            weights[i] = sorted[i] >> 16;
+        }
+        minimumRedundancyLengths(weights, count);
+        limitWideLengths(weights, count);
+    }
+
+    for (int i = 0; i < count; i++) {
+        lengths[sorted[i] & 0xFFFF] = (unsigned char)weights[i];
+    }
+
+    budgetFree(sorted);
+    budgetFree(weights);
+    return count;
+}
+
+/**
+ * Calcula os bits do fluxo codificado com os comprimentos dados
+ * @param frequencies Tabela de WIDE_ALPHABET contadores
+ * @param lengths Comprimentos dos códigos
+ * @return Total de bits (UINT64_MAX se algum símbolo presente não tem código)
+ */
+uint64_t wideCostBits(const uint32_t* frequencies, const unsigned char* lengths) {
+    uint64_t bits = 0;
+    for (int s = 0; s < WIDE_ALPHABET; s++) {
+        if (frequencies[s] > 0) {
+            if (lengths[s] == 0) {
+                return UINT64_MAX;
+            }
+            bits += (uint64_t)frequencies[s] * lengths[s];
+        }
+    }
+    return bits;
+}
+
+/**
+ * Calcula o primeiro código canônico de cada comprimento
+ * @param counts Códigos de cada comprimento (counts[0] = 0)
+ * @param first Recebe o primeiro código de cada comprimento
+ */
+static void canonicalFirstCodes(const int* counts, uint32_t* first) {
+    uint32_t code = 0;
+    first[0] = 0;
+    for (int length = 1; length <= WIDE_MAX_CODE_LENGTH; length++) {
+        code = (code + (uint32_t)counts[length - 1]) << 1;
+        first[length] = code;
+    }
+}
+
+/**
+ * Monta a tabela de códigos canônicos: dentro de cada comprimento, os
+ * códigos seguem a ordem dos símbolos
+ * @param lengths Comprimentos dos códigos
+ * @param table Tabela a preencher
+ */
+void buildWideCodeTable(const unsigned char* lengths, WideCodeTable* table) {
+    int counts[WIDE_MAX_CODE_LENGTH + 1] = {0};
+    table->symbols = 0;
+    table->max_length = 0;
+    for (int s = 0; s < WIDE_ALPHABET; s++) {
+        if (lengths[s] > 0) {
+            counts[lengths[s]]++;
+            table->symbols++;
+            if (lengths[s] > table->max_length) {
+                table->max_length = lengths[s];
+            }
+        }
+    }
+
+    uint32_t next[WIDE_MAX_CODE_LENGTH + 1];
+    canonicalFirstCodes(counts, next);
+    for (int s = 0; s < WIDE_ALPHABET; s++) {
+        table->length[s] = lengths[s];
+        table->code[s] = lengths[s] > 0 ? next[lengths[s]]++ : 0;
+    }
+}
+
+/**
+ * Bytes de um inteiro no formato de tamanho variável (7 bits por byte)
+ * @param value Valor
+ * @return Número de bytes
+ */
+static size_t varintSize(uint32_t value) {
+    size_t size = 1;
+    while (value >= 0x80) {
+        value >>= 7;
+        size++;
+    }
+    return size;
+}
+
+/**
+ * Grava um inteiro no formato de tamanho variável
+ * @param value Valor
+ * @param output Destino (ao menos varintSize(value) bytes)
+ * @return Bytes gravados
+ */
+static size_t putVarint(uint32_t value, unsigned char* output) {
+    size_t size = 0;
+    while (value >= 0x80) {
+        output[size++] = (unsigned char)(value | 0x80);
+        value >>= 7;
+    }
+    output[size++] = (unsigned char)value;
+    return size;
+}
+
+/**
+ * Lê um inteiro de até 3 bytes no formato de tamanho variável
+ * @param input Bytes
+ * @param length Bytes disponíveis
+ * @param position Posição atual (avança)
+ * @param value Recebe o valor
+ * @return 0 se sucesso, -1 se truncado ou longo demais
+ */
+static int getVarint(const unsigned char* input, size_t length, size_t* position, uint32_t* value) {
+    *value = 0;
+    for (int shift = 0; shift < 21; shift += 7) {
+        if (*position >= length) {
+            return -1;
+        }
+        unsigned char byte = input[(*position)++];
+        *value |= (uint32_t)(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return 0;
+        }
+    }
+    return -1;
+}
+
+/**
+ * Calcula o tamanho do cabeçalho esparso: número de símbolos e, para cada
+ * símbolo presente em ordem crescente, a distância ao anterior e o comprimento
+ * @param lengths Comprimentos dos códigos
+ * @return Bytes do cabeçalho
+ */
+size_t wideHeaderSize(const unsigned char* lengths) {
+    size_t size = 0;
+    uint32_t count = 0;
+    int previous = -1;
+    for (int s = 0; s < WIDE_ALPHABET; s++) {
+        if (lengths[s] > 0) {
+            size += varintSize((uint32_t)(s - previous - 1)) + 1;
+            previous = s;
+            count++;
+        }
+    }
+    return size + varintSize(count);
+}
+
+/**
+ * Grava o cabeçalho esparso de comprimentos
+ * @param lengths Comprimentos dos códigos
+ * @param output Destino
+ * @param capacity Capacidade do destino
+ * @return Bytes gravados, ou 0 se não coube
+ */
+size_t writeWideHeader(const unsigned char* lengths, unsigned char* output, size_t capacity) {
+    if (wideHeaderSize(lengths) > capacity) {
+        return 0;
+    }
+
+    uint32_t count = 0;
+    for (int s = 0; s < WIDE_ALPHABET; s++) {
+        count += lengths[s] > 0;
+    }
+
+    size_t position = putVarint(count, output);
+    int previous = -1;
+    for (int s = 0; s < WIDE_ALPHABET; s++) {
+        if (lengths[s] > 0) {
+            position += putVarint((uint32_t)(s - previous - 1), output + position);
+            output[position++] = lengths[s];
+            previous = s;
+        }
+    }
+    return position;
+}
+
+/**
+ * Lê o cabeçalho esparso de comprimentos
+ * @param input Bytes do conteúdo
+ * @param length Bytes disponíveis
+ * @param lengths Recebe WIDE_ALPHABET comprimentos
+ * @return Bytes lidos, ou 0 se o cabeçalho está truncado ou é inválido
+ */
+size_t readWideHeader(const unsigned char* input, size_t length, unsigned char* lengths) {
+    memset(lengths, 0, WIDE_ALPHABET);
+
+    size_t position = 0;
+    uint32_t count;
+    if (getVarint(input, length, &position, &count) != 0 || count == 0 || count > WIDE_ALPHABET) {
+        return 0;
+    }
+
+    uint32_t symbol = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t gap;
+        if (getVarint(input, length, &position, &gap) != 0 || position >= length) {
+            return 0;
+        }
+        symbol = (i == 0 ? 0 : symbol + 1) + gap;
+        unsigned char code_length = input[position++];
+        if (symbol >= WIDE_ALPHABET || code_length == 0 || code_length > WIDE_MAX_CODE_LENGTH) {
+            return 0;
+        }
+        lengths[symbol] = code_length;
+    }
+    return position;
+}
+
+/**
+ * Codifica palavras de 16 bits com a tabela canônica
+ * @param writer Escritor de bits
+ * @param data Bytes (2 * words)
+ * @param words Número de palavras
+ * @param table Tabela de códigos
+ * @return 0 se sucesso, -1 se uma palavra não tem código ou o destino encheu
+ */
+int encodeWideSymbols(BitWriter* writer, const unsigned char* data, size_t words, const WideCodeTable* table) {
+    for (size_t i = 0; i < words; i++) {
+        unsigned int symbol = data[2 * i] | (data[2 * i + 1] << 8);
+        int length = table->length[symbol];
+        if (length == 0) {
+            return -1;
+        }
+        writer->accumulator = (writer->accumulator << length) | table->code[symbol];
+        writer->bit_count += length;
+
+        if (writer->bit_count >= 32) {
+            if (writer->capacity - writer->position < 4 && drainBitWriter(writer) != 0) {
+                writer->overflow = 1;
+                return -1;
+            }
+            writer->bit_count -= 32;
+            uint32_t word = (uint32_t)(writer->accumulator >> writer->bit_count);
+            writer->buffer[writer->position++] = (unsigned char)(word >> 24);
+            writer->buffer[writer->position++] = (unsigned char)(word >> 16);
+            writer->buffer[writer->position++] = (unsigned char)(word >> 8);
+            writer->buffer[writer->position++] = (unsigned char)word;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Calcula o formato da tabela de decodificação de dois níveis: o tamanho
+ * de cada subtabela (o maior código de cada prefixo) e a sua posição
+ * @param lengths Comprimentos dos códigos
+ * @param first Recebe o primeiro código canônico de cada comprimento
+ * @param sub_bits Recebe os bits da subtabela de cada prefixo (0 = sem subtabela)
+ * @param offsets Recebe o início da subtabela de cada prefixo
+ * @param max_length Recebe o maior comprimento presente
+ * @return Entradas da tabela, ou 0 se os comprimentos não formam um código de prefixo
+ */
+static size_t wideTableLayout(const unsigned char* lengths, uint32_t* first, unsigned char* sub_bits,
+                              uint32_t* offsets, int* max_length) {
+    int counts[WIDE_MAX_CODE_LENGTH + 1] = {0};
+    uint64_t kraft = 0;
+    *max_length = 0;
+    for (int s = 0; s < WIDE_ALPHABET; s++) {
+        if (lengths[s] > WIDE_MAX_CODE_LENGTH) {
+            return 0;
+        }
+        if (lengths[s] > 0) {
+            counts[lengths[s]]++;
+            kraft += 1ull << (WIDE_MAX_CODE_LENGTH - lengths[s]);
+            if (lengths[s] > *max_length) {
+                *max_length = lengths[s];
+            }
+        }
+    }
+    if (*max_length == 0 || kraft > (1ull << WIDE_MAX_CODE_LENGTH)) {
+        return 0;
+    }
+
+    uint32_t next[WIDE_MAX_CODE_LENGTH + 1];
+    canonicalFirstCodes(counts, first);
+
+    // Tamanho de cada subtabela: o maior código de cada prefixo
+    memset(sub_bits, 0, 1 << WIDE_ROOT_BITS);
+    memcpy(next, first, sizeof(next));
+    for (int s = 0; s < WIDE_ALPHABET; s++) {
+        if (lengths[s] > WIDE_ROOT_BITS) {
+            uint32_t code = next[lengths[s]]++;
+            uint32_t prefix = code >> (lengths[s] - WIDE_ROOT_BITS);
+            if (lengths[s] - WIDE_ROOT_BITS > sub_bits[prefix]) {
+                sub_bits[prefix] = (unsigned char)(lengths[s] - WIDE_ROOT_BITS);
+            }
+        }
+    }
+
+    size_t size = 1 << WIDE_ROOT_BITS;
+    for (int p = 0; p < (1 << WIDE_ROOT_BITS); p++) {
+        offsets[p] = (uint32_t)size;
+        size += sub_bits[p] > 0 ? (size_t)1 << sub_bits[p] : 0;
+    }
+    return size;
+}
+
+/**
+ * Calcula quantas entradas a tabela de decodificação teria, sem montá-la
+ * (o codificador limita por ela a memória exigida do decodificador)
+ * @param lengths Comprimentos dos códigos
+ * @return Entradas da tabela, ou 0 se os comprimentos não formam um código de prefixo
+ */
+size_t wideDecodeTableEntries(const unsigned char* lengths) {
+    uint32_t first[WIDE_MAX_CODE_LENGTH + 1];
+    unsigned char sub_bits[1 << WIDE_ROOT_BITS];
+    uint32_t offsets[1 << WIDE_ROOT_BITS];
+    int max_length;
+    return wideTableLayout(lengths, first, sub_bits, offsets, &max_length);
+}
+
+/**
+ * Monta a tabela de decodificação de dois níveis: códigos de até
+ * WIDE_ROOT_BITS bits são resolvidos em uma consulta; os demais apontam,
+ * pelo prefixo, para uma subtabela do tamanho exato do maior código
+ * daquele prefixo
+ * @param lengths Comprimentos dos códigos
+ * @return Tabela, ou NULL se os comprimentos não formam um código de prefixo ou faltou memória
+ */
+WideDecodeTable* buildWideDecodeTable(const unsigned char* lengths) {
+    uint32_t first[WIDE_MAX_CODE_LENGTH + 1];
+    uint32_t next[WIDE_MAX_CODE_LENGTH + 1];
+    unsigned char sub_bits[1 << WIDE_ROOT_BITS];
+    uint32_t offsets[1 << WIDE_ROOT_BITS];
+    int max_length;
+    size_t size = wideTableLayout(lengths, first, sub_bits, offsets, &max_length);
+    if (size == 0) {
+        return NULL;
+    }
+
+    WideDecodeTable* table = (WideDecodeTable*)budgetMalloc(sizeof(WideDecodeTable));
+    WideDecodeEntry* entries = (WideDecodeEntry*)budgetCalloc(size, sizeof(WideDecodeEntry));
+    if (table == NULL || entries == NULL) {
+        budgetFree(table);
+        budgetFree(entries);
+        return NULL;
+    }
+    table->entries = entries;
+    table->size = size;
+    table->max_length = max_length;
+
+    for (int p = 0; p < (1 << WIDE_ROOT_BITS); p++) {
+        if (sub_bits[p] > 0) {
+            entries[p].bits = WIDE_ROOT_BITS;
+            entries[p].sub_bits = sub_bits[p];
+            entries[p].offset = offsets[p];
+        }
+    }
+
+    memcpy(next, first, sizeof(next));
+    for (int s = 0; s < WIDE_ALPHABET; s++) {
+        int length = lengths[s];
+        if (length == 0) {
+            continue;
+        }
+
+        uint32_t code = next[length]++;
+        size_t start;
+        size_t span;
+        int bits;
+        if (length <= WIDE_ROOT_BITS) {
+            start = (size_t)code << (WIDE_ROOT_BITS - length);
+            span = (size_t)1 << (WIDE_ROOT_BITS - length);
+            bits = length;
+        } else {
+            uint32_t prefix = code >> (length - WIDE_ROOT_BITS);
+            int extra = length - WIDE_ROOT_BITS;
+            uint32_t low = code & ((1u << extra) - 1);
+            start = offsets[prefix] + ((size_t)low << (sub_bits[prefix] - extra));
+            span = (size_t)1 << (sub_bits[prefix] - extra);
+            bits = extra;
+        }
+
+        for (size_t i = 0; i < span; i++) {
+            entries[start + i].symbol = (uint16_t)s;
+            entries[start + i].bits = (uint8_t)bits;
+        }
+    }
+
+    return table;
+}
+
+/**
+ * Libera uma tabela de decodificação de 16 bits
+ * @param table Tabela (pode ser NULL)
+ */
+void freeWideDecodeTable(WideDecodeTable* table) {
+    if (table != NULL) {
+        budgetFree(table->entries);
+        budgetFree(table);
+    }
+}
+
+/**
+ * Decodifica palavras de 16 bits: uma consulta ao primeiro nível e, para
+ * códigos longos, uma à subtabela
+ * @param reader Leitor de bits
+ * @param table Tabela de decodificação
+ * @param output Destino (2 * words bytes, little-endian)
+ * @param words Palavras a decodificar
+ * @return Palavras decodificadas (menos que words se o fluxo acabou ou é inválido)
+ */
+size_t decodeWideSymbols(BitReader* reader, const WideDecodeTable* table, unsigned char* output, size_t words) {
+    const WideDecodeEntry* entries = table->entries;
+    for (size_t i = 0; i < words; i++) {
+        if (reader->bit_count < WIDE_MAX_CODE_LENGTH) {
+            refillBitReader(reader);
+        }
+
+        uint64_t window = reader->accumulator;
+        const WideDecodeEntry* entry = &entries[window >> (64 - WIDE_ROOT_BITS)];
+        int bits = entry->bits;
+        if (entry->sub_bits > 0) {
+            entry = &entries[entry->offset + ((window << WIDE_ROOT_BITS) >> (64 - entry->sub_bits))];
+            bits += entry->bits;
+        }
+
+        // Código inválido ou bits além do fim do fluxo
+        if (entry->bits == 0 || bits > reader->bit_count) {
+            return i;
+        }
+
+        reader->accumulator <<= bits;
+        reader->bit_count -= bits;
+        output[2 * i] = (unsigned char)entry->symbol;
+        output[2 * i + 1] = (unsigned char)(entry->symbol >> 8);
+    }
+    return words;
+}
+
+/**
+ * Codifica um bloco no modo de 16 bits: cabeçalho esparso, o byte final
+ * (se o bloco tem tamanho ímpar) e o fluxo de bits das palavras
+ * @param data Bytes do bloco
+ * @param length Número de bytes
+ * @param lengths Comprimentos dos códigos (buildWideCodeLengths do bloco)
+ * @param output Destino
+ * @param capacity Capacidade do destino
+ * @return Bytes gravados, ou 0 se não coube ou faltou memória
+ */
+size_t encodeWideBlock(const unsigned char* data, size_t length, const unsigned char* lengths,
+                       unsigned char* output, size_t capacity) {
+    size_t position = writeWideHeader(lengths, output, capacity);
+    if (position == 0) {
+        return 0;
+    }
+    if (length & 1) {
+        if (position >= capacity) {
+            return 0;
+        }
+        output[position++] = data[length - 1];
+    }
+
+    WideCodeTable* table = (WideCodeTable*)budgetMalloc(sizeof(WideCodeTable));
+    if (table == NULL) {
+        return 0;
+    }
+    buildWideCodeTable(lengths, table);
+
+    BitWriter writer;
+    initBitWriter(&writer, output + position, capacity - position, NULL);
+    int result = encodeWideSymbols(&writer, data, length / 2, table) == 0 && flushBitWriter(&writer) == 0;
+    budgetFree(table);
+
+    return result ? position + writer.position : 0;
+}
+
+/**
+ * Decodifica um bloco gravado por encodeWideBlock
+ * @param payload Conteúdo do bloco
+ * @param payload_size Bytes do conteúdo
+ * @param output Destino (raw_size bytes)
+ * @param raw_size Bytes originais do bloco
+ * @return 0 se sucesso, -1 se o bloco está corrompido ou faltou memória
+ */
+int decodeWideBlock(const unsigned char* payload, size_t payload_size, unsigned char* output, size_t raw_size) {
+    unsigned char* lengths = (unsigned char*)budgetMalloc(WIDE_ALPHABET);
+    if (lengths == NULL) {
+        return -1;
+    }
+    size_t position = readWideHeader(payload, payload_size, lengths);
+    WideDecodeTable* table = position > 0 ? buildWideDecodeTable(lengths) : NULL;
+    budgetFree(lengths);
+    if (table == NULL) {
+        return -1;
+    }
+
+    int result = 0;
+    if (raw_size & 1) {
+        if (position >= payload_size) {
+            result = -1;
+        } else {
+            output[raw_size - 1] = payload[position++];
+        }
+    }
+
+    if (result == 0) {
+        BitReader reader;
+        initBitReaderFromMemory(&reader, payload + position, payload_size - position);
+        result = decodeWideSymbols(&reader, table, output, raw_size / 2) == raw_size / 2 ? 0 : -1;
+    }
+
+    freeWideDecodeTable(table);
+    return result;
+}
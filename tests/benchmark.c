@@ -0,0 +1,1100 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "data_structures.h"
+#include "huffman_algorithm.h"
+#include "code_table.h"
+#include "decode_table.h"
+#include "cpu_dispatch.h"
+#include "block_format.h"
+#include "adaptive_huffman.h"
+#include "parallel_decode.h"
+#include "parallel_encode.h"
+#include "async_codec.h"
+#include "huf_reader.h"
+#include <poll.h>
+
+#define BENCH_MIN_SECONDS 0.2
+
+/**
+ * Retorna o tempo monotônico atual em segundos
+ */
+static double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * Gera dados sintéticos semelhantes a texto (palavras de um vocabulário fixo)
+ * @param size Número de bytes a gerar
+ * @return Buffer alocado com os dados
+ */
+static unsigned char* generateTextData(size_t size) {
+    static const char* words[] = {
+        "the", "of", "and", "to", "in", "compress", "huffman", "data", "a", "is",
+        "that", "for", "it", "as", "with", "was", "on", "tree", "code", "bits",
+        "frequency", "symbol", "table", "buffer", "stream", "encoder", "decoder"
+    };
+    const int word_count = sizeof(words) / sizeof(words[0]);
+
+    unsigned char* data = (unsigned char*)malloc(size);
+    if (data == NULL) {
+        fprintf(stderr, "Erro: Falha na alocação de memória para os dados\n");
+        exit(EXIT_FAILURE);
+    }
+
+    unsigned long state = 12345;
+    size_t pos = 0;
+    while (pos < size) {
+        state = state * 1103515245 + 12345;
+        // Distribuição enviesada: palavras iniciais são mais frequentes
+        int index = (int)(((state >> 16) % 1000) * ((state >> 8) % 1000) / 1000000.0 * word_count);
+        const char* word = words[index % word_count];
+        for (size_t j = 0; word[j] != '\0' && pos < size; j++) {
+            data[pos++] = (unsigned char)word[j];
+        }
+        if (pos < size) {
+            data[pos++] = ((state >> 24) % 12 == 0) ? '\n' : ' ';
+        }
+    }
+
+    return data;
+}
+
+/**
+ * Gera dados muito enviesados (semelhantes a logs), com 2 a 4 bits por símbolo
+ * @param size Número de bytes a gerar
+ * @return Buffer alocado com os dados
+ */
+static unsigned char* generateSkewedData(size_t size) {
+    static const char alphabet[] = "0000000011111222334455667789:. -\n";
+    const int alphabet_size = sizeof(alphabet) - 1;
+
+    unsigned char* data = (unsigned char*)malloc(size);
+    if (data == NULL) {
+        fprintf(stderr, "Erro: Falha na alocação de memória para os dados\n");
+        exit(EXIT_FAILURE);
+    }
+
+    unsigned long state = 54321;
+    for (size_t i = 0; i < size; i++) {
+        state = state * 1103515245 + 12345;
+        int index = (int)((state >> 16) % alphabet_size);
+        // Metade dos símbolos repete o mais frequente
+        data[i] = ((state >> 8) & 1) ? '0' : (unsigned char)alphabet[index];
+    }
+
+    return data;
+}
+
+/**
+ * Constrói a árvore de Huffman para um buffer de dados
+ */
+static HuffmanNode* buildTreeForData(const unsigned char* data, size_t size) {
+    unsigned long frequencies[MAX_CHAR] = {0};
+    for (size_t i = 0; i < size; i++) {
+        frequencies[data[i]]++;
+    }
+
+    return buildHuffmanTree(frequencies);
+}
+
+/**
+ * Monta a tabela de códigos inteiros para um buffer de dados
+ */
+static void buildTableForData(const unsigned char* data, size_t size, CodeTable* table) {
+    HuffmanNode* root = buildTreeForData(data, size);
+    char codes[MAX_CHAR][MAX_TREE_HT] = {{0}};
+    char current_code[MAX_TREE_HT] = {0};
+    generateHuffmanCodes(root, current_code, 0, codes);
+    buildCodeTable(codes, table);
+    freeHuffmanTree(root);
+}
+
+/**
+ * Mede o tempo médio de codificação de um buffer
+ * @param use_pairs 1 para construir e usar a tabela de pares
+ * @return Segundos por execução (incluindo a construção da tabela de pares)
+ */
+static double timeEncode(const unsigned char* data, size_t size, const CodeTable* table,
+                         unsigned char* out, size_t out_capacity, int use_pairs) {
+    int runs = 0;
+    double start = nowSeconds();
+    double elapsed;
+
+    do {
+        PairCodeTable* pairs = use_pairs ? buildPairCodeTable(table) : NULL;
+        BitWriter writer;
+        initBitWriter(&writer, out, out_capacity, NULL);
+        encodeSymbols(&writer, data, size, table, pairs);
+        flushBitWriter(&writer);
+        freePairCodeTable(pairs);
+        runs++;
+        elapsed = nowSeconds() - start;
+    } while (elapsed < BENCH_MIN_SECONDS);
+
+    return elapsed / runs;
+}
+
+/**
+ * Compara a codificação com tabela simples e com tabela de pares
+ * para tamanhos crescentes de entrada e mostra o ponto de cruzamento
+ */
+static void benchPairEncoding(void) {
+    printf("=== Codificação: tabela simples vs. tabela de pares ===\n");
+    printf("%10s | %12s | %12s | %8s\n", "Tamanho", "Simples MB/s", "Pares MB/s", "Ganho");
+    printf("-----------|--------------|--------------|---------\n");
+
+    const size_t max_size = 16 * 1024 * 1024;
+    unsigned char* data = generateTextData(max_size);
+    unsigned char* out = (unsigned char*)malloc(max_size + 16);
+    if (out == NULL) {
+        fprintf(stderr, "Erro: Falha na alocação de memória para a saída\n");
+        exit(EXIT_FAILURE);
+    }
+
+    size_t crossover = 0;
+    for (size_t size = 1024; size <= max_size; size *= 4) {
+        CodeTable table;
+        buildTableForData(data, size, &table);
+
+        double single = timeEncode(data, size, &table, out, max_size + 16, 0);
+        double paired = timeEncode(data, size, &table, out, max_size + 16, 1);
+        double mb = size / (1024.0 * 1024.0);
+
+        printf("%8zu K | %12.1f | %12.1f | %7.2fx\n",
+               size / 1024, mb / single, mb / paired, single / paired);
+
+        if (crossover == 0 && paired < single) {
+            crossover = size;
+        }
+    }
+
+    if (crossover > 0) {
+        printf("Ponto de cruzamento: ~%zu KiB (limiar atual: %d KiB)\n\n",
+               crossover / 1024, PAIR_TABLE_MIN_INPUT / 1024);
+    } else {
+        printf("Tabela de pares não compensou nos tamanhos testados\n\n");
+    }
+
+    free(out);
+    free(data);
+}
+
+/**
+ * Mede o tempo médio de decodificação de um fluxo em memória
+ * @return Segundos por execução (incluindo a construção da tabela)
+ */
+static double timeDecode(HuffmanNode* root, DecodeMode mode, const unsigned char* encoded,
+                         size_t encoded_size, unsigned char* out, size_t size) {
+    int runs = 0;
+    double start = nowSeconds();
+    double elapsed;
+
+    do {
+        DecodeTable* table = buildDecodeTable(root, mode);
+        BitReader reader;
+        initBitReaderFromMemory(&reader, encoded, encoded_size);
+        decodeSymbols(&reader, table, out, size);
+        freeDecodeTable(table);
+        runs++;
+        elapsed = nowSeconds() - start;
+    } while (elapsed < BENCH_MIN_SECONDS);
+
+    return elapsed / runs;
+}
+
+/**
+ * Compara a decodificação com um e com vários símbolos por consulta
+ * em dados de texto e em dados muito enviesados
+ */
+static void benchMultiSymbolDecoding(void) {
+    printf("=== Decodificação: um símbolo vs. vários símbolos por consulta ===\n");
+    printf("%10s | %9s | %11s | %11s | %6s | %8s\n",
+           "Dados", "Bits/símb", "Simples MB/s", "Multi MB/s", "Ganho", "Auto");
+    printf("-----------|-----------|-------------|-------------|--------|---------\n");
+
+    const size_t size = 8 * 1024 * 1024;
+    const char* names[] = { "texto", "enviesado" };
+    unsigned char* inputs[] = { generateTextData(size), generateSkewedData(size) };
+
+    unsigned char* encoded = (unsigned char*)malloc(size + 16);
+    unsigned char* decoded = (unsigned char*)malloc(size + MULTI_SYMBOL_MAX);
+    if (encoded == NULL || decoded == NULL) {
+        fprintf(stderr, "Erro: Falha na alocação de memória para os buffers\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (int k = 0; k < 2; k++) {
+        HuffmanNode* root = buildTreeForData(inputs[k], size);
+        char codes[MAX_CHAR][MAX_TREE_HT] = {{0}};
+        char current_code[MAX_TREE_HT] = {0};
+        generateHuffmanCodes(root, current_code, 0, codes);
+        CodeTable table;
+        buildCodeTable(codes, &table);
+
+        BitWriter writer;
+        initBitWriter(&writer, encoded, size + 16, NULL);
+        encodeSymbols(&writer, inputs[k], size, &table, NULL);
+        flushBitWriter(&writer);
+        size_t encoded_size = writer.position;
+
+        double single = timeDecode(root, DECODE_MODE_SINGLE, encoded, encoded_size, decoded, size);
+        double multi = timeDecode(root, DECODE_MODE_MULTI, encoded, encoded_size, decoded, size);
+        DecodeTable* automatic = buildDecodeTable(root, DECODE_MODE_AUTO);
+        double mb = size / (1024.0 * 1024.0);
+
+        printf("%10s | %9.2f | %11.1f | %11.1f | %5.2fx | %8s\n",
+               names[k], encoded_size * 8.0 / size, mb / single, mb / multi, single / multi,
+               automatic->mode == DECODE_MODE_MULTI ? "multi" : "simples");
+
+        freeDecodeTable(automatic);
+        freeHuffmanTree(root);
+        free(inputs[k]);
+    }
+    printf("\n");
+
+    free(encoded);
+    free(decoded);
+}
+
+/**
+ * Mede o tempo médio da contagem de frequências de um buffer
+ * @return Segundos por execução
+ */
+static double timeHistogram(const unsigned char* data, size_t size) {
+    int runs = 0;
+    double start = nowSeconds();
+    double elapsed;
+
+    do {
+        unsigned long frequencies[MAX_CHAR] = {0};
+        countFrequencies(data, size, frequencies);
+        runs++;
+        elapsed = nowSeconds() - start;
+    } while (elapsed < BENCH_MIN_SECONDS);
+
+    return elapsed / runs;
+}
+
+/**
+ * Compara as variantes de kernel suportadas pela CPU
+ * (contagem de frequências, codificação e decodificação)
+ */
+static void benchCpuVariants(void) {
+    printf("=== Kernels por variante de CPU (detectada: %s) ===\n",
+           cpuVariantName(detectCpuVariant()));
+    printf("%10s | %14s | %14s | %14s\n", "Variante", "Contagem MB/s", "Codif. MB/s", "Decodif. MB/s");
+    printf("-----------|----------------|----------------|---------------\n");
+
+    const size_t size = 8 * 1024 * 1024;
+    unsigned char* data = generateTextData(size);
+    unsigned char* encoded = (unsigned char*)malloc(size + 16);
+    unsigned char* decoded = (unsigned char*)malloc(size + MULTI_SYMBOL_MAX);
+    if (encoded == NULL || decoded == NULL) {
+        fprintf(stderr, "Erro: Falha na alocação de memória para os buffers\n");
+        exit(EXIT_FAILURE);
+    }
+
+    HuffmanNode* root = buildTreeForData(data, size);
+    CodeTable table;
+    buildTableForData(data, size, &table);
+
+    BitWriter writer;
+    initBitWriter(&writer, encoded, size + 16, NULL);
+    encodeSymbols(&writer, data, size, &table, NULL);
+    flushBitWriter(&writer);
+    size_t encoded_size = writer.position;
+    double mb = size / (1024.0 * 1024.0);
+
+    for (int v = 0; v < CPU_VARIANT_COUNT; v++) {
+        if (setCpuVariant((CpuVariant)v) != 0) {
+            printf("%10s | %14s | %14s | %14s\n", cpuVariantName((CpuVariant)v), "-", "-", "-");
+            continue;
+        }
+
+        double histogram = timeHistogram(data, size);
+        double encode = timeEncode(data, size, &table, encoded, size + 16, 0);
+        double decode = timeDecode(root, DECODE_MODE_AUTO, encoded, encoded_size, decoded, size);
+
+        printf("%10s | %14.1f | %14.1f | %14.1f\n", cpuVariantName((CpuVariant)v),
+               mb / histogram, mb / encode, mb / decode);
+    }
+    printf("\n");
+
+    setCpuVariant(detectCpuVariant());
+    freeHuffmanTree(root);
+    free(data);
+    free(encoded);
+    free(decoded);
+}
+
+/**
+ * Mede a contagem de frequências de um arquivo com 1, 2, 4... threads
+ * (o arquivo é lido uma vez antes, para medir a partir do cache de páginas)
+ */
+static void benchParallelHistogram(void) {
+    printf("=== Contagem de frequências por trechos (pread) ===\n");
+    printf("%10s | %14s\n", "Threads", "Contagem MB/s");
+    printf("-----------|---------------\n");
+
+    const size_t size = 64 * 1024 * 1024;
+    unsigned char* data = generateTextData(size);
+    FILE* file = tmpfile();
+    if (file == NULL || fwrite(data, 1, size, file) != size || fflush(file) != 0) {
+        fprintf(stderr, "Erro: Não foi possível criar o arquivo temporário\n");
+        exit(EXIT_FAILURE);
+    }
+    free(data);
+
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    double mb = size / (1024.0 * 1024.0);
+    for (int threads = 1; threads <= (online > 1 ? online : 1) && threads <= PARALLEL_HISTOGRAM_MAX_THREADS; threads *= 2) {
+        unsigned long frequencies[MAX_CHAR] = {0};
+        countFileFrequencies(fileno(file), (int64_t)size, threads, frequencies);
+
+        int runs = 0;
+        double start = nowSeconds();
+        double elapsed;
+        do {
+            memset(frequencies, 0, sizeof(frequencies));
+            countFileFrequencies(fileno(file), (int64_t)size, threads, frequencies);
+            runs++;
+            elapsed = nowSeconds() - start;
+        } while (elapsed < BENCH_MIN_SECONDS);
+
+        printf("%10d | %14.1f\n", threads, mb * runs / elapsed);
+    }
+    printf("\n");
+
+    fclose(file);
+}
+
+/**
+ * Mede uma ida e volta por arquivos temporários
+ * @param adaptive 1 para o formato adaptativo, 0 para o formato em blocos
+ * @param data Dados de entrada
+ * @param size Bytes de entrada
+ * @param encode_seconds Tempo de compressão
+ * @param decode_seconds Tempo de descompressão
+ * @return Bytes comprimidos
+ */
+static long timeStreamRoundTrip(int adaptive, const unsigned char* data, size_t size,
+                                double* encode_seconds, double* decode_seconds) {
+    FILE* input = tmpfile();
+    FILE* compressed = tmpfile();
+    FILE* output = tmpfile();
+    if (input == NULL || compressed == NULL || output == NULL) {
+        fprintf(stderr, "Erro: Não foi possível criar arquivos temporários\n");
+        exit(EXIT_FAILURE);
+    }
+    fwrite(data, 1, size, input);
+    rewind(input);
+
+    double start = nowSeconds();
+    if (adaptive) {
+        compressStreamAdaptive(input, compressed);
+    } else {
+        compressStreamBlocks(input, compressed, NULL, NULL);
+    }
+    fflush(compressed);
+    *encode_seconds = nowSeconds() - start;
+    long compressed_size = ftell(compressed);
+
+    rewind(compressed);
+    start = nowSeconds();
+    if (adaptive) {
+        decompressStreamAdaptive(compressed, output);
+    } else {
+        decompressStreamBlocks(compressed, output, NULL, NULL);
+    }
+    fflush(output);
+    *decode_seconds = nowSeconds() - start;
+
+    fclose(input);
+    fclose(compressed);
+    fclose(output);
+    return compressed_size;
+}
+
+/**
+ * Compara o Huffman adaptativo (uma passagem, sem cabeçalho) com o formato
+ * estático em blocos
+ */
+static void benchAdaptive(void) {
+    printf("=== Adaptativo (FGK) vs. estático em blocos ===\n");
+    printf("%10s | %12s | %14s | %14s\n", "Formato", "Tamanho", "Compr. MB/s", "Descompr. MB/s");
+    printf("-----------|--------------|----------------|---------------\n");
+
+    const size_t size = 4 * 1024 * 1024;
+    unsigned char* data = generateTextData(size);
+    double mb = size / (1024.0 * 1024.0);
+    const char* names[] = {"blocos", "adaptativo"};
+
+    for (int adaptive = 0; adaptive <= 1; adaptive++) {
+        double encode;
+        double decode;
+        long compressed = timeStreamRoundTrip(adaptive, data, size, &encode, &decode);
+        printf("%10s | %12ld | %14.1f | %14.1f\n", names[adaptive], compressed, mb / encode, mb / decode);
+    }
+    printf("\n");
+
+    free(data);
+}
+
+/**
+ * Mede cada nível de compressão (-1 a -9) sobre texto intercalado com
+ * trechos de log, mostrando a velocidade contra a razão de compressão
+ */
+static void benchLevels(void) {
+    printf("=== Níveis de compressão (velocidade vs. razão) ===\n");
+    printf("%6s | %12s | %8s | %14s | %14s\n", "Nível", "Tamanho", "Razão", "Compr. MB/s", "Descompr. MB/s");
+    printf("-------|--------------|----------|----------------|---------------\n");
+
+    // Trechos de 192 KiB alternando os dois geradores
+    const size_t size = 8 * 1024 * 1024;
+    const size_t segment = 192 * 1024;
+    unsigned char* text = generateTextData(size);
+    unsigned char* skewed = generateSkewedData(size);
+    for (size_t start = segment; start < size; start += 2 * segment) {
+        size_t length = size - start < segment ? size - start : segment;
+        memcpy(text + start, skewed + start, length);
+    }
+    double mb = size / (1024.0 * 1024.0);
+
+    FILE* input = tmpfile();
+    if (input == NULL) {
+        fprintf(stderr, "Erro: Não foi possível criar arquivos temporários\n");
+        exit(EXIT_FAILURE);
+    }
+    fwrite(text, 1, size, input);
+
+    for (int level = COMPRESSION_LEVEL_MIN; level <= COMPRESSION_LEVEL_MAX; level++) {
+        FILE* compressed = tmpfile();
+        FILE* output = tmpfile();
+        if (compressed == NULL || output == NULL) {
+            fprintf(stderr, "Erro: Não foi possível criar arquivos temporários\n");
+            exit(EXIT_FAILURE);
+        }
+
+        BlockWorkspace workspace;
+        initBlockWorkspace(&workspace);
+        workspace.level = level;
+        rewind(input);
+        double start = nowSeconds();
+        compressStreamBlocksWith(input, compressed, NULL, NULL, &workspace);
+        fflush(compressed);
+        double encode = nowSeconds() - start;
+        freeBlockWorkspace(&workspace);
+        long compressed_size = ftell(compressed);
+
+        rewind(compressed);
+        start = nowSeconds();
+        decompressStreamBlocks(compressed, output, NULL, NULL);
+        fflush(output);
+        double decode = nowSeconds() - start;
+
+        printf("%5d%s | %12ld | %7.2f%% | %14.1f | %14.1f\n", level,
+               level == COMPRESSION_LEVEL_DEFAULT ? "*" : " ", compressed_size,
+               100.0 * compressed_size / size, mb / encode, mb / decode);
+        fclose(compressed);
+        fclose(output);
+    }
+    printf("(* nível padrão do formato em blocos)\n\n");
+
+    fclose(input);
+    free(text);
+    free(skewed);
+}
+
+/**
+ * Mede o custo do progresso no laço de blocos (sem callback vs. com relatório)
+ */
+static void benchProgress(void) {
+    printf("=== Progresso no laço de blocos ===\n");
+    printf("%12s | %14s\n", "Progresso", "Compr. MB/s");
+    printf("-------------|---------------\n");
+
+    const size_t size = 32 * 1024 * 1024;
+    unsigned char* data = generateTextData(size);
+    double mb = size / (1024.0 * 1024.0);
+    FILE* input = tmpfile();
+    if (input == NULL) {
+        fprintf(stderr, "Erro: Não foi possível criar arquivos temporários\n");
+        exit(EXIT_FAILURE);
+    }
+    fwrite(data, 1, size, input);
+
+    // Blocos pequenos aumentam o número de atualizações por segundo
+    MemoryPlan plan;
+    planMemoryBudget(0, &plan);
+    plan.block_size = 64 * 1024;
+
+    const char* names[] = {"desligado", "ligado"};
+    for (int enabled = 0; enabled <= 1; enabled++) {
+        FILE* compressed = tmpfile();
+        if (compressed == NULL) {
+            fprintf(stderr, "Erro: Não foi possível criar arquivos temporários\n");
+            exit(EXIT_FAILURE);
+        }
+
+        ProgressTracker tracker;
+        initProgressTracker(&tracker, size, 1, NULL, NULL);
+        BlockWorkspace workspace;
+        initBlockWorkspace(&workspace);
+        workspace.progress = enabled ? &tracker : NULL;
+
+        rewind(input);
+        double start = nowSeconds();
+        compressStreamBlocksWith(input, compressed, &plan, NULL, &workspace);
+        double elapsed = nowSeconds() - start;
+        freeBlockWorkspace(&workspace);
+        fclose(compressed);
+
+        printf("%12s | %14.1f\n", names[enabled], mb / elapsed);
+    }
+    printf("\n");
+
+    fclose(input);
+    free(data);
+}
+
+/**
+ * Compara a estimativa de tamanho (só frequências) com a compressão em blocos
+ */
+static void benchEstimate(void) {
+    printf("=== Estimativa de tamanho vs. compressão ===\n");
+    printf("%14s | %14s | %12s\n", "Operação", "MB/s", "Tamanho");
+    printf("-------------|----------------|-------------\n");
+
+    const size_t size = 32 * 1024 * 1024;
+    unsigned char* data = generateTextData(size);
+    double mb = size / (1024.0 * 1024.0);
+    FILE* input = tmpfile();
+    FILE* compressed = tmpfile();
+    if (input == NULL || compressed == NULL) {
+        fprintf(stderr, "Erro: Não foi possível criar arquivos temporários\n");
+        exit(EXIT_FAILURE);
+    }
+    fwrite(data, 1, size, input);
+
+    rewind(input);
+    SizeEstimate estimate;
+    double start = nowSeconds();
+    estimateStreamSize(input, NULL, &estimate);
+    double elapsed = nowSeconds() - start;
+    printf("%12s | %14.1f | %12llu\n", "estimativa", mb / elapsed, (unsigned long long)estimate.block_bytes);
+
+    rewind(input);
+    start = nowSeconds();
+    compressStreamBlocks(input, compressed, NULL, NULL);
+    fflush(compressed);
+    elapsed = nowSeconds() - start;
+    printf("%13s | %14.1f | %12ld\n", "compressão", mb / elapsed, ftell(compressed));
+    printf("\n");
+
+    fclose(input);
+    fclose(compressed);
+    free(data);
+}
+
+static void benchTransforms(void) {
+    printf("=== Transformações antes da codificação (blocos de 1 MiB) ===\n");
+    printf("%14s | %12s | %12s | %10s | %10s\n", "Dados", "Sem transf.", "Auto", "MB/s comp.", "MB/s desc.");
+    printf("---------------|--------------|--------------|------------|-----------\n");
+
+    // Texto, registros esparsos (zeros) e leituras de sensor que variam devagar
+    const size_t size = 16 * 1024 * 1024;
+    const char* names[] = {"texto", "esparsos", "sensor"};
+    double mb = size / (1024.0 * 1024.0);
+    MemoryPlan plan;
+    planMemoryBudget(0, &plan);
+
+    for (int kind = 0; kind < 3; kind++) {
+        unsigned char* data = kind == 0 ? generateTextData(size) : (unsigned char*)malloc(size);
+        if (data == NULL) {
+            fprintf(stderr, "Erro: Falha na alocação de memória\n");
+            exit(EXIT_FAILURE);
+        }
+        unsigned int seed = 5;
+        int value = 0;
+        for (size_t i = 0; kind > 0 && i < size; i++) {
+            seed = seed * 1103515245u + 12345u;
+            value += (int)((seed >> 16) % 5) - 2;
+            data[i] = kind == 1 ? (i % 64 < 4 ? (unsigned char)(seed >> 16) : 0) : (unsigned char)value;
+        }
+
+        FILE* input = tmpfile();
+        FILE* plain = tmpfile();
+        FILE* transformed = tmpfile();
+        FILE* restored = tmpfile();
+        if (input == NULL || plain == NULL || transformed == NULL || restored == NULL) {
+            fprintf(stderr, "Erro: Não foi possível criar arquivos temporários\n");
+            exit(EXIT_FAILURE);
+        }
+        fwrite(data, 1, size, input);
+
+        rewind(input);
+        compressStreamBlocks(input, plain, &plan, NULL);
+
+        BlockWorkspace workspace;
+        initBlockWorkspace(&workspace);
+        workspace.transforms = TRANSFORM_ALL;
+        rewind(input);
+        double start = nowSeconds();
+        compressStreamBlocksWith(input, transformed, &plan, NULL, &workspace);
+        fflush(transformed);
+        double compress_time = nowSeconds() - start;
+        freeBlockWorkspace(&workspace);
+
+        rewind(transformed);
+        start = nowSeconds();
+        decompressStreamBlocks(transformed, restored, &plan, NULL);
+        double decompress_time = nowSeconds() - start;
+
+        printf("%14s | %12ld | %12ld | %10.1f | %10.1f\n", names[kind], ftell(plain), ftell(transformed),
+               mb / compress_time, mb / decompress_time);
+
+        fclose(input);
+        fclose(plain);
+        fclose(transformed);
+        fclose(restored);
+        free(data);
+    }
+    printf("\n");
+}
+
+/**
+ * Compara a decodificação em série de um único fluxo com a decodificação
+ * paralela por autossincronização
+ */
+static void benchParallelDecode(void) {
+    printf("=== Decodificação paralela de um único fluxo (autossincronização) ===\n");
+    printf("%10s | %12s | %14s | %14s\n", "Threads", "MB/s", "Sincronizados", "Símb. extras");
+    printf("-----------|--------------|----------------|---------------\n");
+
+    const size_t size = 32 * 1024 * 1024;
+    unsigned char* data = generateTextData(size);
+    unsigned char* encoded = (unsigned char*)malloc(size + 16);
+    unsigned char* decoded = (unsigned char*)malloc(size + MULTI_SYMBOL_MAX);
+    if (encoded == NULL || decoded == NULL) {
+        fprintf(stderr, "Erro: Falha na alocação de memória para os buffers\n");
+        exit(EXIT_FAILURE);
+    }
+
+    HuffmanNode* root = buildTreeForData(data, size);
+    char code_strings[MAX_CHAR][MAX_TREE_HT] = {{0}};
+    char current_code[MAX_TREE_HT] = {0};
+    generateHuffmanCodes(root, current_code, 0, code_strings);
+    CodeTable codes;
+    buildCodeTable(code_strings, &codes);
+    BitWriter writer;
+    initBitWriter(&writer, encoded, size + 16, NULL);
+    encodeSymbols(&writer, data, size, &codes, NULL);
+    flushBitWriter(&writer);
+    size_t encoded_size = writer.position;
+
+    DecodeTable* table = buildDecodeTable(root, DECODE_MODE_AUTO);
+    double mb = size / (1024.0 * 1024.0);
+
+    // Referência: o laço em série de readCompressedData
+    int runs = 0;
+    double start = nowSeconds();
+    double elapsed;
+    do {
+        BitReader reader;
+        initBitReaderFromMemory(&reader, encoded, encoded_size);
+        decodeSymbols(&reader, table, decoded, size);
+        runs++;
+        elapsed = nowSeconds() - start;
+    } while (elapsed < BENCH_MIN_SECONDS);
+    printf("%10s | %12.1f | %14s | %14s\n", "série", mb * runs / elapsed, "-", "-");
+
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    int max_threads = online > 4 ? (int)online : 4;
+    for (int threads = 2; threads <= max_threads && threads <= PARALLEL_DECODE_MAX_THREADS; threads *= 2) {
+        ParallelDecodeStats stats;
+        runs = 0;
+        start = nowSeconds();
+        do {
+            ByteSink sink;
+            initMemorySink(&sink);
+            decodeStreamParallel(encoded, encoded_size, table, (int64_t)size, &sink, threads, &stats);
+            closeSink(&sink);
+            runs++;
+            elapsed = nowSeconds() - start;
+        } while (elapsed < BENCH_MIN_SECONDS);
+
+        printf("%10d | %12.1f | %14llu | %14llu\n", threads, mb * runs / elapsed,
+               (unsigned long long)stats.synchronized, (unsigned long long)stats.resync_symbols);
+    }
+    printf("\n");
+
+    freeDecodeTable(table);
+    freeHuffmanTree(root);
+    free(decoded);
+    free(encoded);
+    free(data);
+}
+
+/**
+ * Compara a codificação em série de um único fluxo com a codificação
+ * paralela com tabela única e costura por posição em bits
+ */
+static void benchParallelEncode(void) {
+    printf("=== Codificação paralela com tabela única (soma de prefixos) ===\n");
+    printf("%10s | %12s | %10s\n", "Threads", "MB/s", "Rodadas");
+    printf("-----------|--------------|-----------\n");
+
+    const size_t size = 32 * 1024 * 1024;
+    unsigned char* data = generateTextData(size);
+    unsigned char* encoded = (unsigned char*)malloc(size + 16);
+    if (encoded == NULL) {
+        fprintf(stderr, "Erro: Falha na alocação de memória para os buffers\n");
+        exit(EXIT_FAILURE);
+    }
+
+    CodeTable table;
+    buildTableForData(data, size, &table);
+    PairCodeTable* pairs = buildPairCodeTable(&table);
+    double mb = size / (1024.0 * 1024.0);
+
+    // Referência: o laço em série de writeCompressedData
+    int runs = 0;
+    double start = nowSeconds();
+    double elapsed;
+    do {
+        BitWriter writer;
+        initBitWriter(&writer, encoded, size + 16, NULL);
+        encodeSymbols(&writer, data, size, &table, pairs);
+        flushBitWriter(&writer);
+        runs++;
+        elapsed = nowSeconds() - start;
+    } while (elapsed < BENCH_MIN_SECONDS);
+    printf("%10s | %12.1f | %10s\n", "série", mb * runs / elapsed, "-");
+
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    int max_threads = online > 4 ? (int)online : 4;
+    for (int threads = 2; threads <= max_threads && threads <= PARALLEL_ENCODE_MAX_THREADS; threads *= 2) {
+        ParallelEncodeStats stats;
+        runs = 0;
+        start = nowSeconds();
+        do {
+            ByteSink sink;
+            initMemorySink(&sink);
+            encodeStreamParallel(data, size, &table, pairs, &sink, threads, &stats);
+            closeSink(&sink);
+            runs++;
+            elapsed = nowSeconds() - start;
+        } while (elapsed < BENCH_MIN_SECONDS);
+
+        printf("%10d | %12.1f | %10llu\n", threads, mb * runs / elapsed, (unsigned long long)stats.rounds);
+    }
+    printf("\n");
+
+    freePairCodeTable(pairs);
+    free(encoded);
+    free(data);
+}
+
+/**
+ * Compara o laço em série dos blocos com o pipeline de estágios em threads
+ * e mostra a ocupação média das filas entre os estágios
+ */
+static void benchPipeline(void) {
+    printf("=== Pipeline de blocos: leitura, análise, codificação e gravação em threads ===\n");
+    printf("%10s | %12s | %12s | %s\n", "Modo", "MB/s comp.", "MB/s desc.", "Ocupação das filas (compressão)");
+    printf("-----------|--------------|--------------|--------------------------------\n");
+
+    const size_t size = 32 * 1024 * 1024;
+    unsigned char* data = generateTextData(size);
+    double mb = size / (1024.0 * 1024.0);
+    MemoryPlan plan;
+    planMemoryBudget(0, &plan);
+
+    FILE* input = tmpfile();
+    if (input == NULL) {
+        fprintf(stderr, "Erro: Não foi possível criar arquivos temporários\n");
+        exit(EXIT_FAILURE);
+    }
+    fwrite(data, 1, size, input);
+
+    for (int pipelined = 0; pipelined < 2; pipelined++) {
+        FILE* compressed = tmpfile();
+        FILE* restored = tmpfile();
+        if (compressed == NULL || restored == NULL) {
+            fprintf(stderr, "Erro: Não foi possível criar arquivos temporários\n");
+            exit(EXIT_FAILURE);
+        }
+
+        BlockWorkspace workspace;
+        initBlockWorkspace(&workspace);
+        workspace.level = 6;
+        workspace.transforms = TRANSFORM_ALL;
+        workspace.pipeline = pipelined;
+        BlockStats stats;
+        rewind(input);
+        double start = nowSeconds();
+        compressStreamBlocksWith(input, compressed, &plan, &stats, &workspace);
+        fflush(compressed);
+        double compress_time = nowSeconds() - start;
+        freeBlockWorkspace(&workspace);
+
+        initBlockWorkspace(&workspace);
+        workspace.pipeline = pipelined;
+        rewind(compressed);
+        start = nowSeconds();
+        decompressStreamBlocksWith(compressed, restored, &plan, NULL, &workspace);
+        fflush(restored);
+        double decompress_time = nowSeconds() - start;
+        freeBlockWorkspace(&workspace);
+
+        printf("%10s | %12.1f | %12.1f |", pipelined ? "pipeline" : "série",
+               mb / compress_time, mb / decompress_time);
+        for (int q = 0; q < stats.pipeline_stages - 1; q++) {
+            printf(" %.2f/%zu", stats.queues[q].average_occupancy, stats.queues[q].capacity);
+        }
+        printf("%s\n", pipelined ? "" : " -");
+
+        fclose(compressed);
+        fclose(restored);
+    }
+    printf("\n");
+
+    fclose(input);
+    free(data);
+}
+
+/**
+ * Compara os blocos codificados por bytes com o alfabeto de 16 bits em
+ * texto UTF-16, amostras de 16 bits e texto comum
+ */
+static void benchWideSymbols(void) {
+    printf("=== Alfabeto de 16 bits contra bytes (blocos de 1 MiB) ===\n");
+    printf("%10s | %7s | %12s | %10s | %10s\n", "Dados", "Modo", "Bytes", "MB/s comp.", "MB/s desc.");
+    printf("-----------|---------|--------------|------------|-----------\n");
+
+    const size_t size = 16 * 1024 * 1024;
+    const char* names[] = {"UTF-16", "sensor", "texto"};
+    double mb = size / (1024.0 * 1024.0);
+    MemoryPlan plan;
+    planMemoryBudget(0, &plan);
+
+    for (int kind = 0; kind < 3; kind++) {
+        unsigned char* data = kind == 1 ? (unsigned char*)malloc(size) : generateTextData(kind == 0 ? size / 2 : size);
+        if (data == NULL) {
+            fprintf(stderr, "Erro: Falha na alocação de memória\n");
+            exit(EXIT_FAILURE);
+        }
+        if (kind == 0) {
+            // Texto em UTF-16LE: letras acentuadas e ideogramas no lugar de algumas letras
+            unsigned char* wide = (unsigned char*)malloc(size);
+            if (wide == NULL) {
+                fprintf(stderr, "Erro: Falha na alocação de memória\n");
+                exit(EXIT_FAILURE);
+            }
+            for (size_t i = 0; i < size / 2; i++) {
+                unsigned int c = data[i];
+                c = c == 'a' ? 0xE3 : c == 'o' ? 0x65E5 : c == 'e' ? 0x672C : c;
+                wide[2 * i] = (unsigned char)c;
+                wide[2 * i + 1] = (unsigned char)(c >> 8);
+            }
+            free(data);
+            data = wide;
+        } else if (kind == 1) {
+            // Amostras de 12 bits em palavras de 16 bits que variam devagar
+            unsigned int seed = 9;
+            int value = 2048;
+            for (size_t i = 0; i < size; i += 2) {
+                seed = seed * 1103515245u + 12345u;
+                value += (int)((seed >> 16) % 9) - 4;
+                value = value < 0 ? 0 : value > 4095 ? 4095 : value;
+                data[i] = (unsigned char)value;
+                data[i + 1] = (unsigned char)(value >> 8);
+            }
+        }
+
+        FILE* input = tmpfile();
+        if (input == NULL) {
+            fprintf(stderr, "Erro: Não foi possível criar arquivos temporários\n");
+            exit(EXIT_FAILURE);
+        }
+        fwrite(data, 1, size, input);
+
+        for (int wide = 0; wide < 2; wide++) {
+            FILE* compressed = tmpfile();
+            FILE* restored = tmpfile();
+            if (compressed == NULL || restored == NULL) {
+                fprintf(stderr, "Erro: Não foi possível criar arquivos temporários\n");
+                exit(EXIT_FAILURE);
+            }
+
+            BlockWorkspace workspace;
+            initBlockWorkspace(&workspace);
+            workspace.wide = wide;
+            rewind(input);
+            double start = nowSeconds();
+            compressStreamBlocksWith(input, compressed, &plan, NULL, &workspace);
+            fflush(compressed);
+            double compress_time = nowSeconds() - start;
+            freeBlockWorkspace(&workspace);
+
+            rewind(compressed);
+            start = nowSeconds();
+            decompressStreamBlocks(compressed, restored, &plan, NULL);
+            fflush(restored);
+            double decompress_time = nowSeconds() - start;
+
+            printf("%10s | %7s | %12ld | %10.1f | %10.1f\n", names[kind], wide ? "16 bits" : "bytes",
+                   ftell(compressed), mb / compress_time, mb / decompress_time);
+
+            fclose(compressed);
+            fclose(restored);
+        }
+
+        fclose(input);
+        free(data);
+    }
+    printf("\n");
+}
+
+/**
+ * Mede a API assíncrona como um laço de eventos: 64 trabalhos de 1 MiB
+ * submetidos com fila limitada e recolhidos quando o descritor fica legível
+ */
+static void benchAsyncCodec(void) {
+    printf("=== API assíncrona: 64 trabalhos de 1 MiB, fila de 8 ===\n");
+    printf("%8s | %10s | %14s | %10s\n", "Threads", "MB/s", "Latência média", "Recusadas");
+    printf("---------|------------|----------------|-----------\n");
+
+    const int jobs = 64;
+    const size_t length = 1024 * 1024;
+    unsigned char* data = generateTextData(length * (size_t)jobs);
+    double mb = jobs * (length / (1024.0 * 1024.0));
+
+    for (int workers = 1; workers <= 4; workers *= 2) {
+        AsyncPool* pool = createAsyncPool(workers, 8, NULL);
+        struct pollfd watch = {asyncCompletionFd(pool), POLLIN, 0};
+        AsyncJob* next = NULL;
+        int submitted = 0;
+        int collected = 0;
+        uint64_t latency_sum = 0;
+
+        double start = nowSeconds();
+        while (collected < jobs) {
+            // Submete até a fila encher; o trabalho recusado espera a próxima volta
+            while (submitted < jobs) {
+                if (next == NULL) {
+                    next = createAsyncBufferJob(ASYNC_COMPRESS, data + length * (size_t)submitted, length);
+                }
+                if (submitAsyncJob(pool, next) != 0) {
+                    break;
+                }
+                next = NULL;
+                submitted++;
+            }
+            poll(&watch, 1, -1);
+            AsyncJob* done;
+            while ((done = nextAsyncCompletion(pool, 0)) != NULL) {
+                latency_sum += done->latency_us;
+                collected++;
+                freeAsyncJob(done);
+            }
+        }
+        double elapsed = nowSeconds() - start;
+
+        AsyncPoolStats stats;
+        getAsyncPoolStats(pool, &stats);
+        destroyAsyncPool(pool);
+        printf("%8d | %10.1f | %11.2f ms | %10llu\n", workers, mb / elapsed,
+               latency_sum / (double)jobs / 1000.0, (unsigned long long)stats.rejected);
+    }
+    printf("\n");
+
+    free(data);
+}
+
+/**
+ * Compara o consumo de um arquivo comprimido pelo leitor sob demanda com a
+ * descompressão para um arquivo temporário seguida da leitura dele
+ */
+static void benchHufReader(void) {
+    printf("=== Leitor sob demanda contra arquivo temporário (32 MiB, leituras de 64 KiB) ===\n");
+    printf("%22s | %10s | %12s\n", "Modo", "MB/s", "Pico de heap");
+    printf("-----------------------|------------|-------------\n");
+
+    const size_t size = 32 * 1024 * 1024;
+    unsigned char* data = generateTextData(size);
+    double mb = size / (1024.0 * 1024.0);
+    FILE* file = fopen("bench_reader.bin", "wb");
+    if (file == NULL) {
+        fprintf(stderr, "Erro: Não foi possível criar arquivos temporários\n");
+        exit(EXIT_FAILURE);
+    }
+    fwrite(data, 1, size, file);
+    fclose(file);
+    compressFileBlocks("bench_reader.bin", "bench_reader.huf", NULL, NULL);
+
+    unsigned char* chunk = (unsigned char*)malloc(64 * 1024);
+    for (int lazy = 0; lazy < 2; lazy++) {
+        size_t before = currentMemoryUsage();
+        resetPeakMemoryUsage();
+        uint64_t total = 0;
+        double start = nowSeconds();
+        if (lazy) {
+            HufReader* reader = hufOpen("bench_reader.huf");
+            ssize_t got;
+            while (reader != NULL && (got = hufRead(reader, chunk, 64 * 1024)) > 0) {
+                total += (uint64_t)got;
+            }
+            hufClose(reader);
+        } else {
+            decompressFileBlocks("bench_reader.huf", "bench_reader.out", NULL, NULL);
+            FILE* restored = fopen("bench_reader.out", "rb");
+            size_t got;
+            while (restored != NULL && (got = fread(chunk, 1, 64 * 1024, restored)) > 0) {
+                total += got;
+            }
+            if (restored != NULL) {
+                fclose(restored);
+            }
+        }
+        double elapsed = nowSeconds() - start;
+        printf("%22s | %10.1f | %9zu KB%s\n", lazy ? "hufRead" : "arquivo temporário",
+               mb / elapsed, (peakMemoryUsage() - before) / 1024, total == size ? "" : " (incompleto)");
+    }
+    printf("\n");
+
+    remove("bench_reader.bin");
+    remove("bench_reader.huf");
+    remove("bench_reader.out");
+    free(chunk);
+    free(data);
+}
+
+int main() {
+    printf("Benchmarks do Compressor Huffman Modular\n");
+    printf("========================================\n\n");
+
+    benchPairEncoding();
+    benchMultiSymbolDecoding();
+    benchCpuVariants();
+    benchParallelHistogram();
+    benchAdaptive();
+    benchLevels();
+    benchProgress();
+    benchEstimate();
+    benchTransforms();
+    benchParallelDecode();
+    benchParallelEncode();
+    benchPipeline();
+    benchWideSymbols();
+    benchAsyncCodec();
+    benchHufReader();
+
+    return 0;
+}
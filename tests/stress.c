@@ -0,0 +1,223 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include "huffman_algorithm.h"
+#include "block_format.h"
+#include "memory_budget.h"
+
+#define STRESS_DEFAULT_SIZE (5ULL << 30)           // Acima de 4 GiB: offsets não cabem em 32 bits
+#define STRESS_PATCH_SIZE (1024 * 1024)            // Trecho de texto gravado em cada posição
+#define STRESS_PATCH_INTERVAL (256ULL << 20)       // Distância entre trechos (o resto são buracos)
+#define STRESS_MAX_RSS_KIB (256 * 1024)            // RSS máximo aceito, independente da entrada
+
+/**
+ * Retorna o tempo monotônico atual em segundos
+ */
+static double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * Converte um tamanho com sufixo opcional (K, M, G) em bytes
+ * @param text Texto a ser convertido
+ * @param size Resultado em bytes
+ * @return 0 se sucesso, -1 se o texto é inválido
+ */
+static int parseSize(const char* text, uint64_t* size) {
+    char* end;
+    unsigned long long value = strtoull(text, &end, 10);
+    if (end == text) {
+        return -1;
+    }
+
+    switch (*end) {
+        case 'k': case 'K': value <<= 10; end++; break;
+        case 'm': case 'M': value <<= 20; end++; break;
+        case 'g': case 'G': value <<= 30; end++; break;
+        default: break;
+    }
+
+    *size = value;
+    return *end == '\0' ? 0 : -1;
+}
+
+/**
+ * Grava um trecho de texto sintético numa posição do arquivo
+ * @param file Arquivo aberto para escrita
+ * @param offset Posição do trecho
+ * @param length Bytes do trecho
+ * @param seed Semente (trechos diferentes têm conteúdos diferentes)
+ * @return 0 se sucesso, -1 se erro
+ */
+static int writePatch(FILE* file, uint64_t offset, size_t length, unsigned int seed) {
+    static const char* words[] = {"bloco ", "offset ", "arquivo ", "huffman ", "64 ", "bits ", "\n"};
+    unsigned char* data = (unsigned char*)malloc(length);
+    if (data == NULL) {
+        fprintf(stderr, "Erro: Falha na alocação de memória para os dados\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (size_t i = 0; i < length; ) {
+        seed = seed * 1103515245u + 12345u;
+        const char* word = words[(seed >> 16) % 7];
+        for (size_t j = 0; word[j] != '\0' && i < length; j++) {
+            data[i++] = (unsigned char)word[j];
+        }
+    }
+
+    int result = fseeko(file, (off_t)offset, SEEK_SET) == 0 && fwrite(data, 1, length, file) == length ? 0 : -1;
+    free(data);
+    return result;
+}
+
+/**
+ * Cria a entrada esparsa: buracos de zeros com trechos de texto a cada
+ * STRESS_PATCH_INTERVAL, mais um trecho cruzando a fronteira de 4 GiB e
+ * outro no fim do arquivo
+ * @param filename Nome do arquivo
+ * @param size Tamanho total
+ * @return 0 se sucesso, -1 se erro
+ */
+static int createSparseInput(const char* filename, uint64_t size) {
+    FILE* file = fopen(filename, "wb");
+    if (file == NULL || ftruncate(fileno(file), (off_t)size) != 0) {
+        fprintf(stderr, "Erro: Não foi possível criar '%s'\n", filename);
+        if (file != NULL) fclose(file);
+        return -1;
+    }
+
+    int result = 0;
+    unsigned int seed = 1;
+    for (uint64_t offset = 0; offset + STRESS_PATCH_SIZE <= size && result == 0; offset += STRESS_PATCH_INTERVAL) {
+        result = writePatch(file, offset, STRESS_PATCH_SIZE, seed++);
+    }
+    if (result == 0 && size > (4ULL << 30) + STRESS_PATCH_SIZE) {
+        result = writePatch(file, (4ULL << 30) - STRESS_PATCH_SIZE / 2, STRESS_PATCH_SIZE, seed++);
+    }
+    if (result == 0 && size >= STRESS_PATCH_SIZE) {
+        result = writePatch(file, size - STRESS_PATCH_SIZE, STRESS_PATCH_SIZE, seed++);
+    }
+
+    if (fclose(file) != 0) {
+        result = -1;
+    }
+    return result;
+}
+
+/**
+ * Imprime o resultado de uma etapa com a vazão
+ * @param name Nome da etapa
+ * @param ok 1 se a etapa passou
+ * @param bytes Bytes originais processados
+ * @param seconds Tempo gasto
+ * @return 1 se passou, 0 caso contrário
+ */
+static int reportStep(const char* name, int ok, uint64_t bytes, double seconds) {
+    printf("%s %-28s %8.2f s  %8.1f MB/s\n", ok ? "✓" : "✗", name, seconds,
+           seconds > 0 ? bytes / seconds / 1e6 : 0.0);
+    return ok;
+}
+
+int main(int argc, char* argv[]) {
+    uint64_t size = STRESS_DEFAULT_SIZE;
+    const char* directory = argc > 2 ? argv[2] : ".";
+    if (argc > 1 && parseSize(argv[1], &size) != 0) {
+        fprintf(stderr, "Uso: %s [tamanho (ex.: 5G)] [diretório]\n", argv[0]);
+        return 1;
+    }
+
+    char input[MAX_FILENAME];
+    char compressed[MAX_FILENAME];
+    char updated[MAX_FILENAME];
+    char output[MAX_FILENAME];
+    char stream[MAX_FILENAME];
+    snprintf(input, sizeof(input), "%s/stress_input.bin", directory);
+    snprintf(compressed, sizeof(compressed), "%s/stress_input.huf", directory);
+    snprintf(updated, sizeof(updated), "%s/stress_updated.huf", directory);
+    snprintf(output, sizeof(output), "%s/stress_output.bin", directory);
+    snprintf(stream, sizeof(stream), "%s/stress_stream.huf", directory);
+
+    printf("=== Teste de Estresse: %llu bytes (%.2f GiB) ===\n",
+           (unsigned long long)size, size / (double)(1ULL << 30));
+
+    int passed = 1;
+    if (createSparseInput(input, size) != 0) {
+        return 1;
+    }
+    passed &= reportStep("Tamanho da entrada (64 bits)", getFileSize(input) == (int64_t)size, 0, 0);
+
+    // Ida: contêiner em blocos com totais e offsets de 64 bits
+    BlockStats stats;
+    double start = nowSeconds();
+    int result = compressFileBlocks(input, compressed, NULL, &stats);
+    passed &= reportStep("Compressão em blocos", result == 0 && stats.input_bytes == size,
+                         size, nowSeconds() - start);
+
+    // Recompressão incremental: copia blocos de offsets acima de 4 GiB
+    BlockIndex index;
+    start = nowSeconds();
+    result = openBlockIndex(compressed, &index);
+    if (result == 0) {
+        BlockWorkspace workspace;
+        initBlockWorkspace(&workspace);
+        workspace.base = &index;
+        result = compressFileBlocksWith(input, updated, NULL, &stats, &workspace);
+        freeBlockWorkspace(&workspace);
+        closeBlockIndex(&index);
+    }
+    passed &= reportStep("Recompressão incremental", result == 0 && stats.reused_blocks == stats.blocks,
+                         size, nowSeconds() - start);
+
+    // Volta e verificação byte a byte
+    start = nowSeconds();
+    result = decompressFileBlocks(updated, output, NULL, &stats);
+    passed &= reportStep("Descompressão em blocos", result == 0 && stats.input_bytes == size,
+                         size, nowSeconds() - start);
+
+    start = nowSeconds();
+    int identical = validateCompression(input, output);
+    passed &= reportStep("Verificação", identical, size, nowSeconds() - start);
+    remove(output);
+
+    // Memória: o pico não pode depender do tamanho da entrada
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    int rss_ok = usage.ru_maxrss <= STRESS_MAX_RSS_KIB;
+    printf("%s RSS máximo: %ld KiB (limite %d KiB), pico contabilizado: %zu bytes\n",
+           rss_ok ? "✓" : "✗", usage.ru_maxrss, STRESS_MAX_RSS_KIB, peakMemoryUsage());
+    passed &= rss_ok;
+
+    // Fluxo único: posições com fseeko/ftello e tamanho de 64 bits no cabeçalho
+    start = nowSeconds();
+    result = compressFile(input, stream);
+    passed &= reportStep("Compressão de fluxo único", result == 0, size, nowSeconds() - start);
+
+    start = nowSeconds();
+    result = result == 0 ? decompressFile(stream, output) : -1;
+    passed &= reportStep("Descompressão de fluxo único", result == 0 && getFileSize(output) == (int64_t)size,
+                         size, nowSeconds() - start);
+
+    start = nowSeconds();
+    identical = result == 0 && validateCompression(input, output);
+    passed &= reportStep("Verificação (fluxo único)", identical, size, nowSeconds() - start);
+
+    // O fluxo único mapeia a entrada: as páginas lidas contam no RSS, mas são
+    // do cache de arquivos e não entram no limite
+    getrusage(RUSAGE_SELF, &usage);
+    printf("  RSS máximo com o fluxo único: %ld KiB (inclui a entrada mapeada)\n", usage.ru_maxrss);
+
+    remove(input);
+    remove(compressed);
+    remove(updated);
+    remove(output);
+    remove(stream);
+
+    printf("%s\n", passed ? "Teste de estresse concluído com sucesso!" : "Teste de estresse falhou!");
+    return passed ? 0 : 1;
+}
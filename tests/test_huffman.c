@@ -3,6 +3,27 @@
 #include <string.h>
 #include "data_structures.h"
 #include "huffman_algorithm.h"
+#include "code_table.h"
+#include "decode_table.h"
+#include "block_format.h"
+#include "cpu_dispatch.h"
+#include "server.h"
+#include "archive.h"
+#include "adaptive_huffman.h"
+#include "byte_stream.h"
+#include "transform.h"
+#include "parallel_decode.h"
+#include "parallel_encode.h"
+#include "wide_symbol.h"
+#include "async_codec.h"
+#include "huf_reader.h"
+#include <pthread.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/time.h>
 
 void testDataStructures() {
     printf("=== Testando Estruturas de Dados ===\n");
@@ -152,19 +173,2617 @@ void testFileOperations() {
     
     // Testar tamanho de arquivo
     printf("4. Obtendo tamanho do arquivo...\n");
-    long size = getFileSize("test_input.txt");
+    int64_t size = getFileSize("test_input.txt");
     if (size > 0) {
-        printf("Tamanho: %ld bytes\n", size);
+        printf("Tamanho: %lld bytes\n", (long long)size);
         printf("Tamanho obtido\n");
     } else {
         printf("✗ Erro ao obter tamanho\n");
     }
     
+    // Testar contagem paralela por trechos
+    printf("5. Contando frequências em paralelo...\n");
+    size_t length = 3 * 1024 * 1024 + 13;
+    unsigned char* data = (unsigned char*)malloc(length);
+    unsigned int seed = 5;
+    for (size_t i = 0; i < length; i++) {
+        seed = seed * 1103515245u + 12345u;
+        data[i] = (unsigned char)((seed >> 16) % ((i / 4096) % 200 + 2));
+    }
+    test_file = fopen("test_histogram.bin", "wb");
+    fwrite(data, 1, length, test_file);
+    fclose(test_file);
+    unsigned long serial[MAX_CHAR] = {0};
+    countFrequencies(data, length, serial);
+    
+    test_file = fopen("test_histogram.bin", "rb");
+    int thread_counts[] = {1, 3, 8};
+    for (int t = 0; t < 3; t++) {
+        unsigned long parallel[MAX_CHAR] = {0};
+        int result = countFileFrequencies(fileno(test_file), (int64_t)length, thread_counts[t], parallel);
+        int same = result == 0 && memcmp(parallel, serial, sizeof(serial)) == 0;
+        printf("%s %d thread(s): frequências %s da contagem serial\n", same ? "✓" : "✗",
+               thread_counts[t], same ? "idênticas às" : "diferentes");
+    }
+    fclose(test_file);
+    free(data);
+    
     // Limpeza
     remove("test_input.txt");
+    remove("test_histogram.bin");
     printf("Arquivo de teste removido\n\n");
 }
 
+void testCodeTables() {
+    printf("=== Testando Tabelas de Códigos ===\n");
+    
+    // Dados de teste com repetição suficiente para formar pares
+    const char* text = "abracadabra, abracadabra! o rato roeu a roupa do rei de roma";
+    size_t length = strlen(text);
+    
+    unsigned long frequencies[MAX_CHAR] = {0};
+    for (size_t i = 0; i < length; i++) {
+        frequencies[(unsigned char)text[i]]++;
+    }
+    
+    HuffmanNode* root = buildHuffmanTree(frequencies);
+    char codes[MAX_CHAR][MAX_TREE_HT] = {{0}};
+    char current_code[MAX_TREE_HT] = {0};
+    generateHuffmanCodes(root, current_code, 0, codes);
+    
+    // Teste 1: Conversão para códigos inteiros
+    printf("1. Convertendo códigos para a forma inteira...\n");
+    CodeTable table;
+    if (buildCodeTable(codes, &table) == 0) {
+        printf("Maior código: %d bits\n", table.max_length);
+    } else {
+        printf("✗ Erro ao converter os códigos\n");
+    }
+    
+    // Teste 2: Codificação simples e por pares devem gerar os mesmos bytes
+    printf("2. Comparando codificação simples e por pares...\n");
+    unsigned char single_out[256] = {0};
+    unsigned char paired_out[256] = {0};
+    BitWriter writer;
+    
+    initBitWriter(&writer, single_out, sizeof(single_out), NULL);
+    encodeSymbols(&writer, (const unsigned char*)text, length, &table, NULL);
+    flushBitWriter(&writer);
+    size_t single_size = writer.position;
+    
+    PairCodeTable* pairs = buildPairCodeTable(&table);
+    initBitWriter(&writer, paired_out, sizeof(paired_out), NULL);
+    encodeSymbols(&writer, (const unsigned char*)text, length, &table, pairs);
+    flushBitWriter(&writer);
+    size_t paired_size = writer.position;
+    
+    if (single_size == paired_size && memcmp(single_out, paired_out, single_size) == 0) {
+        printf("✓ Saídas idênticas (%zu bytes)\n", single_size);
+    } else {
+        printf("✗ Saídas diferentes\n");
+    }
+    
+    // Limpeza
+    freePairCodeTable(pairs);
+    freeHuffmanTree(root);
+    printf("Memória liberada\n\n");
+}
+
+void testDecodeTables() {
+    printf("=== Testando Tabelas de Decodificação ===\n");
+    
+    const char* text = "aaaaaaaabbbbccdeaaaaaaaabbbbccdfaaaaaaaabbbbccdgaaaaabbbbbcccdeh";
+    size_t length = strlen(text);
+    
+    unsigned long frequencies[MAX_CHAR] = {0};
+    for (size_t i = 0; i < length; i++) {
+        frequencies[(unsigned char)text[i]]++;
+    }
+    
+    HuffmanNode* root = buildHuffmanTree(frequencies);
+    char codes[MAX_CHAR][MAX_TREE_HT] = {{0}};
+    char current_code[MAX_TREE_HT] = {0};
+    generateHuffmanCodes(root, current_code, 0, codes);
+    CodeTable table;
+    buildCodeTable(codes, &table);
+    
+    unsigned char encoded[256] = {0};
+    BitWriter writer;
+    initBitWriter(&writer, encoded, sizeof(encoded), NULL);
+    encodeSymbols(&writer, (const unsigned char*)text, length, &table, NULL);
+    flushBitWriter(&writer);
+    
+    // Teste 1: Seleção automática do modo
+    printf("1. Selecionando o modo automaticamente...\n");
+    DecodeTable* automatic = buildDecodeTable(root, DECODE_MODE_AUTO);
+    printf("Comprimento médio: %.2f bits, modo: %s\n", automatic->average_length,
+           automatic->mode == DECODE_MODE_MULTI ? "vários símbolos" : "um símbolo");
+    freeDecodeTable(automatic);
+    
+    // Teste 2: Os dois modos reproduzem o texto original
+    printf("2. Decodificando com um e com vários símbolos por consulta...\n");
+    DecodeMode modes[] = { DECODE_MODE_SINGLE, DECODE_MODE_MULTI };
+    for (int m = 0; m < 2; m++) {
+        unsigned char decoded[256] = {0};
+        DecodeTable* decode_table = buildDecodeTable(root, modes[m]);
+        BitReader reader;
+        initBitReaderFromMemory(&reader, encoded, writer.position);
+        uint64_t count = decodeSymbols(&reader, decode_table, decoded, length);
+        
+        if (count == length && memcmp(decoded, text, length) == 0) {
+            printf("✓ Modo %d: texto recuperado\n", m);
+        } else {
+            printf("✗ Modo %d: texto diferente\n", m);
+        }
+        freeDecodeTable(decode_table);
+    }
+    
+    // Limpeza
+    freeHuffmanTree(root);
+    printf("Memória liberada\n\n");
+}
+
+void testBlockFormat() {
+    printf("=== Testando Formato em Blocos ===\n");
+    
+    // Arquivo maior que um bloco para forçar vários blocos
+    printf("1. Criando arquivo de teste...\n");
+    FILE* test_file = fopen("test_blocks.txt", "w");
+    if (test_file == NULL) {
+        printf("✗ Erro ao criar arquivo de teste\n");
+        return;
+    }
+    for (int i = 0; i < 20000; i++) {
+        fprintf(test_file, "linha %d: o rato roeu a roupa do rei de roma\n", i % 97);
+    }
+    fclose(test_file);
+    
+    // Teste 2: Plano de memória respeita o limite
+    printf("2. Planejando com limite de 256 KiB...\n");
+    MemoryPlan plan;
+    size_t limit = 256 * 1024;
+    if (planMemoryBudget(limit, &plan) == 0 && plan.planned_peak <= limit) {
+        printf("Bloco de %zu bytes, pico previsto de %zu bytes\n", plan.block_size, plan.planned_peak);
+    } else {
+        printf("✗ Plano excede o limite\n");
+    }
+    
+    // Teste 3: Ida e volta dentro do limite
+    printf("3. Comprimindo e descomprimindo em blocos...\n");
+    BlockStats stats;
+    resetPeakMemoryUsage();
+    int compressed = compressFileBlocks("test_blocks.txt", "test_blocks.huf", &plan, &stats);
+    int decompressed = decompressFileBlocks("test_blocks.huf", "test_blocks.out", &plan, NULL);
+    
+    if (compressed == 0 && decompressed == 0 && validateCompression("test_blocks.txt", "test_blocks.out")) {
+        printf("✓ Arquivo recuperado (%llu blocos)\n", (unsigned long long)stats.blocks);
+    } else {
+        printf("✗ Falha na ida e volta em blocos\n");
+    }
+    
+    if (peakMemoryUsage() <= limit) {
+        printf("✓ Pico de memória: %zu bytes\n", peakMemoryUsage());
+    } else {
+        printf("✗ Pico de memória acima do limite: %zu bytes\n", peakMemoryUsage());
+    }
+    
+    // O plano reserva a árvore e as tabelas: nenhum bloco fica sem codificação
+    if (compressed == 0 && stats.stored_blocks == 0) {
+        printf("✓ Todos os blocos codificados dentro do limite\n");
+    } else {
+        printf("✗ %llu blocos gravados sem codificação\n", (unsigned long long)stats.stored_blocks);
+    }
+    
+    // Teste 4: Alocação recusada devolve erro em vez de encerrar o processo
+    printf("4. Construindo a árvore sem memória disponível...\n");
+    unsigned long frequencies[MAX_CHAR];
+    for (int c = 0; c < MAX_CHAR; c++) {
+        frequencies[c] = (unsigned long)c + 1;
+    }
+    size_t before = currentMemoryUsage();
+    setMemoryLimit(before + 4096);
+    clearBudgetExceeded();
+    HuffmanNode* root = buildHuffmanTree(frequencies);
+    int exceeded = budgetExceeded();
+    setMemoryLimit(0);
+    if (root == NULL && exceeded && currentMemoryUsage() == before) {
+        printf("✓ Limite de memória excedido informado, sem vazamentos\n");
+    } else {
+        printf("✗ Falha de alocação não tratada\n");
+        freeHuffmanTree(root);
+    }
+    
+    // Limpeza
+    remove("test_blocks.txt");
+    remove("test_blocks.huf");
+    remove("test_blocks.out");
+    printf("Arquivos de teste removidos\n\n");
+}
+
+void testCpuDispatch() {
+    printf("=== Testando Seleção de Kernels por CPU ===\n");
+    
+    // Dados com alfabeto amplo e distribuição desigual
+    size_t length = 64 * 1024;
+    unsigned char* data = (unsigned char*)malloc(length);
+    unsigned int seed = 12345;
+    for (size_t i = 0; i < length; i++) {
+        seed = seed * 1103515245u + 12345u;
+        data[i] = (unsigned char)((seed >> 16) % ((seed >> 28) + 2) * 17);
+    }
+    
+    // Teste 1: Detecção
+    CpuVariant detected = detectCpuVariant();
+    printf("1. Variante detectada: %s\n", cpuVariantName(detected));
+    
+    // Teste 2: Todas as variantes suportadas produzem o mesmo resultado
+    printf("2. Comparando as variantes suportadas...\n");
+    unsigned long reference_frequencies[MAX_CHAR] = {0};
+    unsigned char* reference_encoded = NULL;
+    size_t reference_size = 0;
+    unsigned char* encoded = (unsigned char*)malloc(length * 2);
+    unsigned char* decoded = (unsigned char*)malloc(length);
+    
+    for (int v = 0; v < CPU_VARIANT_COUNT; v++) {
+        if (setCpuVariant((CpuVariant)v) != 0) {
+            printf("Variante %s não suportada, ignorada\n", cpuVariantName((CpuVariant)v));
+            continue;
+        }
+        
+        unsigned long frequencies[MAX_CHAR] = {0};
+        countFrequencies(data, length, frequencies);
+        
+        HuffmanNode* root = buildHuffmanTree(frequencies);
+        char codes[MAX_CHAR][MAX_TREE_HT] = {{0}};
+        char current_code[MAX_TREE_HT] = {0};
+        generateHuffmanCodes(root, current_code, 0, codes);
+        CodeTable table;
+        buildCodeTable(codes, &table);
+        
+        BitWriter writer;
+        initBitWriter(&writer, encoded, length * 2, NULL);
+        encodeSymbols(&writer, data, length, &table, NULL);
+        flushBitWriter(&writer);
+        
+        DecodeTable* decode_table = buildDecodeTable(root, DECODE_MODE_AUTO);
+        BitReader reader;
+        initBitReaderFromMemory(&reader, encoded, writer.position);
+        uint64_t count = decodeSymbols(&reader, decode_table, decoded, length);
+        freeDecodeTable(decode_table);
+        freeHuffmanTree(root);
+        
+        if (reference_encoded == NULL) {
+            memcpy(reference_frequencies, frequencies, sizeof(frequencies));
+            reference_encoded = (unsigned char*)malloc(writer.position);
+            memcpy(reference_encoded, encoded, writer.position);
+            reference_size = writer.position;
+        }
+        
+        int same = memcmp(frequencies, reference_frequencies, sizeof(frequencies)) == 0 &&
+                   writer.position == reference_size &&
+                   memcmp(encoded, reference_encoded, reference_size) == 0 &&
+                   count == length && memcmp(decoded, data, length) == 0;
+        if (same) {
+            printf("✓ Variante %s: resultado idêntico\n", cpuVariantName((CpuVariant)v));
+        } else {
+            printf("✗ Variante %s: resultado diferente\n", cpuVariantName((CpuVariant)v));
+        }
+    }
+    
+    // Restaura a variante detectada
+    setCpuVariant(detected);
+    
+    // Limpeza
+    free(reference_encoded);
+    free(encoded);
+    free(decoded);
+    free(data);
+    printf("Memória liberada\n\n");
+}
+
+// Executa o servidor em uma thread separada durante o teste
+static void* serverThread(void* argument) {
+    static int result;
+    result = runServer((const char*)argument, 2, NULL);
+    return &result;
+}
+
+// Servidor com plano sob limite de memória (cota inline por thread)
+static MemoryPlan limited_server_plan;
+static void* limitedServerThread(void* argument) {
+    static int result;
+    result = runServer((const char*)argument, 2, &limited_server_plan);
+    return &result;
+}
+
+void testServer() {
+    printf("=== Testando Modo Servidor ===\n");
+    const char* socket_path = "test_server.sock";
+    
+    pthread_t thread;
+    pthread_create(&thread, NULL, serverThread, (void*)socket_path);
+    
+    // Teste 1: Conexão
+    printf("1. Conectando ao servidor...\n");
+    int fd = connectServer(socket_path);
+    if (fd < 0) {
+        printf("✗ Não foi possível conectar\n\n");
+        requestServerShutdown();
+        pthread_join(thread, NULL);
+        return;
+    }
+    printf("✓ Conectado\n");
+    
+    // Teste 2: Ida e volta de buffers pela mesma conexão (tabelas aquecidas)
+    printf("2. Comprimindo e descomprimindo buffers...\n");
+    const char* sentence = "Pedidos pequenos e repetidos reaproveitam os buffers e as tabelas da thread. ";
+    char text[2048] = {0};
+    while (strlen(text) + strlen(sentence) < sizeof(text)) {
+        strcat(text, sentence);
+    }
+    size_t length = strlen(text);
+    for (int round = 0; round < 3; round++) {
+        char command[64];
+        ServerReply compressed, decompressed;
+        snprintf(command, sizeof(command), "COMPRESS-DATA %zu", length);
+        serverRequest(fd, command, (const unsigned char*)text, length, &compressed);
+        snprintf(command, sizeof(command), "DECOMPRESS-DATA %zu", compressed.payload_size);
+        serverRequest(fd, command, compressed.payload, compressed.payload_size, &decompressed);
+        
+        if (compressed.ok && decompressed.ok && decompressed.payload_size == length &&
+            memcmp(decompressed.payload, text, length) == 0) {
+            printf("✓ Rodada %d: %zu -> %zu bytes (%llu us + %llu us)\n", round, length,
+                   compressed.payload_size, (unsigned long long)compressed.latency_us,
+                   (unsigned long long)decompressed.latency_us);
+        } else {
+            printf("✗ Rodada %d: resposta incorreta\n", round);
+        }
+        free(compressed.payload);
+        free(decompressed.payload);
+    }
+    
+    // Teste 3: Dados inválidos geram erro sem derrubar a conexão
+    printf("3. Enviando dados inválidos...\n");
+    ServerReply reply;
+    serverRequest(fd, "DECOMPRESS-DATA 5", (const unsigned char*)"lixo!", 5, &reply);
+    ServerReply ping;
+    serverRequest(fd, "PING", NULL, 0, &ping);
+    if (!reply.ok && ping.ok) {
+        printf("✓ Erro informado: %s\n", reply.message);
+    } else {
+        printf("✗ Dados inválidos não foram rejeitados\n");
+    }
+    
+    // Teste 4: Estatísticas e cache de tabelas
+    printf("4. Consultando estatísticas...\n");
+    ServerStats stats;
+    getServerStats(&stats);
+    if (stats.requests == 7 && stats.errors == 1 && stats.table_hits == 2) {
+        printf("✓ %llu pedidos, %llu tabelas reaproveitadas\n",
+               (unsigned long long)stats.requests, (unsigned long long)stats.table_hits);
+    } else {
+        printf("✗ Estatísticas inesperadas: %llu pedidos, %llu erros, %llu acertos\n",
+               (unsigned long long)stats.requests, (unsigned long long)stats.errors,
+               (unsigned long long)stats.table_hits);
+    }
+    
+    serverRequest(fd, "SHUTDOWN", NULL, 0, &reply);
+    close(fd);
+    void* result;
+    pthread_join(thread, &result);
+    printf("%s Servidor encerrado\n", *(int*)result == 0 ? "✓" : "✗");
+    
+    // Teste 5: Sob limite, pedidos inline são admitidos contra a cota de cada thread
+    printf("5. Enviando pedidos maiores que a cota de uma thread...\n");
+    size_t server_limit = 4 * 1024 * 1024;
+    planServerBudget(server_limit, 2, &limited_server_plan);
+    setMemoryLimit(currentMemoryUsage() + server_limit);
+    pthread_create(&thread, NULL, limitedServerThread, (void*)socket_path);
+    fd = connectServer(socket_path);
+    
+    // Bytes pseudoaleatórios não encolhem: a saída é do tamanho da entrada
+    size_t quota = limited_server_plan.limit;
+    unsigned char* noise = (unsigned char*)malloc(quota + 1);
+    uint32_t state = 12345;
+    for (size_t i = 0; i <= quota; i++) {
+        state = state * 1103515245u + 12345u;
+        noise[i] = (unsigned char)(state >> 24);
+    }
+    char command[64];
+    ServerReply refused, overflow, small;
+    snprintf(command, sizeof(command), "COMPRESS-DATA %zu", quota + 1);
+    serverRequest(fd, command, noise, quota + 1, &refused);
+    snprintf(command, sizeof(command), "COMPRESS-DATA %zu", quota * 3 / 4);
+    serverRequest(fd, command, noise, quota * 3 / 4, &overflow);
+    snprintf(command, sizeof(command), "COMPRESS-DATA %zu", length);
+    serverRequest(fd, command, (const unsigned char*)text, length, &small);
+    getServerStats(&stats);
+    if (!refused.ok && !overflow.ok && small.ok && stats.rejected == 2) {
+        printf("✓ Recusados: %s; a conexão continua atendendo\n", refused.message);
+    } else {
+        printf("✗ Cota ignorada: %s/%s/%s, %llu recusados\n", refused.ok ? "OK" : "ERR",
+               overflow.ok ? "OK" : "ERR", small.ok ? "OK" : "ERR", (unsigned long long)stats.rejected);
+    }
+    free(small.payload);
+    free(noise);
+    
+    // Teste 6: Clientes ociosos ocupando todas as threads são desconectados
+    printf("6. Conectando com as duas threads presas em clientes ociosos...\n");
+    int idle = connectServer(socket_path);
+    int waiting = connectServer(socket_path);
+    struct timeval patience = { 3 * SERVER_IDLE_POLLS * SERVER_POLL_SECONDS, 0 };
+    setsockopt(waiting, SOL_SOCKET, SO_RCVTIMEO, &patience, sizeof(patience));
+    ServerReply late;
+    if (serverRequest(waiting, "PING", NULL, 0, &late) == 0 && late.ok) {
+        printf("✓ Conexão da fila atendida depois da ociosidade das outras\n");
+    } else {
+        printf("✗ Conexão da fila não foi atendida\n");
+    }
+    
+    // Limpeza
+    serverRequest(waiting, "SHUTDOWN", NULL, 0, &reply);
+    close(idle);
+    close(waiting);
+    close(fd);
+    pthread_join(thread, &result);
+    setMemoryLimit(0);
+    printf("%s Servidor encerrado\n", *(int*)result == 0 ? "✓" : "✗");
+    
+    // Teste 7: Um arquivo comum no caminho do socket não é apagado
+    printf("7. Iniciando o servidor sobre um arquivo comum...\n");
+    FILE* keep = fopen("test_server.keep", "w");
+    fputs("não apagar", keep);
+    fclose(keep);
+    int refused_path = runServer("test_server.keep", 1, NULL);
+    keep = fopen("test_server.keep", "r");
+    printf("%s Arquivo %s\n\n", refused_path != 0 && keep != NULL ? "✓" : "✗",
+           keep != NULL ? "preservado" : "apagado");
+    if (keep != NULL) {
+        fclose(keep);
+    }
+    remove("test_server.keep");
+}
+
+void testArchive() {
+    printf("=== Testando Arquivo com Vários Membros ===\n");
+    
+    // Membros com conteúdos e tamanhos diferentes
+    printf("1. Criando membros...\n");
+    const char* names[] = { "test_member_a.txt", "test_member_b.txt", "test_member_c.txt" };
+    const char* contents[] = { "abracadabra abracadabra abracadabra", "", "zzzzzzzzzzzzzzzzzzzzzzzzzzzzzz" };
+    for (int i = 0; i < 3; i++) {
+        FILE* file = fopen(names[i], "w");
+        if (file == NULL) {
+            printf("✗ Não foi possível criar os membros\n\n");
+            return;
+        }
+        fputs(contents[i], file);
+        fclose(file);
+    }
+    
+    // Teste 2: Criação em paralelo e listagem sem decodificar
+    printf("2. Criando e listando o arquivo...\n");
+    ArchiveDirectory directory;
+    if (createArchive("test_archive.hua", names, 3, 2, NULL, 0, NULL, NULL) == 0 &&
+        readArchiveDirectory("test_archive.hua", &directory) == 0) {
+        int matches = directory.count == 3;
+        for (uint32_t i = 0; i < directory.count && matches; i++) {
+            matches = strcmp(directory.entries[i].name, names[i]) == 0 &&
+                      directory.entries[i].original_size == strlen(contents[i]);
+        }
+        printf("%s Diretório com %u membros\n", matches ? "✓" : "✗", directory.count);
+        freeArchiveDirectory(&directory);
+    } else {
+        printf("✗ Falha ao criar ou ler o arquivo\n");
+    }
+    
+    // Teste 3: Extração de um único membro
+    printf("3. Extraindo um membro...\n");
+    const char* single[] = { names[2] };
+    remove(names[2]);
+    if (extractArchive("test_archive.hua", single, 1, NULL, 2, NULL, NULL) == 0) {
+        FILE* file = fopen(names[2], "r");
+        char buffer[64] = {0};
+        if (file != NULL) {
+            size_t bytes_read = fread(buffer, 1, sizeof(buffer) - 1, file);
+            buffer[bytes_read] = '\0';
+            fclose(file);
+        }
+        printf("%s Membro recuperado\n", strcmp(buffer, contents[2]) == 0 ? "✓" : "✗");
+    } else {
+        printf("✗ Falha na extração\n");
+    }
+    
+    // Teste 4: Membro inexistente é rejeitado
+    printf("4. Pedindo um membro inexistente...\n");
+    const char* missing[] = { "inexistente.txt" };
+    if (extractArchive("test_archive.hua", missing, 1, NULL, 1, NULL, NULL) != 0) {
+        printf("✓ Membro inexistente rejeitado\n");
+    } else {
+        printf("✗ Membro inexistente aceito\n");
+    }
+    
+    // Teste 5: Mais membros que descritores livres (um arquivo temporário por thread)
+    printf("5. Criando um arquivo com mais membros que descritores...\n");
+    enum { MANY_MEMBERS = 96 };
+    char many_names[MANY_MEMBERS][32];
+    const char* many[MANY_MEMBERS];
+    for (int i = 0; i < MANY_MEMBERS; i++) {
+        snprintf(many_names[i], sizeof(many_names[i]), "test_many_%d.txt", i);
+        many[i] = many_names[i];
+        FILE* file = fopen(many_names[i], "w");
+        fprintf(file, "membro %d de %d\n", i, MANY_MEMBERS);
+        fclose(file);
+    }
+    struct rlimit saved_limit;
+    getrlimit(RLIMIT_NOFILE, &saved_limit);
+    struct rlimit low_limit = saved_limit;
+    low_limit.rlim_cur = 48;
+    setrlimit(RLIMIT_NOFILE, &low_limit);
+    int many_result = createArchive("test_archive.hua", many, MANY_MEMBERS, 4, NULL, 0, NULL, NULL);
+    setrlimit(RLIMIT_NOFILE, &saved_limit);
+    if (many_result == 0 && readArchiveDirectory("test_archive.hua", &directory) == 0) {
+        printf("%s %u membros com no máximo 48 descritores\n", directory.count == MANY_MEMBERS ? "✓" : "✗",
+               directory.count);
+        freeArchiveDirectory(&directory);
+    } else {
+        printf("✗ Falha ao criar o arquivo com %d membros\n", MANY_MEMBERS);
+    }
+    for (int i = 0; i < MANY_MEMBERS; i++) {
+        remove(many_names[i]);
+    }
+    
+    // Teste 6: Nomes gravados repetidos seriam extraídos no mesmo caminho
+    printf("6. Criando um arquivo com membros repetidos...\n");
+    const char* repeated[] = { names[0], names[2], "./test_member_a.txt" };
+    remove("test_archive.hua");
+    int repeated_result = createArchive("test_archive.hua", repeated, 3, 2, NULL, 0, NULL, NULL);
+    FILE* leftover = fopen("test_archive.hua", "rb");
+    printf("%s Membro repetido %s\n", repeated_result != 0 && leftover == NULL ? "✓" : "✗",
+           repeated_result != 0 ? "rejeitado" : "aceito");
+    if (leftover != NULL) {
+        fclose(leftover);
+    }
+    
+    // Limpeza
+    for (int i = 0; i < 3; i++) {
+        remove(names[i]);
+    }
+    remove("test_archive.hua");
+    printf("Arquivos de teste removidos\n\n");
+}
+
+void testDeduplication() {
+    printf("=== Testando Deduplicação de Blocos ===\n");
+    
+    // Trecho pseudoaleatório repetido em posições não alinhadas aos blocos
+    size_t chunk = 40 * 1024;
+    size_t length = 3 * chunk + 3;
+    unsigned char* data = (unsigned char*)malloc(length);
+    unsigned int seed = 777;
+    for (size_t i = 0; i < chunk; i++) {
+        seed = seed * 1103515245u + 12345u;
+        data[i] = (unsigned char)(seed >> 16);
+    }
+    memcpy(data + chunk, "xyz", 3);
+    memcpy(data + chunk + 3, data, chunk);
+    memcpy(data + 2 * chunk + 3, data, chunk);
+    
+    MemoryPlan plan;
+    planMemoryBudget(0, &plan);
+    plan.block_size = 16 * 1024;
+    
+    // Teste 1: Compressão com referências
+    printf("1. Comprimindo com deduplicação...\n");
+    FILE* input = tmpfile();
+    FILE* compressed = tmpfile();
+    fwrite(data, 1, length, input);
+    rewind(input);
+    
+    BlockWorkspace workspace;
+    initBlockWorkspace(&workspace);
+    workspace.dedup = 1;
+    BlockStats stats;
+    int result = compressStreamBlocksWith(input, compressed, &plan, &stats, &workspace);
+    if (result == 0 && stats.dedup_blocks > 0) {
+        printf("✓ %llu de %llu blocos viraram referências\n",
+               (unsigned long long)stats.dedup_blocks, (unsigned long long)stats.blocks);
+    } else {
+        printf("✗ Nenhum bloco deduplicado\n");
+    }
+    
+    // Teste 2: Referências resolvidas copiando a saída ou decodificando a origem
+    printf("2. Descomprimindo as referências...\n");
+    for (int readable = 1; readable >= 0; readable--) {
+        FILE* output = tmpfile();
+        unsigned char* decoded = (unsigned char*)malloc(length);
+        rewind(compressed);
+        workspace.readable_output = readable;
+        BlockStats decoded_stats;
+        
+        int decompressed = decompressStreamBlocksWith(compressed, output, NULL, &decoded_stats, &workspace);
+        rewind(output);
+        size_t decoded_length = fread(decoded, 1, length, output);
+        
+        if (decompressed == 0 && decoded_length == length && memcmp(decoded, data, length) == 0 &&
+            decoded_stats.dedup_blocks == stats.dedup_blocks) {
+            printf("✓ Saída %s: dados recuperados\n", readable ? "legível" : "somente escrita");
+        } else {
+            printf("✗ Saída %s: dados diferentes\n", readable ? "legível" : "somente escrita");
+        }
+        free(decoded);
+        fclose(output);
+    }
+    freeBlockWorkspace(&workspace);
+
+    // Teste 3: Sob limite, só os primeiros blocos são referenciáveis e os
+    // registros cabem na fração do plano
+    printf("3. Deduplicando mais blocos que os registros do limite...\n");
+    size_t limit = 256 * 1024;
+    size_t repeated_length = 12 * 1024 * 1024;
+    unsigned char* repeated = (unsigned char*)malloc(repeated_length);
+    for (size_t i = 0; i < repeated_length; i++) {
+        repeated[i] = data[i % chunk];
+    }
+    FILE* repeated_input = tmpfile();
+    FILE* repeated_compressed = tmpfile();
+    FILE* repeated_output = tmpfile();
+    fwrite(repeated, 1, repeated_length, repeated_input);
+    rewind(repeated_input);
+
+    MemoryPlan limited;
+    int planned = planMemoryBudgetFor(limit, PLAN_DEDUP, &limited) == 0 && limited.planned_peak <= limit;
+    BlockStats limited_stats;
+    BlockStats restored_stats;
+    setMemoryLimit(limit);
+    resetPeakMemoryUsage();
+    initBlockWorkspace(&workspace);
+    workspace.dedup = 1;
+    int round_trip = planned &&
+                     compressStreamBlocksWith(repeated_input, repeated_compressed, &limited, &limited_stats,
+                                              &workspace) == 0;
+    freeBlockWorkspace(&workspace);
+    rewind(repeated_compressed);
+    round_trip = round_trip &&
+                 decompressStreamBlocks(repeated_compressed, repeated_output, &limited, &restored_stats) == 0;
+    size_t peak = peakMemoryUsage();
+    setMemoryLimit(0);
+
+    unsigned char* restored = (unsigned char*)malloc(repeated_length);
+    rewind(repeated_output);
+    round_trip = round_trip && fread(restored, 1, repeated_length, repeated_output) == repeated_length &&
+                 memcmp(restored, repeated, repeated_length) == 0;
+    uint64_t records = dedupRecordLimit(limit);
+    if (round_trip && limited_stats.blocks > records && restored_stats.dedup_blocks == limited_stats.dedup_blocks &&
+        limited_stats.dedup_blocks > 0 && peak <= limit) {
+        printf("✓ %llu blocos, %llu referências a %llu registráveis (pico %zu bytes)\n",
+               (unsigned long long)limited_stats.blocks, (unsigned long long)limited_stats.dedup_blocks,
+               (unsigned long long)records, peak);
+    } else {
+        printf("✗ Falha sob limite (ida e volta: %d, blocos: %llu, pico: %zu)\n", round_trip,
+               (unsigned long long)limited_stats.blocks, peak);
+    }
+    fclose(repeated_input);
+    fclose(repeated_compressed);
+    fclose(repeated_output);
+    free(repeated);
+    free(restored);
+
+    // Teste 4: Um arquivo com o mesmo nome em dois membros que compartilham os
+    // dados (gravado por versões antigas) não trunca o membro já extraído
+    printf("4. Extraindo membros idênticos com o mesmo nome...\n");
+    const char* twins[] = { "test_dedup_a.txt", "test_dedup_b.txt" };
+    for (int i = 0; i < 2; i++) {
+        FILE* file = fopen(twins[i], "wb");
+        fwrite(data, 1, chunk, file);
+        fclose(file);
+    }
+    int extracted = 0;
+    if (createArchive("test_dedup.hua", twins, 2, 2, NULL, 1, NULL, NULL) == 0) {
+        // Troca o nome do segundo membro no diretório pelo do primeiro
+        FILE* archive = fopen("test_dedup.hua", "r+b");
+        fseek(archive, 0, SEEK_END);
+        size_t archive_size = (size_t)ftell(archive);
+        unsigned char* bytes = (unsigned char*)malloc(archive_size);
+        rewind(archive);
+        size_t archive_read = fread(bytes, 1, archive_size, archive);
+        size_t name_length = strlen(twins[1]);
+        for (size_t i = 0; i + name_length <= archive_read; i++) {
+            if (memcmp(bytes + i, twins[1], name_length) == 0) {
+                fseek(archive, (long)i, SEEK_SET);
+                fwrite(twins[0], 1, name_length, archive);
+            }
+        }
+        fclose(archive);
+        free(bytes);
+
+        unsigned char* member = (unsigned char*)malloc(chunk + 1);
+        FILE* file = NULL;
+        if (extractArchive("test_dedup.hua", NULL, 0, "test_dedup_out", 2, NULL, NULL) == 0 &&
+            (file = fopen("test_dedup_out/test_dedup_a.txt", "rb")) != NULL) {
+            extracted = fread(member, 1, chunk + 1, file) == chunk && memcmp(member, data, chunk) == 0;
+        }
+        if (file != NULL) {
+            fclose(file);
+        }
+        free(member);
+    }
+    printf("%s Membro extraído %s\n", extracted ? "✓" : "✗", extracted ? "intacto" : "truncado ou ausente");
+    for (int i = 0; i < 2; i++) {
+        remove(twins[i]);
+    }
+    remove("test_dedup_out/test_dedup_a.txt");
+    rmdir("test_dedup_out");
+    remove("test_dedup.hua");
+
+    // Limpeza
+    fclose(input);
+    fclose(compressed);
+    free(data);
+    printf("Memória liberada\n\n");
+}
+
+void testIncrementalUpdate() {
+    printf("=== Testando Recompressão Incremental ===\n");
+    
+    // Texto compressível; a segunda versão altera um trecho e ganha um final
+    size_t length = 64 * 1024;
+    unsigned char* data = (unsigned char*)malloc(length + 4096);
+    const char* words[] = {"bloco ", "indice ", "hash ", "huffman ", "arquivo "};
+    unsigned int seed = 99;
+    for (size_t i = 0; i < length + 4096; ) {
+        seed = seed * 1103515245u + 12345u;
+        const char* word = words[(seed >> 16) % 5];
+        for (size_t j = 0; word[j] != '\0' && i < length + 4096; j++) {
+            data[i++] = (unsigned char)word[j];
+        }
+    }
+    
+    MemoryPlan plan;
+    planMemoryBudget(0, &plan);
+    plan.block_size = 8 * 1024;
+    
+    FILE* file = fopen("test_update_v1.txt", "wb");
+    fwrite(data, 1, length, file);
+    fclose(file);
+    memcpy(data + 20000, "ALTERADO", 8);
+    file = fopen("test_update_v2.txt", "wb");
+    fwrite(data, 1, length + 4096, file);
+    fclose(file);
+    
+    // Teste 1: O contêiner anterior traz o índice de blocos
+    printf("1. Lendo o índice do contêiner anterior...\n");
+    compressFileBlocks("test_update_v1.txt", "test_update_v1.huf", &plan, NULL);
+    BlockIndex index;
+    if (openBlockIndex("test_update_v1.huf", &index) == 0 && index.count == 8 &&
+        index.block_size == plan.block_size) {
+        printf("✓ Índice com %llu blocos\n", (unsigned long long)index.count);
+    } else {
+        printf("✗ Índice de blocos inválido\n");
+    }
+    
+    // Teste 2: Só os blocos alterados são codificados
+    printf("2. Recomprimindo a nova versão...\n");
+    BlockWorkspace workspace;
+    initBlockWorkspace(&workspace);
+    workspace.base = &index;
+    BlockStats stats;
+    int result = compressFileBlocksWith("test_update_v2.txt", "test_update_v2.huf", &plan, &stats, &workspace);
+    if (result == 0 && stats.blocks == 9 && stats.reused_blocks == 7) {
+        printf("✓ %llu de %llu blocos copiados sem recodificar\n",
+               (unsigned long long)stats.reused_blocks, (unsigned long long)stats.blocks);
+    } else {
+        printf("✗ Blocos reaproveitados: %llu de %llu\n",
+               (unsigned long long)stats.reused_blocks, (unsigned long long)stats.blocks);
+    }
+    freeBlockWorkspace(&workspace);
+    closeBlockIndex(&index);
+    
+    // Teste 3: O resultado descomprime para a nova versão
+    printf("3. Descomprimindo a nova versão...\n");
+    if (decompressFileBlocks("test_update_v2.huf", "test_update_v2.out", NULL, NULL) == 0 &&
+        validateCompression("test_update_v2.txt", "test_update_v2.out")) {
+        printf("✓ Dados recuperados\n");
+    } else {
+        printf("✗ Dados diferentes\n");
+    }
+
+    // Teste 4: Um hash do índice que aponta para outro conteúdo não é copiado
+    printf("4. Recomprimindo com uma colisão no índice...\n");
+    size_t block = plan.block_size;
+    uint64_t first_offset;
+    openBlockIndex("test_update_v1.huf", &index);
+    int forged = findHashIndex(&index.blocks, hash64(data, block, block), &first_offset) &&
+                 insertHashIndex(&index.blocks, hash64(data + 2 * block, block, block), first_offset) == 0;
+    initBlockWorkspace(&workspace);
+    workspace.base = &index;
+    result = compressFileBlocksWith("test_update_v2.txt", "test_update_v2.huf", &plan, &stats, &workspace);
+    freeBlockWorkspace(&workspace);
+    closeBlockIndex(&index);
+    if (forged && result == 0 && stats.reused_blocks == 7 &&
+        decompressFileBlocks("test_update_v2.huf", "test_update_v2.out", NULL, NULL) == 0 &&
+        validateCompression("test_update_v2.txt", "test_update_v2.out")) {
+        printf("✓ Bloco com o hash forjado recodificado; dados recuperados\n");
+    } else {
+        printf("✗ Bloco com o hash forjado copiado (%llu reaproveitados)\n",
+               (unsigned long long)stats.reused_blocks);
+    }
+
+    // Limpeza
+    remove("test_update_v1.txt");
+    remove("test_update_v1.huf");
+    remove("test_update_v2.txt");
+    remove("test_update_v2.huf");
+    remove("test_update_v2.out");
+    free(data);
+    printf("Memória liberada\n\n");
+}
+
+// Forma compartilhada pelas threads do teste do cache
+static unsigned char cache_test_shape[MAX_SERIALIZED_TREE];
+static size_t cache_test_shape_size;
+
+static void* cacheThread(void* argument) {
+    const DecodeTable** result = (const DecodeTable**)argument;
+    CachedTables* tables = acquireTables(cache_test_shape, cache_test_shape_size);
+    *result = tables != NULL ? cachedDecodeTable(tables) : NULL;
+    releaseTables(tables);
+    return NULL;
+}
+
+void testTableCache() {
+    printf("=== Testando Cache de Tabelas ===\n");
+    
+    setTableCacheCapacity(2);
+    clearTableCache();
+    
+    // Três árvores diferentes
+    unsigned char shapes[3][MAX_SERIALIZED_TREE];
+    size_t sizes[3];
+    for (int t = 0; t < 3; t++) {
+        unsigned long frequencies[MAX_CHAR] = {0};
+        for (int i = 0; i < 8 + t; i++) {
+            frequencies['a' + i] = (unsigned long)(1 + i * (t + 1));
+        }
+        HuffmanNode* root = buildHuffmanTree(frequencies);
+        sizes[t] = flattenTree(root, shapes[t], 0);
+        freeHuffmanTree(root);
+    }
+    
+    // Teste 1: A mesma árvore reaproveita as tabelas
+    printf("1. Pedindo a mesma árvore duas vezes...\n");
+    TableCacheStats before;
+    TableCacheStats after;
+    getTableCacheStats(&before);
+    CachedTables* first = acquireTables(shapes[0], sizes[0]);
+    CachedTables* second = acquireTables(shapes[0], sizes[0]);
+    getTableCacheStats(&after);
+    if (first != NULL && first == second && cachedDecodeTable(first) == cachedDecodeTable(second) &&
+        cachedCodeTable(first) != NULL && after.hits == before.hits + 1) {
+        printf("✓ Tabelas construídas uma vez e reaproveitadas\n");
+    } else {
+        printf("✗ Tabelas não foram reaproveitadas\n");
+    }
+    releaseTables(first);
+    releaseTables(second);
+    
+    // Teste 2: Threads diferentes recebem a mesma tabela
+    printf("2. Compartilhando entre threads...\n");
+    memcpy(cache_test_shape, shapes[1], sizes[1]);
+    cache_test_shape_size = sizes[1];
+    pthread_t threads[4];
+    const DecodeTable* results[4];
+    for (int i = 0; i < 4; i++) {
+        pthread_create(&threads[i], NULL, cacheThread, &results[i]);
+    }
+    for (int i = 0; i < 4; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    int same = results[0] != NULL;
+    for (int i = 1; i < 4; i++) {
+        same = same && results[i] == results[0];
+    }
+    printf("%s Todas as threads usaram a mesma tabela\n", same ? "✓" : "✗");
+    
+    // Teste 3: A entrada menos usada é descartada no limite
+    printf("3. Excedendo o limite de entradas...\n");
+    releaseTables(acquireTables(shapes[0], sizes[0]));
+    releaseTables(acquireTables(shapes[2], sizes[2]));
+    getTableCacheStats(&before);
+    releaseTables(acquireTables(shapes[1], sizes[1]));
+    getTableCacheStats(&after);
+    if (after.entries == 2 && after.evictions > before.evictions && after.misses == before.misses + 1) {
+        printf("✓ %zu entradas, árvore mais antiga descartada\n", after.entries);
+    } else {
+        printf("✗ Limite do cache não respeitado (%zu entradas)\n", after.entries);
+    }
+    
+    // Limpeza
+    clearTableCache();
+    setTableCacheCapacity(TABLE_CACHE_DEFAULT_CAPACITY);
+    printf("Memória liberada\n\n");
+}
+
+void testAdaptiveHuffman() {
+    printf("=== Testando Huffman Adaptativo ===\n");
+    
+    // Texto compressível, um arquivo vazio e um de um único símbolo
+    size_t length = 32 * 1024;
+    unsigned char* data = (unsigned char*)malloc(length);
+    const char* words[] = {"fluxo ", "mensagem ", "adaptativo ", "huffman ", "\n"};
+    unsigned int seed = 7;
+    for (size_t i = 0; i < length; ) {
+        seed = seed * 1103515245u + 12345u;
+        const char* word = words[(seed >> 16) % 5];
+        for (size_t j = 0; word[j] != '\0' && i < length; j++) {
+            data[i++] = (unsigned char)word[j];
+        }
+    }
+    
+    const char* inputs[] = {"test_adaptive_text.txt", "test_adaptive_empty.txt", "test_adaptive_single.txt"};
+    size_t lengths[] = {length, 0, 1000};
+    FILE* file = fopen(inputs[0], "wb");
+    fwrite(data, 1, length, file);
+    fclose(file);
+    file = fopen(inputs[1], "wb");
+    fclose(file);
+    file = fopen(inputs[2], "wb");
+    for (size_t i = 0; i < lengths[2]; i++) {
+        fputc('z', file);
+    }
+    fclose(file);
+    
+    // Teste 1: Ida e volta sem cabeçalho de árvore
+    printf("1. Comprimindo e descomprimindo em uma passagem...\n");
+    for (int t = 0; t < 3; t++) {
+        int ok = compressFileAdaptive(inputs[t], "test_adaptive.huf") == 0 &&
+                 isAdaptiveFile("test_adaptive.huf") &&
+                 decompressFileAdaptive("test_adaptive.huf", "test_adaptive.out") == 0 &&
+                 validateCompression(inputs[t], "test_adaptive.out");
+        int64_t compressed = getFileSize("test_adaptive.huf");
+        printf("%s %s: %zu -> %lld bytes\n", ok ? "✓" : "✗", inputs[t], lengths[t], (long long)compressed);
+    }
+    
+    // Teste 2: Cada mensagem pode ser decodificada assim que é encerrada
+    printf("2. Decodificando mensagem a mensagem...\n");
+    AdaptiveEncoder* encoder = (AdaptiveEncoder*)malloc(sizeof(AdaptiveEncoder));
+    AdaptiveDecoder* decoder = (AdaptiveDecoder*)malloc(sizeof(AdaptiveDecoder));
+    FILE* stream = fopen("test_adaptive.huf", "wb");
+    FILE* reader = fopen("test_adaptive.huf", "rb");
+    ByteSink stream_sink;
+    ByteSource reader_source;
+    ByteSink output;
+    initFileSink(&stream_sink, stream);
+    initFileSource(&reader_source, reader);
+    initMemorySink(&output);
+    const char* first = "primeira mensagem";
+    const char* second = "segunda mensagem, com o modelo já treinado";
+    initAdaptiveEncoder(encoder, &stream_sink);
+    adaptiveEncode(encoder, (const unsigned char*)first, strlen(first));
+    adaptiveFlush(encoder);
+    
+    int status = initAdaptiveDecoder(decoder, &reader_source) == 0 ? adaptiveDecodeMessage(decoder, &output) : -1;
+    if (status == 1 && output.position == strlen(first) && memcmp(output.data, first, output.position) == 0) {
+        printf("✓ Primeira mensagem recuperada antes do fim do fluxo\n");
+    } else {
+        printf("✗ Primeira mensagem não recuperada (status %d)\n", status);
+    }
+    
+    adaptiveEncode(encoder, (const unsigned char*)second, strlen(second));
+    adaptiveFlush(encoder);
+    finishAdaptiveEncoder(encoder);
+    output.position = 0;
+    status = adaptiveDecodeMessage(decoder, &output);
+    int end = status == 1 ? adaptiveDecodeMessage(decoder, &output) : -1;
+    if (end == 0 && output.position == strlen(second) && memcmp(output.data, second, output.position) == 0 &&
+        encoder->messages == 2) {
+        printf("✓ Segunda mensagem e fim do fluxo recuperados\n");
+    } else {
+        printf("✗ Segunda mensagem ou fim do fluxo não recuperados\n");
+    }
+    
+    // Teste 3: Erro de leitura (um diretório não é lido) não vira fim da entrada
+    printf("3. Comprimindo uma entrada que falha na leitura...\n");
+    FILE* broken = fopen(".", "rb");
+    FILE* truncated = fopen("test_adaptive.out", "wb");
+    if (broken != NULL && truncated != NULL && compressStreamAdaptive(broken, truncated) != 0) {
+        printf("✓ Falha de leitura informada\n");
+    } else {
+        printf("✗ Fluxo truncado terminado como completo\n");
+    }
+    if (broken != NULL) {
+        fclose(broken);
+    }
+    if (truncated != NULL) {
+        fclose(truncated);
+    }
+    
+    // Limpeza
+    closeSink(&stream_sink);
+    closeSource(&reader_source);
+    closeSink(&output);
+    fclose(stream);
+    fclose(reader);
+    free(encoder);
+    free(decoder);
+    for (int t = 0; t < 3; t++) {
+        remove(inputs[t]);
+    }
+    remove("test_adaptive.huf");
+    remove("test_adaptive.out");
+    free(data);
+    printf("Memória liberada\n\n");
+}
+
+// O cabeçalho guarda o tamanho original: a saída tem exatamente os bytes da entrada
+static int restoredMatches(const ByteSink* sink, const unsigned char* data, size_t length) {
+    return sink->position == length && (length == 0 || memcmp(sink->data, data, length) == 0);
+}
+
+void testByteStreams() {
+    printf("=== Testando Origens e Destinos de Bytes ===\n");
+    
+    // Texto compressível maior que a janela de peek
+    size_t length = 3 * STREAM_BUFFER_SIZE + 123;
+    unsigned char* data = (unsigned char*)malloc(length);
+    const char* words[] = {"origem ", "destino ", "transporte ", "mmap ", "\n"};
+    unsigned int seed = 11;
+    for (size_t i = 0; i < length; ) {
+        seed = seed * 1103515245u + 12345u;
+        const char* word = words[(seed >> 16) % 5];
+        for (size_t j = 0; word[j] != '\0' && i < length; j++) {
+            data[i++] = (unsigned char)word[j];
+        }
+    }
+    
+    // Teste 1: Ida e volta inteiramente em memória
+    printf("1. Comprimindo de memória para memória...\n");
+    ByteSource source;
+    ByteSink compressed;
+    ByteSink restored;
+    initMemorySource(&source, data, length);
+    initMemorySink(&compressed);
+    initMemorySink(&restored);
+    int result = compressSource(&source, &compressed);
+    ByteSource compressed_source;
+    initMemorySource(&compressed_source, compressed.data, compressed.position);
+    if (result == 0 && decompressSource(&compressed_source, &restored) == 0 && restoredMatches(&restored, data, length)) {
+        printf("✓ %zu -> %zu bytes e de volta\n", length, compressed.position);
+    } else {
+        printf("✗ Ida e volta em memória falhou\n");
+    }
+    
+    // Teste 2: Descritor, FILE* e mmap produzem os mesmos bytes
+    printf("2. Comparando os transportes...\n");
+    FILE* file = fopen("test_stream.txt", "wb");
+    fwrite(data, 1, length, file);
+    fclose(file);
+    
+    int fd = open("test_stream.huf", O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    ByteSource mapped;
+    ByteSink fd_sink;
+    initFdSink(&fd_sink, fd);
+    result = openMappedSource(&mapped, "test_stream.txt") == 0 ? compressSource(&mapped, &fd_sink) : -1;
+    closeSink(&fd_sink);
+    closeSource(&mapped);
+    close(fd);
+    
+    unsigned char* stored = (unsigned char*)malloc(compressed.position + 1);
+    file = fopen("test_stream.huf", "rb");
+    size_t stored_size = fread(stored, 1, compressed.position + 1, file);
+    fclose(file);
+    if (result == 0 && stored_size == compressed.position && memcmp(stored, compressed.data, stored_size) == 0) {
+        printf("✓ mmap -> descritor igual a memória -> memória\n");
+    } else {
+        printf("✗ Transportes produziram saídas diferentes\n");
+    }
+    
+    file = fopen("test_stream.huf", "rb");
+    ByteSource file_source;
+    ByteSink file_restored;
+    initFileSource(&file_source, file);
+    initMemorySink(&file_restored);
+    if (decompressSource(&file_source, &file_restored) == 0 && restoredMatches(&file_restored, data, length)) {
+        printf("✓ FILE* -> memória recupera os dados\n");
+    } else {
+        printf("✗ FILE* -> memória falhou\n");
+    }
+    closeSink(&file_restored);
+    closeSource(&file_source);
+    fclose(file);
+    
+    // Teste 3: Peek expõe até o buffer sem consumir
+    printf("3. Lendo com peek e read...\n");
+    file = fopen("test_stream.txt", "rb");
+    initFileSource(&file_source, file);
+    size_t available;
+    const unsigned char* window = sourcePeek(&file_source, 2 * STREAM_BUFFER_SIZE, &available);
+    unsigned char first[16];
+    int peek_ok = available == STREAM_BUFFER_SIZE && memcmp(window, data, available) == 0 &&
+                  sourceRemaining(&file_source) == (int64_t)length;
+    sourceSkip(&file_source, 100);
+    peek_ok = peek_ok && sourceRead(&file_source, first, sizeof(first)) == sizeof(first) &&
+              memcmp(first, data + 100, sizeof(first)) == 0 && sourceRewind(&file_source) == 0 &&
+              sourceGetc(&file_source) == data[0];
+    printf("%s Janela, consumo e retorno ao início consistentes\n", peek_ok ? "✓" : "✗");
+    closeSource(&file_source);
+    fclose(file);
+    
+    // Teste 4: Um pipe não pode ser relido
+    printf("4. Comprimindo de um pipe...\n");
+    int pipe_fds[2];
+    if (pipe(pipe_fds) == 0) {
+        if (write(pipe_fds[1], data, 1000) != 1000) {
+            printf("✗ Escrita no pipe falhou\n");
+        }
+        close(pipe_fds[1]);
+        ByteSource pipe_source;
+        ByteSink discard;
+        initFdSource(&pipe_source, pipe_fds[0]);
+        initMemorySink(&discard);
+        result = compressSource(&pipe_source, &discard);
+        printf("%s Entrada sem retorno ao início recusada\n", result != 0 ? "✓" : "✗");
+        closeSink(&discard);
+        closeSource(&pipe_source);
+        close(pipe_fds[0]);
+    }
+    
+    // Limpeza
+    closeSink(&compressed);
+    closeSink(&restored);
+    closeSource(&source);
+    closeSource(&compressed_source);
+    remove("test_stream.txt");
+    remove("test_stream.huf");
+    free(stored);
+    free(data);
+    printf("Memória liberada\n\n");
+}
+
+void testCompressionLevels() {
+    printf("=== Testando Níveis de Compressão ===\n");
+    
+    // Dois trechos com alfabetos diferentes na mesma janela de blocos
+    size_t half = 96 * 1024;
+    size_t length = 2 * half;
+    unsigned char* data = (unsigned char*)malloc(length);
+    unsigned int seed = 2024;
+    for (size_t i = 0; i < length; i++) {
+        seed = seed * 1103515245u + 12345u;
+        data[i] = i < half ? (unsigned char)('a' + (seed >> 16) % 8) : (unsigned char)(0x80 | (seed >> 16));
+    }
+    
+    MemoryPlan plan;
+    planMemoryBudget(0, &plan);
+    plan.block_size = 256 * 1024;
+    
+    FILE* input = tmpfile();
+    fwrite(data, 1, length, input);
+    
+    // Teste 1: Todos os níveis recuperam os dados
+    printf("1. Comprimindo e descomprimindo com os níveis %d a %d...\n",
+           COMPRESSION_LEVEL_MIN, COMPRESSION_LEVEL_MAX);
+    uint64_t sizes[COMPRESSION_LEVEL_MAX + 1] = {0};
+    int failures = 0;
+    for (int level = COMPRESSION_LEVEL_MIN; level <= COMPRESSION_LEVEL_MAX; level++) {
+        FILE* compressed = tmpfile();
+        FILE* output = tmpfile();
+        unsigned char* decoded = (unsigned char*)malloc(length);
+        rewind(input);
+        
+        BlockWorkspace workspace;
+        initBlockWorkspace(&workspace);
+        workspace.level = level;
+        BlockStats stats;
+        int result = compressStreamBlocksWith(input, compressed, &plan, &stats, &workspace);
+        freeBlockWorkspace(&workspace);
+        sizes[level] = stats.output_bytes;
+        
+        rewind(compressed);
+        if (result == 0) {
+            result = decompressStreamBlocks(compressed, output, NULL, NULL);
+        }
+        rewind(output);
+        size_t decoded_length = fread(decoded, 1, length, output);
+        
+        if (result != 0 || decoded_length != length || memcmp(decoded, data, length) != 0) {
+            printf("✗ Nível %d: dados diferentes\n", level);
+            failures++;
+        }
+        free(decoded);
+        fclose(compressed);
+        fclose(output);
+    }
+    if (failures == 0) {
+        printf("✓ Níveis %d a %d: dados recuperados (%llu a %llu bytes)\n",
+               COMPRESSION_LEVEL_MIN, COMPRESSION_LEVEL_MAX,
+               (unsigned long long)sizes[COMPRESSION_LEVEL_MAX], (unsigned long long)sizes[COMPRESSION_LEVEL_MIN]);
+    }
+    
+    // Teste 2: A busca da divisão separa os dois alfabetos
+    printf("2. Comparando o nível %d com o padrão...\n", COMPRESSION_LEVEL_MAX);
+    if (sizes[COMPRESSION_LEVEL_MAX] < sizes[COMPRESSION_LEVEL_DEFAULT]) {
+        printf("✓ Nível %d: %llu bytes, padrão: %llu bytes\n", COMPRESSION_LEVEL_MAX,
+               (unsigned long long)sizes[COMPRESSION_LEVEL_MAX], (unsigned long long)sizes[COMPRESSION_LEVEL_DEFAULT]);
+    } else {
+        printf("✗ Nível %d não reduziu a saída\n", COMPRESSION_LEVEL_MAX);
+    }
+    
+    // Teste 3: Níveis rápidos repetem a árvore entre blocos parecidos; níveis
+    // inválidos são recusados
+    printf("3. Verificando as estratégias...\n");
+    FILE* similar = tmpfile();
+    FILE* compressed = tmpfile();
+    fwrite(data, 1, half, similar);
+    rewind(similar);
+    plan.block_size = 8 * 1024;
+    
+    BlockWorkspace workspace;
+    initBlockWorkspace(&workspace);
+    workspace.level = COMPRESSION_LEVEL_MIN;
+    compressStreamBlocksWith(similar, compressed, &plan, NULL, &workspace);
+    uint64_t reused_tables = workspace.table_hits;
+    freeBlockWorkspace(&workspace);
+    fclose(similar);
+    fclose(compressed);
+    
+    LevelStrategy strategy;
+    if (reused_tables > 0 && getLevelStrategy(COMPRESSION_LEVEL_MAX + 1, &strategy) != 0 &&
+        getLevelStrategy(0, &strategy) == 0 && strategy.level == COMPRESSION_LEVEL_DEFAULT) {
+        printf("✓ Nível %d repetiu %llu árvore(s); nível %d recusado\n",
+               COMPRESSION_LEVEL_MIN, (unsigned long long)reused_tables, COMPRESSION_LEVEL_MAX + 1);
+    } else {
+        printf("✗ Estratégias incorretas\n");
+    }
+    
+    // Limpeza
+    fclose(input);
+    free(data);
+    printf("Memória liberada\n\n");
+}
+
+// Relatórios recebidos pelo callback de teste
+typedef struct ProgressLog {
+    int reports;                  // Relatórios intermediários
+    int finished;                 // Relatórios finais
+    int inside;                   // Callbacks em execução (atômico)
+    int overlapped;               // 1 se dois callbacks rodaram ao mesmo tempo
+    int went_back;                // 1 se o total processado diminuiu
+    uint64_t last;                // Último total processado
+} ProgressLog;
+
+static void logProgress(const ProgressReport* report, void* context) {
+    ProgressLog* log = (ProgressLog*)context;
+    if (__atomic_add_fetch(&log->inside, 1, __ATOMIC_RELAXED) > 1) {
+        log->overlapped = 1;
+    }
+    if (report->processed < log->last) {
+        log->went_back = 1;
+    }
+    log->last = report->processed;
+    if (report->finished) {
+        log->finished++;
+    } else {
+        log->reports++;
+    }
+    __atomic_sub_fetch(&log->inside, 1, __ATOMIC_RELAXED);
+}
+
+static void* progressThread(void* argument) {
+    ProgressTracker* tracker = (ProgressTracker*)argument;
+    for (int i = 0; i < 200000; i++) {
+        progressAdvance(tracker, 1);
+    }
+    return NULL;
+}
+
+void testProgress() {
+    printf("=== Testando Relatório de Progresso ===\n");
+    
+    size_t length = 3 * 1024 * 1024;
+    unsigned char* data = (unsigned char*)malloc(length);
+    for (size_t i = 0; i < length; i++) {
+        data[i] = (unsigned char)("progresso de blocos "[i % 20]);
+    }
+    FILE* input = tmpfile();
+    FILE* compressed = tmpfile();
+    FILE* output = tmpfile();
+    fwrite(data, 1, length, input);
+    rewind(input);
+    
+    MemoryPlan plan;
+    planMemoryBudget(0, &plan);
+    plan.block_size = 64 * 1024;
+    
+    // Teste 1: O laço de blocos soma todos os bytes de entrada
+    printf("1. Comprimindo com progresso...\n");
+    ProgressLog log;
+    memset(&log, 0, sizeof(log));
+    ProgressTracker tracker;
+    initProgressTracker(&tracker, length, 1, logProgress, &log);
+    BlockWorkspace workspace;
+    initBlockWorkspace(&workspace);
+    workspace.progress = &tracker;
+    int result = compressStreamBlocksWith(input, compressed, &plan, NULL, &workspace);
+    progressFinish(&tracker);
+    
+    if (result == 0 && log.finished == 1 && log.last == length && !log.went_back) {
+        printf("✓ %llu bytes relatados (%d relatórios intermediários)\n",
+               (unsigned long long)log.last, log.reports);
+    } else {
+        printf("✗ Progresso incorreto: %llu de %zu bytes\n", (unsigned long long)log.last, length);
+    }
+    
+    // Teste 2: A descompressão conta os bytes do contêiner
+    printf("2. Descomprimindo com progresso...\n");
+    uint64_t compressed_size = (uint64_t)ftell(compressed);
+    rewind(compressed);
+    memset(&log, 0, sizeof(log));
+    initProgressTracker(&tracker, compressed_size, 1, logProgress, &log);
+    result = decompressStreamBlocksWith(compressed, output, NULL, NULL, &workspace);
+    progressFinish(&tracker);
+    
+    if (result == 0 && log.last == compressed_size && !log.went_back) {
+        printf("✓ %llu bytes do contêiner relatados\n", (unsigned long long)log.last);
+    } else {
+        printf("✗ Progresso incorreto: %llu de %llu bytes\n",
+               (unsigned long long)log.last, (unsigned long long)compressed_size);
+    }
+    
+    // Teste 3: Várias threads somam sem perdas e um único callback roda por vez
+    printf("3. Atualizando de várias threads...\n");
+    memset(&log, 0, sizeof(log));
+    initProgressTracker(&tracker, 0, 1, logProgress, &log);
+    pthread_t threads[4];
+    for (int i = 0; i < 4; i++) {
+        pthread_create(&threads[i], NULL, progressThread, &tracker);
+    }
+    for (int i = 0; i < 4; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    progressFinish(&tracker);
+    
+    if (log.last == 4 * 200000 && !log.overlapped) {
+        printf("✓ %llu bytes somados por 4 threads\n", (unsigned long long)log.last);
+    } else {
+        printf("✗ Soma incorreta (%llu) ou callbacks simultâneos\n", (unsigned long long)log.last);
+    }
+    
+    // Limpeza
+    freeBlockWorkspace(&workspace);
+    fclose(input);
+    fclose(compressed);
+    fclose(output);
+    free(data);
+    printf("Memória liberada\n\n");
+}
+
+void testSizeEstimate() {
+    printf("=== Testando Estimativa de Tamanho ===\n");
+    
+    // Texto, um único símbolo repetido e bytes pseudoaleatórios (blocos sem codificação)
+    size_t length = 300 * 1024;
+    unsigned char* data = (unsigned char*)malloc(length);
+    const char* names[] = {"texto", "um símbolo", "aleatório"};
+    MemoryPlan plan;
+    planMemoryBudget(0, &plan);
+    plan.block_size = 64 * 1024;
+    
+    printf("1. Comparando a estimativa com a compressão real...\n");
+    for (int kind = 0; kind < 3; kind++) {
+        unsigned int seed = 99;
+        for (size_t i = 0; i < length; i++) {
+            seed = seed * 1103515245u + 12345u;
+            data[i] = kind == 0 ? (unsigned char)("estimativa exata "[i % 17]) :
+                      kind == 1 ? 'z' : (unsigned char)(seed >> 16);
+        }
+        FILE* file = fopen("test_estimate.bin", "wb");
+        fwrite(data, 1, length, file);
+        fclose(file);
+        
+        SizeEstimate estimate;
+        int estimated = estimateFileSize("test_estimate.bin", &plan, &estimate);
+        int compressed = compressFile("test_estimate.bin", "test_estimate.huf") == 0 &&
+                         compressFileBlocks("test_estimate.bin", "test_estimate.hufb", &plan, NULL) == 0;
+        int64_t single_size = getFileSize("test_estimate.huf");
+        int64_t block_size = getFileSize("test_estimate.hufb");
+        
+        if (estimated == 0 && compressed && estimate.input_bytes == length &&
+            (int64_t)estimate.single_stream_bytes == single_size && (int64_t)estimate.block_bytes == block_size) {
+            printf("✓ %s: %lld e %lld bytes, como previsto\n", names[kind],
+                   (long long)single_size, (long long)block_size);
+        } else {
+            printf("✗ %s: previsto %lld/%llu, real %lld/%lld\n", names[kind],
+                   (long long)estimate.single_stream_bytes, (unsigned long long)estimate.block_bytes,
+                   (long long)single_size, (long long)block_size);
+        }
+    }
+    
+    // Teste 2: Entradas vazias têm só os cabeçalhos
+    printf("2. Estimando uma entrada vazia...\n");
+    FILE* empty = tmpfile();
+    SizeEstimate estimate;
+    if (estimateStreamSize(empty, &plan, &estimate) == 0 && estimate.single_stream_bytes == STREAM_HEADER_SIZE + 1 &&
+        estimate.blocks == 0) {
+        printf("✓ Entrada vazia: %llu e %llu bytes\n", (unsigned long long)estimate.single_stream_bytes,
+               (unsigned long long)estimate.block_bytes);
+    } else {
+        printf("✗ Estimativa incorreta para a entrada vazia\n");
+    }
+    fclose(empty);
+    
+    // Limpeza
+    remove("test_estimate.bin");
+    remove("test_estimate.huf");
+    remove("test_estimate.hufb");
+    free(data);
+    printf("Arquivos de teste removidos\n\n");
+}
+
+void testTransforms() {
+    printf("=== Testando Transformações dos Blocos ===\n");
+    
+    // Sequências longas de zeros, rampa lenta (sensores) e texto
+    size_t length = 256 * 1024;
+    unsigned char* data = (unsigned char*)malloc(length);
+    unsigned char* transformed = (unsigned char*)malloc(length);
+    unsigned char* restored = (unsigned char*)malloc(length);
+    const char* names[] = {"zeros esparsos", "rampa", "texto"};
+    
+    printf("1. Aplicando e desfazendo cada transformação...\n");
+    for (int kind = 0; kind < 3; kind++) {
+        unsigned int seed = 7;
+        int value = 128;
+        for (size_t i = 0; i < length; i++) {
+            seed = seed * 1103515245u + 12345u;
+            value += (int)((seed >> 16) % 5) - 2;
+            data[i] = kind == 0 ? (i % 301 == 0 ? (unsigned char)(seed >> 16) : 0) :
+                      kind == 1 ? (unsigned char)value : (unsigned char)("bloco transformado "[i % 19]);
+        }
+        
+        int ok = 1;
+        for (int type = TRANSFORM_RLE; type < TRANSFORM_COUNT; type++) {
+            size_t produced = applyTransform((TransformType)type, data, length, transformed, length);
+            // O RLE pode não caber se a entrada não tem repetições; os demais sempre cabem
+            if (produced == 0 && type == TRANSFORM_RLE) {
+                continue;
+            }
+            memset(restored, 0xAA, length);
+            if (produced == 0 ||
+                invertTransform((TransformType)type, transformed, produced, restored, length) != 0 ||
+                memcmp(data, restored, length) != 0) {
+                printf("✗ %s: falha na transformação %s\n", names[kind], transformName((TransformType)type));
+                ok = 0;
+            }
+        }
+        if (ok) {
+            printf("✓ %s: rle, delta e mtf restauram os bytes originais (escolhida: %s)\n",
+                   names[kind], transformName(chooseTransform(data, length, TRANSFORM_ALL)));
+        }
+    }
+    
+    // Teste 2: Sequências que passam do maior contador e terminam no limite
+    printf("2. Testando os limites do RLE...\n");
+    memset(data, 'r', 1000);
+    memset(data + 1000, 's', RLE_MIN_RUN);
+    size_t produced = applyTransform(TRANSFORM_RLE, data, 1000 + RLE_MIN_RUN, transformed, length);
+    if (produced > 0 && produced < 40 &&
+        invertTransform(TRANSFORM_RLE, transformed, produced, restored, 1000 + RLE_MIN_RUN) == 0 &&
+        memcmp(data, restored, 1000 + RLE_MIN_RUN) == 0) {
+        printf("✓ 1004 bytes viraram %zu e foram restaurados\n", produced);
+    } else {
+        printf("✗ Falha nos limites do RLE\n");
+    }
+    if (produced > 0 && invertTransform(TRANSFORM_RLE, transformed, produced - 1, restored, 1000 + RLE_MIN_RUN) != 0) {
+        printf("✓ Fluxo RLE truncado rejeitado\n");
+    } else {
+        printf("✗ Fluxo RLE truncado aceito\n");
+    }
+    
+    // Teste 3: Contêiner com transformações, comparado com o padrão
+    printf("3. Comprimindo em blocos com e sem transformações...\n");
+    MemoryPlan plan;
+    planMemoryBudget(0, &plan);
+    plan.block_size = 64 * 1024;
+    for (int kind = 0; kind < 2; kind++) {
+        unsigned int seed = 11;
+        int value = 0;
+        for (size_t i = 0; i < length; i++) {
+            seed = seed * 1103515245u + 12345u;
+            value += (int)((seed >> 16) % 3) - 1;
+            data[i] = kind == 0 ? (i % 211 == 0 ? (unsigned char)(seed >> 16) : 0) : (unsigned char)value;
+        }
+        FILE* file = fopen("test_transform.bin", "wb");
+        fwrite(data, 1, length, file);
+        fclose(file);
+        
+        BlockWorkspace workspace;
+        initBlockWorkspace(&workspace);
+        workspace.transforms = TRANSFORM_ALL;
+        BlockStats stats;
+        int compressed = compressFileBlocks("test_transform.bin", "test_transform.plain", &plan, NULL) == 0 &&
+                         compressFileBlocksWith("test_transform.bin", "test_transform.huf", &plan, &stats,
+                                                &workspace) == 0;
+        freeBlockWorkspace(&workspace);
+        int restored_ok = compressed &&
+                          decompressFileBlocks("test_transform.huf", "test_transform.out", NULL, NULL) == 0 &&
+                          validateCompression("test_transform.bin", "test_transform.out");
+        int64_t plain_size = getFileSize("test_transform.plain");
+        int64_t transformed_size = getFileSize("test_transform.huf");
+        
+        if (restored_ok && stats.transformed_blocks > 0 && transformed_size < plain_size) {
+            printf("✓ %s: %lld -> %lld bytes (%llu blocos transformados)\n", names[kind],
+                   (long long)plain_size, (long long)transformed_size,
+                   (unsigned long long)stats.transformed_blocks);
+        } else {
+            printf("✗ %s: %lld -> %lld bytes, restaurado: %d\n", names[kind],
+                   (long long)plain_size, (long long)transformed_size, restored_ok);
+        }
+    }
+    
+    // Teste 4: Lista de transformações da linha de comando
+    printf("4. Interpretando listas de transformações...\n");
+    int mask = 0;
+    int parsed = parseTransformList("delta,rle", &mask) == 0 &&
+                 mask == (TRANSFORM_BIT(TRANSFORM_DELTA) | TRANSFORM_BIT(TRANSFORM_RLE));
+    int auto_mask = 0;
+    parsed = parsed && parseTransformList("auto", &auto_mask) == 0 && auto_mask == TRANSFORM_ALL;
+    parsed = parsed && parseTransformList("none", &mask) == 0 && mask == 0;
+    if (parsed && parseTransformList("zip", &mask) != 0) {
+        printf("✓ Listas válidas aceitas e nomes desconhecidos rejeitados\n");
+    } else {
+        printf("✗ Falha ao interpretar as listas\n");
+    }
+    
+    // Teste 5: O plano reserva o bloco transformado nos dois sentidos
+    printf("5. Comprimindo e descomprimindo com transformações e limite de 1 MiB...\n");
+    MemoryPlan limited;
+    size_t limit = 1024 * 1024;
+    int planned = planMemoryBudgetFor(limit, PLAN_TRANSFORMS, &limited) == 0 && limited.planned_peak <= limit;
+    BlockWorkspace workspace;
+    initBlockWorkspace(&workspace);
+    workspace.transforms = TRANSFORM_ALL;
+    BlockStats limited_stats;
+    setMemoryLimit(limit);
+    int round_trip = planned &&
+                     compressFileBlocksWith("test_transform.bin", "test_transform.huf", &limited, &limited_stats,
+                                            &workspace) == 0;
+    freeBlockWorkspace(&workspace);
+    round_trip = round_trip &&
+                 decompressFileBlocks("test_transform.huf", "test_transform.out", &limited, NULL) == 0 &&
+                 validateCompression("test_transform.bin", "test_transform.out");
+    
+    // Um limite que comporta os blocos mas não o buffer transformado é recusado antes de gravar
+    MemoryPlan tight = limited;
+    tight.limit = workspaceMemoryRequirement(limited.block_size, 0);
+    remove("test_transform.out");
+    int refused = decompressFileBlocks("test_transform.huf", "test_transform.out", &tight, NULL) != 0 &&
+                  !fileExists("test_transform.out");
+    setMemoryLimit(0);
+    if (round_trip && limited_stats.transformed_blocks > 0 && refused) {
+        printf("✓ %llu blocos transformados dentro do limite; limite sem o buffer recusado\n",
+               (unsigned long long)limited_stats.transformed_blocks);
+    } else {
+        printf("✗ Falha com transformações e limite (ida e volta: %d, recusa: %d)\n", round_trip, refused);
+    }
+    
+    // Limpeza
+    remove("test_transform.bin");
+    remove("test_transform.plain");
+    remove("test_transform.huf");
+    remove("test_transform.out");
+    free(data);
+    free(transformed);
+    free(restored);
+    printf("Arquivos de teste removidos\n\n");
+}
+
+void testStreamHeader() {
+    printf("=== Testando o Cabeçalho do Fluxo Único ===\n");
+    
+    // Entradas cujo fluxo de bits termina no meio de um byte, vazias e de um símbolo
+    const char* names[] = {"vazia", "um símbolo", "preenchimento", "texto"};
+    size_t lengths[] = {0, 100000, 3, 50001};
+    unsigned char* data = (unsigned char*)malloc(100000);
+    
+    printf("1. Ida e volta com o tamanho exato...\n");
+    for (int kind = 0; kind < 4; kind++) {
+        size_t length = lengths[kind];
+        for (size_t i = 0; i < length; i++) {
+            data[i] = kind == 1 ? 'q' : kind == 2 ? (unsigned char)("aab"[i]) : (unsigned char)("cabeçalho "[i % 11]);
+        }
+        
+        ByteSource source;
+        ByteSink compressed;
+        ByteSink restored;
+        initMemorySource(&source, data, length);
+        initMemorySink(&compressed);
+        initMemorySink(&restored);
+        int result = compressSource(&source, &compressed);
+        ByteSource compressed_source;
+        initMemorySource(&compressed_source, compressed.data, compressed.position);
+        
+        unsigned long frequencies[MAX_CHAR] = {0};
+        countFrequencies(data, length, frequencies);
+        if (result == 0 && decompressSource(&compressed_source, &restored) == 0 &&
+            restoredMatches(&restored, data, length) && compressed.position == estimateCompressedSize(frequencies)) {
+            printf("✓ %s: %zu -> %zu bytes e de volta\n", names[kind], length, compressed.position);
+        } else {
+            printf("✗ %s: ida e volta falhou (%zu bytes restaurados)\n", names[kind], restored.position);
+        }
+        
+        // Sem o último byte, o fluxo fica curto demais para o tamanho gravado
+        if (kind >= 2) {
+            ByteSource truncated;
+            ByteSink discard;
+            initMemorySource(&truncated, compressed.data, compressed.position - 1);
+            initMemorySink(&discard);
+            if (decompressSource(&truncated, &discard) != 0) {
+                printf("✓ %s: fluxo truncado rejeitado\n", names[kind]);
+            } else {
+                printf("✗ %s: fluxo truncado aceito\n", names[kind]);
+            }
+            closeSink(&discard);
+        }
+        closeSink(&compressed);
+        closeSink(&restored);
+    }
+    
+    // Teste 2: Arquivos sem cabeçalho (formato antigo) continuam legíveis
+    printf("2. Lendo o formato antigo, sem cabeçalho...\n");
+    unsigned long frequencies[MAX_CHAR] = {0};
+    countFrequencies(data, lengths[3], frequencies);
+    HuffmanNode* root = buildHuffmanTree(frequencies);
+    char codes[MAX_CHAR][MAX_TREE_HT] = {{0}};
+    char current_code[MAX_TREE_HT] = {0};
+    generateHuffmanCodes(root, current_code, 0, codes);
+    
+    ByteSource source;
+    ByteSink legacy;
+    ByteSink restored;
+    initMemorySource(&source, data, lengths[3]);
+    initMemorySink(&legacy);
+    initMemorySink(&restored);
+    serializeTree(&legacy, root);
+    sinkPutc(&legacy, 0xFF);
+    writeCompressedData(&source, &legacy, codes);
+    freeHuffmanTree(root);
+    
+    ByteSource legacy_source;
+    initMemorySource(&legacy_source, legacy.data, legacy.position);
+    if (decompressSource(&legacy_source, &restored) == 0 && restored.position >= lengths[3] &&
+        memcmp(restored.data, data, lengths[3]) == 0) {
+        printf("✓ Formato antigo decodificado (%zu bytes)\n", restored.position);
+    } else {
+        printf("✗ Falha ao ler o formato antigo\n");
+    }
+    closeSink(&legacy);
+    closeSink(&restored);
+    
+    // Teste 3: A saída em arquivo é reservada e tem o tamanho exato
+    printf("3. Descomprimindo para arquivo...\n");
+    FILE* file = fopen("test_header.txt", "wb");
+    fwrite(data, 1, lengths[3], file);
+    fclose(file);
+    if (compressFile("test_header.txt", "test_header.huf") == 0 &&
+        decompressFile("test_header.huf", "test_header.out") == 0 &&
+        getFileSize("test_header.out") == (int64_t)lengths[3] &&
+        validateCompression("test_header.txt", "test_header.out")) {
+        printf("✓ Arquivo restaurado com %zu bytes\n", lengths[3]);
+    } else {
+        printf("✗ Arquivo restaurado com %lld bytes\n", (long long)getFileSize("test_header.out"));
+    }
+
+    // Teste 4: Um tamanho original acima dos bits restantes não reserva nada
+    printf("4. Rejeitando um tamanho original forjado...\n");
+    size_t forged_length = (size_t)getFileSize("test_header.huf");
+    unsigned char* forged = (unsigned char*)malloc(forged_length);
+    file = fopen("test_header.huf", "rb");
+    size_t forged_read = fread(forged, 1, forged_length, file);
+    fclose(file);
+    uint64_t claimed = (uint64_t)1 << 30;
+    for (int i = 0; i < 8; i++) {
+        forged[STREAM_MAGIC_SIZE + 1 + i] = (unsigned char)(claimed >> (8 * i));
+    }
+    file = fopen("test_header.huf", "wb");
+    fwrite(forged, 1, forged_read, file);
+    fclose(file);
+
+    ByteSource forged_source;
+    ByteSink forged_output;
+    initMemorySource(&forged_source, forged, forged_read);
+    initMemorySink(&forged_output);
+    int memory_result = decompressSource(&forged_source, &forged_output);
+    if (memory_result != 0 && forged_output.capacity < forged_read) {
+        printf("✓ Memória: rejeitado sem crescer o destino\n");
+    } else {
+        printf("✗ Memória: resultado %d, destino com %zu bytes\n", memory_result, forged_output.capacity);
+    }
+    closeSink(&forged_output);
+
+    remove("test_header.out");
+    if (decompressFile("test_header.huf", "test_header.out") != 0 && !fileExists("test_header.out")) {
+        printf("✓ Arquivo: rejeitado sem deixar a saída\n");
+    } else {
+        printf("✗ Arquivo: saída com %lld bytes\n", (long long)getFileSize("test_header.out"));
+    }
+    free(forged);
+
+    // Limpeza
+    remove("test_header.txt");
+    remove("test_header.huf");
+    remove("test_header.out");
+    free(data);
+    printf("Arquivos de teste removidos\n\n");
+}
+
+void testParallelDecode() {
+    printf("=== Testando a Decodificação Paralela de um Fluxo ===\n");
+    
+    // Texto com bytes raros (códigos maiores que a janela da tabela)
+    size_t length = 3 * 1024 * 1024 + 77;
+    unsigned char* data = (unsigned char*)malloc(length);
+    const char* words[] = {"sincronização ", "trecho ", "fluxo ", "de ", "bits ", "huffman\n"};
+    unsigned int seed = 23;
+    for (size_t i = 0; i < length; ) {
+        seed = seed * 1103515245u + 12345u;
+        if ((seed >> 8) % 4000 == 0) {
+            data[i++] = (unsigned char)(seed >> 20);
+            continue;
+        }
+        const char* word = words[(seed >> 16) % 6];
+        for (size_t j = 0; word[j] != '\0' && i < length; j++) {
+            data[i++] = (unsigned char)word[j];
+        }
+    }
+    
+    // Fluxo no formato atual (com tamanho) e no antigo (sem cabeçalho)
+    unsigned long frequencies[MAX_CHAR] = {0};
+    countFrequencies(data, length, frequencies);
+    HuffmanNode* root = buildHuffmanTree(frequencies);
+    char codes[MAX_CHAR][MAX_TREE_HT] = {{0}};
+    char current_code[MAX_TREE_HT] = {0};
+    generateHuffmanCodes(root, current_code, 0, codes);
+    
+    ByteSource source;
+    ByteSink stream;
+    initMemorySource(&source, data, length);
+    initMemorySink(&stream);
+    writeCompressedData(&source, &stream, codes);
+    
+    // Referência do formato antigo: a decodificação em série até o fim da entrada
+    ByteSource stream_source;
+    ByteSink legacy_reference;
+    initMemorySource(&stream_source, stream.data, stream.position);
+    initMemorySink(&legacy_reference);
+    readCompressedData(&stream_source, &legacy_reference, root, -1);
+    
+    printf("1. Comparando com a decodificação em série...\n");
+    DecodeMode modes[] = {DECODE_MODE_SINGLE, DECODE_MODE_MULTI};
+    int thread_counts[] = {2, 3, 8};
+    for (int m = 0; m < 2; m++) {
+        DecodeTable* table = buildDecodeTable(root, modes[m]);
+        for (int t = 0; t < 3; t++) {
+            ByteSink exact;
+            ByteSink legacy;
+            ParallelDecodeStats stats;
+            initMemorySink(&exact);
+            initMemorySink(&legacy);
+            int exact_result = decodeStreamParallel(stream.data, stream.position, table, (int64_t)length,
+                                                    &exact, thread_counts[t], &stats);
+            int legacy_result = decodeStreamParallel(stream.data, stream.position, table, -1,
+                                                     &legacy, thread_counts[t], NULL);
+            
+            if (exact_result == 0 && restoredMatches(&exact, data, length) && legacy_result == 0 &&
+                restoredMatches(&legacy, legacy_reference.data, legacy_reference.position)) {
+                printf("✓ %s, %d threads: %llu trechos, %llu sincronizados após %llu símbolos\n",
+                       m == 0 ? "um símbolo" : "vários símbolos", thread_counts[t],
+                       (unsigned long long)stats.segments, (unsigned long long)stats.synchronized,
+                       (unsigned long long)stats.resync_symbols);
+            } else {
+                printf("✗ %s, %d threads: saída diferente da série\n",
+                       m == 0 ? "um símbolo" : "vários símbolos", thread_counts[t]);
+            }
+            closeSink(&exact);
+            closeSink(&legacy);
+        }
+        freeDecodeTable(table);
+    }
+    
+    // Teste 2: Mais símbolos pedidos que os do fluxo
+    printf("2. Detectando fluxo truncado...\n");
+    DecodeTable* table = buildDecodeTable(root, DECODE_MODE_AUTO);
+    ByteSink discard;
+    initMemorySink(&discard);
+    if (decodeStreamParallel(stream.data, stream.position / 2, table, (int64_t)length, &discard, 4, NULL) != 0) {
+        printf("✓ Metade do fluxo rejeitada\n");
+    } else {
+        printf("✗ Fluxo truncado aceito\n");
+    }
+    closeSink(&discard);
+    freeDecodeTable(table);
+    
+    // Limpeza
+    closeSink(&stream);
+    closeSink(&legacy_reference);
+    freeHuffmanTree(root);
+    free(data);
+    printf("Memória liberada\n\n");
+}
+
+void testParallelEncode() {
+    printf("=== Testando a Codificação Paralela com Tabela Única ===\n");
+    
+    // Texto variado e dados enviesados (códigos de 1 bit) com poucos bytes no último trecho
+    size_t sizes[] = {5 * PARALLEL_ENCODE_CHUNK + 13, 2 * PARALLEL_ENCODE_CHUNK + 3, 100};
+    const char* names[] = {"texto", "enviesado", "pequeno"};
+    int thread_counts[] = {2, 3, 8};
+    
+    for (int kind = 0; kind < 3; kind++) {
+        size_t length = sizes[kind];
+        unsigned char* data = (unsigned char*)malloc(length);
+        unsigned int seed = 41 + (unsigned int)kind;
+        for (size_t i = 0; i < length; i++) {
+            seed = seed * 1103515245u + 12345u;
+            unsigned int r = (seed >> 16) % 1000;
+            data[i] = kind == 1 ? (r < 990 ? 'a' : (unsigned char)('b' + r % 4)) : (unsigned char)(' ' + r % 90);
+        }
+        
+        unsigned long frequencies[MAX_CHAR] = {0};
+        countFrequencies(data, length, frequencies);
+        HuffmanNode* root = buildHuffmanTree(frequencies);
+        char codes[MAX_CHAR][MAX_TREE_HT] = {{0}};
+        char current_code[MAX_TREE_HT] = {0};
+        generateHuffmanCodes(root, current_code, 0, codes);
+        CodeTable table;
+        buildCodeTable(codes, &table);
+        PairCodeTable* pairs = buildPairCodeTable(&table);
+        
+        // Referência: codificação em série
+        ByteSink reference;
+        unsigned char out_buffer[BUFFER_SIZE];
+        BitWriter writer;
+        initMemorySink(&reference);
+        initBitWriter(&writer, out_buffer, BUFFER_SIZE, &reference);
+        encodeSymbols(&writer, data, length, &table, NULL);
+        flushBitWriter(&writer);
+        
+        for (int t = 0; t < 3; t++) {
+            for (int use_pairs = 0; use_pairs < 2; use_pairs++) {
+                ByteSink parallel;
+                ParallelEncodeStats stats;
+                initMemorySink(&parallel);
+                int result = encodeStreamParallel(data, length, &table, use_pairs ? pairs : NULL,
+                                                  &parallel, thread_counts[t], &stats);
+                
+                if (result == 0 && restoredMatches(&parallel, reference.data, reference.position) &&
+                    stats.bits <= reference.position * 8 && stats.bits + 8 > reference.position * 8) {
+                    if (use_pairs) {
+                        printf("✓ %s, %d threads: %llu trechos em %llu rodadas, idêntico à série\n",
+                               names[kind], thread_counts[t], (unsigned long long)stats.chunks,
+                               (unsigned long long)stats.rounds);
+                    }
+                } else {
+                    printf("✗ %s, %d threads%s: saída diferente da série\n",
+                           names[kind], thread_counts[t], use_pairs ? " (pares)" : "");
+                }
+                closeSink(&parallel);
+            }
+        }
+        
+        closeSink(&reference);
+        freePairCodeTable(pairs);
+        freeHuffmanTree(root);
+        free(data);
+    }
+    
+    // Ida e volta pela origem em memória (caminho automático de writeCompressedData)
+    size_t length = PARALLEL_ENCODE_MIN_INPUT + 7;
+    unsigned char* data = (unsigned char*)malloc(length);
+    for (size_t i = 0; i < length; i++) {
+        data[i] = (unsigned char)("tabela única "[i % 13] + (i % 1009 == 0));
+    }
+    ByteSource source;
+    ByteSink compressed;
+    initMemorySource(&source, data, length);
+    initMemorySink(&compressed);
+    compressSource(&source, &compressed);
+    
+    ByteSource compressed_source;
+    ByteSink restored;
+    initMemorySource(&compressed_source, compressed.data, compressed.position);
+    initMemorySink(&restored);
+    if (decompressSource(&compressed_source, &restored) == 0 && restoredMatches(&restored, data, length)) {
+        printf("✓ Ida e volta de %zu bytes (%d threads disponíveis)\n", length, parallelEncodeThreads(length));
+    } else {
+        printf("✗ Ida e volta falhou\n");
+    }
+    
+    // Limpeza
+    closeSink(&compressed);
+    closeSink(&restored);
+    free(data);
+    printf("Memória liberada\n\n");
+}
+
+void testBlockPipeline() {
+    printf("=== Testando o Pipeline de Blocos ===\n");
+    
+    // Texto, ruído e um trecho repetido (para a deduplicação)
+    size_t length = 1536 * 1024;
+    unsigned char* data = (unsigned char*)malloc(length);
+    unsigned int seed = 23;
+    for (size_t i = 0; i < length; i++) {
+        seed = seed * 1103515245u + 12345u;
+        data[i] = i < length / 3 ? (unsigned char)("estágios ligados por filas "[i % 27]) :
+                  i < 2 * length / 3 ? (unsigned char)(seed >> 16) : data[i - length / 3];
+    }
+    FILE* file = fopen("test_pipeline.bin", "wb");
+    fwrite(data, 1, length, file);
+    fclose(file);
+    
+    MemoryPlan plan;
+    planMemoryBudget(0, &plan);
+    plan.block_size = 64 * 1024;
+    
+    // Teste 1: O contêiner do pipeline é idêntico ao do laço em série
+    printf("1. Comparando o pipeline com o laço em série...\n");
+    const char* names[] = {"nível 1", "nível 5", "nível 6", "transformações", "deduplicação"};
+    int levels[] = {1, 5, 6, 0, 0};
+    for (int config = 0; config < 5; config++) {
+        BlockStats stats[2];
+        int ok = 1;
+        for (int pipelined = 0; pipelined < 2; pipelined++) {
+            BlockWorkspace workspace;
+            initBlockWorkspace(&workspace);
+            workspace.level = levels[config];
+            workspace.transforms = config == 3 ? TRANSFORM_ALL : 0;
+            workspace.dedup = config == 4;
+            workspace.pipeline = pipelined;
+            ok = ok && compressFileBlocksWith("test_pipeline.bin", pipelined ? "test_pipeline.par" : "test_pipeline.ser",
+                                              &plan, &stats[pipelined], &workspace) == 0;
+            freeBlockWorkspace(&workspace);
+        }
+        
+        if (ok && validateCompression("test_pipeline.ser", "test_pipeline.par") &&
+            stats[0].pipeline_stages == 0 && stats[1].pipeline_stages == 4 &&
+            stats[1].blocks == stats[0].blocks && stats[1].queues[0].items == stats[1].blocks) {
+            printf("✓ %s: contêineres idênticos (%llu blocos, ocupação média %.2f/%zu)\n", names[config],
+                   (unsigned long long)stats[1].blocks, stats[1].queues[2].average_occupancy,
+                   stats[1].queues[2].capacity);
+        } else {
+            printf("✗ %s: contêiner do pipeline difere do laço em série\n", names[config]);
+        }
+    }
+    
+    // Teste 2: Descompressão em pipeline (a deduplicação usa o laço em série)
+    printf("2. Descomprimindo em pipeline...\n");
+    int decompressed_ok = 1;
+    for (int dedup = 0; dedup < 2; dedup++) {
+        BlockWorkspace workspace;
+        initBlockWorkspace(&workspace);
+        workspace.transforms = TRANSFORM_ALL;
+        workspace.dedup = dedup;
+        compressFileBlocksWith("test_pipeline.bin", "test_pipeline.huf", &plan, NULL, &workspace);
+        freeBlockWorkspace(&workspace);
+        
+        BlockStats stats;
+        initBlockWorkspace(&workspace);
+        workspace.pipeline = 1;
+        int result = decompressFileBlocksWith("test_pipeline.huf", "test_pipeline.out", NULL, &stats, &workspace);
+        freeBlockWorkspace(&workspace);
+        if (result != 0 || !validateCompression("test_pipeline.bin", "test_pipeline.out") ||
+            stats.input_bytes != length || stats.pipeline_stages != (dedup ? 0 : 3)) {
+            printf("✗ Falha na descompressão %s deduplicação\n", dedup ? "com" : "sem");
+            decompressed_ok = 0;
+        }
+    }
+    if (decompressed_ok) {
+        printf("✓ Arquivo restaurado em pipeline e pelo laço em série com deduplicação\n");
+    }
+    
+    // Teste 3: Contêiner truncado no meio de um bloco
+    printf("3. Rejeitando um contêiner truncado...\n");
+    int64_t size = getFileSize("test_pipeline.huf");
+    FILE* whole = fopen("test_pipeline.huf", "rb");
+    FILE* truncated = fopen("test_pipeline.cut", "wb");
+    for (int64_t i = 0; i < size / 2; i++) {
+        fputc(fgetc(whole), truncated);
+    }
+    fclose(whole);
+    fclose(truncated);
+    BlockWorkspace workspace;
+    initBlockWorkspace(&workspace);
+    workspace.pipeline = 1;
+    if (decompressFileBlocksWith("test_pipeline.cut", "test_pipeline.out", NULL, NULL, &workspace) != 0) {
+        printf("✓ Contêiner truncado rejeitado sem travar os estágios\n");
+    } else {
+        printf("✗ Contêiner truncado aceito\n");
+    }
+    freeBlockWorkspace(&workspace);
+    
+    // Limpeza
+    remove("test_pipeline.bin");
+    remove("test_pipeline.ser");
+    remove("test_pipeline.par");
+    remove("test_pipeline.huf");
+    remove("test_pipeline.cut");
+    remove("test_pipeline.out");
+    free(data);
+    printf("Arquivos de teste removidos\n\n");
+}
+
+void testWideSymbols() {
+    printf("=== Testando o Alfabeto de 16 Bits ===\n");
+    
+    // Teste 1: Frequências de Fibonacci passam do limite de comprimento
+    printf("1. Limitando os comprimentos dos códigos...\n");
+    uint32_t* frequencies = (uint32_t*)calloc(WIDE_ALPHABET, sizeof(uint32_t));
+    unsigned char* lengths = (unsigned char*)malloc(WIDE_ALPHABET);
+    uint32_t previous = 1;
+    uint32_t current = 1;
+    for (int s = 0; s < 40; s++) {
+        frequencies[s * 1601] = current;
+        uint32_t next = previous + current;
+        previous = current;
+        current = next;
+    }
+    int symbols = buildWideCodeLengths(frequencies, lengths);
+    int max_length = 0;
+    uint64_t kraft = 0;
+    for (int s = 0; s < WIDE_ALPHABET; s++) {
+        if (lengths[s] > 0) {
+            kraft += 1ull << (WIDE_MAX_CODE_LENGTH - lengths[s]);
+            max_length = lengths[s] > max_length ? lengths[s] : max_length;
+        }
+    }
+    if (symbols == 40 && max_length == WIDE_MAX_CODE_LENGTH && kraft == (1ull << WIDE_MAX_CODE_LENGTH)) {
+        printf("✓ 40 símbolos com códigos de até %d bits (código completo)\n", max_length);
+    } else {
+        printf("✗ %d símbolos, maior código %d, Kraft %llu\n", symbols, max_length, (unsigned long long)kraft);
+    }
+    
+    // Teste 2: Muitos símbolos raros (subtabelas) e tamanho ímpar
+    printf("2. Codificando e decodificando um bloco de 16 bits...\n");
+    size_t length = 200001;
+    unsigned char* data = (unsigned char*)malloc(length);
+    unsigned char* payload = (unsigned char*)malloc(2 * length);
+    unsigned char* restored = (unsigned char*)malloc(length);
+    unsigned int seed = 31;
+    for (size_t i = 0; i + 1 < length; i += 2) {
+        seed = seed * 1103515245u + 12345u;
+        unsigned int word = (seed >> 16) % ((seed >> 4) % 4096 + 1);
+        data[i] = (unsigned char)word;
+        data[i + 1] = (unsigned char)(word >> 8);
+    }
+    data[length - 1] = 0x5A;
+    memset(frequencies, 0, WIDE_ALPHABET * sizeof(uint32_t));
+    countWideFrequencies(data, length, frequencies);
+    symbols = buildWideCodeLengths(frequencies, lengths);
+    size_t size = encodeWideBlock(data, length, lengths, payload, 2 * length);
+    size_t expected = wideHeaderSize(lengths) + 1 + (wideCostBits(frequencies, lengths) + 7) / 8;
+    WideDecodeTable* table = buildWideDecodeTable(lengths);
+    if (size == expected && table != NULL && table->max_length > WIDE_ROOT_BITS &&
+        decodeWideBlock(payload, size, restored, length) == 0 && memcmp(data, restored, length) == 0) {
+        printf("✓ %d símbolos, códigos de até %d bits: %zu -> %zu bytes e restaurado\n",
+               symbols, table->max_length, length, size);
+    } else {
+        printf("✗ Falha no bloco de 16 bits (%zu bytes, esperado %zu)\n", size, expected);
+    }
+    freeWideDecodeTable(table);
+    
+    // Teste 3: Cabeçalhos inválidos e fluxo truncado
+    printf("3. Rejeitando conteúdos corrompidos...\n");
+    const unsigned char empty[] = {0x00, 0x00};
+    const unsigned char beyond[] = {0x02, 0xFF, 0xFF, 0x03, 0x01, 0x01, 0x01};
+    const unsigned char oversubscribed[] = {0x03, 0x00, 0x01, 0x00, 0x01, 0x00, 0x01, 0xFF};
+    int rejected = decodeWideBlock(empty, sizeof(empty), restored, 4) != 0 &&
+                   decodeWideBlock(beyond, sizeof(beyond), restored, 4) != 0 &&
+                   decodeWideBlock(oversubscribed, sizeof(oversubscribed), restored, 4) != 0 &&
+                   decodeWideBlock(payload, size / 2, restored, length) != 0;
+    if (rejected) {
+        printf("✓ Cabeçalhos inválidos e fluxo truncado rejeitados\n");
+    } else {
+        printf("✗ Conteúdo corrompido aceito\n");
+    }
+    
+    // Teste 4: Contêiner com texto UTF-16 e com bytes aleatórios
+    printf("4. Comprimindo em blocos com símbolos de 16 bits...\n");
+    // ação, coração, 日本語, テキスト, Привет e mundo
+    const unsigned short utf16[][7] = {
+        {0x61, 0xE7, 0xE3, 0x6F, 0}, {0x63, 0x6F, 0x72, 0x61, 0xE7, 0xE3, 0x6F},
+        {0x65E5, 0x672C, 0x8A9E, 0}, {0x30C6, 0x30AD, 0x30B9, 0x30C8, 0},
+        {0x41F, 0x440, 0x438, 0x432, 0x435, 0x442, 0}, {0x6D, 0x75, 0x6E, 0x64, 0x6F, 0}
+    };
+    size_t text_length = 0;
+    while (text_length + 32 < length) {
+        seed = seed * 1103515245u + 12345u;
+        const unsigned short* word = utf16[(seed >> 16) % 6];
+        for (int k = 0; k < 7 && word[k] != 0; k++) {
+            data[text_length++] = (unsigned char)word[k];
+            data[text_length++] = (unsigned char)(word[k] >> 8);
+        }
+        data[text_length++] = 0x20;
+        data[text_length++] = 0x00;
+    }
+    
+    MemoryPlan plan;
+    planMemoryBudget(0, &plan);
+    plan.block_size = 64 * 1024;
+    for (int kind = 0; kind < 2; kind++) {
+        FILE* file = fopen("test_wide.bin", "wb");
+        if (kind == 0) {
+            fwrite(data, 1, text_length, file);
+        } else {
+            for (size_t i = 0; i < length; i++) {
+                seed = seed * 1103515245u + 12345u;
+                fputc((int)(seed >> 16) & 0xFF, file);
+            }
+        }
+        fclose(file);
+        
+        BlockStats stats;
+        BlockStats decoded_stats;
+        BlockWorkspace workspace;
+        initBlockWorkspace(&workspace);
+        workspace.wide = 1;
+        int ok = compressFileBlocks("test_wide.bin", "test_wide.plain", &plan, NULL) == 0 &&
+                 compressFileBlocksWith("test_wide.bin", "test_wide.huf", &plan, &stats, &workspace) == 0;
+        freeBlockWorkspace(&workspace);
+        initBlockWorkspace(&workspace);
+        workspace.pipeline = 1;
+        ok = ok && decompressFileBlocks("test_wide.huf", "test_wide.out", NULL, &decoded_stats) == 0 &&
+             validateCompression("test_wide.bin", "test_wide.out") &&
+             decompressFileBlocksWith("test_wide.huf", "test_wide.out", NULL, NULL, &workspace) == 0 &&
+             validateCompression("test_wide.bin", "test_wide.out");
+        freeBlockWorkspace(&workspace);
+        
+        FILE* container = fopen("test_wide.huf", "rb");
+        fseek(container, BLOCK_MAGIC_SIZE, SEEK_SET);
+        int version = fgetc(container);
+        fclose(container);
+        int64_t plain_size = getFileSize("test_wide.plain");
+        int64_t wide_size = getFileSize("test_wide.huf");
+        
+        if (kind == 0 && ok && version == BLOCK_FORMAT_VERSION && stats.wide_blocks > 0 &&
+            decoded_stats.wide_blocks == stats.wide_blocks && wide_size < plain_size) {
+            printf("✓ UTF-16: %lld -> %lld bytes com %llu blocos de 16 bits, restaurado em série e em pipeline\n",
+                   (long long)plain_size, (long long)wide_size, (unsigned long long)stats.wide_blocks);
+        } else if (kind == 1 && ok && stats.wide_blocks == 0) {
+            printf("✓ Bytes aleatórios: nenhum bloco de 16 bits (%lld bytes)\n", (long long)wide_size);
+        } else {
+            printf("✗ %s: %lld -> %lld bytes, %llu blocos de 16 bits, restaurado: %d\n",
+                   kind == 0 ? "UTF-16" : "aleatórios", (long long)plain_size, (long long)wide_size,
+                   (unsigned long long)stats.wide_blocks, ok);
+        }
+    }
+    
+    // Teste 5: Com limite de memória, o plano reserva as tabelas de 16 bits
+    printf("5. Comprimindo UTF-16 com limite de 2 MiB...\n");
+    FILE* file = fopen("test_wide.bin", "wb");
+    fwrite(data, 1, text_length, file);
+    fclose(file);
+    MemoryPlan limited;
+    MemoryPlan small;
+    size_t limit = 2 * 1024 * 1024;
+    int planned = planMemoryBudgetFor(limit, PLAN_WIDE, &limited) == 0 && (limited.features & PLAN_WIDE) &&
+                  limited.planned_peak <= limit &&
+                  planMemoryBudgetFor(1024 * 1024, PLAN_WIDE, &small) == 0 && !(small.features & PLAN_WIDE);
+    BlockStats limited_stats;
+    BlockWorkspace workspace;
+    initBlockWorkspace(&workspace);
+    workspace.wide = 1;
+    setMemoryLimit(limit);
+    int ok = planned &&
+             compressFileBlocksWith("test_wide.bin", "test_wide.huf", &limited, &limited_stats, &workspace) == 0;
+    freeBlockWorkspace(&workspace);
+    ok = ok && decompressFileBlocks("test_wide.huf", "test_wide.out", &limited, NULL) == 0 &&
+         validateCompression("test_wide.bin", "test_wide.out");
+    setMemoryLimit(0);
+    if (ok && limited_stats.stored_blocks == 0 && limited_stats.wide_blocks == limited_stats.blocks) {
+        printf("✓ %llu blocos de %zu bytes, todos de 16 bits; sem espaço, o plano desliga o modo\n",
+               (unsigned long long)limited_stats.blocks, limited.block_size);
+    } else {
+        printf("✗ Plano: %d, %llu blocos sem codificação, %llu de 16 bits, restaurado: %d\n", planned,
+               (unsigned long long)limited_stats.stored_blocks, (unsigned long long)limited_stats.wide_blocks, ok);
+    }
+    
+    // Limpeza
+    remove("test_wide.bin");
+    remove("test_wide.plain");
+    remove("test_wide.huf");
+    remove("test_wide.out");
+    free(frequencies);
+    free(lengths);
+    free(data);
+    free(payload);
+    free(restored);
+    printf("Arquivos de teste removidos\n\n");
+}
+
+// Trabalhos entregues pelo callback do teste da API assíncrona
+typedef struct AsyncCallbackLog {
+    pthread_mutex_t mutex;
+    AsyncJob* jobs[8];
+    int count;
+} AsyncCallbackLog;
+
+static void recordAsyncCallback(AsyncJob* job, void* context) {
+    AsyncCallbackLog* log = (AsyncCallbackLog*)context;
+    pthread_mutex_lock(&log->mutex);
+    log->jobs[log->count++] = job;
+    pthread_mutex_unlock(&log->mutex);
+}
+
+void testAsyncCodec() {
+    printf("=== Testando a API Assíncrona ===\n");
+    
+    // Oito entradas diferentes de 256 KB
+    size_t length = 256 * 1024;
+    int inputs = 8;
+    unsigned char* data = (unsigned char*)malloc(length * (size_t)inputs);
+    unsigned int seed = 31;
+    for (size_t i = 0; i < length * (size_t)inputs; i++) {
+        seed = seed * 1103515245u + 12345u;
+        data[i] = (seed >> 16) % 7 == 0 ? (unsigned char)(seed >> 8) : (unsigned char)("fila de conclusões "[i % 19]);
+    }
+    
+    MemoryPlan plan;
+    planMemoryBudget(0, &plan);
+    plan.block_size = 64 * 1024;
+    AsyncPool* pool = createAsyncPool(2, 2, &plan);
+    
+    // Teste 1: Submissões com contrapressão e conclusões pelo descritor
+    printf("1. Comprimindo com fila limitada e notificação por descritor...\n");
+    AsyncJob* compressed[8];
+    int submitted = 0;
+    int collected = 0;
+    int notified = 0;
+    struct pollfd watch = {asyncCompletionFd(pool), POLLIN, 0};
+    while (collected < inputs) {
+        if (submitted < inputs) {
+            AsyncJob* job = createAsyncBufferJob(ASYNC_COMPRESS, data + length * (size_t)submitted, length);
+            job->context = (void*)(intptr_t)submitted;
+            int result = submitAsyncJob(pool, job);
+            if (result == 0) {
+                submitted++;
+                continue;
+            }
+            freeAsyncJob(job);
+        }
+        // Fila cheia (ou tudo submetido): espera o descritor como um laço de eventos
+        if (poll(&watch, 1, 10000) == 1 && (watch.revents & POLLIN)) {
+            notified = 1;
+        }
+        AsyncJob* done;
+        while ((done = nextAsyncCompletion(pool, 0)) != NULL) {
+            compressed[(intptr_t)done->context] = done;
+            collected++;
+        }
+    }
+    AsyncPoolStats stats;
+    getAsyncPoolStats(pool, &stats);
+    int all_done = 1;
+    for (int i = 0; i < inputs; i++) {
+        all_done = all_done && compressed[i]->status == ASYNC_DONE && compressed[i]->output_size < length;
+    }
+    if (all_done && notified && stats.completed == (uint64_t)inputs && stats.rejected > 0 && stats.max_queued <= 2 &&
+        poll(&watch, 1, 0) == 0) {
+        printf("✓ %d trabalhos concluídos, %llu submissões recusadas com a fila cheia\n", inputs,
+               (unsigned long long)stats.rejected);
+    } else {
+        printf("✗ Conclusões: %d, recusadas: %llu, notificado: %d\n", all_done,
+               (unsigned long long)stats.rejected, notified);
+    }
+    
+    // Teste 2: Descompressão com callback
+    printf("2. Descomprimindo com callback...\n");
+    AsyncCallbackLog log;
+    memset(&log, 0, sizeof(log));
+    pthread_mutex_init(&log.mutex, NULL);
+    for (int i = 0; i < inputs; i++) {
+        AsyncJob* job = createAsyncBufferJob(ASYNC_DECOMPRESS, compressed[i]->output, compressed[i]->output_size);
+        job->callback = recordAsyncCallback;
+        job->context = &log;
+        while (submitAsyncJob(pool, job) == 1) {
+            nextAsyncCompletion(pool, 1);
+        }
+    }
+    // Sem trabalhos na fila de conclusões, a espera termina quando nada mais está em execução
+    AsyncJob* stray = nextAsyncCompletion(pool, 1);
+    int restored = stray == NULL && log.count == inputs;
+    for (int i = 0; i < log.count; i++) {
+        AsyncJob* job = log.jobs[i];
+        int index = -1;
+        for (int j = 0; j < inputs; j++) {
+            if (job->input == compressed[j]->output) {
+                index = j;
+            }
+        }
+        restored = restored && index >= 0 && job->status == ASYNC_DONE && job->output_size == length &&
+                   memcmp(job->output, data + length * (size_t)index, length) == 0;
+        freeAsyncJob(job);
+    }
+    pthread_mutex_destroy(&log.mutex);
+    if (restored) {
+        printf("✓ %d entradas restauradas pelos callbacks\n", inputs);
+    } else {
+        printf("✗ Callbacks recebidos: %d de %d\n", log.count, inputs);
+    }
+    
+    // Teste 3: Descritores de arquivo na entrada e na saída
+    printf("3. Comprimindo e descomprimindo entre descritores...\n");
+    FILE* file = fopen("test_async.bin", "wb");
+    fwrite(data, 1, length * (size_t)inputs, file);
+    fclose(file);
+    int input_fd = open("test_async.bin", O_RDONLY);
+    int output_fd = open("test_async.huf", O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    AsyncJob* job = createAsyncFdJob(ASYNC_COMPRESS, input_fd, output_fd);
+    submitAsyncJob(pool, job);
+    AsyncJob* done = nextAsyncCompletion(pool, 1);
+    close(input_fd);
+    close(output_fd);
+    int fd_ok = done == job && job->status == ASYNC_DONE && job->output == NULL &&
+                job->stats.input_bytes == length * (size_t)inputs;
+    freeAsyncJob(job);
+    
+    input_fd = open("test_async.huf", O_RDONLY);
+    job = createAsyncFdJob(ASYNC_DECOMPRESS, input_fd, -1);
+    submitAsyncJob(pool, job);
+    done = nextAsyncCompletion(pool, 1);
+    close(input_fd);
+    fd_ok = fd_ok && done == job && job->status == ASYNC_DONE && job->output_size == length * (size_t)inputs &&
+            memcmp(job->output, data, job->output_size) == 0;
+    freeAsyncJob(job);
+    if (fd_ok) {
+        printf("✓ Arquivo comprimido entre descritores e restaurado em buffer\n");
+    } else {
+        printf("✗ Falha nos trabalhos com descritores\n");
+    }
+    
+    // Teste 4: Dados inválidos terminam com erro
+    printf("4. Descomprimindo dados inválidos...\n");
+    job = createAsyncBufferJob(ASYNC_DECOMPRESS, data, 4096);
+    submitAsyncJob(pool, job);
+    done = nextAsyncCompletion(pool, 1);
+    if (done == job && job->status == ASYNC_FAILED && job->output == NULL) {
+        printf("✓ Trabalho concluído com ASYNC_FAILED\n");
+    } else {
+        printf("✗ Dados inválidos não foram rejeitados\n");
+    }
+    freeAsyncJob(job);
+    for (int i = 0; i < inputs; i++) {
+        freeAsyncJob(compressed[i]);
+    }
+    destroyAsyncPool(pool);
+    
+    // Teste 5: Cancelamento na fila e em execução (uma thread, entrada grande)
+    printf("5. Cancelando trabalhos...\n");
+    size_t large_length = 32 * 1024 * 1024;
+    unsigned char* large = (unsigned char*)malloc(large_length);
+    for (size_t i = 0; i < large_length; i++) {
+        large[i] = data[i % (length * (size_t)inputs)];
+    }
+    pool = createAsyncPool(1, 4, &plan);
+    AsyncJob* running = createAsyncBufferJob(ASYNC_COMPRESS, large, large_length);
+    AsyncJob* queued = createAsyncBufferJob(ASYNC_COMPRESS, data, length);
+    submitAsyncJob(pool, running);
+    submitAsyncJob(pool, queued);
+    while (__atomic_load_n(&running->status, __ATOMIC_ACQUIRE) == ASYNC_PENDING) {
+        poll(NULL, 0, 1);
+    }
+    int queued_cancel = cancelAsyncJob(pool, queued);
+    AsyncJob* first = nextAsyncCompletion(pool, 0);
+    int running_cancel = cancelAsyncJob(pool, running);
+    AsyncJob* second = nextAsyncCompletion(pool, 1);
+    if (queued_cancel == 0 && first == queued && queued->status == ASYNC_CANCELLED &&
+        running_cancel == 0 && second == running && running->status == ASYNC_CANCELLED &&
+        running->output == NULL && running->stats.input_bytes < large_length &&
+        cancelAsyncJob(pool, running) == -1) {
+        printf("✓ Trabalho na fila entregue na hora; em execução parou após %llu de %zu bytes\n",
+               (unsigned long long)running->stats.input_bytes, large_length);
+    } else {
+        printf("✗ Cancelamento: fila %d, execução %d, situação %d\n", queued_cancel, running_cancel,
+               running->status);
+    }
+    freeAsyncJob(running);
+    freeAsyncJob(queued);
+    
+    // Teste 6: Encerramento com trabalhos pendentes
+    printf("6. Encerrando com trabalhos pendentes...\n");
+    AsyncCallbackLog shutdown_log;
+    memset(&shutdown_log, 0, sizeof(shutdown_log));
+    pthread_mutex_init(&shutdown_log.mutex, NULL);
+    for (int i = 0; i < 3; i++) {
+        job = createAsyncBufferJob(ASYNC_COMPRESS, large, large_length);
+        job->callback = recordAsyncCallback;
+        job->context = &shutdown_log;
+        submitAsyncJob(pool, job);
+    }
+    destroyAsyncPool(pool);
+    int cancelled = 0;
+    for (int i = 0; i < shutdown_log.count; i++) {
+        cancelled += shutdown_log.jobs[i]->status == ASYNC_CANCELLED;
+        freeAsyncJob(shutdown_log.jobs[i]);
+    }
+    pthread_mutex_destroy(&shutdown_log.mutex);
+    if (shutdown_log.count == 3 && cancelled >= 2) {
+        printf("✓ Os 3 trabalhos foram entregues (%d cancelados)\n", cancelled);
+    } else {
+        printf("✗ Entregues: %d, cancelados: %d\n", shutdown_log.count, cancelled);
+    }
+    
+    // Teste 7: Com plano sob limite, a saída em buffer não passa de plan.limit
+    printf("7. Comprimindo em buffer com plano sob limite...\n");
+    MemoryPlan limited;
+    planMemoryBudget(1024 * 1024, &limited);
+    pool = createAsyncPool(1, 4, &limited);
+    AsyncJob* oversized = createAsyncBufferJob(ASYNC_COMPRESS, large, large_length);
+    AsyncJob* fitting = createAsyncBufferJob(ASYNC_COMPRESS, data, length);
+    submitAsyncJob(pool, oversized);
+    submitAsyncJob(pool, fitting);
+    nextAsyncCompletion(pool, 1);
+    nextAsyncCompletion(pool, 1);
+    if (oversized->status == ASYNC_FAILED && oversized->output == NULL && fitting->status == ASYNC_DONE &&
+        fitting->output_size > 0 && fitting->output_size <= limited.limit) {
+        printf("✓ Saída acima de %zu bytes falhou; a menor foi entregue (%zu bytes)\n", limited.limit,
+               fitting->output_size);
+    } else {
+        printf("✗ Saída sem teto: situações %d e %d\n", oversized->status, fitting->status);
+    }
+    freeAsyncJob(oversized);
+    freeAsyncJob(fitting);
+    destroyAsyncPool(pool);
+    
+    // Limpeza
+    remove("test_async.bin");
+    remove("test_async.huf");
+    free(large);
+    free(data);
+    printf("Arquivos de teste removidos\n\n");
+}
+
+/**
+ * Lê um arquivo comprimido inteiro pelo leitor sob demanda, em pedaços de
+ * tamanhos variados, e compara com os dados originais
+ */
+static int readAllWithHufReader(const char* filename, const unsigned char* expected, size_t length) {
+    HufReader* reader = hufOpen(filename);
+    if (reader == NULL) {
+        return 0;
+    }
+    unsigned char* buffer = (unsigned char*)malloc(length + 1);
+    const size_t chunks[] = {1, 7, 4093, 65536, 300000};
+    size_t total = 0;
+    ssize_t got;
+    for (int i = 0; total <= length; i++) {
+        got = hufRead(reader, buffer + total, chunks[i % 5] < length + 1 - total ? chunks[i % 5] : length + 1 - total);
+        if (got <= 0) {
+            break;
+        }
+        total += (size_t)got;
+    }
+    int ok = got == 0 && total == length && memcmp(buffer, expected, length) == 0 &&
+             hufRead(reader, buffer, 16) == 0;
+    hufClose(reader);
+    free(buffer);
+    return ok;
+}
+
+void testHufReader() {
+    printf("=== Testando o Leitor sob Demanda ===\n");
+    
+    // Texto, ruído e um trecho repetido (referências entre blocos)
+    size_t length = 3 * 1024 * 1024;
+    unsigned char* data = (unsigned char*)malloc(length);
+    unsigned int seed = 47;
+    for (size_t i = 0; i < length; i++) {
+        seed = seed * 1103515245u + 12345u;
+        data[i] = i < length / 3 ? (unsigned char)("leitura sob demanda "[i % 20]) :
+                  i < 2 * length / 3 ? (unsigned char)(seed >> 16) : data[i - length / 3];
+    }
+    FILE* file = fopen("test_reader.bin", "wb");
+    fwrite(data, 1, length, file);
+    fclose(file);
+    
+    MemoryPlan plan;
+    planMemoryBudget(0, &plan);
+    plan.block_size = 64 * 1024;
+    
+    // Teste 1: Contêineres em blocos com transformações, 16 bits e referências
+    printf("1. Lendo contêineres em blocos em pedaços...\n");
+    const char* names[] = {"padrão", "transformações e 16 bits", "deduplicação"};
+    for (int config = 0; config < 3; config++) {
+        BlockWorkspace workspace;
+        initBlockWorkspace(&workspace);
+        workspace.transforms = config == 1 ? TRANSFORM_ALL : 0;
+        workspace.wide = config == 1;
+        workspace.dedup = config == 2;
+        BlockStats stats;
+        compressFileBlocksWith("test_reader.bin", "test_reader.huf", &plan, &stats, &workspace);
+        freeBlockWorkspace(&workspace);
+        
+        if (readAllWithHufReader("test_reader.huf", data, length) && (config != 2 || stats.dedup_blocks > 0)) {
+            printf("✓ %s: %llu blocos lidos sob demanda\n", names[config], (unsigned long long)stats.blocks);
+        } else {
+            printf("✗ %s: dados lidos diferem dos originais\n", names[config]);
+        }
+    }
+    
+    // Teste 2: Memória limitada ao bloco atual
+    printf("2. Medindo a memória do leitor...\n");
+    size_t before = currentMemoryUsage();
+    resetPeakMemoryUsage();
+    HufReader* reader = hufOpen("test_reader.huf");
+    unsigned char chunk[4096];
+    uint64_t total = 0;
+    ssize_t got;
+    while ((got = hufRead(reader, chunk, sizeof(chunk))) > 0) {
+        total += (uint64_t)got;
+    }
+    hufClose(reader);
+    size_t used = peakMemoryUsage() - before;
+    if (got == 0 && total == length && used < 8 * plan.block_size) {
+        printf("✓ %llu bytes lidos com pico de %zu KB (blocos de %zu KB)\n", (unsigned long long)total,
+               used / 1024, plan.block_size / 1024);
+    } else {
+        printf("✗ Pico de %zu KB para blocos de %zu KB\n", used / 1024, plan.block_size / 1024);
+    }
+    
+    // Teste 3: Formato de fluxo único, vazio e de um só símbolo
+    printf("3. Lendo o formato de fluxo único...\n");
+    compressFile("test_reader.bin", "test_reader.hufs");
+    int stream_ok = readAllWithHufReader("test_reader.hufs", data, length);
+    file = fopen("test_reader.one", "wb");
+    fclose(file);
+    compressFile("test_reader.one", "test_reader.hufs");
+    stream_ok = stream_ok && readAllWithHufReader("test_reader.hufs", data, 0);
+    unsigned char repeated[5000];
+    memset(repeated, 'z', sizeof(repeated));
+    file = fopen("test_reader.one", "wb");
+    fwrite(repeated, 1, sizeof(repeated), file);
+    fclose(file);
+    compressFile("test_reader.one", "test_reader.hufs");
+    stream_ok = stream_ok && readAllWithHufReader("test_reader.hufs", repeated, sizeof(repeated));
+    if (stream_ok) {
+        printf("✓ Fluxo único, entrada vazia e símbolo único restaurados\n");
+    } else {
+        printf("✗ Falha na leitura do fluxo único\n");
+    }
+    
+    // Teste 4: Contêiner truncado entrega os blocos inteiros e depois falha
+    printf("4. Lendo um contêiner truncado...\n");
+    int64_t size = getFileSize("test_reader.huf");
+    FILE* whole = fopen("test_reader.huf", "rb");
+    FILE* truncated = fopen("test_reader.cut", "wb");
+    unsigned char* copy = (unsigned char*)malloc((size_t)size);
+    size_t copied = fread(copy, 1, (size_t)size, whole);
+    fwrite(copy, 1, copied / 2, truncated);
+    fclose(whole);
+    fclose(truncated);
+    reader = hufOpen("test_reader.cut");
+    total = 0;
+    while ((got = hufRead(reader, chunk, sizeof(chunk))) > 0) {
+        total += (uint64_t)got;
+    }
+    hufClose(reader);
+    if (got == -1 && total > 0 && total < length) {
+        printf("✓ %llu bytes entregues antes do erro\n", (unsigned long long)total);
+    } else {
+        printf("✗ Contêiner truncado não foi rejeitado (%llu bytes)\n", (unsigned long long)total);
+    }
+    
+    // Limpeza
+    remove("test_reader.bin");
+    remove("test_reader.huf");
+    remove("test_reader.hufs");
+    remove("test_reader.one");
+    remove("test_reader.cut");
+    free(copy);
+    free(data);
+    printf("Arquivos de teste removidos\n\n");
+}
+
 int main() {
     printf("Testes do Compressor Huffman Modular\n");
     printf("=====================================\n\n");
@@ -172,6 +2791,28 @@ int main() {
     testDataStructures();
     testHuffmanAlgorithm();
     testFileOperations();
+    testCodeTables();
+    testDecodeTables();
+    testBlockFormat();
+    testCpuDispatch();
+    testServer();
+    testArchive();
+    testDeduplication();
+    testIncrementalUpdate();
+    testTableCache();
+    testAdaptiveHuffman();
+    testByteStreams();
+    testCompressionLevels();
+    testProgress();
+    testSizeEstimate();
+    testTransforms();
+    testStreamHeader();
+    testParallelDecode();
+    testParallelEncode();
+    testBlockPipeline();
+    testWideSymbols();
+    testAsyncCodec();
+    testHufReader();
     
     printf("Todos os testes concluídos!\n");
     return 0;